@@ -27,6 +27,45 @@
 #include <demoz/c/stdint.h>
 
 
+/* @def: _
+ * c11 memory model atomics (compiler builtins, no <stdatomic.h>),
+ * the operand is a plain integer or pointer object */
+#define ATOMIC_RELAXED __ATOMIC_RELAXED
+#define ATOMIC_ACQUIRE __ATOMIC_ACQUIRE
+#define ATOMIC_RELEASE __ATOMIC_RELEASE
+#define ATOMIC_ACQ_REL __ATOMIC_ACQ_REL
+#define ATOMIC_SEQ_CST __ATOMIC_SEQ_CST
+
+#define ATOMIC_LOAD(p, mo) __atomic_load_n(p, mo)
+#define ATOMIC_STORE(p, v, mo) __atomic_store_n(p, v, mo)
+#define ATOMIC_EXCHANGE(p, v, mo) __atomic_exchange_n(p, v, mo)
+#define ATOMIC_FETCH_ADD(p, v, mo) __atomic_fetch_add(p, v, mo)
+#define ATOMIC_FETCH_SUB(p, v, mo) __atomic_fetch_sub(p, v, mo)
+#define ATOMIC_FETCH_AND(p, v, mo) __atomic_fetch_and(p, v, mo)
+#define ATOMIC_FETCH_OR(p, v, mo) __atomic_fetch_or(p, v, mo)
+/* *old is updated on failure, weak: may fail spuriously (loops) */
+#define ATOMIC_CAS(p, old, v, mo_ok, mo_fail) \
+	__atomic_compare_exchange_n(p, old, v, 0, mo_ok, mo_fail)
+#define ATOMIC_CAS_WEAK(p, old, v, mo_ok, mo_fail) \
+	__atomic_compare_exchange_n(p, old, v, 1, mo_ok, mo_fail)
+#define ATOMIC_FENCE(mo) __atomic_thread_fence(mo)
+
+/* spin-wait hint */
+#if (defined(__i386__) || defined(__x86_64__))
+#	define ATOMIC_PAUSE() __builtin_ia32_pause()
+#elif defined(__aarch64__)
+#	define ATOMIC_PAUSE() __asm__ __volatile__("yield" ::: "memory")
+#else
+#	define ATOMIC_PAUSE() __asm__ __volatile__("" ::: "memory")
+#endif
+
+/* false sharing boundary */
+#ifndef ATOMIC_CACHE_LINE
+#	define ATOMIC_CACHE_LINE 64
+#endif
+/* end */
+
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -24,6 +24,7 @@
 #define _DEMOZ_C_STDLIB_H
 
 #include <demoz/config.h>
+#include <demoz/c/stddef.h>
 #include <demoz/c/stdint.h>
 
 
@@ -68,6 +69,12 @@ struct random_ctx {
 		.bptr = &name##_random_tab1[0], \
 		.eptr = &name##_random_tab1[31] \
 		}
+
+/* radix sort keys of the float/double bits (unsigned order) */
+#define RADIX_KEY_F32(x) ((uint32_t)(x) ^ ((uint32_t)((int32_t)(x) >> 31) \
+	| 0x80000000U))
+#define RADIX_KEY_F64(x) ((uint64_t)(x) ^ ((uint64_t)((int64_t)(x) >> 63) \
+	| 0x8000000000000000ULL))
 /* end */
 
 
@@ -99,8 +106,16 @@ extern
 double C_SYMBOL(strtod)(const char *s, char **e)
 ;
 
+extern
+double C_SYMBOL(strntod)(const char *s, size_t n, char **e)
+;
+
 /* c/stdlib_atoi.c */
 
+extern
+uint64_t C_SYMBOL(atou64n)(const char *s, size_t n, char **e, uint64_t *m)
+;
+
 extern
 uint64_t C_SYMBOL(___strtoull)(const char *s, char **e, uint64_t *m, int32_t b)
 ;
@@ -133,6 +148,26 @@ extern
 unsigned long long C_SYMBOL(strtoull)(const char *s, char **e, int32_t b)
 ;
 
+/* c/stdlib_dtoa.c */
+
+extern
+uint64_t C_SYMBOL(___dtoa)(double v, int32_t *e)
+;
+
+/* c/stdlib_itoa.c */
+
+extern
+int32_t C_SYMBOL(u64len)(uint64_t v)
+;
+
+extern
+int32_t C_SYMBOL(u64toa)(char *p, uint64_t v)
+;
+
+extern
+int32_t C_SYMBOL(u64tox)(char *p, uint64_t v, int32_t u)
+;
+
 /* c/stdlib_qsort.c */
 
 extern
@@ -140,6 +175,31 @@ void C_SYMBOL(qsort)(void *b, uint64_t n, uint64_t w,
 		int32_t (*cmp)(const void *, const void *))
 ;
 
+extern
+void C_SYMBOL(msort)(void *b, uint64_t n, uint64_t w,
+		int32_t (*cmp)(const void *, const void *), void *tmp)
+;
+
+extern
+void C_SYMBOL(radix_sort32)(void *b, uint64_t n, uint64_t w,
+		uint32_t (*key)(const void *), void *tmp)
+;
+
+extern
+void C_SYMBOL(radix_sort64)(void *b, uint64_t n, uint64_t w,
+		uint64_t (*key)(const void *), void *tmp)
+;
+
+extern
+void C_SYMBOL(radix_part32)(void *b, uint64_t n, uint64_t w,
+		uint32_t (*key)(const void *), void *tmp, uint64_t *part)
+;
+
+extern
+void C_SYMBOL(radix_part64)(void *b, uint64_t n, uint64_t w,
+		uint64_t (*key)(const void *), void *tmp, uint64_t *part)
+;
+
 extern
 void *C_SYMBOL(bsearch)(const void *k, const void *b, uint64_t n, uint64_t w,
 		int32_t (*cmp)(const void *, const void *))
@@ -50,6 +50,11 @@ extern
 void *C_SYMBOL(memchr)(const void *s, uint8_t c, size_t len)
 ;
 
+extern
+void *C_SYMBOL(memchr2)(const void *s, uint8_t c1, uint8_t c2,
+		size_t len)
+;
+
 extern
 void *C_SYMBOL(memrchr)(const void *s, uint8_t c, size_t len)
 ;
@@ -118,6 +123,12 @@ extern
 char *C_SYMBOL(strtok_r)(char *s, const char *sp, char **sl)
 ;
 
+/* c/string_utf8.c */
+
+extern
+int32_t C_SYMBOL(utf8_validate)(const void *s, size_t len)
+;
+
 #ifdef __cplusplus
 }
 #endif
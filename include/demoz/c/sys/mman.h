@@ -47,6 +47,11 @@
 #define X_MS_ASYNC 0x01      /* non-blocking synchronous */
 #define X_MS_SYNC 0x02       /* blocking synchronous */
 #define X_MS_INVALIDATE 0x04 /* synchronous and marked as dirty page */
+
+#define X_MREMAP_MAYMOVE 0x01 /* the kernel may relocate the mapping */
+#define X_MREMAP_FIXED 0x02   /* move to the new address (with MAYMOVE) */
+
+#define X_MFD_CLOEXEC 0x01 /* close on exec */
 /* end */
 
 
@@ -54,6 +59,12 @@
 extern "C" {
 #endif
 
+/* c/sys/mman_memfd.c */
+
+extern
+int32_t C_SYMBOL(memfd_create)(const char *name, int32_t flags)
+;
+
 /* c/sys/mman_mm.c */
 
 extern
@@ -69,6 +80,11 @@ extern
 int32_t C_SYMBOL(mprotect)(void *addr, size_t len, int32_t prot)
 ;
 
+extern
+void *C_SYMBOL(mremap)(void *addr, size_t old_len, size_t new_len,
+		int32_t flags, void *new_addr)
+;
+
 /* c/sys/mman_sync.c */
 
 extern
@@ -0,0 +1,227 @@
+/* @file: stdio.h
+ * #desc:
+ *    The definitions of buffered file streams.
+ *
+ * #copy:
+ *    Copyright (C) 1970 Public Free Software
+ *
+ *    This library is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 2.1 of the License, or (at your option) any later version.
+ *
+ *    This library is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with this library; if not,
+ *    see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _DEMOZ_C_SYS_STDIO_H
+#define _DEMOZ_C_SYS_STDIO_H
+
+#include <demoz/config.h>
+#include <demoz/c/stddef.h>
+#include <demoz/c/stdint.h>
+#include <demoz/c/stdarg.h>
+#include <demoz/c/sys/types.h>
+#include <demoz/c/sys/unistd.h>
+
+
+/* @def: _
+ * end of file */
+#define X_EOF (-1)
+/* default buffer size */
+#define X_BUFSIZ 4096
+
+/* full buffering */
+#define X_IOFBF 0
+/* line buffering */
+#define X_IOLBF 1
+/* no buffering (flushed before each call returns) */
+#define X_IONBF 2
+
+/* one direction at a time: rpos/rend hold read-ahead data,
+ * wpos the pending output, buf has one more byte for scanf,
+ * lock is the owner thread and count its nesting */
+struct x_file {
+	int32_t fd;
+	int32_t flags;
+	int32_t mode;
+	volatile int32_t lock;
+	int32_t count;
+	uint8_t *buf;
+	size_t size;
+	size_t rpos;
+	size_t rend;
+	size_t wpos;
+	struct x_file *next;
+};
+/* end */
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* c/sys/stdio_file.c */
+
+extern
+struct x_file *C_SYMBOL(stdin)
+;
+
+extern
+struct x_file *C_SYMBOL(stdout)
+;
+
+extern
+struct x_file *C_SYMBOL(stderr)
+;
+
+extern
+int32_t C_SYMBOL(___fput)(struct x_file *f, const void *s, size_t len)
+;
+
+extern
+int32_t C_SYMBOL(___fdone)(struct x_file *f)
+;
+
+extern
+char *C_SYMBOL(___fline)(struct x_file *f, size_t *len, int32_t more)
+;
+
+extern
+struct x_file *C_SYMBOL(fdopen)(int32_t fd, const char *mode)
+;
+
+extern
+struct x_file *C_SYMBOL(fopen)(const char *path, const char *mode)
+;
+
+extern
+int32_t C_SYMBOL(fclose)(struct x_file *f)
+;
+
+extern
+int32_t C_SYMBOL(setvbuf)(struct x_file *f, char *buf, int32_t mode,
+		size_t size)
+;
+
+extern
+int32_t C_SYMBOL(fflush)(struct x_file *f)
+;
+
+extern
+size_t C_SYMBOL(fread)(void *p, size_t size, size_t n, struct x_file *f)
+;
+
+extern
+size_t C_SYMBOL(fwrite)(const void *p, size_t size, size_t n,
+		struct x_file *f)
+;
+
+extern
+int32_t C_SYMBOL(fseek)(struct x_file *f, x_off_t off, int32_t whence)
+;
+
+extern
+x_off_t C_SYMBOL(ftell)(struct x_file *f)
+;
+
+extern
+void C_SYMBOL(rewind)(struct x_file *f)
+;
+
+extern
+int32_t C_SYMBOL(fileno)(struct x_file *f)
+;
+
+extern
+int32_t C_SYMBOL(feof)(struct x_file *f)
+;
+
+extern
+int32_t C_SYMBOL(ferror)(struct x_file *f)
+;
+
+extern
+void C_SYMBOL(clearerr)(struct x_file *f)
+;
+
+extern
+void C_SYMBOL(flockfile)(struct x_file *f)
+;
+
+extern
+void C_SYMBOL(funlockfile)(struct x_file *f)
+;
+
+extern
+int32_t C_SYMBOL(ftrylockfile)(struct x_file *f)
+;
+
+extern
+int32_t C_SYMBOL(getc)(struct x_file *f)
+;
+
+extern
+int32_t C_SYMBOL(getchar)(void)
+;
+
+extern
+int32_t C_SYMBOL(putc)(int32_t c, struct x_file *f)
+;
+
+extern
+int32_t C_SYMBOL(putchar)(int32_t c)
+;
+
+extern
+int32_t C_SYMBOL(fputs)(const char *s, struct x_file *f)
+;
+
+/* c/sys/stdio_fprintf.c */
+
+extern
+int32_t C_SYMBOL(vfprintf)(struct x_file *f, const char *fmt, va_list ap)
+;
+
+extern
+int32_t C_SYMBOL(fprintf)(struct x_file *f, const char *fmt, ...)
+;
+
+extern
+int32_t C_SYMBOL(vprintf)(const char *fmt, va_list ap)
+;
+
+extern
+int32_t C_SYMBOL(printf)(const char *fmt, ...)
+;
+
+/* c/sys/stdio_fscanf.c */
+
+extern
+int32_t C_SYMBOL(vfscanf)(struct x_file *f, const char *fmt, va_list ap)
+;
+
+extern
+int32_t C_SYMBOL(fscanf)(struct x_file *f, const char *fmt, ...)
+;
+
+extern
+int32_t C_SYMBOL(vscanf)(const char *fmt, va_list ap)
+;
+
+extern
+int32_t C_SYMBOL(scanf)(const char *fmt, ...)
+;
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif
@@ -64,6 +64,30 @@ extern
 void C_SYMBOL(free)(void *p)
 ;
 
+extern
+void *C_SYMBOL(realloc)(void *p, size_t size)
+;
+
+extern
+void *C_SYMBOL(calloc)(size_t n, size_t size)
+;
+
+extern
+int32_t C_SYMBOL(posix_memalign)(void **p, size_t align, size_t size)
+;
+
+extern
+void *C_SYMBOL(aligned_alloc)(size_t align, size_t size)
+;
+
+extern
+size_t C_SYMBOL(malloc_usable_size)(void *p)
+;
+
+extern
+void C_SYMBOL(malloc_thread_release)(void)
+;
+
 #ifdef __cplusplus
 }
 #endif
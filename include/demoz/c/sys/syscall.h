@@ -63,6 +63,7 @@
 #	endif
 #	include <linux/time.h>
 #	include <linux/mman.h>
+#	include <linux/memfd.h>
 #	include <linux/fcntl.h>
 #	include <linux/fs.h>
 #	include <linux/stat.h>
@@ -91,7 +92,9 @@
 #define XSYSCALL_mmap (__NR_mmap)
 #define XSYSCALL_munmap (__NR_munmap)
 #define XSYSCALL_mprotect (__NR_mprotect)
+#define XSYSCALL_mremap (__NR_mremap)
 #define XSYSCALL_msync (__NR_msync)
+#define XSYSCALL_memfd_create (__NR_memfd_create)
 
 /* fcntl.h */
 #define XSYSCALL_fcntl (__NR_fcntl)
@@ -109,6 +112,8 @@
 
 #define XSYSCALL_lseek (__NR_lseek)
 #define XSYSCALL_llseek (__NR_llseek)
+#define XSYSCALL_ftruncate (__NR_ftruncate)
+#define XSYSCALL_ftruncate64 (__NR_ftruncate64)
 
 #define XSYSCALL_unlink (__NR_unlink)
 #define XSYSCALL_unlinkat (__NR_unlinkat)
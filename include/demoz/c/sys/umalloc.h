@@ -45,29 +45,49 @@ struct umalloc_chunk_node {
 	struct umalloc_chunk chunk;
 };
 
+/* free chunk link (stored in the chunk body) */
+struct umalloc_chunk_link {
+	struct umalloc_chunk *next, *prev;
+};
+
+/* allocations of this size and above get their own node */
+#define UMALLOC_BIG_SIZE (1 << 17)
+
+/* bins: 64 exact (16 ... 1024) + 32 log-spaced (4 per power of two) */
+#define UMALLOC_BIN_NUM 96
+#define UMALLOC_BIN_MAP ((UMALLOC_BIN_NUM + 31) / 32)
+
 struct umalloc_ctx {
 	struct list_head chunk;
-	struct umalloc_chunk *idle;
+	struct umalloc_chunk *idle; /* retained empty node */
+	struct umalloc_chunk *bin[UMALLOC_BIN_NUM];
+	uint32_t bin_map[UMALLOC_BIN_MAP]; /* non-empty bins */
 	void *arg;
 	/* size, arg */
 	void *(*call_alloc)(size_t, void *);
 	/* alloc pointer, size, arg */
 	void (*call_free)(void *, size_t, void *);
+	/* alloc pointer, old size, new size, arg (optional, big chunk) */
+	void *(*call_realloc)(void *, size_t, size_t, void *);
 };
 
 #define UMALLOC_NEW(name, alloc, free, _arg) \
 	struct umalloc_ctx name = { \
 		.chunk.node = NULL, \
+		.idle = NULL, \
 		.call_alloc = alloc, \
 		.call_free = free, \
 		.arg = _arg \
 		}
 
 #define UMALLOC_INIT(name, alloc, free, _arg) \
-	(name)->chunk.node = NULL; \
-	(name)->call_alloc = alloc; \
-	(name)->call_free = free; \
-	(name)->arg = _arg
+	*(name) = (struct umalloc_ctx){ \
+		.chunk.node = NULL, \
+		.idle = NULL, \
+		.call_alloc = alloc, \
+		.call_free = free, \
+		.arg = _arg \
+		}
 /* end */
 
 
@@ -89,6 +109,19 @@ extern
 void C_SYMBOL(___ufree_all)(struct umalloc_ctx *ctx)
 ;
 
+extern
+void *C_SYMBOL(___umalloc_align)(struct umalloc_ctx *ctx, size_t align,
+		size_t size)
+;
+
+extern
+void *C_SYMBOL(___urealloc)(struct umalloc_ctx *ctx, void *p, size_t size)
+;
+
+extern
+size_t C_SYMBOL(___umalloc_usable)(void *p)
+;
+
 #ifdef __cplusplus
 }
 #endif
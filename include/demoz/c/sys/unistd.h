@@ -95,6 +95,12 @@ extern
 int32_t C_SYMBOL(sleep)(uint32_t n)
 ;
 
+/* c/sys/unistd_truncate.c */
+
+extern
+int32_t C_SYMBOL(ftruncate)(int32_t fd, x_off_t len)
+;
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,163 @@
+/* @file: ini_index.h
+ * #desc:
+ *    The definitions of compiled ini (initial configuration) index.
+ *
+ * #copy:
+ *    Copyright (C) 1970 Public Free Software
+ *
+ *    This library is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 2.1 of the License, or (at your option) any later version.
+ *
+ *    This library is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with this library; if not,
+ *    see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _DEMOZ_CONF_INI_INDEX_H
+#define _DEMOZ_CONF_INI_INDEX_H
+
+#include <demoz/config.h>
+#include <demoz/c/stddef.h>
+#include <demoz/c/stdint.h>
+#include <demoz/ds/arena.h>
+#include <demoz/ds/swissmap.h>
+#include <demoz/conf/ini_parse.h>
+
+
+/* @def: _
+ * image | [head] [section ctrl] [section array] [key ctrl] [key array]
+ *       | [string pool]
+ *
+ * the whole index is one block, every reference is an offset from the
+ * image start, so the image can be written out and mapped back as-is
+ * (same SWISSMAP_WIDTH and byte order). strings are null terminated,
+ * keys before the first section belong to the section "".
+ */
+#define INI_INDEX_MAGIC 0x58444e49 /* "INDX" */
+#define INI_INDEX_VERSION 1
+#define INI_INDEX_ALIGN 64
+#define INI_INDEX_EVENT_MIN 64
+
+/* ini_index error code (ini_parse codes for syntax errors) */
+#define INI_INDEX_ERR_ALLOC 32
+#define INI_INDEX_ERR_SIZE 33
+#define INI_INDEX_ERR_IMAGE 34
+
+struct ini_index_head {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t size; /* image bytes */
+	uint32_t width; /* SWISSMAP_WIDTH */
+	uint32_t sec_num;
+	uint32_t key_num;
+	uint32_t sec_total;
+	uint32_t key_total;
+	/* image offsets */
+	uint32_t sec_ctrl;
+	uint32_t sec_array;
+	uint32_t key_ctrl;
+	uint32_t key_array;
+	uint32_t pool;
+	uint32_t _pad[3];
+};
+
+struct ini_index_sec {
+	uint32_t name;
+	uint32_t len;
+};
+
+struct ini_index_key {
+	uint32_t sec; /* section slot */
+	uint32_t name;
+	uint32_t len;
+	uint32_t value;
+	uint32_t value_len;
+};
+
+struct ini_index_event {
+	const char *s;
+	int32_t len;
+	int32_t type;
+};
+
+struct ini_index {
+	const char *base; /* image */
+	struct swissmap_head sec;
+	struct swissmap_head key;
+	int32_t err;
+	/* load state */
+	int32_t ev_len;
+	int32_t ev_max;
+	struct ini_index_event *ev;
+	struct arena_ctx *arena;
+	struct ini_ctx ini;
+};
+
+#define INI_INDEX_SIZE(x) (((const struct ini_index_head *)(x)->base)->size)
+#define INI_INDEX_ERR(x) ((x)->err)
+/* end */
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* conf/ini_index.c */
+
+extern
+int32_t F_SYMBOL(ini_index_load)(struct ini_index *idx,
+		struct arena_ctx *arena, const char *s)
+;
+
+extern
+int32_t F_SYMBOL(ini_index_open)(struct ini_index *idx, const void *buf,
+		size_t size)
+;
+
+extern
+const void *F_SYMBOL(ini_index_snapshot)(struct ini_index *idx,
+		size_t *size)
+;
+
+extern
+int32_t F_SYMBOL(ini_index_has)(struct ini_index *idx, const char *sec)
+;
+
+extern
+const char *F_SYMBOL(ini_index_get)(struct ini_index *idx, const char *sec,
+		const char *key, int32_t *len)
+;
+
+extern
+int32_t F_SYMBOL(ini_index_int)(struct ini_index *idx, const char *sec,
+		const char *key, int64_t *v)
+;
+
+extern
+int32_t F_SYMBOL(ini_index_bool)(struct ini_index *idx, const char *sec,
+		const char *key, int32_t *v)
+;
+
+extern
+int32_t F_SYMBOL(ini_index_double)(struct ini_index *idx, const char *sec,
+		const char *key, double *v)
+;
+
+extern
+int32_t F_SYMBOL(ini_index_duration)(struct ini_index *idx,
+		const char *sec, const char *key, int64_t *v)
+;
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif
@@ -0,0 +1,116 @@
+/* @file: json_dom.h
+ * #desc:
+ *    The definitions of json document (tape) builder.
+ *
+ * #copy:
+ *    Copyright (C) 1970 Public Free Software
+ *
+ *    This library is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 2.1 of the License, or (at your option) any later version.
+ *
+ *    This library is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with this library; if not,
+ *    see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _DEMOZ_CONF_JSON_DOM_H
+#define _DEMOZ_CONF_JSON_DOM_H
+
+#include <demoz/config.h>
+#include <demoz/c/stddef.h>
+#include <demoz/c/stdint.h>
+#include <demoz/ds/arena.h>
+#include <demoz/conf/json_parse.h>
+
+
+/* @def: _
+ * tape | [type:8 | count:24 | skip:32]  array, object
+ *      | [type:8 | length:56] [pointer] key (JSON_VALUE_TYPE), string,
+ *      |                                number (source text)
+ *      | [type:8]                       null, true, false
+ *      | [end:8 | start:56]             array end, object end
+ *
+ * values are tape indexes, tape[0] is the root. skip is the index after
+ * the container end, object members are key, value, key, value...
+ * strings point into the source buffer, unless they have escapes
+ * (then into the arena). the tape and strings live in one arena.
+ */
+#define JSON_DOM_TAPE_MIN 256
+
+/* json_dom_parse error code (json_parse codes for syntax errors) */
+#define JSON_DOM_ERR_ALLOC 32
+
+struct json_dom {
+	uint64_t *tape;
+	int32_t len; /* tape entries */
+	int32_t max; /* tape capacity */
+	int32_t err;
+	int32_t depth;
+	struct arena_ctx *arena;
+	struct json_ctx json;
+	int32_t stack[JSON_DEPTH_MAX]; /* open containers */
+};
+
+#define JSON_DOM_TYPE(dom, v) ((int32_t)((dom)->tape[v] >> 56))
+/* end */
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* conf/json_dom.c */
+
+extern
+int32_t F_SYMBOL(json_dom_parse)(struct json_dom *dom,
+		struct arena_ctx *arena, const char *s)
+;
+
+extern
+int32_t F_SYMBOL(json_dom_size)(struct json_dom *dom, int32_t v)
+;
+
+extern
+int32_t F_SYMBOL(json_dom_child)(struct json_dom *dom, int32_t v)
+;
+
+extern
+int32_t F_SYMBOL(json_dom_next)(struct json_dom *dom, int32_t v)
+;
+
+extern
+int32_t F_SYMBOL(json_dom_get)(struct json_dom *dom, int32_t v,
+		const char *key, int32_t len)
+;
+
+extern
+int32_t F_SYMBOL(json_dom_at)(struct json_dom *dom, int32_t v, int32_t n)
+;
+
+extern
+int32_t F_SYMBOL(json_dom_pointer)(struct json_dom *dom, int32_t v,
+		const char *path)
+;
+
+extern
+const char *F_SYMBOL(json_dom_string)(struct json_dom *dom, int32_t v,
+		int32_t *len)
+;
+
+extern
+double F_SYMBOL(json_dom_number)(struct json_dom *dom, int32_t v)
+;
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif
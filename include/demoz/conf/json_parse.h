@@ -50,6 +50,20 @@
 #define JSON_ERR_ARRAY_STRING 10
 #define JSON_ERR_ARRAY_NUMBER 11
 #define JSON_ERR_COMMENT 12
+#define JSON_ERR_DEPTH 13
+#define JSON_ERR_TOKEN_SIZE 14
+#define JSON_ERR_INCOMPLETE 15
+#define JSON_ERR_UTF8 16
+#define JSON_ERR_UNESCAPE 17
+
+/* string options */
+#define JSON_OPT_UNESCAPE 0x01 /* decoded strings to the callback */
+#define JSON_OPT_UTF8 0x02 /* strings must be valid utf-8 */
+
+struct arena_ctx;
+
+/* json_feed nesting limit */
+#define JSON_DEPTH_MAX 256
 
 struct json_ctx {
 	const char *str;
@@ -60,6 +74,24 @@ struct json_ctx {
 	int32_t (*call)(int32_t, const char *, int32_t, void *);
 	/* type, arg */
 	int32_t (*call_end)(int32_t, void *);
+	/* json_feed state */
+	int32_t depth;
+	int32_t lex;
+	int32_t sub;
+	int32_t kw_n;
+	const char *kw;
+	/* token buffer, for tokens split across feeds */
+	char *tok;
+	int32_t tok_len;
+	int32_t tok_max;
+	uint8_t stack[JSON_DEPTH_MAX];
+	/* string options (JSON_OPT_*) */
+	int32_t opt;
+	/* decoded strings: kept in the arena, or in the buffer (until
+	 * the next string) */
+	struct arena_ctx *arena;
+	char *ubuf;
+	int32_t ubuf_max;
 };
 
 #define JSON_NEW(name, _call, _call_end, _arg) \
@@ -72,7 +104,21 @@ struct json_ctx {
 #define JSON_INIT(name, _call, _call_end, _arg) \
 	(name)->call = _call; \
 	(name)->call_end = _call_end; \
-	(name)->arg = _arg
+	(name)->arg = _arg; \
+	(name)->opt = 0
+
+/* string options, decoded strings go to the arena (if any) or to the
+ * buffer (strings longer than this are errors) */
+#define JSON_OPT_INIT(name, _opt, _arena, _buf, _size) \
+	(name)->opt = _opt; \
+	(name)->arena = _arena; \
+	(name)->ubuf = _buf; \
+	(name)->ubuf_max = _size
+
+/* token buffer of json_feed (tokens longer than this are errors) */
+#define JSON_FEED_INIT(name, _buf, _size) \
+	(name)->tok = _buf; \
+	(name)->tok_max = _size
 
 #define JSON_STR(x) ((x)->str)
 #define JSON_ERR(x) ((x)->err)
@@ -90,6 +136,22 @@ extern
 int32_t F_SYMBOL(json_parse)(struct json_ctx *ctx, const char *s)
 ;
 
+extern
+void F_SYMBOL(json_feed_reset)(struct json_ctx *ctx)
+;
+
+extern
+int32_t F_SYMBOL(json_feed)(struct json_ctx *ctx, const char *s, int32_t len)
+;
+
+extern
+int32_t F_SYMBOL(json_finish)(struct json_ctx *ctx)
+;
+
+extern
+int32_t F_SYMBOL(json_unescape)(char *d, const char *s, int32_t len)
+;
+
 #ifdef __cplusplus
 }
 #endif
@@ -60,9 +60,16 @@
 #define XML_ERR_STATEMENT_ATTR_VALUE 11
 #define XML_ERR_COMMENT 12
 #define XML_ERR_CDATA 13
+#define XML_ERR_TOKEN_SIZE 14
+#define XML_ERR_INCOMPLETE 15
+#define XML_ERR_REFERENCE 16
+
+/* string options */
+#define XML_OPT_DECODE 0x01 /* decoded text and attribute values */
 
 struct xml_ctx {
 	const char *str;
+	const char *end; /* end of the xml_parse input */
 	int32_t len;
 	int32_t err;
 	void *arg;
@@ -70,6 +77,20 @@ struct xml_ctx {
 	int32_t (*call)(int32_t, const char *, int32_t, void *);
 	/* type, string, length, arg */
 	int32_t (*call_end)(int32_t, const char *, int32_t, void *);
+	/* xml_feed state */
+	int32_t depth;
+	int32_t state;
+	int32_t sub;
+	const char *kw;
+	/* token buffer, for tokens split across feeds */
+	char *tok;
+	int32_t tok_len;
+	int32_t tok_max;
+	/* string options (XML_OPT_*) */
+	int32_t opt;
+	/* decoded strings (until the next string) */
+	char *dbuf;
+	int32_t dbuf_max;
 };
 
 #define XML_NEW(name, _call, _call_end, _arg) \
@@ -82,7 +103,20 @@ struct xml_ctx {
 #define XML_INIT(name, _call, _call_end, _arg) \
 	(name)->call = _call; \
 	(name)->call_end = _call_end; \
-	(name)->arg = _arg
+	(name)->arg = _arg; \
+	(name)->opt = 0
+
+/* string options, decoded strings go to the buffer (strings longer
+ * than this are errors) */
+#define XML_OPT_INIT(name, _opt, _buf, _size) \
+	(name)->opt = _opt; \
+	(name)->dbuf = _buf; \
+	(name)->dbuf_max = _size
+
+/* token buffer of xml_feed (tokens longer than this are errors) */
+#define XML_FEED_INIT(name, _buf, _size) \
+	(name)->tok = _buf; \
+	(name)->tok_max = _size
 
 #define XML_ERR(name) ((name)->err)
 #define XML_LEN(name) ((name)->len)
@@ -99,6 +133,22 @@ extern
 int32_t F_SYMBOL(xml_parse)(struct xml_ctx *ctx, const char *s)
 ;
 
+extern
+void F_SYMBOL(xml_feed_reset)(struct xml_ctx *ctx)
+;
+
+extern
+int32_t F_SYMBOL(xml_feed)(struct xml_ctx *ctx, const char *s, int32_t len)
+;
+
+extern
+int32_t F_SYMBOL(xml_finish)(struct xml_ctx *ctx)
+;
+
+extern
+int32_t F_SYMBOL(xml_decode)(char *d, const char *s, int32_t len)
+;
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,114 @@
+/* @file: arena.h
+ * #desc:
+ *    The definitions of arena (bump-pointer region) allocator.
+ *
+ * #copy:
+ *    Copyright (C) 1970 Public Free Software
+ *
+ *    This library is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 2.1 of the License, or (at your option) any later version.
+ *
+ *    This library is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with this library; if not,
+ *    see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _DEMOZ_DS_ARENA_H
+#define _DEMOZ_DS_ARENA_H
+
+#include <demoz/config.h>
+#include <demoz/c/stddef.h>
+#include <demoz/c/stdint.h>
+
+
+/* @def: _
+ * ctx | block --> block --> block --> NULL
+ *       (new)                 (old)
+ *       block | { prev, size }<alloc><alloc>...
+ */
+struct arena_block {
+	struct arena_block *prev;
+	size_t size;
+};
+
+struct arena_ctx {
+	struct arena_block *block; /* current block */
+	size_t pos; /* offset of the current block */
+	size_t block_size;
+	void *arg;
+	/* size, arg */
+	void *(*call_alloc)(size_t, void *);
+	/* alloc pointer, size, arg */
+	void (*call_free)(void *, size_t, void *);
+};
+
+/* rollback point */
+struct arena_mark {
+	struct arena_block *block;
+	size_t pos;
+};
+
+#define ARENA_BLOCK_SIZE 65536
+#define ARENA_ALIGN 16
+#define ARENA_HEADER_SIZE \
+	((sizeof(struct arena_block) + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1))
+
+#define ARENA_NEW(name, _block_size, alloc, free, _arg) \
+	struct arena_ctx name = { \
+		.block = NULL, \
+		.pos = 0, \
+		.block_size = _block_size, \
+		.call_alloc = alloc, \
+		.call_free = free, \
+		.arg = _arg \
+		}
+/* end */
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ds/arena.c */
+
+extern
+void F_SYMBOL(arena_init)(struct arena_ctx *ctx, size_t block_size,
+		void *(*call_alloc)(size_t, void *),
+		void (*call_free)(void *, size_t, void *),
+		void *arg)
+;
+
+extern
+void *F_SYMBOL(arena_alloc_align)(struct arena_ctx *ctx, size_t size,
+		size_t align)
+;
+
+extern
+void *F_SYMBOL(arena_alloc)(struct arena_ctx *ctx, size_t size)
+;
+
+extern
+void F_SYMBOL(arena_mark)(struct arena_ctx *ctx, struct arena_mark *mark)
+;
+
+extern
+void F_SYMBOL(arena_reset)(struct arena_ctx *ctx, struct arena_mark *mark)
+;
+
+extern
+void F_SYMBOL(arena_release)(struct arena_ctx *ctx)
+;
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif
@@ -0,0 +1,116 @@
+/* @file: dheap.h
+ * #desc:
+ *    The definitions of indexed d-ary heap data structure.
+ *
+ * #copy:
+ *    Copyright (C) 1970 Public Free Software
+ *
+ *    This library is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 2.1 of the License, or (at your option) any later version.
+ *
+ *    This library is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with this library; if not,
+ *    see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _DEMOZ_DS_DHEAP_H
+#define _DEMOZ_DS_DHEAP_H
+
+#include <demoz/config.h>
+#include <demoz/c/stddef.h>
+#include <demoz/c/stdint.h>
+
+
+/* @def: _
+ * intrusive min-heap, each node keeps its array index (updated on
+ * every move), so erase and key changes need no search. arity is
+ * 2, 4 or 8: the children of one node share one or two cache lines,
+ * and the tree is shallower (sift-up compares less). */
+struct dheap_node {
+	size_t index;
+};
+
+struct dheap_head {
+	struct dheap_node **array;
+	size_t size;
+	size_t total_size;
+	uint32_t shift; /* log2(arity) */
+};
+
+#define DHEAP_NONE ((size_t)-1)
+
+#define DHEAP_NEW(name, _array, _total_size, _arity) \
+	struct dheap_head name = { \
+		.array = _array, \
+		.size = 0, \
+		.total_size = _total_size, \
+		.shift = __builtin_ctz(_arity) \
+		}
+
+#define DHEAP_INIT(name, _array, _total_size, _arity) \
+	(name)->array = _array; \
+	(name)->size = 0; \
+	(name)->total_size = _total_size; \
+	(name)->shift = __builtin_ctz(_arity)
+
+#define DHEAP_NODE_INIT(x) ((x)->index = DHEAP_NONE)
+
+#define DHEAP_PARENT(x, n) (((n) - 1) >> (x)->shift)
+#define DHEAP_CHILD(x, n) (((n) << (x)->shift) + 1)
+
+#define DHEAP_SIZE(x) ((x)->size)
+#define DHEAP_FIRST(x) ((x)->size ? (x)->array[0] : NULL)
+#define DHEAP_IN(x, node) ((node)->index < (x)->size \
+	&& (x)->array[(node)->index] == (node))
+/* end */
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ds/dheap.c */
+
+extern
+int32_t F_SYMBOL(dheap_insert)(struct dheap_head *head,
+		struct dheap_node *_new, int32_t (*cmp)(void *, void *))
+;
+
+extern
+struct dheap_node *F_SYMBOL(dheap_extract)(struct dheap_head *head,
+		int32_t (*cmp)(void *, void *))
+;
+
+extern
+int32_t F_SYMBOL(dheap_erase)(struct dheap_head *head,
+		struct dheap_node *node, int32_t (*cmp)(void *, void *))
+;
+
+extern
+void F_SYMBOL(dheap_decrease)(struct dheap_head *head,
+		struct dheap_node *node, int32_t (*cmp)(void *, void *))
+;
+
+extern
+void F_SYMBOL(dheap_increase)(struct dheap_head *head,
+		struct dheap_node *node, int32_t (*cmp)(void *, void *))
+;
+
+extern
+void F_SYMBOL(dheap_update)(struct dheap_head *head,
+		struct dheap_node *node, int32_t (*cmp)(void *, void *))
+;
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif
@@ -24,26 +24,41 @@
 #define _DEMOZ_DS_RINGBUF_H
 
 #include <demoz/config.h>
+#include <demoz/c/stddef.h>
 #include <demoz/c/stdint.h>
 
 
-/* @def: _ */
+/* @def: _
+ * a power of two size is masked instead of divided (mask: size - 1),
+ * and keeps the offsets right when the indexes wrap around */
 struct ringbuf_head {
 	uint8_t *buf;
 	uint32_t size;
+	uint32_t mask; /* 0: not a power of two */
 	uint32_t read;
 	uint32_t write;
 };
 
+/* same layout as struct iovec (readv/writev) */
+struct ringbuf_span {
+	void *base;
+	size_t len;
+};
+
+#define RINGBUF_MASK(size) \
+	(((size) & ((size) - 1)) ? 0 : (uint32_t)(size) - 1)
+
 #define RINGBUF_NEW(name, _buf, _size) \
 	struct ringbuf_head name = { \
 		.buf = _buf, .size = _size, \
+		.mask = RINGBUF_MASK(_size), \
 		.read = 0, .write = 0 \
 		}
 
 #define RINGBUF_INIT(x, _buf, _size) \
 	(x)->buf = _buf; \
 	(x)->size = _size;\
+	(x)->mask = RINGBUF_MASK(_size); \
 	(x)->read = 0; \
 	(x)->write = 0
 
@@ -58,6 +73,9 @@ struct ringbuf_head {
 
 #define RINGBUF_IS_EMPTY(x) ((x)->write == (x)->read)
 #define RINGBUF_IS_FULL(x) ((x)->size == ((x)->write - (x)->read))
+
+/* spans in use (1 or 2, the second one is empty if not wrapped) */
+#define RINGBUF_SPAN_NUM(s) ((s)[1].len ? 2 : 1)
 /* end */
 
 
@@ -82,6 +100,24 @@ uint32_t F_SYMBOL(ringbuf_peek)(struct ringbuf_head *head, uint8_t *s,
 		uint32_t len, uint32_t off)
 ;
 
+extern
+uint32_t F_SYMBOL(ringbuf_reserve)(struct ringbuf_head *head,
+		struct ringbuf_span span[2], uint32_t len)
+;
+
+extern
+void F_SYMBOL(ringbuf_commit)(struct ringbuf_head *head, uint32_t len)
+;
+
+extern
+uint32_t F_SYMBOL(ringbuf_peek_span)(struct ringbuf_head *head,
+		struct ringbuf_span span[2], uint32_t len)
+;
+
+extern
+void F_SYMBOL(ringbuf_consume)(struct ringbuf_head *head, uint32_t len)
+;
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,67 @@
+/* @file: ringbuf_mirror.h
+ * #desc:
+ *    The definitions of mirrored (virtual memory) ring buffer.
+ *
+ * #copy:
+ *    Copyright (C) 1970 Public Free Software
+ *
+ *    This library is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 2.1 of the License, or (at your option) any later version.
+ *
+ *    This library is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with this library; if not,
+ *    see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _DEMOZ_DS_RINGBUF_MIRROR_H
+#define _DEMOZ_DS_RINGBUF_MIRROR_H
+
+#include <demoz/config.h>
+#include <demoz/c/stdint.h>
+#include <demoz/ds/ringbuf.h>
+
+
+/* @def: _
+ * buf | [pages 0..size) [the same pages again]
+ *
+ * the ring pages are mapped twice back to back, any range of up to
+ * size bytes from the read or write offset is contiguous. the head
+ * is a plain ringbuf_head (power of two size), the ringbuf calls work
+ * as usual, commit and consume move the indexes. */
+#define RINGBUF_MIRROR_PAGE 4096
+
+/* read pointer, RINGBUF_USED(x) bytes */
+#define RINGBUF_MIRROR_READ(x) ((x)->buf + ((x)->read & (x)->mask))
+/* write pointer, RINGBUF_AVAIL(x) bytes */
+#define RINGBUF_MIRROR_WRITE(x) ((x)->buf + ((x)->write & (x)->mask))
+/* end */
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ds/ringbuf_mirror.c */
+
+extern
+int32_t F_SYMBOL(ringbuf_mirror_create)(struct ringbuf_head *head,
+		uint32_t size)
+;
+
+extern
+void F_SYMBOL(ringbuf_mirror_destroy)(struct ringbuf_head *head)
+;
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif
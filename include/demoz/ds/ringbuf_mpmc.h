@@ -0,0 +1,85 @@
+/* @file: ringbuf_mpmc.h
+ * #desc:
+ *    The definitions of multi-producer multi-consumer slot queue.
+ *
+ * #copy:
+ *    Copyright (C) 1970 Public Free Software
+ *
+ *    This library is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 2.1 of the License, or (at your option) any later version.
+ *
+ *    This library is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with this library; if not,
+ *    see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _DEMOZ_DS_RINGBUF_MPMC_H
+#define _DEMOZ_DS_RINGBUF_MPMC_H
+
+#include <demoz/config.h>
+#include <demoz/c/stddef.h>
+#include <demoz/c/stdint.h>
+#include <demoz/c/atomic.h>
+
+
+/* @def: _
+ * bounded queue of fixed-size slots, any thread may push or pop.
+ * slot | [seq:32] [data:wsize] (8-byte stride)
+ *
+ * a slot is free for the push position pos when seq == pos, and
+ * holds data for the pop position pos when seq == pos + 1. the pop
+ * sets seq to pos + size for the next lap. the positions are claimed
+ * by cas, then the slot is published by a release store of seq.
+ * size is a power of two. */
+struct ringbuf_mpmc_head {
+	uint8_t *buf;
+	uint32_t size;
+	uint32_t mask;
+	uint32_t wsize;
+	uint32_t stride;
+	uint32_t push __attribute__((aligned(ATOMIC_CACHE_LINE)));
+	uint32_t pop __attribute__((aligned(ATOMIC_CACHE_LINE)));
+} __attribute__((aligned(ATOMIC_CACHE_LINE)));
+
+#define RINGBUF_MPMC_STRIDE(wsize) \
+	((sizeof(uint32_t) + (size_t)(wsize) + 7) & ~(size_t)7)
+/* buffer size of the slots */
+#define RINGBUF_MPMC_BUFSIZE(size, wsize) \
+	((size_t)(size) * RINGBUF_MPMC_STRIDE(wsize))
+/* end */
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ds/ringbuf_mpmc.c */
+
+extern
+void F_SYMBOL(ringbuf_mpmc_init)(struct ringbuf_mpmc_head *head,
+		void *buf, uint32_t size, uint32_t wsize)
+;
+
+extern
+int32_t F_SYMBOL(ringbuf_mpmc_push)(struct ringbuf_mpmc_head *head,
+		const void *p)
+;
+
+extern
+int32_t F_SYMBOL(ringbuf_mpmc_pop)(struct ringbuf_mpmc_head *head,
+		void *p)
+;
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif
@@ -0,0 +1,92 @@
+/* @file: ringbuf_spsc.h
+ * #desc:
+ *    The definitions of single-producer single-consumer ring buffer.
+ *
+ * #copy:
+ *    Copyright (C) 1970 Public Free Software
+ *
+ *    This library is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 2.1 of the License, or (at your option) any later version.
+ *
+ *    This library is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with this library; if not,
+ *    see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _DEMOZ_DS_RINGBUF_SPSC_H
+#define _DEMOZ_DS_RINGBUF_SPSC_H
+
+#include <demoz/config.h>
+#include <demoz/c/stdint.h>
+#include <demoz/c/atomic.h>
+
+
+/* @def: _
+ * one producer thread writes, one consumer thread reads. each side
+ * owns a cache line: its index (published with release) and a copy of
+ * the other index, reloaded (acquire) only when the copy says the ring
+ * is full or empty. size is a power of two. */
+struct ringbuf_spsc_head {
+	uint8_t *buf;
+	uint32_t size;
+	uint32_t mask;
+	/* producer */
+	uint32_t write __attribute__((aligned(ATOMIC_CACHE_LINE)));
+	uint32_t read_cache;
+	/* consumer */
+	uint32_t read __attribute__((aligned(ATOMIC_CACHE_LINE)));
+	uint32_t write_cache;
+} __attribute__((aligned(ATOMIC_CACHE_LINE)));
+
+#define RINGBUF_SPSC_NEW(name, _buf, _size) \
+	struct ringbuf_spsc_head name = { \
+		.buf = _buf, .size = _size, .mask = (_size) - 1, \
+		.write = 0, .read_cache = 0, \
+		.read = 0, .write_cache = 0 \
+		}
+
+#define RINGBUF_SPSC_INIT(x, _buf, _size) \
+	(x)->buf = _buf; \
+	(x)->size = _size; \
+	(x)->mask = (_size) - 1; \
+	(x)->write = 0; \
+	(x)->read_cache = 0; \
+	(x)->read = 0; \
+	(x)->write_cache = 0
+
+/* either side, a snapshot */
+#define RINGBUF_SPSC_USED(x) \
+	(ATOMIC_LOAD(&(x)->write, ATOMIC_ACQUIRE) \
+	- ATOMIC_LOAD(&(x)->read, ATOMIC_ACQUIRE))
+/* end */
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ds/ringbuf_spsc.c */
+
+extern
+uint32_t F_SYMBOL(ringbuf_spsc_write)(struct ringbuf_spsc_head *head,
+		const uint8_t *s, uint32_t len)
+;
+
+extern
+uint32_t F_SYMBOL(ringbuf_spsc_read)(struct ringbuf_spsc_head *head,
+		uint8_t *s, uint32_t len)
+;
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif
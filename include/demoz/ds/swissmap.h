@@ -28,23 +28,58 @@
 #include <demoz/c/stdint.h>
 
 
-/* @def: _ */
+/* @def: _
+ * ctrl group matcher (one bit per slot) */
+#define SWISSMAP_SIMD_SWAR 1
+#define SWISSMAP_SIMD_SSE2 2
+#define SWISSMAP_SIMD_NEON 3
+
+#ifndef SWISSMAP_SIMD
+#	if defined(__SSE2__)
+#		define SWISSMAP_SIMD SWISSMAP_SIMD_SSE2
+#	elif (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#		define SWISSMAP_SIMD SWISSMAP_SIMD_NEON
+#	else
+#		define SWISSMAP_SIMD SWISSMAP_SIMD_SWAR
+#	endif
+#endif
+
+#if (SWISSMAP_SIMD == SWISSMAP_SIMD_SWAR)
+#	define SWISSMAP_WIDTH 8
+#else
+#	define SWISSMAP_WIDTH 16
+#endif
+
 union swissmap_group {
-	/* XXX: simd optimization */
-	uint32_t ctrl;
-	uint8_t _ctrl[4];
+	uint64_t ctrl[SWISSMAP_WIDTH / 8];
+	uint8_t _ctrl[SWISSMAP_WIDTH];
 };
 
 struct swissmap_head {
 	union swissmap_group *group;
 	void *array;
 	size_t wsize; /* size of each bucket */
-	size_t size;
-	size_t total_size;
+	size_t size; /* both tables */
+	size_t total_size; /* power of two (SWISSMAP_ALIGN) */
+	size_t deleted; /* tombstones */
+	/* rehash source (auto mode) */
+	union swissmap_group *old_group;
+	void *old_array;
+	size_t old_size;
+	size_t old_total;
+	size_t old_pos; /* next group to move */
+	uint32_t flags;
 	/* input key, length */
 	uint64_t (*call_hash)(const void *, size_t);
 	/* bucket, input key, length */
 	int32_t (*call_cmp)(void *, const void *, size_t);
+	/* bucket */
+	uint64_t (*call_rehash)(void *);
+	/* size, arg */
+	void *(*call_alloc)(size_t, void *);
+	/* pointer, size, arg */
+	void (*call_free)(void *, size_t, void *);
+	void *arg;
 };
 
 #define SWISSMAP_NEW(name, _ctrl, _array, _wsize, \
@@ -61,28 +96,81 @@ struct swissmap_head {
 
 #define SWISSMAP_INIT(x, _ctrl, _array, _wsize, \
 		_total_size, _hash, _cmp) \
-	(x)->group = _ctrl; \
-	(x)->array = _array; \
-	(x)->wsize = _wsize; \
-	(x)->size = 0; \
-	(x)->total_size = _total_size; \
-	(x)->call_hash = _hash; \
-	(x)->call_cmp = _cmp
+	*(x) = (struct swissmap_head){ \
+		.group = _ctrl, \
+		.array = _array, \
+		.wsize = _wsize, \
+		.size = 0, \
+		.total_size = _total_size, \
+		.call_hash = _hash, \
+		.call_cmp = _cmp \
+		}
+
+/* auto mode: the table storage is owned and resized by the swissmap */
+#define SWISSMAP_AUTO_NEW(name, _wsize, _hash, _cmp, _rehash, \
+		_alloc, _free, _arg, _flags) \
+	struct swissmap_head name = { \
+		.wsize = _wsize, \
+		.flags = _flags, \
+		.call_hash = _hash, \
+		.call_cmp = _cmp, \
+		.call_rehash = _rehash, \
+		.call_alloc = _alloc, \
+		.call_free = _free, \
+		.arg = _arg \
+		}
+
+#define SWISSMAP_AUTO_INIT(x, _wsize, _hash, _cmp, _rehash, \
+		_alloc, _free, _arg, _flags) \
+	*(x) = (struct swissmap_head){ \
+		.wsize = _wsize, \
+		.flags = _flags, \
+		.call_hash = _hash, \
+		.call_cmp = _cmp, \
+		.call_rehash = _rehash, \
+		.call_alloc = _alloc, \
+		.call_free = _free, \
+		.arg = _arg \
+		}
+
+/* auto mode flags */
+#define SWISSMAP_AUTO_SHRINK 0x01
+
+/* auto mode policy (per mille, see SWISSMAP_FACTOR) */
+#ifndef SWISSMAP_GROW_FACTOR
+#	define SWISSMAP_GROW_FACTOR 875 /* used (live + tombstone) */
+#endif
+#ifndef SWISSMAP_PURGE_FACTOR
+#	define SWISSMAP_PURGE_FACTOR 500 /* live, purge instead of grow */
+#endif
+#ifndef SWISSMAP_SHRINK_FACTOR
+#	define SWISSMAP_SHRINK_FACTOR 125 /* live, halve the table */
+#endif
 
 /* 0b1'0000000 */
 #define SWISSMAP_EMPTY 0x80
 /* 0b1'1111110 */
 #define SWISSMAP_DELETE 0xfe
 
-#define SWISSMAP_CLIGN(x) (((x) + 3) / 4)
-#define SWISSMAP_ALIGN(x) (4 * SWISSMAP_CLIGN(x))
+/* capacity: power of two, at least one group */
+#define SWISSMAP_ALIGN(x) ((size_t)1 << (64 - __builtin_clzll( \
+	((uint64_t)(x) - 1) | (SWISSMAP_WIDTH - 1))))
+#define SWISSMAP_CLIGN(x) (SWISSMAP_ALIGN(x) / SWISSMAP_WIDTH)
 
-#define SWISSMAP_ACTRL(x, n) ((x)->group[(n) >> 2]._ctrl[(n) & 3])
-#define SWISSMAP_ARRAY(x, n) ((void *)((char *)(x)->array + head->wsize * (n)))
+#define SWISSMAP_ACTRL(x, n) \
+	((x)->group[(n) / SWISSMAP_WIDTH]._ctrl[(n) % SWISSMAP_WIDTH])
+#define SWISSMAP_ARRAY(x, n) ((void *)((char *)(x)->array + (x)->wsize * (n)))
 
-#define SWISSMAP_FACTOR(x) (((x)->size * 1000) / (x)->total_size)
+/* load of the current table (per mille) */
+#define SWISSMAP_FACTOR(x) ((((x)->size - (x)->old_size) * 1000) \
+	/ (x)->total_size)
 #define SWISSMAP_SIZE(x) ((x)->size)
 #define SWISSMAP_TOTAL(x) ((x)->total_size)
+
+/* no insert/delete inside the loop */
+#define SWISSMAP_FOR_EACH(head, pos, p) \
+	for (size_t pos = 0; \
+			((p) = F_SYMBOL(swissmap_next)(head, &pos)); )
 /* end */
 
 
@@ -111,6 +199,33 @@ void *F_SYMBOL(swissmap_delete)(struct swissmap_head *head,
 		const void *key, size_t len)
 ;
 
+extern
+void F_SYMBOL(swissmap_purge)(struct swissmap_head *head)
+;
+
+extern
+void F_SYMBOL(swissmap_release)(struct swissmap_head *head)
+;
+
+extern
+void *F_SYMBOL(swissmap_next)(struct swissmap_head *head, size_t *pos)
+;
+
+extern
+int32_t F_SYMBOL(swissmap_reserve)(struct swissmap_head *head, size_t n)
+;
+
+extern
+size_t F_SYMBOL(swissmap_find_batch)(struct swissmap_head *head,
+		const void *key, size_t len, size_t n, void **bucket)
+;
+
+extern
+size_t F_SYMBOL(swissmap_insert_batch)(struct swissmap_head *head,
+		const void *key, size_t len, size_t n,
+		void (*call_set)(void *, size_t, int32_t, void *), void *arg)
+;
+
 #ifdef __cplusplus
 }
 #endif
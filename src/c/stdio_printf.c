@@ -62,8 +62,17 @@ struct printf_ctx {
 #define FG_POSITIVE_NEG 0x200
 #define FG_PRECISE 0x400
 
-#define DOU2STR_DF_PREMAX 324
-#define DOU2STR_DF_LENMAX 680
+/* exact expansion ends at 2^-1074, the rest is zero padding */
+#define DOU2STR_DF_PREMAX 1074
+/* integer digits of DBL_MAX, point, decimals */
+#define DOU2STR_DF_LENMAX (309 + 1 + DOU2STR_DF_PREMAX)
+/* 5^1074 * 2^53 has 767 digits */
+#define DOU2STR_BIGMAX 90
+#define DOU2STR_DIGMAX (DOU2STR_BIGMAX * 9)
+/* floor(log10(2^e)) */
+#define DOU2STR_LOG10_POW2(e) (((uint32_t)(e) * 78913) >> 18)
+/* %r switches to exponent form outside 10^-4 .. 10^17 */
+#define DOU2STR_R_EXPMAX 17
 /* end */
 
 /* @func: _out_pad (static)
@@ -123,21 +132,7 @@ static int32_t _int2str_o(int32_t n, char *p, uint64_t v)
  */
 static int32_t _int2str_d(int32_t n, char *p, uint64_t v)
 {
-	int32_t t = n;
-
-	do {
-		p[n++] = (v % 10) + '0';
-		v /= 10;
-	} while (v);
-
-	int32_t k = n;
-	while (k > t) {
-		char w = p[--k];
-		p[k] = p[t];
-		p[t++] = w;
-	}
-
-	return n;
+	return n + C_SYMBOL(u64toa)(p + n, v);
 }
 
 /* @func: _int2str_x (static)
@@ -151,22 +146,7 @@ static int32_t _int2str_d(int32_t n, char *p, uint64_t v)
  */
 static int32_t _int2str_x(int32_t n, char *p, uint64_t v)
 {
-	int32_t t = n;
-
-	do {
-		int32_t k = v & 15;
-		p[n++] = (k < 10) ? (k + '0') : (k + 'a' - 10);
-		v >>= 4;
-	} while (v);
-
-	int32_t k = n;
-	while (k > t) {
-		char w = p[--k];
-		p[k] = p[t];
-		p[t++] = w;
-	}
-
-	return n;
+	return n + C_SYMBOL(u64tox)(p + n, v, 0);
 }
 
 /* @func: _int2str_X (static)
@@ -180,144 +160,257 @@ static int32_t _int2str_x(int32_t n, char *p, uint64_t v)
  */
 static int32_t _int2str_X(int32_t n, char *p, uint64_t v)
 {
-	int32_t t = n;
+	return n + C_SYMBOL(u64tox)(p + n, v, 1);
+}
 
+/* @func: _dou2dec_exact (static)
+ * #desc:
+ *    floating number to exact decimal digits conversion.
+ *
+ * #1: d [out] digits buffer
+ * #2: v [in]  input floating (finite, sign is ignored)
+ * #3: e [out] exponent of the last digit
+ * #r:   [ret] digits length
+ */
+static int32_t _dou2dec_exact(char *d, double v, int32_t *e)
+{
+	uint32_t big[DOU2STR_BIGMAX];
+	union {
+		double f;
+		uint64_t i;
+	} u = { .f = v };
+	uint64_t m = u.i & ((1ULL << 52) - 1);
+	int32_t x = (int32_t)(u.i >> 52) & 0x7ff;
+	int32_t e2 = -1074, sz = 0, len = 0;
+
+	*e = 0;
+	if (x) {
+		m |= 1ULL << 52;
+		e2 = x - 1075;
+	}
+	if (!m) {
+		d[0] = '0';
+		return 1;
+	}
+	while (!(m & 1)) {
+		m >>= 1;
+		e2++;
+	}
+
+	/* little-endian, base 10^9 */
 	do {
-		int32_t k = v & 15;
-		p[n++] = (k < 10) ? (k + '0') : (k + 'A' - 10);
-		v >>= 4;
-	} while (v);
+		big[sz++] = m % 1000000000;
+		m /= 1000000000;
+	} while (m);
 
-	int32_t k = n;
-	while (k > t) {
-		char w = p[--k];
-		p[k] = p[t];
-		p[t++] = w;
+#undef MIN
+#define MIN(a, b) (((a) < (b)) ? (a) : (b))
+
+	/* m * 2^e2, or (m * 5^-e2) * 10^e2 */
+	for (int32_t k = (e2 < 0) ? -e2 : e2; k > 0; ) {
+		uint64_t mul = 1, carry = 0;
+		if (e2 < 0) { /* up to 5^13 */
+			for (; k > 0 && mul < 1220703125; k--)
+				mul *= 5;
+		} else {
+			mul <<= MIN(k, 29);
+			k -= MIN(k, 29);
+		}
+
+		for (int32_t i = 0; i < sz; i++) {
+			uint64_t t = big[i] * mul + carry;
+			big[i] = t % 1000000000;
+			carry = t / 1000000000;
+		}
+		for (; carry; carry /= 1000000000)
+			big[sz++] = carry % 1000000000;
+	}
+	if (e2 < 0)
+		*e = e2;
+
+	len = _int2str_d(0, d, big[--sz]);
+	while (sz-- > 0) {
+		uint32_t t = big[sz];
+		for (int32_t j = 8; j >= 0; j--) {
+			d[len + j] = (t % 10) + '0';
+			t /= 10;
+		}
+		len += 9;
 	}
 
-	return n;
+	return len;
 }
 
-/* @func: _dou2str_df (static)
+/* @func: _dec_round (static)
  * #desc:
- *    floating number to string conversion.
+ *    decimal digits rounding (round half to even).
  *
- * #1: n   [in]  buffer offset
- * #2: p   [out] buffer
- * #3: v   [in]  input floating
- * #4: pre [in]  floating precision
- * #r:     [ret] output length (+offset)
+ * #1: d     [in/out] digits buffer
+ * #2: len   [in]     digits length
+ * #3: e     [in/out] exponent of the last digit
+ * #4: keep  [in]     digits to keep (<= 0: above the first digit)
+ * #5: exact [in]     digits are exact
+ * #r:       [ret] digits length, -1: undecidable halfway (not exact)
  */
-static int32_t _dou2str_df(int32_t n, char *p, double v, int32_t pre)
+static int32_t _dec_round(char *d, int32_t len, int32_t *e, int32_t keep,
+		int32_t exact)
 {
-	uint32_t big[90], *a, *z, *r;
-	int32_t e = 0, intlen = 0, need = 0;
-
-	v = C_SYMBOL(frexp)(C_SYMBOL(fabs)(v), &e);
+	int32_t up = 0, rest = 0;
 
-	/* integer length, log10(v) + e * log10(2) == log10(v * 2^e) */
-	intlen = (int32_t)C_SYMBOL(floor)(C_SYMBOL(log10)(v)
-		+ e * 0.3010299956639812) + 1;
+	if (keep >= len)
+		return len;
 
-	/* compensate precision */
-	v *= 2;
-	if (v)
-		e--;
-	if (v) {
-		v *= 0x1p28;
-		e -= 28;
+	if (keep < 0) { /* below half of the last place */
+		*e += len - keep;
+		d[0] = '0';
+		return 1;
 	}
 
-	if (v < 0) {
-		a = z = r = big;
+	for (int32_t i = keep + 1; i < len && !rest; i++)
+		rest = (d[i] != '0');
+	if (d[keep] == '5' && !rest) {
+		/* the shortest digits may sit on either side of the tie */
+		if (!exact)
+			return -1;
+		up = (keep > 0 && (d[keep - 1] - '0') & 1);
 	} else {
-		a = z = r = big + (sizeof(big) / sizeof(uint32_t))
-			- X_FP_DBL_MANT_DIG - 1;
+		up = (d[keep] >= '5');
 	}
 
-	/* enlarge */
-	do {
-		*z = (uint32_t)v;
-		v = (v - (uint32_t)(*z++)) * 1000000000;
-	} while (v);
+	*e += len - keep;
+	len = keep;
+
+	if (up) {
+		int32_t i = len - 1;
+		for (; i >= 0 && d[i] == '9'; i--)
+			d[i] = '0';
+		if (i >= 0) {
+			d[i]++;
+		} else { /* 99..9 to 10..0 */
+			d[0] = '1';
+			if (len) {
+				(*e)++;
+			} else {
+				len = 1;
+			}
+		}
+	} else if (!len) {
+		d[len++] = '0';
+	}
 
-#undef MIN
-#define MIN(a, b) (((a) < (b)) ? (a) : (b))
+	return len;
+}
 
-	/* max precision */
-	pre = (pre < 0) ? -pre : pre;
-	pre = MIN(pre, DOU2STR_DF_PREMAX);
-	need = ((pre + (X_FP_DBL_MANT_DIG / 3) + 8) / 9) + 1;
-
-	while (e > 0) { /* positive */
-		int32_t sh = MIN(29, e);
-		uint32_t carry = 0;
-		for (uint32_t *d = z - 1; d >= a; d--) {
-			uint64_t k = ((uint64_t)*d << sh) + carry;
-			*d = k % 1000000000;
-			carry = k / 1000000000;
-		}
-		if (carry)
-			*--a = carry;
-		while (z > a && !z[-1])
-			z--;
-		e -= sh;
-	}
-	while (e < 0) { /* negative */
-		int32_t sh = MIN(9, -e);
-		uint32_t carry = 0;
-		for (uint32_t *d = a; d < z; d++) {
-			uint32_t k = *d & ((1 << sh) - 1);
-			*d = (*d >> sh) + carry;
-			carry = (1000000000 >> sh) * k;
-		}
-		if (!*a)
-			a++;
-		if (carry)
-			*z++ = carry;
-		if ((int32_t)(z - r) > need)
-			z = r + need;
-		e += sh;
+/* @func: _dou2dec (static)
+ * #desc:
+ *    floating number to rounded decimal digits conversion.
+ *
+ *    the shortest digits (ryu) are used when they round the same as the
+ *    exact value: either they already sit on the output grid and the
+ *    ulp is finer than the grid, or they are cut off and no halfway
+ *    point lies between them and the exact value (shortest digits have
+ *    no shorter neighbour in the rounding interval). otherwise the
+ *    exact expansion is rounded.
+ *
+ * #1: d   [out] digits buffer
+ * #2: v   [in]  input floating (finite, sign is ignored)
+ * #3: e   [out] exponent of the last digit
+ * #4: pre [in]  decimals (fix) / significant digits
+ * #5: fix [in]  fixed-point rounding
+ * #r:     [ret] digits length
+ */
+static int32_t _dou2dec(char *d, double v, int32_t *e, int32_t pre,
+		int32_t fix)
+{
+	union {
+		double f;
+		uint64_t i;
+	} u = { .f = v };
+	int32_t x = (int32_t)(u.i >> 52) & 0x7ff;
+	int32_t e2 = x ? (x - 1075) : -1074, len, keep, g;
+	uint64_t m;
+
+	m = C_SYMBOL(___dtoa)(v, e);
+	len = _int2str_d(0, d, m);
+	keep = fix ? (len + *e + pre) : pre;
+
+	if (keep < len) {
+		len = _dec_round(d, len, e, keep, 0);
+		if (len > 0)
+			return len;
+	} else {
+		/* 2^e2 < 10^g, floor(log10(2^|e2|)) is conservative */
+		g = *e + len - keep;
+		if (!m)
+			return len;
+		if (e2 >= 0 && (int32_t)DOU2STR_LOG10_POW2(e2) < g)
+			return len;
+		if (e2 < 0 && -(int32_t)DOU2STR_LOG10_POW2(-e2) <= g)
+			return len;
 	}
 
-	if (intlen <= 0) {
+	len = _dou2dec_exact(d, v, e);
+	keep = fix ? (len + *e + pre) : pre;
+
+	return _dec_round(d, len, e, keep, 1);
+}
+
+/* @func: _dec2str_f (static)
+ * #desc:
+ *    decimal digits to fixed-point string conversion.
+ *
+ * #1: n   [in]  buffer offset
+ * #2: p   [out] buffer
+ * #3: d   [in]  digits
+ * #4: len [in]  digits length
+ * #5: e   [in]  exponent of the last digit
+ * #6: pre [in]  decimals
+ * #7: dot [in]  always decimal point
+ * #r:     [ret] output length (+offset)
+ */
+static int32_t _dec2str_f(int32_t n, char *p, const char *d, int32_t len,
+		int32_t e, int32_t pre, int32_t dot)
+{
+	int32_t k = len + e; /* integer digits */
+
+	if (k <= 0) {
 		p[n++] = '0';
-		if (pre > 0) { /* prefix padding */
-			p[n++] = '.';
-			n = _out_pad(n, p, '0', -intlen);
-			pre -= MIN(-intlen, pre);
-			intlen = 0;
-		}
+	} else {
+		for (int32_t i = 0; i < k; i++)
+			p[n++] = (i < len) ? d[i] : '0';
 	}
 
-	char buf[12], *w;
-	for (uint32_t *d = a; d < z; d++) {
-		int32_t len = _int2str_d(0, buf, *d);
-		if (d != a && len < 9) {
-			_out_pad(0, buf, '0', 9 - len);
-			_int2str_d(9 - len, buf, *d);
-			len = 9;
-		}
-		buf[len] = '\0';
-		w = buf;
-
-		if (intlen > 0) { /* integer */
-			for (; len && intlen; len--, intlen--)
-				p[n++] = *w++;
-			if (!intlen && pre > 0) { /* decimals */
-				p[n++] = '.';
-				for (; len && pre; len--, pre--)
-					p[n++] = *w++;
-			}
-		} else if (pre > 0) { /* decimals */
-			for (; len && pre; len--, pre--)
-				p[n++] = *w++;
-		} else {
-			break;
-		}
-	}
+	if (pre > 0 || dot)
+		p[n++] = '.';
+	for (int32_t i = k; i < k + pre; i++)
+		p[n++] = (i >= 0 && i < len) ? d[i] : '0';
 
-	return _out_pad(n, p, '0', pre); /* suffix padding */
+	return n;
+}
+
+/* @func: _dec2str_e (static)
+ * #desc:
+ *    decimal digits to exponent mantissa string conversion.
+ *
+ * #1: n   [in]  buffer offset
+ * #2: p   [out] buffer
+ * #3: d   [in]  digits
+ * #4: len [in]  digits length
+ * #5: pre [in]  decimals
+ * #6: dot [in]  always decimal point
+ * #r:     [ret] output length (+offset)
+ */
+static int32_t _dec2str_e(int32_t n, char *p, const char *d, int32_t len,
+		int32_t pre, int32_t dot)
+{
+	p[n++] = d[0];
+
+	if (pre > 0 || dot)
+		p[n++] = '.';
+	for (int32_t i = 1; i <= pre; i++)
+		p[n++] = (i < len) ? d[i] : '0';
+
+	return n;
 }
 
 /* @func: _printf_di (static)
@@ -560,19 +653,98 @@ static int32_t _printf_s(struct printf_ctx *ctx)
  */
 static int32_t _printf_f(struct printf_ctx *ctx)
 {
-	char buf[DOU2STR_DF_LENMAX];
-	int32_t neg = 0, a_len = 0, z_len = 0, p_len = 0, len = 0;
-	int32_t flags = ctx->flags;
-	double v = ctx->va.f;
+	char buf[DOU2STR_DF_LENMAX], d[DOU2STR_DIGMAX], x_buf[8];
+	int32_t neg = 0, a_len = 0, z_len = 0, p_len = 0, x_len = 0, len = 0;
+	int32_t flags = ctx->flags, pre = ctx->precise, fix = 1, e = 0, k;
+	int32_t dot = flags & FG_BASE_PREFIX, upper = 0;
+	union {
+		double f;
+		uint64_t i;
+	} u = { .f = ctx->va.f };
+
+	neg = (int32_t)(u.i >> 63);
+	upper = (ctx->specifiers >= 'A' && ctx->specifiers <= 'Z');
+
+	if ((u.i >> 52 & 0x7ff) == 0x7ff) { /* infinity and nan */
+		const char *s = (u.i << 12) ? "nan" : "inf";
+		for (; len < 3; len++)
+			buf[len] = upper ? (s[len] - 'a' + 'A') : s[len];
+		if (flags & FG_ALIGN_RIGHT_ZERO) {
+			flags &= ~FG_ALIGN_RIGHT_ZERO;
+			flags |= FG_ALIGN_RIGHT;
+		}
+		goto e;
+	}
 
-	if (v < 0)
-		neg = 1;
-	len = _dou2str_df(0, buf, v, ctx->precise);
+#undef MIN
+#define MIN(a, b) (((a) < (b)) ? (a) : (b))
 
-	if (ctx->precise > DOU2STR_DF_PREMAX)
-		p_len = ctx->precise - DOU2STR_DF_PREMAX;
+	switch (ctx->specifiers) {
+		case 'e':
+		case 'E':
+			fix = 0;
+			len = _dou2dec(d, ctx->va.f, &e,
+				MIN(pre, DOU2STR_DF_PREMAX) + 1, 0);
+			break;
+		case 'g':
+		case 'G':
+			if (!pre)
+				pre = 1;
+			len = _dou2dec(d, ctx->va.f, &e,
+				MIN(pre, DOU2STR_DF_PREMAX), 0);
+			k = len + e - 1;
+			fix = (k < pre && k >= -4);
+			pre = fix ? (pre - 1 - k) : (pre - 1);
+			break;
+		case 'r': /* shortest round-trip */
+			len = _int2str_d(0, d,
+				C_SYMBOL(___dtoa)(ctx->va.f, &e));
+			k = len + e - 1;
+			fix = (k < DOU2STR_R_EXPMAX && k >= -4);
+			pre = fix ? -e : (len - 1);
+			break;
+		default:
+			len = _dou2dec(d, ctx->va.f, &e,
+				MIN(pre, DOU2STR_DF_PREMAX), 1);
+			break;
+	}
 
-	a_len = ctx->align - len - p_len;
+	/* no trailing zeros, unless '#' */
+	if ((ctx->specifiers | 0x20) == 'g' && !dot) {
+		while (len > 1 && d[len - 1] == '0') {
+			len--;
+			e++;
+		}
+		pre = MIN(pre, fix ? -e : (len - 1));
+	}
+	if (pre < 0)
+		pre = 0;
+
+	/* padding zero */
+	if (pre > DOU2STR_DF_PREMAX) {
+		p_len = pre - DOU2STR_DF_PREMAX;
+		pre = DOU2STR_DF_PREMAX;
+	}
+
+	if (fix) {
+		len = _dec2str_f(0, buf, d, len, e, pre, dot);
+	} else {
+		k = len + e - 1;
+		if (d[0] == '0')
+			k = 0;
+		len = _dec2str_e(0, buf, d, len, pre, dot);
+
+		x_buf[x_len++] = upper ? 'E' : 'e';
+		x_buf[x_len++] = (k < 0) ? '-' : '+';
+		if (k < 0)
+			k = -k;
+		if (k < 10)
+			x_buf[x_len++] = '0';
+		x_len = _int2str_d(x_len, x_buf, (uint64_t)k);
+	}
+
+e:
+	a_len = ctx->align - len - p_len - x_len;
 	if (neg || flags & FG_POSITIVE_NEG)
 		a_len--;
 
@@ -608,6 +780,11 @@ static int32_t _printf_f(struct printf_ctx *ctx)
 		if (ctx->pad(ctx, '0', p_len))
 			return -1;
 	}
+	/* exponent */
+	if (x_len > 0) {
+		if (ctx->out(x_buf, x_len, ctx->arg))
+			return -1;
+	}
 	/* left aligned */
 	if (a_len > 0 && flags & FG_ALIGN_LEFT) {
 		if (ctx->pad(ctx, ' ', a_len))
@@ -669,8 +846,10 @@ int32_t C_SYMBOL(___printf)(const char *fmt, va_list ap, void *arg,
 					return -1;
 				continue;
 			}
-		} else {
-			if (ctx.pad(&ctx, *fmt, 1))
+		} else { /* literal text in one piece */
+			const char *s = fmt;
+			for (; fmt[1] != '\0' && fmt[1] != '%'; fmt++);
+			if (ctx.out(s, (int32_t)(fmt - s + 1), ctx.arg))
 				return -1;
 			continue;
 		}
@@ -843,7 +1022,8 @@ e:
 			case 'E':
 			case 'f': case 'F': case 'g':
 			case 'G': case 'a': case 'A':
-				if (!ctx.precise && ctx.flags & FG_PRECISE)
+			case 'r': /* shortest round-trip */
+				if (!(ctx.flags & FG_PRECISE))
 					ctx.precise = 6;
 				ctx.va.f = va_arg(ap, double);
 
@@ -237,17 +237,14 @@ int32_t C_SYMBOL(___scanf)(const char *s, char **e, const char *fmt,
 					neg = (*s == '-') ? 1 : 0;
 					s++;
 				}
-				if (*s == '0') {
-					s++;
-					if (*s == 'X' || *s == 'x') {
+				if (specifiers == 'i' && *s == '0') {
+					if (s[1] == 'X' || s[1] == 'x') {
 						b = 16;
-						s++;
-					} else if (*s >= '0' && *s <= '7') {
+						s += 2;
+					} else if (s[1] >= '0' && s[1] <= '7') {
 						b = 8;
 						s++;
 					}
-					if (specifiers == 'd' && b != 10)
-						return -1;
 				}
 
 				v = C_SYMBOL(___strtoull)(s, (char **)&s,
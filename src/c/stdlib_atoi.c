@@ -27,6 +27,85 @@
 #include <demoz/c/stdlib.h>
 
 
+/* @def: _ */
+/* 19 digits cannot overflow 64-bit */
+#define ATOI_DIG_SAFE 19
+/* an 8-byte load stays in the page (no length given) */
+#define ATOI_PAGE_SAFE(p) (((uintptr_t)(p) & 4095) <= 4096 - 8)
+/* end */
+
+/* @func: _swar_digits8 (static)
+ * #desc:
+ *    eight decimal digits to number conversion (SWAR).
+ *
+ * #1: s [in]  input string (8 bytes readable)
+ * #2: v [out] number
+ * #r:   [ret] 1: all digits, 0: not all digits
+ */
+static int32_t _swar_digits8(const char *s, uint64_t *v)
+{
+	const uint8_t *p = (const uint8_t *)s;
+	uint64_t x = (uint64_t)p[0] | (uint64_t)p[1] << 8
+		| (uint64_t)p[2] << 16 | (uint64_t)p[3] << 24
+		| (uint64_t)p[4] << 32 | (uint64_t)p[5] << 40
+		| (uint64_t)p[6] << 48 | (uint64_t)p[7] << 56;
+
+	/* high nibbles are 3 and no low nibble is above 9 */
+	if (((x & 0xf0f0f0f0f0f0f0f0ULL)
+			| (((x + 0x0606060606060606ULL)
+			& 0xf0f0f0f0f0f0f0f0ULL) >> 4))
+			!= 0x3333333333333333ULL)
+		return 0;
+
+	/* pairs, then quads, then the eight digits */
+	x -= 0x3030303030303030ULL;
+	x = (x * 10) + (x >> 8);
+	x = (((x & 0x000000ff000000ffULL) * (100 + (1000000ULL << 32)))
+		+ (((x >> 16) & 0x000000ff000000ffULL)
+		* (1 + (10000ULL << 32)))) >> 32;
+	*v = x;
+
+	return 1;
+}
+
+/* @func: atou64n
+ * #desc:
+ *    decimal digits to unsigned number conversion, reads at most n
+ *    characters (no sign, no spaces, no null terminator needed).
+ *
+ * #1: s [in]     input string
+ * #2: n [in]     input length (SIZE_MAX: null-terminated)
+ * #3: e [out]    end pointer / NULL
+ * #4: m [in/out] overflow limit (set to 0 on overflow) / NULL
+ * #r:   [ret]    return number
+ */
+uint64_t C_SYMBOL(atou64n)(const char *s, size_t n, char **e, uint64_t *m)
+{
+	uint64_t v = 0, x;
+	size_t i = 0;
+
+	for (; i + 8 <= ATOI_DIG_SAFE && n - i >= 8; i += 8) {
+		if (n == SIZE_MAX && !ATOI_PAGE_SAFE(s + i))
+			break;
+		if (!_swar_digits8(s + i, &x))
+			break;
+		v = v * 100000000 + x;
+	}
+	for (; i < n && s[i] >= '0' && s[i] <= '9'; i++) {
+		uint32_t d = s[i] - '0';
+		if (m && i >= ATOI_DIG_SAFE && v > (*m - d) / 10)
+			*m = 0;
+		v = (v * 10) + d;
+	}
+	if (m && v > *m)
+		*m = 0;
+
+	if (e) /* end position */
+		*e = (char *)s + i;
+
+	return v;
+}
+
 /* @func: ___strtoull
  * #desc:
  *    string to integer conversion.
@@ -78,6 +157,13 @@ uint64_t C_SYMBOL(___strtoull)(const char *s, char **e, uint64_t *m, int32_t b)
 	for (; *s == '0'; s++);
 
 	uint64_t n = 0;
+	if (b == 10) {
+		char *ee;
+		n = C_SYMBOL(atou64n)(s, SIZE_MAX, &ee, m);
+		s = ee;
+		goto e;
+	}
+
 	for (int32_t d = 0; *s != '\0'; s++) {
 		if (*s >= '0' && *s <= '9') {
 			d = (*s - '0');
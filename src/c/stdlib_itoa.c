@@ -0,0 +1,155 @@
+/* @file: stdlib_itoa.c
+ * #desc:
+ *    The implementations of integer to string conversion.
+ *
+ * #copy:
+ *    Copyright (C) 1970 Public Free Software
+ *
+ *    This library is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 2.1 of the License, or (at your option) any later version.
+ *
+ *    This library is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with this library; if not,
+ *    see <https://www.gnu.org/licenses/>.
+ */
+
+#include <demoz/config.h>
+#include <demoz/c/stddef.h>
+#include <demoz/c/stdint.h>
+#include <demoz/c/stdlib.h>
+
+
+/* @def: _ */
+/* "00" .. "99" */
+static const char _itoa_dig2[200] = {
+	'0','0','0','1','0','2','0','3','0','4',
+	'0','5','0','6','0','7','0','8','0','9',
+	'1','0','1','1','1','2','1','3','1','4',
+	'1','5','1','6','1','7','1','8','1','9',
+	'2','0','2','1','2','2','2','3','2','4',
+	'2','5','2','6','2','7','2','8','2','9',
+	'3','0','3','1','3','2','3','3','3','4',
+	'3','5','3','6','3','7','3','8','3','9',
+	'4','0','4','1','4','2','4','3','4','4',
+	'4','5','4','6','4','7','4','8','4','9',
+	'5','0','5','1','5','2','5','3','5','4',
+	'5','5','5','6','5','7','5','8','5','9',
+	'6','0','6','1','6','2','6','3','6','4',
+	'6','5','6','6','6','7','6','8','6','9',
+	'7','0','7','1','7','2','7','3','7','4',
+	'7','5','7','6','7','7','7','8','7','9',
+	'8','0','8','1','8','2','8','3','8','4',
+	'8','5','8','6','8','7','8','8','8','9',
+	'9','0','9','1','9','2','9','3','9','4',
+	'9','5','9','6','9','7','9','8','9','9'
+};
+
+static const uint64_t _itoa_pow10[20] = {
+	1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL,
+	1000000ULL, 10000000ULL, 100000000ULL, 1000000000ULL,
+	10000000000ULL, 100000000000ULL, 1000000000000ULL,
+	10000000000000ULL, 100000000000000ULL, 1000000000000000ULL,
+	10000000000000000ULL, 100000000000000000ULL,
+	1000000000000000000ULL, 10000000000000000000ULL
+};
+/* end */
+
+/* @func: _bits64 (static)
+ * #desc:
+ *    significant bit count.
+ *
+ * #1: v [in]  input number
+ * #r:   [ret] bit count (v == 0: 1)
+ */
+static int32_t _bits64(uint64_t v)
+{
+	v |= 1;
+#if defined(__GNUC__) || defined(__clang__)
+	return 64 - __builtin_clzll(v);
+#else
+	int32_t n = 0;
+	for (; v; v >>= 1)
+		n++;
+
+	return n;
+#endif
+}
+
+/* @func: u64len
+ * #desc:
+ *    decimal digit count of the unsigned number.
+ *
+ * #1: v [in]  input number
+ * #r:   [ret] digit count (v == 0: 1)
+ */
+int32_t C_SYMBOL(u64len)(uint64_t v)
+{
+	/* 1233 / 4096 ~= log10(2) */
+	int32_t t = (_bits64(v) * 1233) >> 12;
+
+	return t + ((v | 1) >= _itoa_pow10[t]);
+}
+
+/* @func: u64toa
+ * #desc:
+ *    unsigned number to decimal conversion (no null terminator).
+ *
+ * #1: p [out] output buffer (20 bytes are enough)
+ * #2: v [in]  input number
+ * #r:   [ret] output length
+ */
+int32_t C_SYMBOL(u64toa)(char *p, uint64_t v)
+{
+	int32_t len = C_SYMBOL(u64len)(v), n = len;
+
+	/* 32-bit divisions once the rest fits */
+	while (v >> 32) {
+		uint32_t r = (uint32_t)(v % 100) * 2;
+		v /= 100;
+		p[--n] = _itoa_dig2[r + 1];
+		p[--n] = _itoa_dig2[r];
+	}
+
+	uint32_t w = (uint32_t)v;
+	while (w >= 100) {
+		uint32_t r = (w % 100) * 2;
+		w /= 100;
+		p[--n] = _itoa_dig2[r + 1];
+		p[--n] = _itoa_dig2[r];
+	}
+	if (w >= 10) {
+		p[--n] = _itoa_dig2[w * 2 + 1];
+		p[--n] = _itoa_dig2[w * 2];
+	} else {
+		p[--n] = (char)w + '0';
+	}
+
+	return len;
+}
+
+/* @func: u64tox
+ * #desc:
+ *    unsigned number to hexadecimal conversion (no null terminator).
+ *
+ * #1: p [out] output buffer (16 bytes are enough)
+ * #2: v [in]  input number
+ * #3: u [in]  uppercase letters
+ * #r:   [ret] output length
+ */
+int32_t C_SYMBOL(u64tox)(char *p, uint64_t v, int32_t u)
+{
+	const char *dig = u ? "0123456789ABCDEF" : "0123456789abcdef";
+	int32_t len = (_bits64(v) + 3) >> 2;
+
+	for (int32_t n = len; n > 0; v >>= 4)
+		p[--n] = dig[v & 15];
+
+	return len;
+}
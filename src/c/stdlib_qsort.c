@@ -27,9 +27,32 @@
 #include <demoz/c/stdlib.h>
 
 
+/* @def: _
+ * pdqsort (pattern-defeating quicksort) */
+#define INSERTION_SORT_THRESHOLD 24
+#define NINTHER_THRESHOLD 128
+#define PARTIAL_INSERTION_SORT_LIMIT 8
+#define BLOCK_SIZE 64
+
+#define AT(x, n) ((char *)(x) + ((n) * w))
+#define LESS(a, b) (cmp(a, b) < 0)
+/* end */
+
+/* @def: _
+ * msort (stable merge sort, timsort runs) */
+#define MIN_MERGE 64
+#define MAX_RUNS 86
+/* end */
+
+/* @def: _
+ * radix sort (8-bit digits) */
+#define RADIX_KEY(k32, k64, p) ((k32) ? (uint64_t)(k32)(p) : (k64)(p))
+/* end */
+
 /* @func: _qsort_swap (static)
  * #desc:
- *    memory swap.
+ *    memory swap (4, 8 and 16 bytes aligned members are swapped in
+ *    registers).
  *
  * #1: a [in/out] member pointer
  * #2: b [in/out] member pointer
@@ -37,6 +60,30 @@
  */
 static void _qsort_swap(void *a, void *b, uint64_t n)
 {
+	uintptr_t align = (uintptr_t)a | (uintptr_t)b;
+
+	if (n == 8 && !(align & 7)) {
+		uint64_t t = *(uint64_t *)a;
+		*(uint64_t *)a = *(uint64_t *)b;
+		*(uint64_t *)b = t;
+		return;
+	}
+	if (n == 4 && !(align & 3)) {
+		uint32_t t = *(uint32_t *)a;
+		*(uint32_t *)a = *(uint32_t *)b;
+		*(uint32_t *)b = t;
+		return;
+	}
+	if (!(n & 7) && !(align & 7) && n <= 32) {
+		uint64_t *x = a, *y = b;
+		for (; n; n -= 8) {
+			uint64_t t = *x;
+			*x++ = *y;
+			*y++ = t;
+		}
+		return;
+	}
+
 	char buf[32];
 	for (; n > 32; n -= 32) {
 		C_SYMBOL(memcpy)(buf, a, 32);
@@ -79,16 +126,16 @@ static void _qsort(void *b, uint64_t n, uint64_t w,
 	}
 }
 
-/* @func: qsort
+/* @func: _qsort_heap (static)
  * #desc:
- *    sort a table of data (heapsort).
+ *    heapsort (worst case fallback).
  *
  * #1: b   [in/out] base array
  * #2: n   [in]     number of array members
  * #3: w   [in]     members size
  * #4: cmp [in]     callback cmp
  */
-void C_SYMBOL(qsort)(void *b, uint64_t n, uint64_t w,
+static void _qsort_heap(void *b, uint64_t n, uint64_t w,
 		int32_t (*cmp)(const void *, const void *))
 {
 	if (n-- <= 1)
@@ -106,6 +153,820 @@ void C_SYMBOL(qsort)(void *b, uint64_t n, uint64_t w,
 	}
 }
 
+/* @func: _qsort_insertion (static)
+ * #desc:
+ *    insertion sort, the unguarded version needs a member before
+ *    the array that is not greater than any member.
+ *
+ * #1: b         [in/out] begin pointer
+ * #2: e         [in]     end pointer
+ * #3: w         [in]     members size
+ * #4: cmp       [in]     callback cmp
+ * #5: unguarded [in]     no begin check
+ */
+static void _qsort_insertion(char *b, char *e, uint64_t w,
+		int32_t (*cmp)(const void *, const void *), int32_t unguarded)
+{
+	if (b == e)
+		return;
+
+	for (char *cur = b + w; cur < e; cur += w) {
+		for (char *p = cur; (unguarded || p > b)
+				&& LESS(p, p - w); p -= w)
+			_qsort_swap(p, p - w, w);
+	}
+}
+
+/* @func: _qsort_partial_insertion (static)
+ * #desc:
+ *    insertion sort that gives up after a few moves.
+ *
+ * #1: b   [in/out] begin pointer
+ * #2: e   [in]     end pointer
+ * #3: w   [in]     members size
+ * #4: cmp [in]     callback cmp
+ * #r:     [ret]    1: sorted, 0: gave up
+ */
+static int32_t _qsort_partial_insertion(char *b, char *e, uint64_t w,
+		int32_t (*cmp)(const void *, const void *))
+{
+	uint64_t limit = 0;
+
+	if (b == e)
+		return 1;
+
+	for (char *cur = b + w; cur < e; cur += w) {
+		char *p = cur;
+		for (; p > b && LESS(p, p - w); p -= w)
+			_qsort_swap(p, p - w, w);
+		limit += (uint64_t)(cur - p) / w;
+		if (limit > PARTIAL_INSERTION_SORT_LIMIT)
+			return (cur + w) == e;
+	}
+
+	return 1;
+}
+
+/* @func: _qsort_sort2 (static)
+ * #desc:
+ *    order two members.
+ *
+ * #1: a   [in/out] member pointer
+ * #2: b   [in/out] member pointer
+ * #3: w   [in]     members size
+ * #4: cmp [in]     callback cmp
+ */
+static void _qsort_sort2(char *a, char *b, uint64_t w,
+		int32_t (*cmp)(const void *, const void *))
+{
+	if (LESS(b, a))
+		_qsort_swap(a, b, w);
+}
+
+/* @func: _qsort_sort3 (static)
+ * #desc:
+ *    order three members (median in the middle).
+ *
+ * #1: a   [in/out] member pointer
+ * #2: b   [in/out] member pointer
+ * #3: c   [in/out] member pointer
+ * #4: w   [in]     members size
+ * #5: cmp [in]     callback cmp
+ */
+static void _qsort_sort3(char *a, char *b, char *c, uint64_t w,
+		int32_t (*cmp)(const void *, const void *))
+{
+	_qsort_sort2(a, b, w, cmp);
+	_qsort_sort2(b, c, w, cmp);
+	_qsort_sort2(a, b, w, cmp);
+}
+
+/* @func: _qsort_partition_right (static)
+ * #desc:
+ *    partition around the pivot at begin, equal members go to the
+ *    right side.
+ *
+ * #1: b   [in/out] begin pointer (pivot)
+ * #2: e   [in]     end pointer
+ * #3: w   [in]     members size
+ * #4: cmp [in]     callback cmp
+ * #5: ok  [out]    already partitioned
+ * #r:     [ret]    pivot position
+ */
+static char *_qsort_partition_right(char *b, char *e, uint64_t w,
+		int32_t (*cmp)(const void *, const void *), int32_t *ok)
+{
+	char *first = b, *last = e;
+
+	/* the pivot (median of 3) bounds both scans */
+	while (LESS(first += w, b));
+	if ((first - w) == b) {
+		while (first < last && !LESS(last -= w, b));
+	} else {
+		while (!LESS(last -= w, b));
+	}
+
+	*ok = first >= last;
+	while (first < last) {
+		_qsort_swap(first, last, w);
+		while (LESS(first += w, b));
+		while (!LESS(last -= w, b));
+	}
+
+	first -= w;
+	_qsort_swap(b, first, w);
+
+	return first;
+}
+
+/* @func: _qsort_partition_branchless (static)
+ * #desc:
+ *    block partition (BlockQuicksort), the comparison results are
+ *    collected into offset buffers so that there is no branch on them.
+ *
+ * #1: b   [in/out] begin pointer (pivot)
+ * #2: e   [in]     end pointer
+ * #3: w   [in]     members size
+ * #4: cmp [in]     callback cmp
+ * #5: ok  [out]    already partitioned
+ * #r:     [ret]    pivot position
+ */
+static char *_qsort_partition_branchless(char *b, char *e, uint64_t w,
+		int32_t (*cmp)(const void *, const void *), int32_t *ok)
+{
+	uint8_t offsets_l[BLOCK_SIZE], offsets_r[BLOCK_SIZE];
+	char *first = b, *last = e;
+
+	while (LESS(first += w, b));
+	if ((first - w) == b) {
+		while (first < last && !LESS(last -= w, b));
+	} else {
+		while (!LESS(last -= w, b));
+	}
+
+	*ok = first >= last;
+	if (!*ok) {
+		_qsort_swap(first, last, w);
+		first += w;
+
+		char *base_l = first, *base_r = last;
+		uint64_t num_l = 0, num_r = 0, start_l = 0, start_r = 0;
+		while (first < last) {
+			/* fill up the empty offset blocks */
+			uint64_t unknown = (uint64_t)(last - first) / w;
+			uint64_t split_l = num_l ? 0
+				: (num_r ? unknown : (unknown / 2));
+			uint64_t split_r = num_r ? 0 : (unknown - split_l);
+			if (split_l > BLOCK_SIZE)
+				split_l = BLOCK_SIZE;
+			if (split_r > BLOCK_SIZE)
+				split_r = BLOCK_SIZE;
+
+			for (uint64_t i = 0; i < split_l; i++) {
+				offsets_l[num_l] = (uint8_t)i;
+				num_l += !LESS(first, b);
+				first += w;
+			}
+			for (uint64_t i = 0; i < split_r; ) {
+				offsets_r[num_r] = (uint8_t)++i;
+				last -= w;
+				num_r += LESS(last, b);
+			}
+
+			/* swap the members on the wrong side */
+			uint64_t num = (num_l < num_r) ? num_l : num_r;
+			for (uint64_t i = 0; i < num; i++) {
+				_qsort_swap(AT(base_l, offsets_l[start_l + i]),
+					base_r - offsets_r[start_r + i] * w,
+					w);
+			}
+			num_l -= num;
+			num_r -= num;
+			start_l += num;
+			start_r += num;
+			if (!num_l) {
+				start_l = 0;
+				base_l = first;
+			}
+			if (!num_r) {
+				start_r = 0;
+				base_r = last;
+			}
+		}
+
+		/* the leftover members of one side */
+		if (num_l) {
+			while (num_l--) {
+				last -= w;
+				_qsort_swap(AT(base_l,
+					offsets_l[start_l + num_l]), last, w);
+			}
+			first = last;
+		}
+		if (num_r) {
+			while (num_r--) {
+				_qsort_swap(base_r - offsets_r[start_r + num_r]
+					* w, first, w);
+				first += w;
+			}
+		}
+	}
+
+	first -= w;
+	_qsort_swap(b, first, w);
+
+	return first;
+}
+
+/* @func: _qsort_partition_left (static)
+ * #desc:
+ *    partition around the pivot at begin, equal members go to the
+ *    left side (many equal members).
+ *
+ * #1: b   [in/out] begin pointer (pivot)
+ * #2: e   [in]     end pointer
+ * #3: w   [in]     members size
+ * #4: cmp [in]     callback cmp
+ * #r:     [ret]    pivot position
+ */
+static char *_qsort_partition_left(char *b, char *e, uint64_t w,
+		int32_t (*cmp)(const void *, const void *))
+{
+	char *first = b, *last = e;
+
+	while (LESS(b, last -= w));
+	if ((last + w) == e) {
+		while (first < last && !LESS(b, first += w));
+	} else {
+		while (!LESS(b, first += w));
+	}
+
+	while (first < last) {
+		_qsort_swap(first, last, w);
+		while (LESS(b, last -= w));
+		while (!LESS(b, first += w));
+	}
+
+	_qsort_swap(b, last, w);
+
+	return last;
+}
+
+/* @func: _qsort_pdq (static)
+ * #desc:
+ *    pdqsort loop (recursion on the left side).
+ *
+ * #1: b        [in/out] begin pointer
+ * #2: e        [in]     end pointer
+ * #3: w        [in]     members size
+ * #4: cmp      [in]     callback cmp
+ * #5: bad      [in]     bad partitions allowed
+ * #6: leftmost [in]     no member before the begin
+ */
+static void _qsort_pdq(char *b, char *e, uint64_t w,
+		int32_t (*cmp)(const void *, const void *),
+		int32_t bad, int32_t leftmost)
+{
+	int32_t ok;
+	char *p;
+
+	while (1) {
+		uint64_t size = (uint64_t)(e - b) / w;
+		if (size < INSERTION_SORT_THRESHOLD) {
+			_qsort_insertion(b, e, w, cmp, !leftmost);
+			return;
+		}
+
+		/* median of 3 or pseudo median of 9 (ninther) to begin */
+		uint64_t s2 = size / 2;
+		if (size > NINTHER_THRESHOLD) {
+			_qsort_sort3(b, AT(b, s2), e - w, w, cmp);
+			_qsort_sort3(b + w, AT(b, s2 - 1), e - 2 * w, w, cmp);
+			_qsort_sort3(b + 2 * w, AT(b, s2 + 1), e - 3 * w,
+				w, cmp);
+			_qsort_sort3(AT(b, s2 - 1), AT(b, s2), AT(b, s2 + 1),
+				w, cmp);
+			_qsort_swap(b, AT(b, s2), w);
+		} else {
+			_qsort_sort3(AT(b, s2), b, e - w, w, cmp);
+		}
+
+		/*
+		 * the member before is not less than the pivot, so the
+		 * pivot is equal to it, put all equal members left.
+		 */
+		if (!leftmost && !LESS(b - w, b)) {
+			b = _qsort_partition_left(b, e, w, cmp) + w;
+			continue;
+		}
+
+		if (w <= 16) {
+			p = _qsort_partition_branchless(b, e, w, cmp, &ok);
+		} else {
+			p = _qsort_partition_right(b, e, w, cmp, &ok);
+		}
+
+		uint64_t l_size = (uint64_t)(p - b) / w;
+		uint64_t r_size = (uint64_t)(e - (p + w)) / w;
+		if (l_size < (size / 8) || r_size < (size / 8)) {
+			if (!--bad) {
+				_qsort_heap(b, size, w, cmp);
+				return;
+			}
+
+			/* break the patterns */
+			if (l_size >= INSERTION_SORT_THRESHOLD) {
+				_qsort_swap(b, AT(b, l_size / 4), w);
+				_qsort_swap(p - w, p - (l_size / 4) * w, w);
+				if (l_size > NINTHER_THRESHOLD) {
+					_qsort_swap(b + w,
+						AT(b, l_size / 4 + 1), w);
+					_qsort_swap(b + 2 * w,
+						AT(b, l_size / 4 + 2), w);
+					_qsort_swap(p - 2 * w,
+						p - (l_size / 4 + 1) * w, w);
+					_qsort_swap(p - 3 * w,
+						p - (l_size / 4 + 2) * w, w);
+				}
+			}
+			if (r_size >= INSERTION_SORT_THRESHOLD) {
+				_qsort_swap(p + w, AT(p, 1 + r_size / 4), w);
+				_qsort_swap(e - w, e - (r_size / 4) * w, w);
+				if (r_size > NINTHER_THRESHOLD) {
+					_qsort_swap(p + 2 * w,
+						AT(p, 2 + r_size / 4), w);
+					_qsort_swap(p + 3 * w,
+						AT(p, 3 + r_size / 4), w);
+					_qsort_swap(e - 2 * w,
+						e - (1 + r_size / 4) * w, w);
+					_qsort_swap(e - 3 * w,
+						e - (2 + r_size / 4) * w, w);
+				}
+			}
+		} else if (ok && _qsort_partial_insertion(b, p, w, cmp)
+				&& _qsort_partial_insertion(p + w, e, w, cmp)) {
+			/* already partitioned, and both sides nearly sorted */
+			return;
+		}
+
+		_qsort_pdq(b, p, w, cmp, bad, leftmost);
+		b = p + w;
+		leftmost = 0;
+	}
+}
+
+/* @func: qsort
+ * #desc:
+ *    sort a table of data (pdqsort).
+ *
+ * #1: b   [in/out] base array
+ * #2: n   [in]     number of array members
+ * #3: w   [in]     members size
+ * #4: cmp [in]     callback cmp
+ */
+void C_SYMBOL(qsort)(void *b, uint64_t n, uint64_t w,
+		int32_t (*cmp)(const void *, const void *))
+{
+	if (n <= 1 || !w)
+		return;
+
+	/* log2(n) bad partitions before the heapsort */
+	_qsort_pdq(b, AT(b, n), w, cmp, 64 - __builtin_clzll(n), 1);
+}
+
+/* @func: _msort_copy (static)
+ * #desc:
+ *    member copy (4 and 8 bytes aligned members are copied in
+ *    registers).
+ *
+ * #1: a [out] target pointer
+ * #2: b [in]  source pointer
+ * #3: n [in]  member size
+ */
+static void _msort_copy(void *a, const void *b, uint64_t n)
+{
+	uintptr_t align = (uintptr_t)a | (uintptr_t)b;
+
+	if (n == 8 && !(align & 7)) {
+		*(uint64_t *)a = *(const uint64_t *)b;
+	} else if (n == 4 && !(align & 3)) {
+		*(uint32_t *)a = *(const uint32_t *)b;
+	} else {
+		C_SYMBOL(memcpy)(a, b, n);
+	}
+}
+
+/* @func: _msort_upper (static)
+ * #desc:
+ *    first member greater than the key.
+ *
+ * #1: k   [in]  key member
+ * #2: b   [in]  base sorted array
+ * #3: n   [in]  number of array members
+ * #4: w   [in]  members size
+ * #5: cmp [in]  callback cmp
+ * #r:     [ret] member index
+ */
+static uint64_t _msort_upper(const void *k, char *b, uint64_t n, uint64_t w,
+		int32_t (*cmp)(const void *, const void *))
+{
+	uint64_t lo = 0;
+
+	while (n > 0) {
+		uint64_t half = n / 2;
+		if (LESS(k, AT(b, lo + half))) {
+			n = half;
+		} else {
+			lo += half + 1;
+			n -= half + 1;
+		}
+	}
+
+	return lo;
+}
+
+/* @func: _msort_lower (static)
+ * #desc:
+ *    first member not less than the key.
+ *
+ * #1: k   [in]  key member
+ * #2: b   [in]  base sorted array
+ * #3: n   [in]  number of array members
+ * #4: w   [in]  members size
+ * #5: cmp [in]  callback cmp
+ * #r:     [ret] member index
+ */
+static uint64_t _msort_lower(const void *k, char *b, uint64_t n, uint64_t w,
+		int32_t (*cmp)(const void *, const void *))
+{
+	uint64_t lo = 0;
+
+	while (n > 0) {
+		uint64_t half = n / 2;
+		if (LESS(AT(b, lo + half), k)) {
+			lo += half + 1;
+			n -= half + 1;
+		} else {
+			n = half;
+		}
+	}
+
+	return lo;
+}
+
+/* @func: _msort_insertion (static)
+ * #desc:
+ *    stable binary insertion sort.
+ *
+ * #1: b     [in/out] base array
+ * #2: n     [in]     number of array members
+ * #3: start [in]     members before it are sorted
+ * #4: w     [in]     members size
+ * #5: cmp   [in]     callback cmp
+ * #6: tmp   [in]     one member buffer
+ */
+static void _msort_insertion(char *b, uint64_t n, uint64_t start,
+		uint64_t w, int32_t (*cmp)(const void *, const void *),
+		char *tmp)
+{
+	for (uint64_t i = start; i < n; i++) {
+		uint64_t k = _msort_upper(AT(b, i), b, i, w, cmp);
+		if (k == i)
+			continue;
+		_msort_copy(tmp, AT(b, i), w);
+		for (uint64_t j = i; j > k; j--)
+			_msort_copy(AT(b, j), AT(b, j - 1), w);
+		_msort_copy(AT(b, k), tmp, w);
+	}
+}
+
+/* @func: _msort_run (static)
+ * #desc:
+ *    length of the natural run at the begin, a strictly descending
+ *    run is reversed.
+ *
+ * #1: b   [in/out] base array
+ * #2: n   [in]     number of array members
+ * #3: w   [in]     members size
+ * #4: cmp [in]     callback cmp
+ * #r:     [ret]    run length
+ */
+static uint64_t _msort_run(char *b, uint64_t n, uint64_t w,
+		int32_t (*cmp)(const void *, const void *))
+{
+	uint64_t k = 1;
+
+	if (n < 2)
+		return n;
+
+	if (LESS(AT(b, 1), b)) {
+		while (++k < n && LESS(AT(b, k), AT(b, k - 1)));
+		for (uint64_t i = 0, j = k - 1; i < j; i++, j--)
+			_qsort_swap(AT(b, i), AT(b, j), w);
+	} else {
+		while (++k < n && !LESS(AT(b, k), AT(b, k - 1)));
+	}
+
+	return k;
+}
+
+/* @func: _msort_merge (static)
+ * #desc:
+ *    merge two adjacent sorted runs, the smaller one is moved into
+ *    the buffer.
+ *
+ * #1: a   [in/out] first run
+ * #2: na  [in]     first run length
+ * #3: nb  [in]     second run length (follows the first run)
+ * #4: w   [in]     members size
+ * #5: cmp [in]     callback cmp
+ * #6: tmp [in]     buffer
+ */
+static void _msort_merge(char *a, uint64_t na, uint64_t nb, uint64_t w,
+		int32_t (*cmp)(const void *, const void *), char *tmp)
+{
+	char *b = AT(a, na);
+
+	/* the members already in place */
+	uint64_t k = _msort_upper(b, a, na, w, cmp);
+	a = AT(a, k);
+	na -= k;
+	if (!na)
+		return;
+	nb = _msort_lower(AT(a, na - 1), b, nb, w, cmp);
+	if (!nb)
+		return;
+
+	if (na <= nb) {
+		/* forward: the buffer (first run) wins the ties */
+		char *x = tmp, *xe = AT(tmp, na), *y = b, *ye = AT(b, nb);
+		C_SYMBOL(memcpy)(tmp, a, na * w);
+		for (; x < xe && y < ye; a += w) {
+			/* no branch on the comparison result */
+			uint64_t c = LESS(y, x);
+			_msort_copy(a, c ? y : x, w);
+			y += c * w;
+			x += (c ^ 1) * w;
+		}
+		if (x < xe)
+			C_SYMBOL(memcpy)(a, x, (uint64_t)(xe - x));
+	} else {
+		/* backward: the first run goes first on the ties */
+		char *x = AT(a, na), *y = AT(tmp, nb), *p = AT(b, nb);
+		C_SYMBOL(memcpy)(tmp, b, nb * w);
+		while (x > a && y > tmp) {
+			uint64_t c = LESS(y - w, x - w);
+			p -= w;
+			x -= c * w;
+			y -= (c ^ 1) * w;
+			_msort_copy(p, c ? x : y, w);
+		}
+		if (y > tmp)
+			C_SYMBOL(memcpy)(a, tmp, (uint64_t)(y - tmp));
+	}
+}
+
+/* @func: msort
+ * #desc:
+ *    stable sort a table of data (adaptive merge sort, natural runs
+ *    of the timsort).
+ *
+ * #1: b   [in/out] base array
+ * #2: n   [in]     number of array members
+ * #3: w   [in]     members size
+ * #4: cmp [in]     callback cmp
+ * #5: tmp [in]     buffer (n / 2 + 1 members)
+ */
+void C_SYMBOL(msort)(void *b, uint64_t n, uint64_t w,
+		int32_t (*cmp)(const void *, const void *), void *tmp)
+{
+	uint64_t run_base[MAX_RUNS], run_len[MAX_RUNS], minrun, r = 0;
+	int32_t sp = 0;
+
+	if (n < 2 || !w)
+		return;
+
+	/* minrun: 32..64, n / minrun close to a power of two */
+	for (minrun = n; minrun >= MIN_MERGE; minrun >>= 1)
+		r |= minrun & 1;
+	minrun += r;
+
+	for (uint64_t lo = 0; lo < n; ) {
+		uint64_t len = _msort_run(AT(b, lo), n - lo, w, cmp);
+		if (len < minrun) {
+			uint64_t force = minrun;
+			if ((n - lo) < force)
+				force = n - lo;
+			_msort_insertion(AT(b, lo), force, len, w, cmp, tmp);
+			len = force;
+		}
+		run_base[sp] = lo;
+		run_len[sp++] = len;
+		lo += len;
+
+		/* keep the run lengths growing faster than fibonacci */
+		while (sp > 1) {
+			int32_t i = sp - 2;
+			if ((i > 0 && run_len[i - 1]
+					<= (run_len[i] + run_len[i + 1]))
+					|| (i > 1 && run_len[i - 2]
+					<= (run_len[i - 1] + run_len[i]))) {
+				if (run_len[i - 1] < run_len[i + 1])
+					i--;
+			} else if (run_len[i] > run_len[i + 1]) {
+				break;
+			}
+			_msort_merge(AT(b, run_base[i]), run_len[i],
+				run_len[i + 1], w, cmp, tmp);
+			run_len[i] += run_len[i + 1];
+			for (int32_t j = i + 1; j < (sp - 1); j++) {
+				run_base[j] = run_base[j + 1];
+				run_len[j] = run_len[j + 1];
+			}
+			sp--;
+		}
+	}
+
+	while (sp > 1) {
+		int32_t i = sp - 2;
+		if (i > 0 && run_len[i - 1] < run_len[i + 1])
+			i--;
+		_msort_merge(AT(b, run_base[i]), run_len[i],
+			run_len[i + 1], w, cmp, tmp);
+		run_len[i] += run_len[i + 1];
+		for (int32_t j = i + 1; j < (sp - 1); j++) {
+			run_base[j] = run_base[j + 1];
+			run_len[j] = run_len[j + 1];
+		}
+		sp--;
+	}
+}
+
+/* @func: _radix_sort (static)
+ * #desc:
+ *    stable LSD radix sort, the digits that are the same for all
+ *    members are skipped.
+ *
+ * #1: b     [in/out] base array
+ * #2: n     [in]     number of array members
+ * #3: w     [in]     members size
+ * #4: k32   [in]     callback key (32-bit) / NULL
+ * #5: k64   [in]     callback key (64-bit) / NULL
+ * #6: tmp   [in]     buffer (n members)
+ * #7: bytes [in]     key digits
+ */
+static void _radix_sort(void *b, uint64_t n, uint64_t w,
+		uint32_t (*k32)(const void *), uint64_t (*k64)(const void *),
+		void *tmp, int32_t bytes)
+{
+	uint64_t count[8][256];
+	char *src = b, *dst = tmp, *t;
+	uint64_t first;
+
+	if (n < 2 || !w)
+		return;
+
+	C_SYMBOL(memset)(count, 0, sizeof(count));
+	for (uint64_t i = 0; i < n; i++) {
+		uint64_t k = RADIX_KEY(k32, k64, AT(b, i));
+		for (int32_t d = 0; d < bytes; d++)
+			count[d][(k >> (d * 8)) & 0xff]++;
+	}
+	first = RADIX_KEY(k32, k64, b);
+
+	for (int32_t d = 0; d < bytes; d++) {
+		uint64_t *c = count[d], sum = 0;
+		if (c[(first >> (d * 8)) & 0xff] == n)
+			continue;
+
+		for (int32_t i = 0; i < 256; i++) {
+			uint64_t x = c[i];
+			c[i] = sum;
+			sum += x;
+		}
+		for (uint64_t i = 0; i < n; i++) {
+			char *p = AT(src, i);
+			uint64_t k = RADIX_KEY(k32, k64, p);
+			_msort_copy(AT(dst, c[(k >> (d * 8)) & 0xff]++),
+				p, w);
+		}
+		t = src;
+		src = dst;
+		dst = t;
+	}
+
+	if (src != b)
+		C_SYMBOL(memcpy)(b, src, n * w);
+}
+
+/* @func: _radix_part (static)
+ * #desc:
+ *    stable partition by the top key digit.
+ *
+ * #1: b     [in/out] base array
+ * #2: n     [in]     number of array members
+ * #3: w     [in]     members size
+ * #4: k32   [in]     callback key (32-bit) / NULL
+ * #5: k64   [in]     callback key (64-bit) / NULL
+ * #6: tmp   [in]     buffer (n members)
+ * #7: bytes [in]     key digits
+ * #8: part  [out]    part offsets (257 members)
+ */
+static void _radix_part(void *b, uint64_t n, uint64_t w,
+		uint32_t (*k32)(const void *), uint64_t (*k64)(const void *),
+		void *tmp, int32_t bytes, uint64_t *part)
+{
+	int32_t shift = (bytes - 1) * 8;
+	uint64_t c[256];
+
+	C_SYMBOL(memset)(part, 0, sizeof(uint64_t) * 257);
+	for (uint64_t i = 0; i < n; i++) {
+		uint64_t k = RADIX_KEY(k32, k64, AT(b, i));
+		part[((k >> shift) & 0xff) + 1]++;
+	}
+	for (int32_t i = 0; i < 256; i++) {
+		part[i + 1] += part[i];
+		c[i] = part[i];
+	}
+
+	for (uint64_t i = 0; i < n; i++) {
+		char *p = AT(b, i);
+		uint64_t k = RADIX_KEY(k32, k64, p);
+		_msort_copy(AT(tmp, c[(k >> shift) & 0xff]++), p, w);
+	}
+	C_SYMBOL(memcpy)(b, tmp, n * w);
+}
+
+/* @func: radix_sort32
+ * #desc:
+ *    stable sort a table of data by a 32-bit key (LSD radix sort).
+ *
+ * #1: b   [in/out] base array
+ * #2: n   [in]     number of array members
+ * #3: w   [in]     members size
+ * #4: key [in]     callback key
+ * #5: tmp [in]     buffer (n members)
+ */
+void C_SYMBOL(radix_sort32)(void *b, uint64_t n, uint64_t w,
+		uint32_t (*key)(const void *), void *tmp)
+{
+	_radix_sort(b, n, w, key, NULL, tmp, 4);
+}
+
+/* @func: radix_sort64
+ * #desc:
+ *    stable sort a table of data by a 64-bit key (LSD radix sort).
+ *
+ * #1: b   [in/out] base array
+ * #2: n   [in]     number of array members
+ * #3: w   [in]     members size
+ * #4: key [in]     callback key
+ * #5: tmp [in]     buffer (n members)
+ */
+void C_SYMBOL(radix_sort64)(void *b, uint64_t n, uint64_t w,
+		uint64_t (*key)(const void *), void *tmp)
+{
+	_radix_sort(b, n, w, NULL, key, tmp, 8);
+}
+
+/* @func: radix_part32
+ * #desc:
+ *    partition a table of data by the top byte of a 32-bit key,
+ *    the parts can be sorted independently (in parallel) with the
+ *    radix_sort32.
+ *
+ * #1: b    [in/out] base array
+ * #2: n    [in]     number of array members
+ * #3: w    [in]     members size
+ * #4: key  [in]     callback key
+ * #5: tmp  [in]     buffer (n members)
+ * #6: part [out]    part i: [part[i], part[i + 1]) (257 members)
+ */
+void C_SYMBOL(radix_part32)(void *b, uint64_t n, uint64_t w,
+		uint32_t (*key)(const void *), void *tmp, uint64_t *part)
+{
+	_radix_part(b, n, w, key, NULL, tmp, 4, part);
+}
+
+/* @func: radix_part64
+ * #desc:
+ *    partition a table of data by the top byte of a 64-bit key,
+ *    the parts can be sorted independently (in parallel) with the
+ *    radix_sort64.
+ *
+ * #1: b    [in/out] base array
+ * #2: n    [in]     number of array members
+ * #3: w    [in]     members size
+ * #4: key  [in]     callback key
+ * #5: tmp  [in]     buffer (n members)
+ * #6: part [out]    part i: [part[i], part[i + 1]) (257 members)
+ */
+void C_SYMBOL(radix_part64)(void *b, uint64_t n, uint64_t w,
+		uint64_t (*key)(const void *), void *tmp, uint64_t *part)
+{
+	_radix_part(b, n, w, NULL, key, tmp, 8, part);
+}
+
 /* @func: bsearch
  * #desc:
  *    binary search a sorted table.
@@ -26,193 +26,1150 @@
 #include <demoz/c/string.h>
 
 
-/* @func: memcpy
+/* @def: _
+ * string kernels (memcpy, memset, memcmp, memchr, memchr2, strlen), avx2 is
+ * selected at run time on top of sse2 */
+#define STRING_SIMD_SWAR 1
+#define STRING_SIMD_SSE2 2
+#define STRING_SIMD_NEON 3
+
+#ifndef STRING_SIMD
+#	if defined(__SSE2__)
+#		define STRING_SIMD STRING_SIMD_SSE2
+#	elif (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#		define STRING_SIMD STRING_SIMD_NEON
+#	else
+#		define STRING_SIMD STRING_SIMD_SWAR
+#	endif
+#endif
+/* end */
+
+#if (STRING_SIMD == STRING_SIMD_SSE2)
+#	include <immintrin.h>
+#elif (STRING_SIMD == STRING_SIMD_NEON)
+#	include <arm_neon.h>
+#endif
+
+/* the word loops below must not be turned back into library calls */
+#if defined(__GNUC__) && !defined(__clang__)
+#	pragma GCC optimize ("no-tree-loop-distribute-patterns")
+#endif
+
+
+/* @def: _
+ * word-at-a-time helpers (little endian), HAS_ZERO() is exact for
+ * the lowest zero byte */
+#define WSIZE sizeof(size_t)
+#define ONES ((size_t)-1 / 0xff)
+#define HIGHS (ONES << 7)
+#define HAS_ZERO(x) (((x) - ONES) & ~(x) & HIGHS)
+#define ZERO_INDEX(x) ((size_t)__builtin_ctzll((uint64_t)(x)) >> 3)
+
+/* length from an aligned-down pointer, (size_t)-1 means no limit */
+#define LEN_OFF(len, off) \
+	(((len) > (size_t)-1 - (off)) ? (size_t)-1 : (len) + (off))
+
+#define LOAD(p) (*(const wunaligned_t *)(p))
+#define STORE(p, x) (*(wunaligned_t *)(p) = (x))
+
+/* copies at least this large bypass the cache */
+#ifndef STRING_NT_SIZE
+#	define STRING_NT_SIZE (4 * 1024 * 1024)
+#endif
+/* end */
+
+typedef size_t __attribute__((__may_alias__, __aligned__(1))) wunaligned_t;
+typedef size_t __attribute__((__may_alias__)) waligned_t;
+
+/* @func: _memcpy_swar (static)
  * #desc:
- *    copy memory area.
+ *    word-at-a-time memcpy, the unaligned head and tail are covered
+ *    by two overlapping word copies.
  *
  * #1: t   [out] target pointer
  * #2: s   [in]  source pointer
  * #3: len [in]  length
  * #r:     [ret] target pointer
  */
-void *C_SYMBOL(memcpy)(void *t, const void *s, size_t len)
+static void *_memcpy_swar(void *t, const void *s, size_t len)
 {
-	if (!len) /* len is zero */
+	uint8_t *d = t;
+	const uint8_t *p = s;
+
+	if (len < WSIZE) {
+		while (len--)
+			*d++ = *p++;
 		return t;
+	}
 
-#if 1 /* little endian */
-#	define LS >>
-#	define RS <<
-#else
-#	define LS <<
-#	define RS >>
-#endif
+	size_t head = LOAD(p), tail = LOAD(p + len - WSIZE);
+	uint8_t *e = d + len;
+
+	size_t k = WSIZE - ((uintptr_t)d & (WSIZE - 1));
+	d += k;
+	p += k;
+	len -= k;
+	for (; len >= WSIZE * 4; len -= WSIZE * 4) {
+		size_t w0 = LOAD(p), w1 = LOAD(p + WSIZE),
+			w2 = LOAD(p + WSIZE * 2), w3 = LOAD(p + WSIZE * 3);
+		((waligned_t *)d)[0] = w0;
+		((waligned_t *)d)[1] = w1;
+		((waligned_t *)d)[2] = w2;
+		((waligned_t *)d)[3] = w3;
+		d += WSIZE * 4;
+		p += WSIZE * 4;
+	}
+	for (; len >= WSIZE; len -= WSIZE) {
+		*(waligned_t *)d = LOAD(p);
+		d += WSIZE;
+		p += WSIZE;
+	}
+	STORE(t, head);
+	STORE(e - WSIZE, tail);
 
-	volatile uint8_t *_t = t, *_s = (uint8_t *)s;
-	uint32_t w, x;
-
-	for (; ((uintptr_t)_s & 3) && len; len--)
-		*_t++ = *_s++;
-
-	switch ((uintptr_t)_t & 3) {
-		case 0:
-			for (; len > 15; len -= 16) {
-				((uint32_t *)_t)[0] = ((uint32_t *)_s)[0];
-				((uint32_t *)_t)[1] = ((uint32_t *)_s)[1];
-				((uint32_t *)_t)[2] = ((uint32_t *)_s)[2];
-				((uint32_t *)_t)[3] = ((uint32_t *)_s)[3];
-				_t += 16;
-				_s += 16;
-			}
-			break;
-		case 1:
-			if (len < 32)
-				break;
-
-			w = *((uint32_t *)_s);
-			*_t++ = *_s++;
-			*_t++ = *_s++;
-			*_t++ = *_s++;
-			len -= 3;
-
-			for (; len > 16; len -= 16) {
-				x = *((uint32_t *)(_s + 1));
-				((uint32_t *)_t)[0] = (w LS 24) | (x RS 8);
-				w = *((uint32_t *)(_s + 5));
-				((uint32_t *)_t)[1] = (x LS 24) | (w RS 8);
-				x = *((uint32_t *)(_s + 9));
-				((uint32_t *)_t)[2] = (w LS 24) | (x RS 8);
-				w = *((uint32_t *)(_s + 13));
-				((uint32_t *)_t)[3] = (x LS 24) | (w RS 8);
-				_t += 16;
-				_s += 16;
-			}
-			break;
-		case 2:
-			if (len < 32)
-				break;
-
-			w = *((uint32_t *)_s);
-			*_t++ = *_s++;
-			*_t++ = *_s++;
-			len -= 2;
-
-			for (; len > 17; len -= 16) {
-				x = *((uint32_t *)(_s + 2));
-				((uint32_t *)_t)[0] = (w LS 16) | (x RS 16);
-				w = *((uint32_t *)(_s + 6));
-				((uint32_t *)_t)[1] = (x LS 16) | (w RS 16);
-				x = *((uint32_t *)(_s + 10));
-				((uint32_t *)_t)[2] = (w LS 16) | (x RS 16);
-				w = *((uint32_t *)(_s + 14));
-				((uint32_t *)_t)[3] = (x LS 16) | (w RS 16);
-				_t += 16;
-				_s += 16;
-			}
-			break;
-		case 3:
-			if (len < 32)
-				break;
-
-			w = *((uint32_t *)_s);
-			*_t++ = *_s++;
-			len -= 1;
-
-			for (; len > 18; len -= 16) {
-				x = *((uint32_t *)(_s + 3));
-				((uint32_t *)_t)[0] = (w LS 8) | (x RS 24);
-				w = *((uint32_t *)(_s + 7));
-				((uint32_t *)_t)[1] = (x LS 8) | (w RS 24);
-				x = *((uint32_t *)(_s + 11));
-				((uint32_t *)_t)[2] = (w LS 8) | (x RS 24);
-				w = *((uint32_t *)(_s + 15));
-				((uint32_t *)_t)[3] = (x LS 8) | (w RS 24);
-				_t += 16;
-				_s += 16;
-			}
-			break;
-		default:
-			break;
+	return t;
+}
+
+/* @func: _memset_swar (static)
+ * #desc:
+ *    word-at-a-time memset.
+ *
+ * #1: t   [out] target pointer
+ * #2: c   [in]  character
+ * #3: len [in]  length
+ * #r:     [ret] target pointer
+ */
+static void *_memset_swar(void *t, int8_t c, size_t len)
+{
+	uint8_t *d = t;
+
+	if (len < WSIZE) {
+		while (len--)
+			*d++ = (uint8_t)c;
+		return t;
+	}
+
+	size_t w = (uint8_t)c * ONES;
+	STORE(d, w);
+	STORE(d + len - WSIZE, w);
+
+	size_t k = WSIZE - ((uintptr_t)d & (WSIZE - 1));
+	d += k;
+	len -= k;
+	for (; len >= WSIZE * 4; len -= WSIZE * 4) {
+		((waligned_t *)d)[0] = w;
+		((waligned_t *)d)[1] = w;
+		((waligned_t *)d)[2] = w;
+		((waligned_t *)d)[3] = w;
+		d += WSIZE * 4;
+	}
+	for (; len >= WSIZE; len -= WSIZE) {
+		*(waligned_t *)d = w;
+		d += WSIZE;
+	}
+
+	return t;
+}
+
+/* @func: _memcmp_swar (static)
+ * #desc:
+ *    word-at-a-time memcmp.
+ *
+ * #1: s1  [in]  source1 pointer
+ * #2: s2  [in]  source2 pointer
+ * #3: len [in]  length
+ * #r:     [ret] 0: equal, 0<N>0: *s1 - *s2
+ */
+static int32_t _memcmp_swar(const void *s1, const void *s2, size_t len)
+{
+	const uint8_t *a = s1, *b = s2;
+
+	for (; len >= WSIZE; len -= WSIZE) {
+		size_t x = LOAD(a) ^ LOAD(b);
+		if (x) {
+			size_t i = ZERO_INDEX(x);
+			return a[i] - b[i];
+		}
+		a += WSIZE;
+		b += WSIZE;
+	}
+	for (; len; len--, a++, b++) {
+		if (*a != *b)
+			return *a - *b;
+	}
+
+	return 0;
+}
+
+#if (STRING_SIMD == STRING_SIMD_SWAR)
+
+/* @func: _memchr_swar (static)
+ * #desc:
+ *    word-at-a-time memchr.
+ *
+ * #1: s   [in]  source pointer
+ * #2: c   [in]  character
+ * #3: len [in]  length
+ * #r:     [ret] target location / NULL pointer
+ */
+static void *_memchr_swar(const void *s, uint8_t c, size_t len)
+{
+	const uint8_t *p = s;
+
+	for (; ((uintptr_t)p & (WSIZE - 1)) && len; len--, p++) {
+		if (*p == c)
+			return (void *)p;
+	}
+
+	size_t w = c * ONES;
+	for (; len >= WSIZE; len -= WSIZE, p += WSIZE) {
+		size_t x = *(const waligned_t *)p ^ w;
+		x = HAS_ZERO(x);
+		if (x)
+			return (void *)(p + ZERO_INDEX(x));
+	}
+	for (; len; len--, p++) {
+		if (*p == c)
+			return (void *)p;
+	}
+
+	return NULL;
+}
+
+/* @func: _memchr2_swar (static)
+ * #desc:
+ *    word-at-a-time memchr for either of two characters.
+ *
+ * #1: s   [in]  source pointer
+ * #2: c1  [in]  character
+ * #3: c2  [in]  character
+ * #4: len [in]  length
+ * #r:     [ret] target location / NULL pointer
+ */
+static void *_memchr2_swar(const void *s, uint8_t c1, uint8_t c2,
+		size_t len)
+{
+	const uint8_t *p = s;
+
+	for (; ((uintptr_t)p & (WSIZE - 1)) && len; len--, p++) {
+		if (*p == c1 || *p == c2)
+			return (void *)p;
+	}
+
+	/* the lowest bit of either mask is exact */
+	size_t w1 = c1 * ONES, w2 = c2 * ONES;
+	for (; len >= WSIZE; len -= WSIZE, p += WSIZE) {
+		size_t x = *(const waligned_t *)p;
+		x = HAS_ZERO(x ^ w1) | HAS_ZERO(x ^ w2);
+		if (x)
+			return (void *)(p + ZERO_INDEX(x));
+	}
+	for (; len; len--, p++) {
+		if (*p == c1 || *p == c2)
+			return (void *)p;
+	}
+
+	return NULL;
+}
+
+/* @func: _strlen_swar (static)
+ * #desc:
+ *    word-at-a-time strlen, aligned words never cross a page.
+ *
+ * #1: s [in]  string pointer
+ * #r:   [ret] string length
+ */
+static size_t _strlen_swar(const char *s)
+{
+	const char *p = s;
+
+	for (; (uintptr_t)p & (WSIZE - 1); p++) {
+		if (*p == '\0')
+			return (size_t)(p - s);
+	}
+
+	for (;; p += WSIZE) {
+		size_t x = *(const waligned_t *)p;
+		x = HAS_ZERO(x);
+		if (x)
+			return (size_t)(p - s) + ZERO_INDEX(x);
 	}
+}
+
+#elif (STRING_SIMD == STRING_SIMD_SSE2)
 
-	if (len & 16) {
-		*_t++ = *_s++; *_t++ = *_s++; *_t++ = *_s++; *_t++ = *_s++;
-		*_t++ = *_s++; *_t++ = *_s++; *_t++ = *_s++; *_t++ = *_s++;
-		*_t++ = *_s++; *_t++ = *_s++; *_t++ = *_s++; *_t++ = *_s++;
-		*_t++ = *_s++; *_t++ = *_s++; *_t++ = *_s++; *_t++ = *_s++;
+/* @func: _memcpy_sse2 (static)
+ * #desc:
+ *    sse2 memcpy, large copies use non-temporal stores.
+ *
+ * #1: t   [out] target pointer
+ * #2: s   [in]  source pointer
+ * #3: len [in]  length
+ * #r:     [ret] target pointer
+ */
+static void *_memcpy_sse2(void *t, const void *s, size_t len)
+{
+	if (len < 16)
+		return _memcpy_swar(t, s, len);
+
+	uint8_t *d = t;
+	const uint8_t *p = s;
+	__m128i head = _mm_loadu_si128((const __m128i *)p);
+	__m128i tail = _mm_loadu_si128((const __m128i *)(p + len - 16));
+	uint8_t *e = d + len;
+
+	size_t k = 16 - ((uintptr_t)d & 15);
+	d += k;
+	p += k;
+	len -= k;
+	if (len >= STRING_NT_SIZE) {
+		for (; len >= 64; len -= 64) {
+			__m128i x0 = _mm_loadu_si128((const __m128i *)p);
+			__m128i x1 = _mm_loadu_si128((const __m128i *)p + 1);
+			__m128i x2 = _mm_loadu_si128((const __m128i *)p + 2);
+			__m128i x3 = _mm_loadu_si128((const __m128i *)p + 3);
+			_mm_stream_si128((__m128i *)d, x0);
+			_mm_stream_si128((__m128i *)d + 1, x1);
+			_mm_stream_si128((__m128i *)d + 2, x2);
+			_mm_stream_si128((__m128i *)d + 3, x3);
+			d += 64;
+			p += 64;
+		}
+		_mm_sfence();
 	}
-	if (len & 8) {
-		*_t++ = *_s++; *_t++ = *_s++; *_t++ = *_s++; *_t++ = *_s++;
-		*_t++ = *_s++; *_t++ = *_s++; *_t++ = *_s++; *_t++ = *_s++;
+	for (; len >= 64; len -= 64) {
+		__m128i x0 = _mm_loadu_si128((const __m128i *)p);
+		__m128i x1 = _mm_loadu_si128((const __m128i *)p + 1);
+		__m128i x2 = _mm_loadu_si128((const __m128i *)p + 2);
+		__m128i x3 = _mm_loadu_si128((const __m128i *)p + 3);
+		_mm_store_si128((__m128i *)d, x0);
+		_mm_store_si128((__m128i *)d + 1, x1);
+		_mm_store_si128((__m128i *)d + 2, x2);
+		_mm_store_si128((__m128i *)d + 3, x3);
+		d += 64;
+		p += 64;
 	}
-	if (len & 4) {
-		*_t++ = *_s++; *_t++ = *_s++; *_t++ = *_s++; *_t++ = *_s++;
+	for (; len >= 16; len -= 16) {
+		_mm_store_si128((__m128i *)d,
+			_mm_loadu_si128((const __m128i *)p));
+		d += 16;
+		p += 16;
 	}
-	if (len & 2) {
-		*_t++ = *_s++; *_t++ = *_s++;
+	_mm_storeu_si128((__m128i *)t, head);
+	_mm_storeu_si128((__m128i *)(e - 16), tail);
+
+	return t;
+}
+
+/* @func: _memset_sse2 (static)
+ * #desc:
+ *    sse2 memset.
+ *
+ * #1: t   [out] target pointer
+ * #2: c   [in]  character
+ * #3: len [in]  length
+ * #r:     [ret] target pointer
+ */
+static void *_memset_sse2(void *t, int8_t c, size_t len)
+{
+	if (len < 16)
+		return _memset_swar(t, c, len);
+
+	uint8_t *d = t;
+	__m128i v = _mm_set1_epi8(c);
+	_mm_storeu_si128((__m128i *)d, v);
+	_mm_storeu_si128((__m128i *)(d + len - 16), v);
+
+	size_t k = 16 - ((uintptr_t)d & 15);
+	d += k;
+	len -= k;
+	for (; len >= 64; len -= 64) {
+		_mm_store_si128((__m128i *)d, v);
+		_mm_store_si128((__m128i *)d + 1, v);
+		_mm_store_si128((__m128i *)d + 2, v);
+		_mm_store_si128((__m128i *)d + 3, v);
+		d += 64;
+	}
+	for (; len >= 16; len -= 16) {
+		_mm_store_si128((__m128i *)d, v);
+		d += 16;
 	}
-	if (len & 1)
-		*_t++ = *_s++;
 
 	return t;
 }
 
-/* @func: memmove
+/* @func: _memcmp_sse2 (static)
  * #desc:
- *    copy memory area (memory overlap and then copy).
+ *    sse2 memcmp.
+ *
+ * #1: s1  [in]  source1 pointer
+ * #2: s2  [in]  source2 pointer
+ * #3: len [in]  length
+ * #r:     [ret] 0: equal, 0<N>0: *s1 - *s2
+ */
+static int32_t _memcmp_sse2(const void *s1, const void *s2, size_t len)
+{
+	const uint8_t *a = s1, *b = s2;
+
+	for (; len >= 16; len -= 16) {
+		uint32_t m = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(
+			_mm_loadu_si128((const __m128i *)a),
+			_mm_loadu_si128((const __m128i *)b)));
+		if (m != 0xffff) {
+			m = (uint32_t)__builtin_ctz(~m);
+			return a[m] - b[m];
+		}
+		a += 16;
+		b += 16;
+	}
+
+	return _memcmp_swar(a, b, len);
+}
+
+/* @func: _memchr_sse2 (static)
+ * #desc:
+ *    sse2 memchr, aligned blocks never cross a page.
+ *
+ * #1: s   [in]  source pointer
+ * #2: c   [in]  character
+ * #3: len [in]  length
+ * #r:     [ret] target location / NULL pointer
+ */
+static void *_memchr_sse2(const void *s, uint8_t c, size_t len)
+{
+	if (!len)
+		return NULL;
+
+	size_t off = (uintptr_t)s & 15;
+	const uint8_t *p = (const uint8_t *)s - off;
+	__m128i v = _mm_set1_epi8((int8_t)c);
+	uint32_t m = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(
+		_mm_load_si128((const __m128i *)p), v)) >> off << off;
+
+	len = LEN_OFF(len, off);
+	while (1) {
+		if (m) {
+			off = (size_t)__builtin_ctz(m);
+			return off < len ? (void *)(p + off) : NULL;
+		}
+		if (len <= 16)
+			return NULL;
+		p += 16;
+		len -= 16;
+		m = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(
+			_mm_load_si128((const __m128i *)p), v));
+	}
+}
+
+/* @func: _memchr2_sse2 (static)
+ * #desc:
+ *    sse2 memchr for either of two characters.
+ *
+ * #1: s   [in]  source pointer
+ * #2: c1  [in]  character
+ * #3: c2  [in]  character
+ * #4: len [in]  length
+ * #r:     [ret] target location / NULL pointer
+ */
+static void *_memchr2_sse2(const void *s, uint8_t c1, uint8_t c2,
+		size_t len)
+{
+	if (!len)
+		return NULL;
+
+	size_t off = (uintptr_t)s & 15;
+	const uint8_t *p = (const uint8_t *)s - off;
+	__m128i v1 = _mm_set1_epi8((int8_t)c1), v2 = _mm_set1_epi8((int8_t)c2);
+	__m128i x = _mm_load_si128((const __m128i *)p);
+	uint32_t m = (uint32_t)_mm_movemask_epi8(_mm_or_si128(
+		_mm_cmpeq_epi8(x, v1), _mm_cmpeq_epi8(x, v2))) >> off << off;
+
+	len = LEN_OFF(len, off);
+	while (1) {
+		if (m) {
+			off = (size_t)__builtin_ctz(m);
+			return off < len ? (void *)(p + off) : NULL;
+		}
+		if (len <= 16)
+			return NULL;
+		p += 16;
+		len -= 16;
+		x = _mm_load_si128((const __m128i *)p);
+		m = (uint32_t)_mm_movemask_epi8(_mm_or_si128(
+			_mm_cmpeq_epi8(x, v1), _mm_cmpeq_epi8(x, v2)));
+	}
+}
+
+/* @func: _strlen_sse2 (static)
+ * #desc:
+ *    sse2 strlen, aligned blocks never cross a page.
+ *
+ * #1: s [in]  string pointer
+ * #r:   [ret] string length
+ */
+static size_t _strlen_sse2(const char *s)
+{
+	size_t off = (uintptr_t)s & 15;
+	const char *p = s - off;
+	__m128i z = _mm_setzero_si128();
+	uint32_t m = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(
+		_mm_load_si128((const __m128i *)p), z)) >> off << off;
+
+	while (!m) {
+		p += 16;
+		m = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(
+			_mm_load_si128((const __m128i *)p), z));
+	}
+
+	return (size_t)(p - s) + (size_t)__builtin_ctz(m);
+}
+
+/* @func: _memcpy_avx2 (static)
+ * #desc:
+ *    avx2 memcpy, large copies use non-temporal stores.
  *
  * #1: t   [out] target pointer
  * #2: s   [in]  source pointer
  * #3: len [in]  length
  * #r:     [ret] target pointer
  */
-void *C_SYMBOL(memmove)(void *t, const void *s, size_t len)
+__attribute__((target("avx2")))
+static void *_memcpy_avx2(void *t, const void *s, size_t len)
 {
-	if (t <= s)
-		return C_SYMBOL(memcpy)(t, s, len);
+	if (len < 32)
+		return _memcpy_sse2(t, s, len);
+
+	uint8_t *d = t;
+	const uint8_t *p = s;
+	__m256i head = _mm256_loadu_si256((const __m256i *)p);
+	__m256i tail = _mm256_loadu_si256((const __m256i *)(p + len - 32));
+	uint8_t *e = d + len;
+
+	size_t k = 32 - ((uintptr_t)d & 31);
+	d += k;
+	p += k;
+	len -= k;
+	if (len >= STRING_NT_SIZE) {
+		for (; len >= 128; len -= 128) {
+			__m256i x0 = _mm256_loadu_si256((const __m256i *)p);
+			__m256i x1 = _mm256_loadu_si256((const __m256i *)p + 1);
+			__m256i x2 = _mm256_loadu_si256((const __m256i *)p + 2);
+			__m256i x3 = _mm256_loadu_si256((const __m256i *)p + 3);
+			_mm256_stream_si256((__m256i *)d, x0);
+			_mm256_stream_si256((__m256i *)d + 1, x1);
+			_mm256_stream_si256((__m256i *)d + 2, x2);
+			_mm256_stream_si256((__m256i *)d + 3, x3);
+			d += 128;
+			p += 128;
+		}
+		_mm_sfence();
+	}
+	for (; len >= 128; len -= 128) {
+		__m256i x0 = _mm256_loadu_si256((const __m256i *)p);
+		__m256i x1 = _mm256_loadu_si256((const __m256i *)p + 1);
+		__m256i x2 = _mm256_loadu_si256((const __m256i *)p + 2);
+		__m256i x3 = _mm256_loadu_si256((const __m256i *)p + 3);
+		_mm256_store_si256((__m256i *)d, x0);
+		_mm256_store_si256((__m256i *)d + 1, x1);
+		_mm256_store_si256((__m256i *)d + 2, x2);
+		_mm256_store_si256((__m256i *)d + 3, x3);
+		d += 128;
+		p += 128;
+	}
+	for (; len >= 32; len -= 32) {
+		_mm256_store_si256((__m256i *)d,
+			_mm256_loadu_si256((const __m256i *)p));
+		d += 32;
+		p += 32;
+	}
+	_mm256_storeu_si256((__m256i *)t, head);
+	_mm256_storeu_si256((__m256i *)(e - 32), tail);
 
-	volatile uint8_t *_t = (uint8_t *)t + len, *_s = (uint8_t *)s + len;
-	while (len--)
-		*--_t = *--_s;
+	return t;
+}
+
+/* @func: _memset_avx2 (static)
+ * #desc:
+ *    avx2 memset.
+ *
+ * #1: t   [out] target pointer
+ * #2: c   [in]  character
+ * #3: len [in]  length
+ * #r:     [ret] target pointer
+ */
+__attribute__((target("avx2")))
+static void *_memset_avx2(void *t, int8_t c, size_t len)
+{
+	if (len < 32)
+		return _memset_sse2(t, c, len);
+
+	uint8_t *d = t;
+	__m256i v = _mm256_set1_epi8(c);
+	_mm256_storeu_si256((__m256i *)d, v);
+	_mm256_storeu_si256((__m256i *)(d + len - 32), v);
+
+	size_t k = 32 - ((uintptr_t)d & 31);
+	d += k;
+	len -= k;
+	for (; len >= 128; len -= 128) {
+		_mm256_store_si256((__m256i *)d, v);
+		_mm256_store_si256((__m256i *)d + 1, v);
+		_mm256_store_si256((__m256i *)d + 2, v);
+		_mm256_store_si256((__m256i *)d + 3, v);
+		d += 128;
+	}
+	for (; len >= 32; len -= 32) {
+		_mm256_store_si256((__m256i *)d, v);
+		d += 32;
+	}
 
 	return t;
 }
 
-/* @func: memset
+/* @func: _memcmp_avx2 (static)
  * #desc:
- *    fill memory with a constant byte.
+ *    avx2 memcmp.
+ *
+ * #1: s1  [in]  source1 pointer
+ * #2: s2  [in]  source2 pointer
+ * #3: len [in]  length
+ * #r:     [ret] 0: equal, 0<N>0: *s1 - *s2
+ */
+__attribute__((target("avx2")))
+static int32_t _memcmp_avx2(const void *s1, const void *s2, size_t len)
+{
+	const uint8_t *a = s1, *b = s2;
+
+	for (; len >= 32; len -= 32) {
+		uint32_t m = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(
+			_mm256_loadu_si256((const __m256i *)a),
+			_mm256_loadu_si256((const __m256i *)b)));
+		if (m != 0xffffffff) {
+			m = (uint32_t)__builtin_ctz(~m);
+			return a[m] - b[m];
+		}
+		a += 32;
+		b += 32;
+	}
+
+	return _memcmp_sse2(a, b, len);
+}
+
+/* @func: _memchr_avx2 (static)
+ * #desc:
+ *    avx2 memchr, aligned blocks never cross a page.
+ *
+ * #1: s   [in]  source pointer
+ * #2: c   [in]  character
+ * #3: len [in]  length
+ * #r:     [ret] target location / NULL pointer
+ */
+__attribute__((target("avx2")))
+static void *_memchr_avx2(const void *s, uint8_t c, size_t len)
+{
+	if (!len)
+		return NULL;
+
+	size_t off = (uintptr_t)s & 31;
+	const uint8_t *p = (const uint8_t *)s - off;
+	__m256i v = _mm256_set1_epi8((int8_t)c);
+	uint32_t m = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(
+		_mm256_load_si256((const __m256i *)p), v)) >> off << off;
+
+	len = LEN_OFF(len, off);
+	while (1) {
+		if (m) {
+			off = (size_t)__builtin_ctz(m);
+			return off < len ? (void *)(p + off) : NULL;
+		}
+		if (len <= 32)
+			return NULL;
+		p += 32;
+		len -= 32;
+		m = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(
+			_mm256_load_si256((const __m256i *)p), v));
+	}
+}
+
+/* @func: _memchr2_avx2 (static)
+ * #desc:
+ *    avx2 memchr for either of two characters.
+ *
+ * #1: s   [in]  source pointer
+ * #2: c1  [in]  character
+ * #3: c2  [in]  character
+ * #4: len [in]  length
+ * #r:     [ret] target location / NULL pointer
+ */
+__attribute__((target("avx2")))
+static void *_memchr2_avx2(const void *s, uint8_t c1, uint8_t c2,
+		size_t len)
+{
+	if (!len)
+		return NULL;
+
+	size_t off = (uintptr_t)s & 31;
+	const uint8_t *p = (const uint8_t *)s - off;
+	__m256i v1 = _mm256_set1_epi8((int8_t)c1);
+	__m256i v2 = _mm256_set1_epi8((int8_t)c2);
+	__m256i x = _mm256_load_si256((const __m256i *)p);
+	uint32_t m = (uint32_t)_mm256_movemask_epi8(_mm256_or_si256(
+		_mm256_cmpeq_epi8(x, v1), _mm256_cmpeq_epi8(x, v2)));
+
+	m = m >> off << off;
+
+	len = LEN_OFF(len, off);
+	while (1) {
+		if (m) {
+			off = (size_t)__builtin_ctz(m);
+			return off < len ? (void *)(p + off) : NULL;
+		}
+		if (len <= 32)
+			return NULL;
+		p += 32;
+		len -= 32;
+		x = _mm256_load_si256((const __m256i *)p);
+		m = (uint32_t)_mm256_movemask_epi8(_mm256_or_si256(
+			_mm256_cmpeq_epi8(x, v1), _mm256_cmpeq_epi8(x, v2)));
+	}
+}
+
+/* @func: _strlen_avx2 (static)
+ * #desc:
+ *    avx2 strlen, aligned blocks never cross a page.
+ *
+ * #1: s [in]  string pointer
+ * #r:   [ret] string length
+ */
+__attribute__((target("avx2")))
+static size_t _strlen_avx2(const char *s)
+{
+	size_t off = (uintptr_t)s & 31;
+	const char *p = s - off;
+	__m256i z = _mm256_setzero_si256();
+	uint32_t m = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(
+		_mm256_load_si256((const __m256i *)p), z)) >> off << off;
+
+	while (!m) {
+		p += 32;
+		m = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(
+			_mm256_load_si256((const __m256i *)p), z));
+	}
+
+	return (size_t)(p - s) + (size_t)__builtin_ctz(m);
+}
+
+/* @func: _string_avx2 (static)
+ * #desc:
+ *    check the cpu (cpuid) and the os (xgetbv) for avx2 support.
+ *
+ * #r: [ret] 0: no, 1: yes
+ */
+static int32_t _string_avx2(void)
+{
+	uint32_t a, b, c, d;
+
+	__asm__ volatile ("cpuid"
+		: "=a" (a), "=b" (b), "=c" (c), "=d" (d)
+		: "a" (0), "c" (0));
+	if (a < 7)
+		return 0;
+
+	__asm__ volatile ("cpuid"
+		: "=a" (a), "=b" (b), "=c" (c), "=d" (d)
+		: "a" (1), "c" (0));
+	if (!(c & (1U << 27)) || !(c & (1U << 28))) /* osxsave, avx */
+		return 0;
+
+	__asm__ volatile ("xgetbv" : "=a" (a), "=d" (d) : "c" (0));
+	if ((a & 6) != 6) /* xmm and ymm state */
+		return 0;
+
+	__asm__ volatile ("cpuid"
+		: "=a" (a), "=b" (b), "=c" (c), "=d" (d)
+		: "a" (7), "c" (0));
+
+	return (b >> 5) & 1;
+}
+
+#elif (STRING_SIMD == STRING_SIMD_NEON)
+
+/* @def: _
+ * neon byte mask: four bits per byte, MASK_INDEX() gives the lowest */
+#define NEON_MASK(x) vget_lane_u64(vreinterpret_u64_u8( \
+	vshrn_n_u16(vreinterpretq_u16_u8(x), 4)), 0)
+#define MASK_INDEX(x) ((size_t)__builtin_ctzll(x) >> 2)
+/* end */
+
+/* @func: _memcpy_neon (static)
+ * #desc:
+ *    neon memcpy.
+ *
+ * #1: t   [out] target pointer
+ * #2: s   [in]  source pointer
+ * #3: len [in]  length
+ * #r:     [ret] target pointer
+ */
+static void *_memcpy_neon(void *t, const void *s, size_t len)
+{
+	if (len < 16)
+		return _memcpy_swar(t, s, len);
+
+	uint8_t *d = t;
+	const uint8_t *p = s;
+	uint8x16_t head = vld1q_u8(p), tail = vld1q_u8(p + len - 16);
+	uint8_t *e = d + len;
+
+	size_t k = 16 - ((uintptr_t)d & 15);
+	d += k;
+	p += k;
+	len -= k;
+	for (; len >= 64; len -= 64) {
+		uint8x16_t x0 = vld1q_u8(p), x1 = vld1q_u8(p + 16),
+			x2 = vld1q_u8(p + 32), x3 = vld1q_u8(p + 48);
+		vst1q_u8(d, x0);
+		vst1q_u8(d + 16, x1);
+		vst1q_u8(d + 32, x2);
+		vst1q_u8(d + 48, x3);
+		d += 64;
+		p += 64;
+	}
+	for (; len >= 16; len -= 16) {
+		vst1q_u8(d, vld1q_u8(p));
+		d += 16;
+		p += 16;
+	}
+	vst1q_u8((uint8_t *)t, head);
+	vst1q_u8(e - 16, tail);
+
+	return t;
+}
+
+/* @func: _memset_neon (static)
+ * #desc:
+ *    neon memset.
  *
  * #1: t   [out] target pointer
  * #2: c   [in]  character
  * #3: len [in]  length
  * #r:     [ret] target pointer
  */
-void *C_SYMBOL(memset)(void *t, int8_t c, size_t len)
+static void *_memset_neon(void *t, int8_t c, size_t len)
 {
-	int8_t cc[4] = { c, c, c, c };
-	volatile int8_t *_t = t;
+	if (len < 16)
+		return _memset_swar(t, c, len);
+
+	uint8_t *d = t;
+	uint8x16_t v = vdupq_n_u8((uint8_t)c);
+	vst1q_u8(d, v);
+	vst1q_u8(d + len - 16, v);
+
+	size_t k = 16 - ((uintptr_t)d & 15);
+	d += k;
+	len -= k;
+	for (; len >= 64; len -= 64) {
+		vst1q_u8(d, v);
+		vst1q_u8(d + 16, v);
+		vst1q_u8(d + 32, v);
+		vst1q_u8(d + 48, v);
+		d += 64;
+	}
+	for (; len >= 16; len -= 16) {
+		vst1q_u8(d, v);
+		d += 16;
+	}
+
+	return t;
+}
 
-	for (; ((uintptr_t)_t & 3) && len; len--)
-		*_t++ = c;
+/* @func: _memcmp_neon (static)
+ * #desc:
+ *    neon memcmp.
+ *
+ * #1: s1  [in]  source1 pointer
+ * #2: s2  [in]  source2 pointer
+ * #3: len [in]  length
+ * #r:     [ret] 0: equal, 0<N>0: *s1 - *s2
+ */
+static int32_t _memcmp_neon(const void *s1, const void *s2, size_t len)
+{
+	const uint8_t *a = s1, *b = s2;
 
-	for (; len > 15; len -= 16) {
-		((uint32_t *)_t)[0] = *((uint32_t *)cc);
-		((uint32_t *)_t)[1] = *((uint32_t *)cc);
-		((uint32_t *)_t)[2] = *((uint32_t *)cc);
-		((uint32_t *)_t)[3] = *((uint32_t *)cc);
-		_t += 16;
+	for (; len >= 16; len -= 16) {
+		uint64_t m = NEON_MASK(vceqq_u8(vld1q_u8(a), vld1q_u8(b)));
+		if (~m) {
+			size_t i = MASK_INDEX(~m);
+			return a[i] - b[i];
+		}
+		a += 16;
+		b += 16;
 	}
-	for (; len > 3; len -= 4) {
-		*((uint32_t *)_t) = *((uint32_t *)cc);
-		_t += 4;
+
+	return _memcmp_swar(a, b, len);
+}
+
+/* @func: _memchr_neon (static)
+ * #desc:
+ *    neon memchr, aligned blocks never cross a page.
+ *
+ * #1: s   [in]  source pointer
+ * #2: c   [in]  character
+ * #3: len [in]  length
+ * #r:     [ret] target location / NULL pointer
+ */
+static void *_memchr_neon(const void *s, uint8_t c, size_t len)
+{
+	if (!len)
+		return NULL;
+
+	size_t off = (uintptr_t)s & 15;
+	const uint8_t *p = (const uint8_t *)s - off;
+	uint8x16_t v = vdupq_n_u8(c);
+	uint64_t m = NEON_MASK(vceqq_u8(vld1q_u8(p), v))
+		>> (off * 4) << (off * 4);
+
+	len = LEN_OFF(len, off);
+	while (1) {
+		if (m) {
+			off = MASK_INDEX(m);
+			return off < len ? (void *)(p + off) : NULL;
+		}
+		if (len <= 16)
+			return NULL;
+		p += 16;
+		len -= 16;
+		m = NEON_MASK(vceqq_u8(vld1q_u8(p), v));
 	}
+}
 
-	while (len--)
-		*_t++ = c;
+/* @func: _memchr2_neon (static)
+ * #desc:
+ *    neon memchr for either of two characters.
+ *
+ * #1: s   [in]  source pointer
+ * #2: c1  [in]  character
+ * #3: c2  [in]  character
+ * #4: len [in]  length
+ * #r:     [ret] target location / NULL pointer
+ */
+static void *_memchr2_neon(const void *s, uint8_t c1, uint8_t c2,
+		size_t len)
+{
+	if (!len)
+		return NULL;
+
+	size_t off = (uintptr_t)s & 15;
+	const uint8_t *p = (const uint8_t *)s - off;
+	uint8x16_t v1 = vdupq_n_u8(c1), v2 = vdupq_n_u8(c2);
+	uint8x16_t x = vld1q_u8(p);
+	uint64_t m = NEON_MASK(vorrq_u8(vceqq_u8(x, v1), vceqq_u8(x, v2)))
+		>> (off * 4) << (off * 4);
+
+	len = LEN_OFF(len, off);
+	while (1) {
+		if (m) {
+			off = MASK_INDEX(m);
+			return off < len ? (void *)(p + off) : NULL;
+		}
+		if (len <= 16)
+			return NULL;
+		p += 16;
+		len -= 16;
+		x = vld1q_u8(p);
+		m = NEON_MASK(vorrq_u8(vceqq_u8(x, v1), vceqq_u8(x, v2)));
+	}
+}
+
+/* @func: _strlen_neon (static)
+ * #desc:
+ *    neon strlen, aligned blocks never cross a page.
+ *
+ * #1: s [in]  string pointer
+ * #r:   [ret] string length
+ */
+static size_t _strlen_neon(const char *s)
+{
+	size_t off = (uintptr_t)s & 15;
+	const uint8_t *p = (const uint8_t *)s - off;
+	uint8x16_t z = vdupq_n_u8(0);
+	uint64_t m = NEON_MASK(vceqq_u8(vld1q_u8(p), z))
+		>> (off * 4) << (off * 4);
+
+	while (!m) {
+		p += 16;
+		m = NEON_MASK(vceqq_u8(vld1q_u8(p), z));
+	}
+
+	return (size_t)((const char *)p - s) + MASK_INDEX(m);
+}
+
+#endif /* STRING_SIMD */
+
+static void *_memcpy_init(void *t, const void *s, size_t len);
+static void *_memset_init(void *t, int8_t c, size_t len);
+static int32_t _memcmp_init(const void *s1, const void *s2, size_t len);
+static void *_memchr_init(const void *s, uint8_t c, size_t len);
+static void *_memchr2_init(const void *s, uint8_t c1, uint8_t c2,
+		size_t len);
+static size_t _strlen_init(const char *s);
+
+/* resolved on the first call (see _string_init) */
+static void *(*_memcpy_call)(void *, const void *, size_t) = _memcpy_init;
+static void *(*_memset_call)(void *, int8_t, size_t) = _memset_init;
+static int32_t (*_memcmp_call)(const void *, const void *, size_t)
+	= _memcmp_init;
+static void *(*_memchr_call)(const void *, uint8_t, size_t) = _memchr_init;
+static void *(*_memchr2_call)(const void *, uint8_t, uint8_t, size_t)
+	= _memchr2_init;
+static size_t (*_strlen_call)(const char *) = _strlen_init;
+
+/* @func: _string_init (static)
+ * #desc:
+ *    select the string kernels for this cpu, racing callers store
+ *    the same pointers.
+ */
+static void _string_init(void)
+{
+#if (STRING_SIMD == STRING_SIMD_SSE2)
+	if (_string_avx2()) {
+		_memcpy_call = _memcpy_avx2;
+		_memset_call = _memset_avx2;
+		_memcmp_call = _memcmp_avx2;
+		_memchr_call = _memchr_avx2;
+		_memchr2_call = _memchr2_avx2;
+		_strlen_call = _strlen_avx2;
+	} else {
+		_memcpy_call = _memcpy_sse2;
+		_memset_call = _memset_sse2;
+		_memcmp_call = _memcmp_sse2;
+		_memchr_call = _memchr_sse2;
+		_memchr2_call = _memchr2_sse2;
+		_strlen_call = _strlen_sse2;
+	}
+#elif (STRING_SIMD == STRING_SIMD_NEON)
+	_memcpy_call = _memcpy_neon;
+	_memset_call = _memset_neon;
+	_memcmp_call = _memcmp_neon;
+	_memchr_call = _memchr_neon;
+	_memchr2_call = _memchr2_neon;
+	_strlen_call = _strlen_neon;
+#else
+	_memcpy_call = _memcpy_swar;
+	_memset_call = _memset_swar;
+	_memcmp_call = _memcmp_swar;
+	_memchr_call = _memchr_swar;
+	_memchr2_call = _memchr2_swar;
+	_strlen_call = _strlen_swar;
+#endif
+}
+
+static void *_memcpy_init(void *t, const void *s, size_t len)
+{
+	_string_init();
+	return _memcpy_call(t, s, len);
+}
+
+static void *_memset_init(void *t, int8_t c, size_t len)
+{
+	_string_init();
+	return _memset_call(t, c, len);
+}
+
+static int32_t _memcmp_init(const void *s1, const void *s2, size_t len)
+{
+	_string_init();
+	return _memcmp_call(s1, s2, len);
+}
+
+static void *_memchr_init(const void *s, uint8_t c, size_t len)
+{
+	_string_init();
+	return _memchr_call(s, c, len);
+}
+
+static void *_memchr2_init(const void *s, uint8_t c1, uint8_t c2,
+		size_t len)
+{
+	_string_init();
+	return _memchr2_call(s, c1, c2, len);
+}
+
+static size_t _strlen_init(const char *s)
+{
+	_string_init();
+	return _strlen_call(s);
+}
+
+/* @func: memcpy
+ * #desc:
+ *    copy memory area.
+ *
+ * #1: t   [out] target pointer
+ * #2: s   [in]  source pointer
+ * #3: len [in]  length
+ * #r:     [ret] target pointer
+ */
+void *C_SYMBOL(memcpy)(void *t, const void *s, size_t len)
+{
+	return _memcpy_call(t, s, len);
+}
+
+/* @func: memmove
+ * #desc:
+ *    copy memory area (memory overlap and then copy).
+ *
+ * #1: t   [out] target pointer
+ * #2: s   [in]  source pointer
+ * #3: len [in]  length
+ * #r:     [ret] target pointer
+ */
+void *C_SYMBOL(memmove)(void *t, const void *s, size_t len)
+{
+	uint8_t *d = t;
+	const uint8_t *p = s;
+
+	if ((uintptr_t)d - (uintptr_t)p >= len
+			&& (uintptr_t)p - (uintptr_t)d >= len)
+		return _memcpy_call(t, s, len);
+
+	/* overlap: each word is loaded before its store can clobber it */
+	if (d < p) {
+		for (; len >= WSIZE; len -= WSIZE) {
+			STORE(d, LOAD(p));
+			d += WSIZE;
+			p += WSIZE;
+		}
+		while (len--)
+			*d++ = *p++;
+	} else {
+		d += len;
+		p += len;
+		for (; len >= WSIZE; len -= WSIZE) {
+			d -= WSIZE;
+			p -= WSIZE;
+			STORE(d, LOAD(p));
+		}
+		while (len--)
+			*--d = *--p;
+	}
 
 	return t;
 }
 
+/* @func: memset
+ * #desc:
+ *    fill memory with a constant byte.
+ *
+ * #1: t   [out] target pointer
+ * #2: c   [in]  character
+ * #3: len [in]  length
+ * #r:     [ret] target pointer
+ */
+void *C_SYMBOL(memset)(void *t, int8_t c, size_t len)
+{
+	return _memset_call(t, c, len);
+}
+
 /* @func: memchr
  * #desc:
  *    scan memory for a character.
@@ -224,12 +1181,23 @@ void *C_SYMBOL(memset)(void *t, int8_t c, size_t len)
  */
 void *C_SYMBOL(memchr)(const void *s, uint8_t c, size_t len)
 {
-	for (uint8_t *t = (uint8_t *)s; len--; t++) {
-		if (*t == c)
-			return (void *)t;
-	}
+	return _memchr_call(s, c, len);
+}
 
-	return NULL;
+/* @func: memchr2
+ * #desc:
+ *    scan memory for either of two characters.
+ *
+ * #1: s   [in]  source pointer
+ * #2: c1  [in]  character
+ * #3: c2  [in]  character
+ * #4: len [in]  length
+ * #r:     [ret] target location / NULL pointer
+ */
+void *C_SYMBOL(memchr2)(const void *s, uint8_t c1, uint8_t c2,
+		size_t len)
+{
+	return _memchr2_call(s, c1, c2, len);
 }
 
 /* @func: memrchr
@@ -258,17 +1226,11 @@ void *C_SYMBOL(memrchr)(const void *s, uint8_t c, size_t len)
  * #1: s1  [in]  source1 pointer
  * #2: s2  [in]  source2 pointer
  * #3: len [in]  length
- * #r:     [ret] 0: equal, 0<N>0: *s2 - *s1
+ * #r:     [ret] 0: equal, 0<N>0: *s1 - *s2
  */
 int32_t C_SYMBOL(memcmp)(const void *s1, const void *s2, size_t len)
 {
-	if (!len)
-		return 0;
-
-	uint8_t *t1 = (uint8_t *)s1, *t2 = (uint8_t *)s2;
-	for (; --len && *t1 == *t2; t1++, t2++);
-
-	return *t1 - *t2;
+	return _memcmp_call(s1, s2, len);
 }
 
 /* @func: strlen
@@ -280,10 +1242,7 @@ int32_t C_SYMBOL(memcmp)(const void *s1, const void *s2, size_t len)
  */
 size_t C_SYMBOL(strlen)(const char *s)
 {
-	const char *a = s;
-	for (; *s != '\0'; s++);
-
-	return (size_t)(s - a);
+	return _strlen_call(s);
 }
 
 /* @func: strnlen
@@ -296,10 +1255,9 @@ size_t C_SYMBOL(strlen)(const char *s)
  */
 size_t C_SYMBOL(strnlen)(const char *s, size_t len)
 {
-	const char *a = s;
-	for (; len && *s != '\0'; s++, len--);
+	const char *e = _memchr_call(s, '\0', len);
 
-	return (size_t)(s - a);
+	return e ? (size_t)(e - s) : len;
 }
 
 /* @func: strcpy
@@ -0,0 +1,384 @@
+/* @file: string_utf8.c
+ * #desc:
+ *    The implementations of utf-8 validation.
+ *
+ * #copy:
+ *    Copyright (C) 1970 Public Free Software
+ *
+ *    This library is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 2.1 of the License, or (at your option) any later version.
+ *
+ *    This library is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with this library; if not,
+ *    see <https://www.gnu.org/licenses/>.
+ */
+
+#include <demoz/config.h>
+#include <demoz/c/stddef.h>
+#include <demoz/c/stdint.h>
+#include <demoz/c/string.h>
+
+
+/* @def: _
+ * same switch as c/string.c, the lookup kernels need a byte shuffle
+ * (avx2 at run time, aarch64 neon) */
+#define STRING_SIMD_SWAR 1
+#define STRING_SIMD_SSE2 2
+#define STRING_SIMD_NEON 3
+
+#ifndef STRING_SIMD
+#	if defined(__SSE2__)
+#		define STRING_SIMD STRING_SIMD_SSE2
+#	elif (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#		define STRING_SIMD STRING_SIMD_NEON
+#	else
+#		define STRING_SIMD STRING_SIMD_SWAR
+#	endif
+#endif
+/* end */
+
+#if (STRING_SIMD == STRING_SIMD_SSE2)
+#	include <immintrin.h>
+#elif (STRING_SIMD == STRING_SIMD_NEON && defined(__aarch64__))
+#	include <arm_neon.h>
+#endif
+
+
+/* @def: _
+ * lookup method (Keiser and Lemire, "Validating UTF-8 In Less Than
+ * One Instruction Per Byte"), the error classes of a byte pair are
+ * the and of three nibble tables */
+#define TOO_SHORT (1 << 0) /* lead byte, then no continuation */
+#define TOO_LONG (1 << 1) /* ascii, then continuation */
+#define OVERLONG_3 (1 << 2)
+#define TOO_LARGE (1 << 3)
+#define SURROGATE (1 << 4)
+#define OVERLONG_2 (1 << 5)
+#define TOO_LARGE_1000 (1 << 6)
+#define OVERLONG_4 (1 << 6)
+#define TWO_CONTS (1 << 7) /* two continuations (may be valid) */
+#define CARRY (TOO_SHORT | TOO_LONG | TWO_CONTS)
+
+/* first byte, high nibble */
+#define UTF8_BYTE_1_HIGH \
+	TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, \
+	TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, \
+	TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS, \
+	TOO_SHORT | OVERLONG_2, \
+	TOO_SHORT, \
+	TOO_SHORT | OVERLONG_3 | SURROGATE, \
+	TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4
+
+/* first byte, low nibble */
+#define UTF8_BYTE_1_LOW \
+	CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4, \
+	CARRY | OVERLONG_2, \
+	CARRY, \
+	CARRY, \
+	CARRY | TOO_LARGE, \
+	CARRY | TOO_LARGE | TOO_LARGE_1000, \
+	CARRY | TOO_LARGE | TOO_LARGE_1000, \
+	CARRY | TOO_LARGE | TOO_LARGE_1000, \
+	CARRY | TOO_LARGE | TOO_LARGE_1000, \
+	CARRY | TOO_LARGE | TOO_LARGE_1000, \
+	CARRY | TOO_LARGE | TOO_LARGE_1000, \
+	CARRY | TOO_LARGE | TOO_LARGE_1000, \
+	CARRY | TOO_LARGE | TOO_LARGE_1000, \
+	CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE, \
+	CARRY | TOO_LARGE | TOO_LARGE_1000, \
+	CARRY | TOO_LARGE | TOO_LARGE_1000
+
+/* second byte, high nibble */
+#define UTF8_BYTE_2_HIGH \
+	TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, \
+	TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, \
+	TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 \
+		| OVERLONG_4, \
+	TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE, \
+	TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE, \
+	TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE, \
+	TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT
+/* end */
+
+typedef uint64_t __attribute__((__may_alias__, __aligned__(1))) u64unaligned_t;
+
+/* @func: _utf8_scalar (static)
+ * #desc:
+ *    utf-8 validation, one sequence at a time (ascii words are
+ *    skipped 8 bytes at a time).
+ *
+ * #1: s   [in]  input buffer
+ * #2: len [in]  input length
+ * #r:     [ret] 0: valid, -1: invalid
+ */
+static int32_t _utf8_scalar(const uint8_t *s, size_t len)
+{
+	size_t i = 0;
+
+	while (i < len) {
+		if (len - i >= 8
+				&& !(*(const u64unaligned_t *)(s + i)
+					& 0x8080808080808080ULL)) {
+			i += 8;
+			continue;
+		}
+
+		uint32_t c = s[i], u, min;
+		size_t n;
+		if (c < 0x80) {
+			i++;
+			continue;
+		} else if ((c & 0xe0) == 0xc0) {
+			n = 1;
+			u = c & 0x1f;
+			min = 0x80;
+		} else if ((c & 0xf0) == 0xe0) {
+			n = 2;
+			u = c & 0x0f;
+			min = 0x800;
+		} else if ((c & 0xf8) == 0xf0) {
+			n = 3;
+			u = c & 0x07;
+			min = 0x10000;
+		} else {
+			return -1;
+		}
+		if (len - i <= n)
+			return -1;
+
+		for (size_t k = 1; k <= n; k++) {
+			c = s[i + k];
+			if ((c & 0xc0) != 0x80)
+				return -1;
+			u = (u << 6) | (c & 0x3f);
+		}
+		/* overlong, surrogate, or out of range */
+		if (u < min || u > 0x10ffff || (u >= 0xd800 && u <= 0xdfff))
+			return -1;
+		i += n + 1;
+	}
+
+	return 0;
+}
+
+#if (STRING_SIMD == STRING_SIMD_SSE2)
+
+/* @func: _utf8_avx2 (static)
+ * #desc:
+ *    avx2 utf-8 validation (lookup method), 32 bytes at a time.
+ *
+ * #1: s   [in]  input buffer
+ * #2: len [in]  input length
+ * #r:     [ret] 0: valid, -1: invalid
+ */
+__attribute__((target("avx2")))
+static int32_t _utf8_avx2(const uint8_t *s, size_t len)
+{
+	const __m256i t1h = _mm256_setr_epi8(UTF8_BYTE_1_HIGH,
+		UTF8_BYTE_1_HIGH);
+	const __m256i t1l = _mm256_setr_epi8(UTF8_BYTE_1_LOW,
+		UTF8_BYTE_1_LOW);
+	const __m256i t2h = _mm256_setr_epi8(UTF8_BYTE_2_HIGH,
+		UTF8_BYTE_2_HIGH);
+	/* the last three bytes may not start a longer sequence */
+	const __m256i last = _mm256_setr_epi8(
+		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+		0xf0 - 1, 0xe0 - 1, 0xc0 - 1);
+	const __m256i lo = _mm256_set1_epi8(0x0f);
+	__m256i prev = _mm256_setzero_si256(), err = prev, incomplete = prev;
+	uint8_t pad[32];
+
+	for (size_t i = 0; i < len; i += 32) {
+		__m256i x;
+		if (len - i < 32) { /* ascii padding */
+			C_SYMBOL(memset)(pad, 0, sizeof(pad));
+			C_SYMBOL(memcpy)(pad, s + i, len - i);
+			x = _mm256_loadu_si256((const __m256i *)pad);
+		} else {
+			x = _mm256_loadu_si256((const __m256i *)(s + i));
+		}
+
+		if (!_mm256_movemask_epi8(x)) { /* ascii */
+			err = _mm256_or_si256(err, incomplete);
+			incomplete = _mm256_setzero_si256();
+			prev = x;
+			continue;
+		}
+
+		/* the previous 1, 2, 3 bytes */
+		__m256i p = _mm256_permute2x128_si256(prev, x, 0x21);
+		__m256i p1 = _mm256_alignr_epi8(x, p, 15);
+		__m256i p2 = _mm256_alignr_epi8(x, p, 14);
+		__m256i p3 = _mm256_alignr_epi8(x, p, 13);
+
+		__m256i sc = _mm256_and_si256(
+			_mm256_and_si256(
+				_mm256_shuffle_epi8(t1h, _mm256_and_si256(
+					_mm256_srli_epi16(p1, 4), lo)),
+				_mm256_shuffle_epi8(t1l,
+					_mm256_and_si256(p1, lo))),
+			_mm256_shuffle_epi8(t2h, _mm256_and_si256(
+				_mm256_srli_epi16(x, 4), lo)));
+
+		/* third and fourth bytes must be continuations */
+		__m256i must = _mm256_or_si256(
+			_mm256_subs_epu8(p2, _mm256_set1_epi8(0xe0 - 0x80)),
+			_mm256_subs_epu8(p3, _mm256_set1_epi8(0xf0 - 0x80)));
+		must = _mm256_and_si256(must, _mm256_set1_epi8(0x80));
+		err = _mm256_or_si256(err, _mm256_xor_si256(must, sc));
+
+		incomplete = _mm256_subs_epu8(x, last);
+		prev = x;
+	}
+	err = _mm256_or_si256(err, incomplete);
+
+	return _mm256_testz_si256(err, err) ? 0 : -1;
+}
+
+/* @func: _utf8_has_avx2 (static)
+ * #desc:
+ *    check the cpu (cpuid) and the os (xgetbv) for avx2 support.
+ *
+ * #r: [ret] 0: no, 1: yes
+ */
+static int32_t _utf8_has_avx2(void)
+{
+	uint32_t a, b, c, d;
+
+	__asm__ volatile ("cpuid"
+		: "=a" (a), "=b" (b), "=c" (c), "=d" (d)
+		: "a" (0), "c" (0));
+	if (a < 7)
+		return 0;
+
+	__asm__ volatile ("cpuid"
+		: "=a" (a), "=b" (b), "=c" (c), "=d" (d)
+		: "a" (1), "c" (0));
+	if (!(c & (1U << 27)) || !(c & (1U << 28))) /* osxsave, avx */
+		return 0;
+
+	__asm__ volatile ("xgetbv" : "=a" (a), "=d" (d) : "c" (0));
+	if ((a & 6) != 6) /* xmm and ymm state */
+		return 0;
+
+	__asm__ volatile ("cpuid"
+		: "=a" (a), "=b" (b), "=c" (c), "=d" (d)
+		: "a" (7), "c" (0));
+
+	return (b >> 5) & 1;
+}
+
+#elif (STRING_SIMD == STRING_SIMD_NEON && defined(__aarch64__))
+
+/* @func: _utf8_neon (static)
+ * #desc:
+ *    neon utf-8 validation (lookup method), 16 bytes at a time.
+ *
+ * #1: s   [in]  input buffer
+ * #2: len [in]  input length
+ * #r:     [ret] 0: valid, -1: invalid
+ */
+static int32_t _utf8_neon(const uint8_t *s, size_t len)
+{
+	static const uint8_t t1h_[16] = { UTF8_BYTE_1_HIGH };
+	static const uint8_t t1l_[16] = { UTF8_BYTE_1_LOW };
+	static const uint8_t t2h_[16] = { UTF8_BYTE_2_HIGH };
+	static const uint8_t last_[16] = {
+		255, 255, 255, 255, 255, 255, 255, 255,
+		255, 255, 255, 255, 255, 0xf0 - 1, 0xe0 - 1, 0xc0 - 1
+	};
+	uint8x16_t t1h = vld1q_u8(t1h_), t1l = vld1q_u8(t1l_),
+		t2h = vld1q_u8(t2h_), last = vld1q_u8(last_);
+	uint8x16_t lo = vdupq_n_u8(0x0f);
+	uint8x16_t prev = vdupq_n_u8(0), err = prev, incomplete = prev;
+	uint8_t pad[16];
+
+	for (size_t i = 0; i < len; i += 16) {
+		uint8x16_t x;
+		if (len - i < 16) { /* ascii padding */
+			C_SYMBOL(memset)(pad, 0, sizeof(pad));
+			C_SYMBOL(memcpy)(pad, s + i, len - i);
+			x = vld1q_u8(pad);
+		} else {
+			x = vld1q_u8(s + i);
+		}
+
+		if (vmaxvq_u8(x) < 0x80) { /* ascii */
+			err = vorrq_u8(err, incomplete);
+			incomplete = vdupq_n_u8(0);
+			prev = x;
+			continue;
+		}
+
+		uint8x16_t p1 = vextq_u8(prev, x, 15);
+		uint8x16_t p2 = vextq_u8(prev, x, 14);
+		uint8x16_t p3 = vextq_u8(prev, x, 13);
+
+		uint8x16_t sc = vandq_u8(
+			vandq_u8(vqtbl1q_u8(t1h, vshrq_n_u8(p1, 4)),
+				vqtbl1q_u8(t1l, vandq_u8(p1, lo))),
+			vqtbl1q_u8(t2h, vshrq_n_u8(x, 4)));
+
+		uint8x16_t must = vorrq_u8(
+			vqsubq_u8(p2, vdupq_n_u8(0xe0 - 0x80)),
+			vqsubq_u8(p3, vdupq_n_u8(0xf0 - 0x80)));
+		must = vandq_u8(must, vdupq_n_u8(0x80));
+		err = vorrq_u8(err, veorq_u8(must, sc));
+
+		incomplete = vqsubq_u8(x, last);
+		prev = x;
+	}
+	err = vorrq_u8(err, incomplete);
+
+	return vmaxvq_u8(err) ? -1 : 0;
+}
+
+#endif /* STRING_SIMD */
+
+static int32_t _utf8_init(const uint8_t *s, size_t len);
+
+/* resolved on the first call */
+static int32_t (*_utf8_call)(const uint8_t *, size_t) = _utf8_init;
+
+/* @func: _utf8_init (static)
+ * #desc:
+ *    select the utf-8 kernel for this cpu.
+ *
+ * #1: s   [in]  input buffer
+ * #2: len [in]  input length
+ * #r:     [ret] 0: valid, -1: invalid
+ */
+static int32_t _utf8_init(const uint8_t *s, size_t len)
+{
+#if (STRING_SIMD == STRING_SIMD_SSE2)
+	_utf8_call = _utf8_has_avx2() ? _utf8_avx2 : _utf8_scalar;
+#elif (STRING_SIMD == STRING_SIMD_NEON && defined(__aarch64__))
+	_utf8_call = _utf8_neon;
+#else
+	_utf8_call = _utf8_scalar;
+#endif
+
+	return _utf8_call(s, len);
+}
+
+/* @func: utf8_validate
+ * #desc:
+ *    utf-8 validation (no overlong forms, no surrogates, up to
+ *    U+10FFFF).
+ *
+ * #1: s   [in]  input buffer
+ * #2: len [in]  input length
+ * #r:     [ret] 0: valid, -1: invalid
+ */
+int32_t C_SYMBOL(utf8_validate)(const void *s, size_t len)
+{
+	return _utf8_call(s, len);
+}
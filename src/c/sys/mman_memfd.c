@@ -0,0 +1,86 @@
+/* @file: mman_memfd.c
+ * #desc:
+ *    The implementations of memory management.
+ *
+ * #copy:
+ *    Copyright (C) 1970 Public Free Software
+ *
+ *    This library is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 2.1 of the License, or (at your option) any later version.
+ *
+ *    This library is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with this library; if not,
+ *    see <https://www.gnu.org/licenses/>.
+ */
+
+#include <demoz/config.h>
+#include <demoz/c/stdint.h>
+#include <demoz/c/errno.h>
+#include <demoz/c/sys/mman.h>
+#include <demoz/c/sys/syscall.h>
+
+
+/* @func: memfd_create
+ * #desc:
+ *    create an anonymous memory file (for shared mappings).
+ *
+ * #1: file name (debugging only)
+ * #2: flags
+ * #r: file descriptor, -1: errno
+ */
+int32_t C_SYMBOL(memfd_create)(const char *name, int32_t flags)
+{
+#if (DEMOZ_PLATFORM == DEMOZ_PLATFORM_LINUX)
+
+	int32_t ret = 0;
+	uint32_t _flags = 0;
+
+	if (flags & X_MFD_CLOEXEC)
+		_flags |= MFD_CLOEXEC;
+
+	ret = C_SYMBOL(syscall_linux)(
+		XSYSCALL_memfd_create,
+		name,
+		_flags);
+
+	if (ret < 0) {
+		/* errno */
+		switch (ret) {
+			case -EFAULT:
+				x_errno = X_EFAULT;
+				break;
+			case -EINVAL:
+				x_errno = X_EINVAL;
+				break;
+			case -EMFILE:
+				x_errno = X_EMFILE;
+				break;
+			case -ENFILE:
+				x_errno = X_ENFILE;
+				break;
+			case -ENOMEM:
+				x_errno = X_ENOMEM;
+				break;
+			case -ENOSYS:
+				x_errno = X_ENOSYS;
+				break;
+			default:
+				x_errno = X_EUNKNOWN;
+				break;
+		}
+		return -1;
+	}
+
+	return ret;
+
+#else
+#	error "!!!unknown DEMOZ_PLATFORM!!!"
+#endif
+}
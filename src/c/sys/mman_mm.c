@@ -231,3 +231,71 @@ int32_t C_SYMBOL(mprotect)(void *addr, size_t len, int32_t prot)
 #	error "!!!unknown DEMOZ_PLATFORM!!!"
 #endif
 }
+
+/* @func: mremap
+ * #desc:
+ *    resize (and possibly move) memory pages (4096 aligned).
+ *
+ * #1: pages address
+ * #2: old pages length
+ * #3: new pages length
+ * #4: remapping flags
+ * #5: new address (X_MREMAP_FIXED)
+ * #r: return address (X_MAP_FAILED: errno)
+ */
+void *C_SYMBOL(mremap)(void *addr, size_t old_len, size_t new_len,
+		int32_t flags, void *new_addr)
+{
+#if (DEMOZ_PLATFORM == DEMOZ_PLATFORM_LINUX)
+
+	ssize_t ret = 0;
+	int32_t _flags = 0;
+
+	if ((uintptr_t)addr & 4095 || old_len & 4095 || new_len & 4095
+			|| (uintptr_t)new_addr & 4095) {
+		/* errno */
+		x_errno = X_EINVAL;
+		return X_MAP_FAILED;
+	}
+
+	if (flags & X_MREMAP_MAYMOVE)
+		_flags |= MREMAP_MAYMOVE;
+	if (flags & X_MREMAP_FIXED)
+		_flags |= MREMAP_FIXED;
+
+	ret = C_SYMBOL(syscall_linux)(
+		XSYSCALL_mremap,
+		addr,
+		old_len,
+		new_len,
+		_flags,
+		new_addr);
+
+	if (ret < 0 && ret > -4096) {
+		/* errno */
+		switch (ret) {
+			case -EAGAIN:
+				x_errno = X_EAGAIN;
+				break;
+			case -EFAULT:
+				x_errno = X_EFAULT;
+				break;
+			case -EINVAL:
+				x_errno = X_EINVAL;
+				break;
+			case -ENOMEM:
+				x_errno = X_ENOMEM;
+				break;
+			default:
+				x_errno = X_EUNKNOWN;
+				break;
+		}
+		return X_MAP_FAILED;
+	}
+
+	return (void *)ret;
+
+#else
+#	error "!!!unknown DEMOZ_PLATFORM!!!"
+#endif
+}
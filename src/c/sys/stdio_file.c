@@ -0,0 +1,932 @@
+/* @file: stdio_file.c
+ * #desc:
+ *    The implementations of buffered file streams.
+ *
+ * #copy:
+ *    Copyright (C) 1970 Public Free Software
+ *
+ *    This library is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 2.1 of the License, or (at your option) any later version.
+ *
+ *    This library is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with this library; if not,
+ *    see <https://www.gnu.org/licenses/>.
+ */
+
+#include <demoz/config.h>
+#include <demoz/c/stddef.h>
+#include <demoz/c/stdint.h>
+#include <demoz/c/atomic.h>
+#include <demoz/c/errno.h>
+#include <demoz/c/string.h>
+#include <demoz/c/sys/types.h>
+#include <demoz/c/sys/stat.h>
+#include <demoz/c/sys/fcntl.h>
+#include <demoz/c/sys/unistd.h>
+#include <demoz/c/sys/stdlib.h>
+#include <demoz/c/sys/stdio.h>
+
+
+/* @def: _ */
+#define FILE_READ 0x01
+#define FILE_WRITE 0x02
+#define FILE_EOF 0x04
+#define FILE_ERROR 0x08
+/* line buffering: a newline is pending */
+#define FILE_LF 0x10
+/* buffer from malloc */
+#define FILE_BUF 0x20
+/* object (and default buffer) from malloc */
+#define FILE_OBJ 0x40
+
+#define FILE_MODE 0666
+
+#define FILE_NEW(_fd, _flags, _mode, _buf, _next) { \
+	.fd = _fd, .flags = _flags, .mode = _mode, \
+	.lock = 0, .count = 0, \
+	.buf = _buf, .size = X_BUFSIZ, \
+	.rpos = 0, .rend = 0, .wpos = 0, \
+	.next = _next \
+	}
+
+static uint8_t _stdin_buf[X_BUFSIZ + 1];
+static uint8_t _stdout_buf[X_BUFSIZ + 1];
+static uint8_t _stderr_buf[X_BUFSIZ + 1];
+
+static struct x_file _stdin = FILE_NEW(0, FILE_READ, X_IOFBF,
+	_stdin_buf, NULL);
+static struct x_file _stdout = FILE_NEW(1, FILE_WRITE, X_IOLBF,
+	_stdout_buf, &_stdin);
+static struct x_file _stderr = FILE_NEW(2, FILE_WRITE, X_IONBF,
+	_stderr_buf, &_stdout);
+
+struct x_file *C_SYMBOL(stdin) = &_stdin;
+struct x_file *C_SYMBOL(stdout) = &_stdout;
+struct x_file *C_SYMBOL(stderr) = &_stderr;
+
+/* open streams (flushed at exit) */
+static struct x_file *_file_head = &_stderr;
+static volatile int32_t _file_exit = 0;
+
+#if (DEMOZ_THREAD == DEMOZ_ENABLE_THREAD)
+static volatile int32_t _file_lock = 0;
+static volatile int32_t _file_tid = 0;
+static __thread int32_t _file_self = 0;
+#endif
+/* end */
+
+/* @func: _list_lock (static)
+ * #desc:
+ *    stream list spin lock.
+ */
+static void _list_lock(void)
+{
+#if (DEMOZ_THREAD == DEMOZ_ENABLE_THREAD)
+	int32_t lock = C_SYMBOL(atomic_cas)(&_file_lock, 0, 1);
+	while (lock && C_SYMBOL(atomic_cas)(&_file_lock, 0, 1));
+#endif
+}
+
+/* @func: _list_unlock (static)
+ * #desc:
+ *    stream list spin unlock.
+ */
+static void _list_unlock(void)
+{
+#if (DEMOZ_THREAD == DEMOZ_ENABLE_THREAD)
+	while (!C_SYMBOL(atomic_cas)(&_file_lock, 1, 0));
+#endif
+}
+
+#if (DEMOZ_THREAD == DEMOZ_ENABLE_THREAD)
+
+/* @func: _self (static)
+ * #desc:
+ *    lock owner id of the calling thread.
+ *
+ * #r: [ret] owner id (>0)
+ */
+static int32_t _self(void)
+{
+	int32_t n;
+
+	if (!_file_self) {
+		do {
+			n = _file_tid;
+		} while (C_SYMBOL(atomic_cas)(&_file_tid, n, n + 1) != n);
+		_file_self = n + 1;
+	}
+
+	return _file_self;
+}
+
+#endif
+
+/* @func: _lock (static)
+ * #desc:
+ *    stream spin lock (recursive, for flockfile).
+ *
+ * #1: f [in/out] stream
+ */
+static void _lock(struct x_file *f)
+{
+#if (DEMOZ_THREAD == DEMOZ_ENABLE_THREAD)
+	int32_t self = _self();
+	if (f->lock == self) {
+		f->count++;
+		return;
+	}
+	while (C_SYMBOL(atomic_cas)(&f->lock, 0, self));
+	f->count = 1;
+#else
+	(void)f;
+#endif
+}
+
+/* @func: _unlock (static)
+ * #desc:
+ *    stream spin unlock.
+ *
+ * #1: f [in/out] stream
+ */
+static void _unlock(struct x_file *f)
+{
+#if (DEMOZ_THREAD == DEMOZ_ENABLE_THREAD)
+	if (--f->count)
+		return;
+	int32_t self = f->lock;
+	while (C_SYMBOL(atomic_cas)(&f->lock, self, 0) != self);
+#else
+	(void)f;
+#endif
+}
+
+/* @func: _file_write (static)
+ * #desc:
+ *    write the whole buffer to the file descriptor.
+ *
+ * #1: f   [in/out] stream
+ * #2: s   [in]     buffer
+ * #3: len [in]     buffer length
+ * #r:     [ret]    0: no error, -1: error
+ */
+static int32_t _file_write(struct x_file *f, const uint8_t *s, size_t len)
+{
+	while (len) {
+		ssize_t r = C_SYMBOL(write)(f->fd, s, len);
+		if (r < 0) {
+			if (x_errno == X_EINTR)
+				continue;
+			f->flags |= FILE_ERROR;
+			return -1;
+		}
+		s += r;
+		len -= (size_t)r;
+	}
+
+	return 0;
+}
+
+/* @func: _file_flush (static)
+ * #desc:
+ *    write out the pending output.
+ *
+ * #1: f [in/out] stream
+ * #r:   [ret]    0: no error, -1: error
+ */
+static int32_t _file_flush(struct x_file *f)
+{
+	if (!f->wpos)
+		return 0;
+
+	int32_t r = _file_write(f, f->buf, f->wpos);
+	f->wpos = 0;
+	f->flags &= ~FILE_LF;
+
+	return r;
+}
+
+/* @func: _file_unread (static)
+ * #desc:
+ *    drop the read-ahead data and move the file offset back to the
+ *    stream position (pipes and ttys just lose it).
+ *
+ * #1: f [in/out] stream
+ */
+static void _file_unread(struct x_file *f)
+{
+	if (f->rpos < f->rend)
+		C_SYMBOL(lseek)(f->fd, -(x_off_t)(f->rend - f->rpos),
+			X_SEEK_CUR);
+	f->rpos = f->rend = 0;
+}
+
+/* @func: _file_flush_all (static)
+ * #desc:
+ *    flush all open streams.
+ *
+ * #r: [ret] 0: no error, -1: error
+ */
+static int32_t _file_flush_all(void)
+{
+	int32_t r = 0;
+
+	_list_lock();
+	for (struct x_file *f = _file_head; f; f = f->next) {
+		_lock(f);
+		r |= _file_flush(f);
+		_unlock(f);
+	}
+	_list_unlock();
+
+	return r;
+}
+
+/* @func: _file_atexit (static)
+ * #desc:
+ *    flush all open streams at exit.
+ */
+static void _file_atexit(void)
+{
+	_file_flush_all();
+}
+
+/* @func: ___fput
+ * #desc:
+ *    append to the stream buffer (unlocked), writes that do not fit
+ *    go to the file descriptor without a copy.
+ *
+ * #1: f   [in/out] stream
+ * #2: s   [in]     buffer
+ * #3: len [in]     buffer length
+ * #r:     [ret]    0: no error, -1: error
+ */
+int32_t C_SYMBOL(___fput)(struct x_file *f, const void *s, size_t len)
+{
+	if (!(f->flags & FILE_WRITE)) {
+		f->flags |= FILE_ERROR;
+		x_errno = X_EBADF;
+		return -1;
+	}
+	if (!_file_exit && !C_SYMBOL(atomic_cas)(&_file_exit, 0, 1))
+		C_SYMBOL(atexit)(_file_atexit);
+
+	if (f->rend)
+		_file_unread(f);
+
+	if (len > f->size - f->wpos) {
+		if (_file_flush(f))
+			return -1;
+		if (len >= f->size)
+			return _file_write(f, s, len);
+	}
+	/* after the flush (it clears the flag) */
+	if (f->mode == X_IOLBF && C_SYMBOL(memchr)(s, '\n', len))
+		f->flags |= FILE_LF;
+	C_SYMBOL(memcpy)(f->buf + f->wpos, s, len);
+	f->wpos += len;
+
+	return 0;
+}
+
+/* @func: ___fdone
+ * #desc:
+ *    end of a write call (unlocked), flush by the buffering mode.
+ *
+ * #1: f [in/out] stream
+ * #r:   [ret]    0: no error, -1: error
+ */
+int32_t C_SYMBOL(___fdone)(struct x_file *f)
+{
+	if (f->mode == X_IONBF || (f->flags & FILE_LF))
+		return _file_flush(f);
+
+	return 0;
+}
+
+/* @func: ___fline
+ * #desc:
+ *    read window (unlocked), it ends after the last buffered newline
+ *    (or at the end of file), the rest of a line is read when none
+ *    is buffered. the window is consumed by moving rpos.
+ *
+ * #1: f    [in/out] stream
+ * #2: len  [out]    window length
+ * #3: more [in]     read more (the window was not enough)
+ * #r:      [ret]    window pointer / NULL pointer (end of file, error)
+ */
+char *C_SYMBOL(___fline)(struct x_file *f, size_t *len, int32_t more)
+{
+	if (!(f->flags & FILE_READ)) {
+		f->flags |= FILE_ERROR;
+		x_errno = X_EBADF;
+		return NULL;
+	}
+	if (_file_flush(f))
+		return NULL;
+
+	size_t n = f->rend - f->rpos;
+	if (more || !C_SYMBOL(memchr)(f->buf + f->rpos, '\n', n)) {
+		C_SYMBOL(memmove)(f->buf, f->buf + f->rpos, n);
+		f->rpos = 0;
+		f->rend = n;
+
+		while (f->rend < f->size && !(f->flags & FILE_EOF)) {
+			ssize_t r = C_SYMBOL(read)(f->fd, f->buf + f->rend,
+				f->size - f->rend);
+			if (r < 0) {
+				if (x_errno == X_EINTR)
+					continue;
+				f->flags |= FILE_ERROR;
+				break;
+			}
+			if (!r) {
+				f->flags |= FILE_EOF;
+				break;
+			}
+			n = f->rend;
+			f->rend += (size_t)r;
+			if (C_SYMBOL(memchr)(f->buf + n, '\n', (size_t)r))
+				break;
+		}
+	}
+	if (f->rpos == f->rend)
+		return NULL;
+
+	/* a partial last line waits for the rest */
+	n = f->rend;
+	if (!(f->flags & FILE_EOF)) {
+		for (; n > f->rpos && f->buf[n - 1] != '\n'; n--);
+		if (n == f->rpos) /* one line fills the buffer */
+			n = f->rend;
+	}
+	*len = n - f->rpos;
+
+	return (char *)f->buf + f->rpos;
+}
+
+/* @func: _file_mode (static)
+ * #desc:
+ *    parse the fopen mode string ("r", "w", "a", "+", "b", "e", "x").
+ *
+ * #1: mode   [in]  mode string
+ * #2: oflags [out] open flags
+ * #r:        [ret] stream flags / -1: invalid mode
+ */
+static int32_t _file_mode(const char *mode, int32_t *oflags)
+{
+	int32_t flags;
+
+	switch (*mode++) {
+		case 'r':
+			flags = FILE_READ;
+			*oflags = X_O_RDONLY;
+			break;
+		case 'w':
+			flags = FILE_WRITE;
+			*oflags = X_O_WRONLY | X_O_CREAT | X_O_TRUNC;
+			break;
+		case 'a':
+			flags = FILE_WRITE;
+			*oflags = X_O_WRONLY | X_O_CREAT | X_O_APPEND;
+			break;
+		default:
+			x_errno = X_EINVAL;
+			return -1;
+	}
+
+	for (; *mode != '\0'; mode++) {
+		switch (*mode) {
+			case '+':
+				flags |= FILE_READ | FILE_WRITE;
+				*oflags = (*oflags & ~X_O_ACCMODE) | X_O_RDWR;
+				break;
+			case 'e':
+				*oflags |= X_O_CLOEXEC;
+				break;
+			case 'x':
+				*oflags |= X_O_EXCL;
+				break;
+			case 'b':
+				break;
+			default:
+				x_errno = X_EINVAL;
+				return -1;
+		}
+	}
+
+	return flags;
+}
+
+/* @func: fdopen
+ * #desc:
+ *    associate a stream with a file descriptor.
+ *
+ * #1: fd   [in]  file descriptor
+ * #2: mode [in]  mode string
+ * #r:      [ret] stream / NULL pointer
+ */
+struct x_file *C_SYMBOL(fdopen)(int32_t fd, const char *mode)
+{
+	int32_t oflags, flags = _file_mode(mode, &oflags);
+	if (flags < 0)
+		return NULL;
+
+	struct x_file *f = C_SYMBOL(malloc)(sizeof(struct x_file)
+		+ X_BUFSIZ + 1);
+	if (!f)
+		return NULL;
+
+	f->fd = fd;
+	f->flags = flags | FILE_OBJ;
+	f->mode = X_IOFBF;
+	f->lock = 0;
+	f->count = 0;
+	f->buf = (uint8_t *)(f + 1);
+	f->size = X_BUFSIZ;
+	f->rpos = f->rend = f->wpos = 0;
+
+	_list_lock();
+	f->next = _file_head;
+	_file_head = f;
+	_list_unlock();
+
+	return f;
+}
+
+/* @func: fopen
+ * #desc:
+ *    open a file stream.
+ *
+ * #1: path [in]  path name
+ * #2: mode [in]  mode string
+ * #r:      [ret] stream / NULL pointer
+ */
+struct x_file *C_SYMBOL(fopen)(const char *path, const char *mode)
+{
+	int32_t oflags;
+	if (_file_mode(mode, &oflags) < 0)
+		return NULL;
+
+	int32_t fd = C_SYMBOL(open)(path, oflags, FILE_MODE);
+	if (fd < 0)
+		return NULL;
+
+	struct x_file *f = C_SYMBOL(fdopen)(fd, mode);
+	if (!f)
+		C_SYMBOL(close)(fd);
+
+	return f;
+}
+
+/* @func: fclose
+ * #desc:
+ *    flush and close a stream.
+ *
+ * #1: f [in/out] stream
+ * #r:   [ret]    0: no error, X_EOF: error
+ */
+int32_t C_SYMBOL(fclose)(struct x_file *f)
+{
+	_list_lock();
+	for (struct x_file **p = &_file_head; *p; p = &(*p)->next) {
+		if (*p == f) {
+			*p = f->next;
+			break;
+		}
+	}
+	_list_unlock();
+
+	_lock(f);
+	int32_t r = _file_flush(f);
+	r |= C_SYMBOL(close)(f->fd);
+
+	if (f->flags & FILE_BUF)
+		C_SYMBOL(free)(f->buf);
+	if (f->flags & FILE_OBJ) {
+		C_SYMBOL(free)(f);
+	} else {
+		f->flags = 0;
+		_unlock(f);
+	}
+
+	return r ? X_EOF : 0;
+}
+
+/* @func: setvbuf
+ * #desc:
+ *    set the stream buffering, before any input/output.
+ *
+ * #1: f    [in/out] stream
+ * #2: buf  [in]     buffer / NULL pointer (allocate)
+ * #3: mode [in]     X_IOFBF, X_IOLBF, X_IONBF
+ * #4: size [in]     buffer size (0: keep the buffer)
+ * #r:      [ret]    0: no error, -1: error
+ */
+int32_t C_SYMBOL(setvbuf)(struct x_file *f, char *buf, int32_t mode,
+		size_t size)
+{
+	if (mode != X_IOFBF && mode != X_IOLBF && mode != X_IONBF) {
+		x_errno = X_EINVAL;
+		return -1;
+	}
+
+	_lock(f);
+	if (f->wpos || f->rend) {
+		_unlock(f);
+		x_errno = X_EINVAL;
+		return -1;
+	}
+
+	if (size > 1) {
+		uint8_t *p = (uint8_t *)buf;
+		if (!p) {
+			p = C_SYMBOL(malloc)(size);
+			if (!p) {
+				_unlock(f);
+				return -1;
+			}
+		}
+		if (f->flags & FILE_BUF)
+			C_SYMBOL(free)(f->buf);
+		f->flags = buf ? (f->flags & ~FILE_BUF)
+			: (f->flags | FILE_BUF);
+		/* one byte is kept for the scanf terminator */
+		f->buf = p;
+		f->size = size - 1;
+	}
+	f->mode = mode;
+	_unlock(f);
+
+	return 0;
+}
+
+/* @func: fflush
+ * #desc:
+ *    write out the pending output of a stream.
+ *
+ * #1: f [in/out] stream / NULL pointer (all streams)
+ * #r:   [ret]    0: no error, X_EOF: error
+ */
+int32_t C_SYMBOL(fflush)(struct x_file *f)
+{
+	int32_t r;
+
+	if (!f)
+		return _file_flush_all() ? X_EOF : 0;
+
+	_lock(f);
+	r = _file_flush(f);
+	_unlock(f);
+
+	return r ? X_EOF : 0;
+}
+
+/* @func: fread
+ * #desc:
+ *    binary stream input, reads larger than the buffer go to the
+ *    target without a copy.
+ *
+ * #1: p    [out]    target buffer
+ * #2: size [in]     item size
+ * #3: n    [in]     number of items
+ * #4: f    [in/out] stream
+ * #r:      [ret]    number of items read
+ */
+size_t C_SYMBOL(fread)(void *p, size_t size, size_t n, struct x_file *f)
+{
+	size_t len = size * n, k = 0;
+	uint8_t *t = p;
+	ssize_t r;
+
+	if (!len || len / n != size)
+		return 0;
+
+	_lock(f);
+	if (!(f->flags & FILE_READ)) {
+		f->flags |= FILE_ERROR;
+		_unlock(f);
+		x_errno = X_EBADF;
+		return 0;
+	}
+	if (_file_flush(f)) {
+		_unlock(f);
+		return 0;
+	}
+
+	while (k < len) {
+		if (f->rpos < f->rend) {
+			size_t m = f->rend - f->rpos;
+			if (m > len - k)
+				m = len - k;
+			C_SYMBOL(memcpy)(t + k, f->buf + f->rpos, m);
+			f->rpos += m;
+			k += m;
+			continue;
+		}
+		if (f->flags & FILE_EOF)
+			break;
+
+		if (len - k >= f->size) {
+			r = C_SYMBOL(read)(f->fd, t + k, len - k);
+			if (r > 0)
+				k += (size_t)r;
+		} else {
+			r = C_SYMBOL(read)(f->fd, f->buf, f->size);
+			f->rpos = 0;
+			f->rend = r > 0 ? (size_t)r : 0;
+		}
+		if (r < 0) {
+			if (x_errno == X_EINTR)
+				continue;
+			f->flags |= FILE_ERROR;
+			break;
+		}
+		if (!r)
+			f->flags |= FILE_EOF;
+	}
+	_unlock(f);
+
+	return k / size;
+}
+
+/* @func: fwrite
+ * #desc:
+ *    binary stream output.
+ *
+ * #1: p    [in]     source buffer
+ * #2: size [in]     item size
+ * #3: n    [in]     number of items
+ * #4: f    [in/out] stream
+ * #r:      [ret]    number of items written
+ */
+size_t C_SYMBOL(fwrite)(const void *p, size_t size, size_t n,
+		struct x_file *f)
+{
+	size_t len = size * n;
+	int32_t r;
+
+	if (!len || len / n != size)
+		return 0;
+
+	_lock(f);
+	r = C_SYMBOL(___fput)(f, p, len);
+	if (!r)
+		r = C_SYMBOL(___fdone)(f);
+	_unlock(f);
+
+	return r ? 0 : n;
+}
+
+/* @func: fseek
+ * #desc:
+ *    reposition a stream.
+ *
+ * #1: f      [in/out] stream
+ * #2: off    [in]     offset
+ * #3: whence [in]     X_SEEK_SET, X_SEEK_CUR, X_SEEK_END
+ * #r:        [ret]    0: no error, -1: error
+ */
+int32_t C_SYMBOL(fseek)(struct x_file *f, x_off_t off, int32_t whence)
+{
+	_lock(f);
+	if (_file_flush(f)) {
+		_unlock(f);
+		return -1;
+	}
+
+	if (whence == X_SEEK_CUR)
+		off -= (x_off_t)(f->rend - f->rpos);
+	f->rpos = f->rend = 0;
+
+	off = C_SYMBOL(lseek)(f->fd, off, whence);
+	if (off >= 0)
+		f->flags &= ~FILE_EOF;
+	_unlock(f);
+
+	return off < 0 ? -1 : 0;
+}
+
+/* @func: ftell
+ * #desc:
+ *    get the stream position.
+ *
+ * #1: f [in]  stream
+ * #r:   [ret] >=0: position, -1: error
+ */
+x_off_t C_SYMBOL(ftell)(struct x_file *f)
+{
+	_lock(f);
+	x_off_t off = C_SYMBOL(lseek)(f->fd, 0, X_SEEK_CUR);
+	if (off >= 0) {
+		off += (x_off_t)f->wpos;
+		off -= (x_off_t)(f->rend - f->rpos);
+	}
+	_unlock(f);
+
+	return off;
+}
+
+/* @func: rewind
+ * #desc:
+ *    reposition a stream to the beginning and clear the error.
+ *
+ * #1: f [in/out] stream
+ */
+void C_SYMBOL(rewind)(struct x_file *f)
+{
+	C_SYMBOL(fseek)(f, 0, X_SEEK_SET);
+	C_SYMBOL(clearerr)(f);
+}
+
+/* @func: fileno
+ * #desc:
+ *    get the file descriptor of a stream.
+ *
+ * #1: f [in]  stream
+ * #r:   [ret] file descriptor
+ */
+int32_t C_SYMBOL(fileno)(struct x_file *f)
+{
+	return f->fd;
+}
+
+/* @func: feof
+ * #desc:
+ *    test the end of file indicator.
+ *
+ * #1: f [in]  stream
+ * #r:   [ret] 0: no, 1: yes
+ */
+int32_t C_SYMBOL(feof)(struct x_file *f)
+{
+	return !!(f->flags & FILE_EOF);
+}
+
+/* @func: ferror
+ * #desc:
+ *    test the error indicator.
+ *
+ * #1: f [in]  stream
+ * #r:   [ret] 0: no, 1: yes
+ */
+int32_t C_SYMBOL(ferror)(struct x_file *f)
+{
+	return !!(f->flags & FILE_ERROR);
+}
+
+/* @func: clearerr
+ * #desc:
+ *    clear the end of file and error indicators.
+ *
+ * #1: f [in/out] stream
+ */
+void C_SYMBOL(clearerr)(struct x_file *f)
+{
+	_lock(f);
+	f->flags &= ~(FILE_EOF | FILE_ERROR);
+	_unlock(f);
+}
+
+/* @func: flockfile
+ * #desc:
+ *    stream lock, the stream calls of the owner thread nest inside.
+ *
+ * #1: f [in/out] stream
+ */
+void C_SYMBOL(flockfile)(struct x_file *f)
+{
+	_lock(f);
+}
+
+/* @func: funlockfile
+ * #desc:
+ *    stream unlock.
+ *
+ * #1: f [in/out] stream
+ */
+void C_SYMBOL(funlockfile)(struct x_file *f)
+{
+	_unlock(f);
+}
+
+/* @func: ftrylockfile
+ * #desc:
+ *    stream lock without waiting.
+ *
+ * #1: f [in/out] stream
+ * #r:   [ret]    0: locked, 1: busy
+ */
+int32_t C_SYMBOL(ftrylockfile)(struct x_file *f)
+{
+#if (DEMOZ_THREAD == DEMOZ_ENABLE_THREAD)
+	int32_t self = _self();
+	if (f->lock == self) {
+		f->count++;
+		return 0;
+	}
+	if (C_SYMBOL(atomic_cas)(&f->lock, 0, self))
+		return 1;
+	f->count = 1;
+
+	return 0;
+#else
+	(void)f;
+	return 0;
+#endif
+}
+
+/* @func: getc
+ * #desc:
+ *    get a character from a stream.
+ *
+ * #1: f [in/out] stream
+ * #r:   [ret]    character / X_EOF
+ */
+int32_t C_SYMBOL(getc)(struct x_file *f)
+{
+	uint8_t c;
+
+	_lock(f);
+	if (f->rpos < f->rend) {
+		c = f->buf[f->rpos++];
+		_unlock(f);
+		return c;
+	}
+	_unlock(f);
+
+	return C_SYMBOL(fread)(&c, 1, 1, f) ? c : X_EOF;
+}
+
+/* @func: getchar
+ * #desc:
+ *    get a character from the standard input.
+ *
+ * #r: [ret] character / X_EOF
+ */
+int32_t C_SYMBOL(getchar)(void)
+{
+	return C_SYMBOL(getc)(C_SYMBOL(stdin));
+}
+
+/* @func: putc
+ * #desc:
+ *    put a character to a stream.
+ *
+ * #1: c [in]     character
+ * #2: f [in/out] stream
+ * #r:   [ret]    character / X_EOF
+ */
+int32_t C_SYMBOL(putc)(int32_t c, struct x_file *f)
+{
+	uint8_t v = (uint8_t)c;
+	int32_t r;
+
+	_lock(f);
+	r = C_SYMBOL(___fput)(f, &v, 1);
+	if (!r)
+		r = C_SYMBOL(___fdone)(f);
+	_unlock(f);
+
+	return r ? X_EOF : v;
+}
+
+/* @func: putchar
+ * #desc:
+ *    put a character to the standard output.
+ *
+ * #1: c [in]  character
+ * #r:   [ret] character / X_EOF
+ */
+int32_t C_SYMBOL(putchar)(int32_t c)
+{
+	return C_SYMBOL(putc)(c, C_SYMBOL(stdout));
+}
+
+/* @func: fputs
+ * #desc:
+ *    put a string to a stream.
+ *
+ * #1: s [in]     string
+ * #2: f [in/out] stream
+ * #r:   [ret]    0: no error, X_EOF: error
+ */
+int32_t C_SYMBOL(fputs)(const char *s, struct x_file *f)
+{
+	int32_t r;
+
+	_lock(f);
+	r = C_SYMBOL(___fput)(f, s, C_SYMBOL(strlen)(s));
+	if (!r)
+		r = C_SYMBOL(___fdone)(f);
+	_unlock(f);
+
+	return r ? X_EOF : 0;
+}
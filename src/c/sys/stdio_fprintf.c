@@ -0,0 +1,115 @@
+/* @file: stdio_fprintf.c
+ * #desc:
+ *    The implementations of formatted stream output.
+ *
+ * #copy:
+ *    Copyright (C) 1970 Public Free Software
+ *
+ *    This library is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 2.1 of the License, or (at your option) any later version.
+ *
+ *    This library is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with this library; if not,
+ *    see <https://www.gnu.org/licenses/>.
+ */
+
+#include <demoz/config.h>
+#include <demoz/c/stddef.h>
+#include <demoz/c/stdint.h>
+#include <demoz/c/stdarg.h>
+#include <demoz/c/stdio.h>
+#include <demoz/c/sys/stdio.h>
+
+
+/* @def: _ */
+struct fprintf_ctx {
+	struct x_file *f;
+	int32_t len;
+};
+
+static int32_t _call(const char *s, int32_t len, void *arg) {
+	struct fprintf_ctx *ctx = arg;
+
+	ctx->len += len;
+
+	return C_SYMBOL(___fput)(ctx->f, s, (size_t)len);
+}
+/* end */
+
+/* @func: vfprintf
+ * #desc:
+ *    formatted output to a stream, the conversions are written into
+ *    the stream buffer.
+ *
+ * #1: f   [in/out] stream
+ * #2: fmt [in]     format string
+ * #3: ap  [in]     variable parameter
+ * #r:     [ret]    >=0: output length, -1: error
+ */
+int32_t C_SYMBOL(vfprintf)(struct x_file *f, const char *fmt, va_list ap)
+{
+	struct fprintf_ctx ctx = {
+		.f = f, .len = 0
+		};
+
+	C_SYMBOL(flockfile)(f);
+	int32_t r = C_SYMBOL(___printf)(fmt, ap, &ctx, _call);
+	if (!r)
+		r = C_SYMBOL(___fdone)(f);
+	C_SYMBOL(funlockfile)(f);
+
+	return r ? -1 : ctx.len;
+}
+
+/* @func: fprintf
+ * #desc:
+ *    formatted output to a stream.
+ *
+ * #1: f   [in/out] stream
+ * #2: fmt [in]     format string
+ * #N:     [in]     variable parameter
+ * #r:     [ret]    >=0: output length, -1: error
+ */
+int32_t C_SYMBOL(fprintf)(struct x_file *f, const char *fmt, ...)
+{
+	va_list ap;
+	va_start(ap, fmt);
+
+	return C_SYMBOL(vfprintf)(f, fmt, ap);
+}
+
+/* @func: vprintf
+ * #desc:
+ *    formatted output to the standard output.
+ *
+ * #1: fmt [in]  format string
+ * #2: ap  [in]  variable parameter
+ * #r:     [ret] >=0: output length, -1: error
+ */
+int32_t C_SYMBOL(vprintf)(const char *fmt, va_list ap)
+{
+	return C_SYMBOL(vfprintf)(C_SYMBOL(stdout), fmt, ap);
+}
+
+/* @func: printf
+ * #desc:
+ *    formatted output to the standard output.
+ *
+ * #1: fmt [in]  format string
+ * #N:     [in]  variable parameter
+ * #r:     [ret] >=0: output length, -1: error
+ */
+int32_t C_SYMBOL(printf)(const char *fmt, ...)
+{
+	va_list ap;
+	va_start(ap, fmt);
+
+	return C_SYMBOL(vprintf)(fmt, ap);
+}
@@ -0,0 +1,127 @@
+/* @file: stdio_fscanf.c
+ * #desc:
+ *    The implementations of formatted stream input.
+ *
+ * #copy:
+ *    Copyright (C) 1970 Public Free Software
+ *
+ *    This library is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 2.1 of the License, or (at your option) any later version.
+ *
+ *    This library is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with this library; if not,
+ *    see <https://www.gnu.org/licenses/>.
+ */
+
+#include <demoz/config.h>
+#include <demoz/c/stddef.h>
+#include <demoz/c/stdint.h>
+#include <demoz/c/stdarg.h>
+#include <demoz/c/stdio.h>
+#include <demoz/c/sys/stdio.h>
+
+
+/* @func: vfscanf
+ * #desc:
+ *    stream convert to formatted value, the buffered lines are scanned
+ *    again with more input when the scan reaches their end (the buffer
+ *    size bounds a scan).
+ *
+ * #1: f   [in/out] stream
+ * #2: fmt [in]     formatted string
+ * #3: ap  [in]     variable argument
+ * #r:     [ret]    >0: number of matching, <0: format error, X_EOF
+ */
+int32_t C_SYMBOL(vfscanf)(struct x_file *f, const char *fmt, va_list ap)
+{
+	size_t len = 0, n, k;
+	int32_t r;
+	char *s, *e, c;
+	va_list aq;
+
+	C_SYMBOL(flockfile)(f);
+	s = C_SYMBOL(___fline)(f, &len, 0);
+	if (!s) {
+		C_SYMBOL(funlockfile)(f);
+		return X_EOF;
+	}
+
+	while (1) {
+		/* the byte after the window is put back */
+		c = s[len];
+		s[len] = '\0';
+		e = s;
+		va_copy(aq, ap);
+		r = C_SYMBOL(___scanf)(s, &e, fmt, aq);
+		va_end(aq);
+		s[len] = c;
+
+		/* a format space also matches the terminator */
+		k = (size_t)(e - s);
+		k = (k > len) ? len : k;
+		if (k < len)
+			break;
+		/* a token may go on after the window */
+		n = len;
+		s = C_SYMBOL(___fline)(f, &len, 1);
+		if (!s || len == n)
+			break;
+	}
+	f->rpos += k;
+	C_SYMBOL(funlockfile)(f);
+
+	return r;
+}
+
+/* @func: fscanf
+ * #desc:
+ *    stream convert to formatted value.
+ *
+ * #1: f   [in/out] stream
+ * #2: fmt [in]     formatted string
+ * #N:     [out]    variable argument
+ * #r:     [ret]    >0: number of matching, <0: format error, X_EOF
+ */
+int32_t C_SYMBOL(fscanf)(struct x_file *f, const char *fmt, ...)
+{
+	va_list ap;
+	va_start(ap, fmt);
+
+	return C_SYMBOL(vfscanf)(f, fmt, ap);
+}
+
+/* @func: vscanf
+ * #desc:
+ *    standard input convert to formatted value.
+ *
+ * #1: fmt [in]  formatted string
+ * #2: ap  [in]  variable argument
+ * #r:     [ret] >0: number of matching, <0: format error, X_EOF
+ */
+int32_t C_SYMBOL(vscanf)(const char *fmt, va_list ap)
+{
+	return C_SYMBOL(vfscanf)(C_SYMBOL(stdin), fmt, ap);
+}
+
+/* @func: scanf
+ * #desc:
+ *    standard input convert to formatted value.
+ *
+ * #1: fmt [in]  formatted string
+ * #N:     [out] variable argument
+ * #r:     [ret] >0: number of matching, <0: format error, X_EOF
+ */
+int32_t C_SYMBOL(scanf)(const char *fmt, ...)
+{
+	va_list ap;
+	va_start(ap, fmt);
+
+	return C_SYMBOL(vscanf)(fmt, ap);
+}
@@ -24,33 +24,269 @@
 #include <demoz/c/stddef.h>
 #include <demoz/c/stdint.h>
 #include <demoz/c/atomic.h>
+#include <demoz/c/errno.h>
+#include <demoz/c/string.h>
 #include <demoz/c/sys/mman.h>
 #include <demoz/c/sys/umalloc.h>
 #include <demoz/c/sys/stdlib.h>
 
 
-/* @def: _ */
-static void *_alloc(size_t size, void *arg) {
-	(void)arg;
+/* @def: _
+ * thread cache --> arena { central list, umalloc_ctx } --> mmap
+ *
+ * every umalloc node is mapped on ARENA_ALIGN boundary, and the first
+ * word of the mapping points to the owner arena, so any pointer can
+ * find the arena (and its lock) by masking. the byte before the pointer
+ * is masked, an aligned chunk may start the second window of its node.
+ */
+#define ARENA_NUM 8
+/* larger than a umalloc node (256KiB) */
+#define ARENA_ALIGN (1UL << 20)
+#define ARENA_OFFSET 16
+#define ARENA_OWNER(x) \
+	(*(struct malloc_arena **)(((uintptr_t)(x) - 1) \
+		& ~(ARENA_ALIGN - 1)))
+
+/* size class: 16, 32, 48 ... 1024 */
+#define CLASS_NUM 64
+#define CLASS_SIZE(x) (((x) + 1) << 4)
+#define CLASS_INDEX(x) ((((x) + 15) >> 4) - 1)
+
+#define CACHE_LIMIT 64
+#define CACHE_BATCH 32
+#define CENTRAL_LIMIT 1024
+
+#define LIST_NEXT_OBJ(x) (*(void **)(x))
+
+struct malloc_arena {
+	volatile int32_t lock;
+	size_t align; /* node alignment (posix_memalign) */
+	struct umalloc_ctx ctx;
+	void *list[CLASS_NUM];
+	uint32_t count[CLASS_NUM];
+};
+
+struct malloc_cache {
+	struct malloc_arena *arena;
+	void *list[CLASS_NUM];
+	uint32_t count[CLASS_NUM];
+};
+
+/* the second window starts on the alignment (>= ARENA_ALIGN) */
+static char *_map(size_t len, size_t align)
+{
+	if (len > ((size_t)-1 - align))
+		return NULL;
 
-	void *p = C_SYMBOL(mmap)(NULL, (size + 4095) & ~4095UL,
+	char *p = C_SYMBOL(mmap)(NULL, len + align,
 		X_PROT_READ | X_PROT_WRITE,
 		X_MAP_PRIVATE | X_MAP_ANONYMOUS, -1, 0);
+	if (p == X_MAP_FAILED)
+		return NULL;
+
+	char *a = (char *)((((uintptr_t)p + ARENA_ALIGN + align - 1)
+		& ~(align - 1)) - ARENA_ALIGN);
+	if (a != p)
+		C_SYMBOL(munmap)(p, a - p);
+	C_SYMBOL(munmap)(a + len, (p + align) - a);
+
+	return a;
+}
+
+static void *_alloc(size_t size, void *arg)
+{
+	struct malloc_arena *arena = arg;
+
+	char *a = _map((size + ARENA_OFFSET + 4095) & ~4095UL, arena->align);
+	if (!a)
+		return NULL;
+
+	*(struct malloc_arena **)a = arg;
+
+	return a + ARENA_OFFSET;
+}
 
-	return (p == X_MAP_FAILED) ? NULL : p;
+static void _free(void *p, size_t size, void *arg)
+{
+	(void)arg;
+
+	C_SYMBOL(munmap)((char *)p - ARENA_OFFSET,
+		(size + ARENA_OFFSET + 4095) & ~4095UL);
 }
 
-static void _free(void *p, size_t size, void *arg) {
+static void *_realloc(void *p, size_t old, size_t size, void *arg)
+{
 	(void)arg;
 
-	C_SYMBOL(munmap)(p, (size + 4095) & ~4095UL);
+	char *a = (char *)p - ARENA_OFFSET, *r;
+	size_t olen = (old + ARENA_OFFSET + 4095) & ~4095UL;
+	size_t len = (size + ARENA_OFFSET + 4095) & ~4095UL;
+	if (olen == len)
+		return p;
+
+	r = C_SYMBOL(mremap)(a, olen, len, 0, NULL);
+	if (r != X_MAP_FAILED)
+		return p;
+
+	/* move the pages to a new aligned place (no copy) */
+	r = _map(len, ARENA_ALIGN);
+	if (!r)
+		return NULL;
+	if (C_SYMBOL(mremap)(a, olen, len, X_MREMAP_MAYMOVE | X_MREMAP_FIXED,
+			r) == X_MAP_FAILED) {
+		C_SYMBOL(munmap)(r, len);
+		return NULL;
+	}
+
+	return r + ARENA_OFFSET;
 }
 
-UMALLOC_NEW(___global_umalloc_ctx, _alloc, _free, NULL);
+#define ARENA_NEW(n) { \
+	.align = ARENA_ALIGN, \
+	.ctx = { \
+		.chunk.node = NULL, \
+		.call_alloc = _alloc, \
+		.call_free = _free, \
+		.call_realloc = _realloc, \
+		.arg = &_arena[n] \
+		} \
+	}
+
+static struct malloc_arena _arena[ARENA_NUM];
+static struct malloc_arena _arena[ARENA_NUM] = {
+	ARENA_NEW(0), ARENA_NEW(1), ARENA_NEW(2), ARENA_NEW(3),
+	ARENA_NEW(4), ARENA_NEW(5), ARENA_NEW(6), ARENA_NEW(7)
+	};
 
-static volatile int32_t _lock = 0;
+static volatile int32_t _arena_next = 0;
+
+#if (DEMOZ_THREAD == DEMOZ_ENABLE_THREAD)
+static __thread struct malloc_cache _cache;
+#else
+static struct malloc_cache _cache;
+#endif
 /* end */
 
+/* @func: _arena_lock (static)
+ * #desc:
+ *    arena spin lock.
+ *
+ * #1: arena struct
+ */
+static void _arena_lock(struct malloc_arena *arena)
+{
+	int32_t lock = C_SYMBOL(atomic_cas)(&arena->lock, 0, 1);
+	while (lock && C_SYMBOL(atomic_cas)(&arena->lock, 0, 1));
+}
+
+/* @func: _arena_unlock (static)
+ * #desc:
+ *    arena spin unlock.
+ *
+ * #1: arena struct
+ */
+static void _arena_unlock(struct malloc_arena *arena)
+{
+	while (!C_SYMBOL(atomic_cas)(&arena->lock, 1, 0));
+}
+
+/* @func: _cache_arena (static)
+ * #desc:
+ *    bind the thread cache to an arena (round-robin).
+ *
+ * #r: arena struct
+ */
+static struct malloc_arena *_cache_arena(void)
+{
+	if (_cache.arena)
+		return _cache.arena;
+
+	int32_t n = _arena_next;
+	while (C_SYMBOL(atomic_cas)(&_arena_next, n, n + 1) != n)
+		n = _arena_next;
+
+	_cache.arena = &_arena[(uint32_t)n % ARENA_NUM];
+
+	return _cache.arena;
+}
+
+/* @func: _cache_refill (static)
+ * #desc:
+ *    refill a batch of objects from the central list of arena.
+ *
+ * #1: size class index
+ * #r: object pointer / NULL pointer
+ */
+static void *_cache_refill(uint32_t k)
+{
+	struct malloc_arena *arena = _cache_arena();
+	void *p;
+
+	_arena_lock(arena);
+
+	for (uint32_t i = 0; i < CACHE_BATCH; i++) {
+		p = arena->list[k];
+		if (p) {
+			arena->list[k] = LIST_NEXT_OBJ(p);
+			arena->count[k]--;
+		} else {
+			p = C_SYMBOL(___umalloc)(&arena->ctx, CLASS_SIZE(k));
+			if (!p)
+				break;
+		}
+		LIST_NEXT_OBJ(p) = _cache.list[k];
+		_cache.list[k] = p;
+		_cache.count[k]++;
+	}
+
+	_arena_unlock(arena);
+
+	p = _cache.list[k];
+	if (p) {
+		_cache.list[k] = LIST_NEXT_OBJ(p);
+		_cache.count[k]--;
+	}
+
+	return p;
+}
+
+/* @func: _cache_spill (static)
+ * #desc:
+ *    return a batch of objects to the central list of owner arena.
+ *
+ * #1: size class index
+ */
+static void _cache_spill(uint32_t k)
+{
+	struct malloc_arena *arena = NULL, *owner;
+	void *p;
+
+	for (uint32_t i = 0; i < CACHE_BATCH && _cache.list[k]; i++) {
+		p = _cache.list[k];
+		_cache.list[k] = LIST_NEXT_OBJ(p);
+		_cache.count[k]--;
+
+		owner = ARENA_OWNER(p);
+		if (owner != arena) {
+			if (arena)
+				_arena_unlock(arena);
+			arena = owner;
+			_arena_lock(arena);
+		}
+
+		if (arena->count[k] < CENTRAL_LIMIT) {
+			LIST_NEXT_OBJ(p) = arena->list[k];
+			arena->list[k] = p;
+			arena->count[k]++;
+		} else {
+			C_SYMBOL(___ufree)(&arena->ctx, p);
+		}
+	}
+
+	if (arena)
+		_arena_unlock(arena);
+}
+
 /* @func: malloc
  * #desc:
  *    heap memory allocator.
@@ -60,12 +296,30 @@ static volatile int32_t _lock = 0;
  */
 void *C_SYMBOL(malloc)(size_t size)
 {
-	int32_t lock = C_SYMBOL(atomic_cas)(&_lock, 0, 1);
-	while (lock && C_SYMBOL(atomic_cas)(&_lock, 0, 1));
+	struct malloc_arena *arena;
+	void *p;
 
-	void *p = C_SYMBOL(___umalloc)(&___global_umalloc_ctx, size);
+	if (!size)
+		size = 1;
 
-	while (!C_SYMBOL(atomic_cas)(&_lock, 1, 0));
+	uint32_t k = CLASS_INDEX(size);
+	if (size <= CLASS_SIZE(CLASS_NUM - 1)) {
+		p = _cache.list[k];
+		if (p) {
+			_cache.list[k] = LIST_NEXT_OBJ(p);
+			_cache.count[k]--;
+			return p;
+		}
+
+		return _cache_refill(k);
+	}
+
+	arena = _cache_arena();
+	_arena_lock(arena);
+
+	p = C_SYMBOL(___umalloc)(&arena->ctx, size);
+
+	_arena_unlock(arena);
 
 	return p;
 }
@@ -78,13 +332,175 @@ void *C_SYMBOL(malloc)(size_t size)
  */
 void C_SYMBOL(free)(void *p)
 {
+	struct malloc_arena *arena;
+
 	if (!p)
 		return;
 
-	int32_t lock = C_SYMBOL(atomic_cas)(&_lock, 0, 1);
-	while (lock && C_SYMBOL(atomic_cas)(&_lock, 0, 1));
+	/* the usable size may be larger than the class size */
+	size_t size = C_SYMBOL(___umalloc_usable)(p) & ~15UL;
+	uint32_t k = CLASS_INDEX(size);
+	if (size <= CLASS_SIZE(CLASS_NUM - 1)) {
+		if (_cache.count[k] >= CACHE_LIMIT)
+			_cache_spill(k);
+
+		LIST_NEXT_OBJ(p) = _cache.list[k];
+		_cache.list[k] = p;
+		_cache.count[k]++;
+		return;
+	}
+
+	arena = ARENA_OWNER(p);
+	_arena_lock(arena);
+
+	C_SYMBOL(___ufree)(&arena->ctx, p);
+
+	_arena_unlock(arena);
+}
+
+/* @func: realloc
+ * #desc:
+ *    heap memory reallocator.
+ *
+ * #1: heap pointer / NULL pointer
+ * #2: alloc length
+ * #r: heap pointer (NULL: the old pointer is unchanged)
+ */
+void *C_SYMBOL(realloc)(void *p, size_t size)
+{
+	struct malloc_arena *arena;
+
+	if (!p)
+		return C_SYMBOL(malloc)(size);
+	if (!size) {
+		C_SYMBOL(free)(p);
+		return NULL;
+	}
+
+	size_t n = C_SYMBOL(___umalloc_usable)(p);
+	if (size <= n && n <= CLASS_SIZE(CLASS_NUM))
+		return p;
+
+	arena = ARENA_OWNER(p);
+	_arena_lock(arena);
+
+	p = C_SYMBOL(___urealloc)(&arena->ctx, p, size);
+
+	_arena_unlock(arena);
+
+	return p;
+}
+
+/* @func: calloc
+ * #desc:
+ *    heap memory allocator (zero filled).
+ *
+ * #1: number of members
+ * #2: member length
+ * #r: heap pointer
+ */
+void *C_SYMBOL(calloc)(size_t n, size_t size)
+{
+	if (size && n > ((size_t)-1 / size)) {
+		x_errno = X_ENOMEM;
+		return NULL;
+	}
+
+	size *= n;
+	void *p = C_SYMBOL(malloc)(size);
+	/* big chunks are fresh pages */
+	if (p && size < UMALLOC_BIG_SIZE)
+		C_SYMBOL(memset)(p, 0, size);
+
+	return p;
+}
+
+/* @func: posix_memalign
+ * #desc:
+ *    aligned heap memory allocator.
+ *
+ * #1: heap pointer
+ * #2: alignment (power of two, multiple of sizeof(void *))
+ * #3: alloc length
+ * #r: 0: no error, X_EINVAL: invalid alignment, X_ENOMEM: no memory
+ */
+int32_t C_SYMBOL(posix_memalign)(void **p, size_t align, size_t size)
+{
+	struct malloc_arena *arena;
+
+	if (align < sizeof(void *) || (align & (align - 1)))
+		return X_EINVAL;
+
+	if (align <= 16) {
+		*p = C_SYMBOL(malloc)(size);
+		return *p ? 0 : X_ENOMEM;
+	}
+
+	arena = _cache_arena();
+	_arena_lock(arena);
 
-	C_SYMBOL(___ufree)(&___global_umalloc_ctx, p);
+	/* a big node of its own, the chunk starts its second window */
+	if (align > ARENA_ALIGN)
+		arena->align = align;
+	*p = C_SYMBOL(___umalloc_align)(&arena->ctx, align, size);
+	arena->align = ARENA_ALIGN;
+
+	_arena_unlock(arena);
+
+	return *p ? 0 : X_ENOMEM;
+}
+
+/* @func: aligned_alloc
+ * #desc:
+ *    aligned heap memory allocator.
+ *
+ * #1: alignment (power of two)
+ * #2: alloc length
+ * #r: heap pointer
+ */
+void *C_SYMBOL(aligned_alloc)(size_t align, size_t size)
+{
+	void *p;
+
+	if (align < sizeof(void *))
+		align = sizeof(void *);
+
+	int32_t ret = C_SYMBOL(posix_memalign)(&p, align, size);
+	if (ret) {
+		x_errno = ret;
+		return NULL;
+	}
+
+	return p;
+}
+
+/* @func: malloc_usable_size
+ * #desc:
+ *    usable length of the heap memory.
+ *
+ * #1: heap pointer / NULL pointer
+ * #r: usable length
+ */
+size_t C_SYMBOL(malloc_usable_size)(void *p)
+{
+	if (!p)
+		return 0;
+
+	return C_SYMBOL(___umalloc_usable)(p);
+}
+
+/* @func: malloc_thread_release
+ * #desc:
+ *    return the thread cache to the arenas, call it before a thread
+ *    exits (the cached objects are lost otherwise). the cache is bound
+ *    again on the next allocation.
+ */
+void C_SYMBOL(malloc_thread_release)(void)
+{
+	for (uint32_t k = 0; k < CLASS_NUM; k++) {
+		while (_cache.list[k])
+			_cache_spill(k);
+	}
 
-	while (!C_SYMBOL(atomic_cas)(&_lock, 1, 0));
+	_cache.arena = NULL;
 }
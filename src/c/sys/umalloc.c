@@ -23,6 +23,7 @@
 #include <demoz/config.h>
 #include <demoz/c/stddef.h>
 #include <demoz/c/stdint.h>
+#include <demoz/c/string.h>
 #include <demoz/ds/list.h>
 #include <demoz/c/sys/umalloc.h>
 
@@ -32,22 +33,29 @@
  *        node  | { list, size, chunk }
  *        chunk | chunk <--> chunk --> end
  *                { prev_size, size|flags }<alloc>
+ *                { prev_size, size|flags }{ next, prev }<free>
  * aligned: 16
  *  32: ((8+4+12) + (8^+8)+(8^+8))
  *  64: ((16+8)   + (8^+8)+(8^+8))
  *                    2      3
+ *
+ * bin | 0 ... 63 (16 ... 1024) | 64 ... 95 (2^10 ... 2^18, 4 steps)
+ *       exact                    first-fit
  */
 #define CHUNK_NODE_SIZE sizeof(struct umalloc_chunk_node)
 #define CHUNK_SIZE sizeof(struct umalloc_chunk)
+#define CHUNK_LINK_SIZE sizeof(struct umalloc_chunk_link)
 
 /* stack 16-byte aligend */
 #define CHUNK_ALIGNED_SIZE(x) (((x) + CHUNK_SIZE + 15) & ~15U)
 #define CHUNK_NODE_ALIGNED_SIZE(x) (((x) + 15) & ~15UL)
+#define CHUNK_MIN_SIZE CHUNK_ALIGNED_SIZE(CHUNK_LINK_SIZE)
 
 #define NEXT_CHUNK(x) \
 	((struct umalloc_chunk *)((char *)(x) + GET_SIZE(x)))
 #define PREV_CHUNK(x) \
 	((struct umalloc_chunk *)((char *)(x) - (x)->prev_size))
+#define CHUNK_LINK(x) ((struct umalloc_chunk_link *)((x) + 1))
 
 #define GET_INUSE(x) ((x)->size_flags & 0x01)
 #define GET_END(x) ((x)->size_flags & 0x02)
@@ -59,9 +67,120 @@
 #define FG_BIG 0x04
 
 #define ALLOC_CHUNK_SIZE (2 << 17)
-#define ALLOC_SIZE_MAX (1 << 17)
+#define ALLOC_SIZE_MAX UMALLOC_BIG_SIZE
+
+/* aligned big chunk: prev_size is the offset to the node chunk */
+#define BIG_CHUNK(x) \
+	((struct umalloc_chunk *)((char *)(x) - (x)->prev_size))
+
+#define BIN_SMALL_NUM 64
+#define BIN_SMALL_MAX (BIN_SMALL_NUM << 4)
 /* end */
 
+/* @func: _umalloc_bin_index (static)
+ * #desc:
+ *    bin index of the chunk size.
+ *
+ * #1: chunk size
+ * #r: bin index
+ */
+static uint32_t _umalloc_bin_index(uint32_t size)
+{
+	if (size <= BIN_SMALL_MAX)
+		return (size >> 4) - 1;
+
+	uint32_t b = 31 - __builtin_clz(size);
+	uint32_t k = BIN_SMALL_NUM + ((b - 10) << 2)
+		+ ((size >> (b - 2)) & 3);
+
+	return (k < UMALLOC_BIN_NUM) ? k : (UMALLOC_BIN_NUM - 1);
+}
+
+/* @func: _umalloc_bin_insert (static)
+ * #desc:
+ *    insert free chunk into the bin.
+ *
+ * #1: umalloc context struct
+ * #2: chunk pointer
+ */
+static void _umalloc_bin_insert(struct umalloc_ctx *ctx,
+		struct umalloc_chunk *chunk)
+{
+	uint32_t k = _umalloc_bin_index(GET_SIZE(chunk));
+	struct umalloc_chunk_link *link = CHUNK_LINK(chunk);
+
+	link->prev = NULL;
+	link->next = ctx->bin[k];
+	if (link->next)
+		CHUNK_LINK(link->next)->prev = chunk;
+
+	ctx->bin[k] = chunk;
+	ctx->bin_map[k >> 5] |= 1U << (k & 31);
+}
+
+/* @func: _umalloc_bin_remove (static)
+ * #desc:
+ *    remove free chunk from the bin.
+ *
+ * #1: umalloc context struct
+ * #2: chunk pointer
+ */
+static void _umalloc_bin_remove(struct umalloc_ctx *ctx,
+		struct umalloc_chunk *chunk)
+{
+	uint32_t k = _umalloc_bin_index(GET_SIZE(chunk));
+	struct umalloc_chunk_link *link = CHUNK_LINK(chunk);
+
+	if (link->prev) {
+		CHUNK_LINK(link->prev)->next = link->next;
+	} else {
+		ctx->bin[k] = link->next;
+		if (!link->next)
+			ctx->bin_map[k >> 5] &= ~(1U << (k & 31));
+	}
+	if (link->next)
+		CHUNK_LINK(link->next)->prev = link->prev;
+
+	if (ctx->idle == chunk)
+		ctx->idle = NULL;
+}
+
+/* @func: _umalloc_bin_search (static)
+ * #desc:
+ *    search the free chunk of bins.
+ *
+ * #1: umalloc context struct
+ * #2: chunk size
+ * #r: chunk pointer / NULL pointer
+ */
+static struct umalloc_chunk *_umalloc_bin_search(struct umalloc_ctx *ctx,
+		uint32_t size)
+{
+	uint32_t k = _umalloc_bin_index(size);
+
+	/* first-fit in the log-spaced bin */
+	if (k >= BIN_SMALL_NUM) {
+		for (struct umalloc_chunk *pos = ctx->bin[k];
+				pos;
+				pos = CHUNK_LINK(pos)->next) {
+			if (GET_SIZE(pos) >= size)
+				return pos;
+		}
+		k++;
+	}
+
+	/* any chunk of the next non-empty bin */
+	for (uint32_t i = k >> 5; i < UMALLOC_BIN_MAP; i++) {
+		uint32_t m = ctx->bin_map[i];
+		if (i == (k >> 5))
+			m &= ~0U << (k & 31);
+		if (m)
+			return ctx->bin[(i << 5) + __builtin_ctz(m)];
+	}
+
+	return NULL;
+}
+
 /* @func: _umalloc_new_node (static)
  * #desc:
  *    allocate a memory chunk.
@@ -82,7 +201,6 @@ static void *_umalloc_new_node(struct umalloc_ctx *ctx, uint32_t size)
 	node->chunk.size_flags = SET_SIZE(size - CHUNK_NODE_SIZE) | FG_END;
 
 	F_SYMBOL(list_add)(&ctx->chunk, &node->list);
-	ctx->idle = &node->chunk;
 
 	return node;
 }
@@ -112,118 +230,132 @@ static void *_umalloc_new_big_node(struct umalloc_ctx *ctx, size_t size)
 	return node;
 }
 
-/* @func: _umalloc_chunk_merge (static)
+/* @func: _umalloc_chunk_free (static)
  * #desc:
- *    merge unused chunk backward.
+ *    coalesce unused chunk with the free neighbours into the bins.
  *
- * #1: chunk pointer
+ * #1: umalloc context struct
+ * #2: chunk pointer
  */
-static void _umalloc_chunk_merge(struct umalloc_chunk *chunk)
+static void _umalloc_chunk_free(struct umalloc_ctx *ctx,
+		struct umalloc_chunk *chunk)
 {
-	struct umalloc_chunk *next = NULL;
-	uint32_t size = 0;
-
-	for (struct umalloc_chunk *pos = chunk;
-			!GET_INUSE(pos);
-			pos = NEXT_CHUNK(pos)) {
-		size += GET_SIZE(pos);
-		if (GET_END(pos)) {
-			next = NULL;
-			break;
+	struct umalloc_chunk_node *node;
+	struct umalloc_chunk *next, *prev;
+
+	if (!GET_END(chunk)) {
+		next = NEXT_CHUNK(chunk);
+		if (!GET_INUSE(next)) {
+			_umalloc_bin_remove(ctx, next);
+			chunk->size_flags = SET_SIZE(GET_SIZE(chunk)
+				+ GET_SIZE(next)) | GET_END(next);
+		}
+	}
+	if (chunk->prev_size) {
+		prev = PREV_CHUNK(chunk);
+		if (!GET_INUSE(prev)) {
+			_umalloc_bin_remove(ctx, prev);
+			prev->size_flags = SET_SIZE(GET_SIZE(prev)
+				+ GET_SIZE(chunk)) | GET_END(chunk);
+			chunk = prev;
 		}
-		next = NEXT_CHUNK(pos);
 	}
-	if (!size)
+	if (!GET_END(chunk))
+		NEXT_CHUNK(chunk)->prev_size = GET_SIZE(chunk);
+
+	/* keep one empty node, release the others */
+	if (!chunk->prev_size && GET_END(chunk)) {
+		if (ctx->idle) {
+			node = container_of(chunk,
+				struct umalloc_chunk_node, chunk);
+			F_SYMBOL(list_del)(&ctx->chunk, &node->list);
+			ctx->call_free(node, node->size, ctx->arg);
+			return;
+		}
+		_umalloc_bin_insert(ctx, chunk);
+		ctx->idle = chunk;
 		return;
+	}
 
-	chunk->size_flags = SET_SIZE(size) | (next ? 0 : FG_END);
-	if (next)
-		next->prev_size = size;
+	_umalloc_bin_insert(ctx, chunk);
 }
 
-/* @func: _umalloc_prev (static)
+/* @func: _umalloc_chunk_split (static)
  * #desc:
- *    forward offset unused chunk.
+ *    split the tail of chunk back into the bins.
  *
- * #1: chunk pointer
- * #r: chunk pointer
+ * #1: umalloc context struct
+ * #2: chunk pointer
+ * #3: chunk size
  */
-static void *_umalloc_prev(struct umalloc_chunk *chunk)
+static void _umalloc_chunk_split(struct umalloc_ctx *ctx,
+		struct umalloc_chunk *chunk, uint32_t size)
 {
-	if (!chunk->prev_size)
-		return chunk;
-
-	for (struct umalloc_chunk *pos = PREV_CHUNK(chunk);
-			!GET_INUSE(pos);
-			pos = PREV_CHUNK(pos)) {
-		chunk = pos;
-		if (!chunk->prev_size)
-			break;
-	}
+	uint32_t psize = GET_SIZE(chunk), pend = GET_END(chunk);
+	if (psize < (size + CHUNK_MIN_SIZE))
+		return;
+
+	chunk->size_flags = SET_SIZE(size) | GET_INUSE(chunk);
+
+	struct umalloc_chunk *next = NEXT_CHUNK(chunk);
+	next->prev_size = size;
+	next->size_flags = SET_SIZE(psize - size) | pend;
+	if (!pend) /* cur -> next -> next */
+		NEXT_CHUNK(next)->prev_size = psize - size;
 
-	return chunk;
+	_umalloc_chunk_free(ctx, next);
 }
 
-/* @func: _umalloc_chunk (static)
+/* @func: _umalloc_free_node (static)
  * #desc:
- *    allocate memory chunk.
+ *    free the node of big chunk.
  *
  * #1: umalloc context struct
  * #2: chunk pointer
- * #3: allocate size
- * #r: allocated chunk pointer
  */
-static void *_umalloc_chunk(struct umalloc_ctx *ctx,
-		struct umalloc_chunk *chunk, uint32_t size)
+static void _umalloc_free_node(struct umalloc_ctx *ctx,
+		struct umalloc_chunk *chunk)
 {
-	size = CHUNK_ALIGNED_SIZE(size);
-	struct umalloc_chunk *next = NULL;
-
-	for (struct umalloc_chunk *pos = chunk;
-			pos;
-			pos = NEXT_CHUNK(pos)) {
-		if (GET_INUSE(pos)) {
-			if (GET_END(pos))
-				return NULL;
-			continue;
-		}
+	struct umalloc_chunk_node *node = container_of(BIG_CHUNK(chunk),
+		struct umalloc_chunk_node, chunk);
 
-		_umalloc_chunk_merge(pos);
-		uint32_t psize = GET_SIZE(pos), pend = GET_END(pos);
-		if (psize < size) {
-			if (pend)
-				return NULL;
-			continue;
-		}
+	F_SYMBOL(list_del)(&ctx->chunk, &node->list);
+	ctx->call_free(node, node->size, ctx->arg);
+}
 
-		ctx->idle = NULL;
-		if (psize == size) {
-			pos->size_flags |= FG_INUSE;
-			return pos;
-		}
-		if (psize >= (size + CHUNK_ALIGNED_SIZE(8))) {
-			pos->size_flags = SET_SIZE(size) | FG_INUSE;
-
-			next = NEXT_CHUNK(pos);
-			next->prev_size = size;
-			next->size_flags = SET_SIZE(psize - size);
-			ctx->idle = next;
-
-			if (pend) { /* pos | cur -> next */
-				next->size_flags |= FG_END;
-			} else { /* pos | cur -> next -> next */
-				next = NEXT_CHUNK(next);
-				next->prev_size = SET_SIZE(psize - size);
-			}
+/* @func: _umalloc_realloc_big (static)
+ * #desc:
+ *    resize the node of big chunk (no copy).
+ *
+ * #1: umalloc context struct
+ * #2: chunk pointer
+ * #3: allocate size
+ * #r: allocated pointer / NULL pointer
+ */
+static void *_umalloc_realloc_big(struct umalloc_ctx *ctx,
+		struct umalloc_chunk *chunk, size_t size)
+{
+	struct umalloc_chunk_node *node = container_of(chunk,
+		struct umalloc_chunk_node, chunk);
 
-			return pos;
-		}
+	F_SYMBOL(list_del)(&ctx->chunk, &node->list);
 
-		pos->size_flags |= FG_INUSE;
-		return pos;
+	size += CHUNK_NODE_SIZE;
+	struct umalloc_chunk_node *_new = ctx->call_realloc(node,
+		node->size, size, ctx->arg);
+	if (!_new) {
+		F_SYMBOL(list_add)(&ctx->chunk, &node->list);
+		return NULL;
 	}
 
-	return NULL;
+	_new->size = size;
+	_new->chunk.size_flags = SET_SIZE(size - CHUNK_NODE_SIZE) | FG_INUSE
+		| FG_END | FG_BIG;
+
+	F_SYMBOL(list_add)(&ctx->chunk, &_new->list);
+
+	chunk = &_new->chunk;
+	return ++chunk;
 }
 
 /* @func: ___umalloc
@@ -245,31 +377,25 @@ void *C_SYMBOL(___umalloc)(struct umalloc_ctx *ctx, size_t size)
 			return NULL;
 		chunk = &node->chunk;
 		return ++chunk;
-	} else if (!size) {
-		size = 1;
+	} else if (size < CHUNK_LINK_SIZE) {
+		size = CHUNK_LINK_SIZE;
 	}
+	size = CHUNK_ALIGNED_SIZE(size);
 
-	LIST_FOR_EACH(ctx->chunk.node, pos) {
-		node = container_of(pos, struct umalloc_chunk_node, list);
+	chunk = _umalloc_bin_search(ctx, size);
+	if (chunk) {
+		_umalloc_bin_remove(ctx, chunk);
+	} else {
+		node = _umalloc_new_node(ctx, ALLOC_CHUNK_SIZE);
+		if (!node)
+			return NULL;
 		chunk = &node->chunk;
-		if (GET_BIG(chunk))
-			continue;
-		if (ctx->idle)
-			chunk = ctx->idle;
-
-		chunk = _umalloc_chunk(ctx, chunk, size);
-		if (chunk)
-			return ++chunk;
-		if (ctx->idle)
-			break;
 	}
 
-	node = _umalloc_new_node(ctx, ALLOC_CHUNK_SIZE);
-	if (!node)
-		return NULL;
-	chunk = _umalloc_chunk(ctx, &node->chunk, size);
+	chunk->size_flags |= FG_INUSE;
+	_umalloc_chunk_split(ctx, chunk, size);
 
-	return chunk ? ++chunk : NULL;
+	return ++chunk;
 }
 
 /* @func: ___ufree
@@ -282,7 +408,6 @@ void *C_SYMBOL(___umalloc)(struct umalloc_ctx *ctx, size_t size)
  */
 int32_t C_SYMBOL(___ufree)(struct umalloc_ctx *ctx, void *p)
 {
-	struct umalloc_chunk_node *node;
 	struct umalloc_chunk *chunk = p;
 
 	chunk--;
@@ -290,22 +415,12 @@ int32_t C_SYMBOL(___ufree)(struct umalloc_ctx *ctx, void *p)
 		return -1;
 
 	if (GET_BIG(chunk)) {
-		node = container_of(chunk, struct umalloc_chunk_node, chunk);
-		F_SYMBOL(list_del)(&ctx->chunk, &node->list);
-		ctx->call_free(node, node->size, ctx->arg);
+		_umalloc_free_node(ctx, chunk);
 		return 0;
 	}
 
 	chunk->size_flags &= ~FG_INUSE;
-	chunk = _umalloc_prev(chunk);
-	_umalloc_chunk_merge(chunk);
-
-	ctx->idle = NULL;
-	if (!chunk->prev_size && GET_END(chunk)) {
-		node = container_of(chunk, struct umalloc_chunk_node, chunk);
-		F_SYMBOL(list_del)(&ctx->chunk, &node->list);
-		ctx->call_free(node, node->size, ctx->arg);
-	}
+	_umalloc_chunk_free(ctx, chunk);
 
 	return 0;
 }
@@ -328,4 +443,160 @@ void C_SYMBOL(___ufree_all)(struct umalloc_ctx *ctx)
 			break;
 		}
 	}
+
+	ctx->idle = NULL;
+	for (uint32_t i = 0; i < UMALLOC_BIN_NUM; i++)
+		ctx->bin[i] = NULL;
+	for (uint32_t i = 0; i < UMALLOC_BIN_MAP; i++)
+		ctx->bin_map[i] = 0;
+}
+
+/* @func: ___umalloc_align
+ * #desc:
+ *    aligned memory allocator.
+ *
+ * #1: umalloc context struct
+ * #2: alignment (power of two)
+ * #3: allocate size
+ * #r: allocated pointer
+ */
+void *C_SYMBOL(___umalloc_align)(struct umalloc_ctx *ctx, size_t align,
+		size_t size)
+{
+	struct umalloc_chunk_node *node;
+	struct umalloc_chunk *chunk, *_new;
+	uintptr_t p, a;
+
+	if (align <= 16)
+		return C_SYMBOL(___umalloc)(ctx, size);
+	if (size > ((size_t)-1 - align - CHUNK_MIN_SIZE))
+		return NULL;
+
+	if ((size + align + CHUNK_MIN_SIZE) >= ALLOC_SIZE_MAX) { /* big */
+		node = _umalloc_new_big_node(ctx, size + align);
+		if (!node)
+			return NULL;
+		chunk = &node->chunk;
+		p = (uintptr_t)(chunk + 1);
+		a = (p + align - 1) & ~(uintptr_t)(align - 1);
+		if (a == p)
+			return (void *)p;
+
+		_new = (struct umalloc_chunk *)a - 1;
+		_new->prev_size = (char *)_new - (char *)chunk;
+		_new->size_flags = chunk->size_flags;
+		return (void *)a;
+	}
+
+	p = (uintptr_t)C_SYMBOL(___umalloc)(ctx, size + align + CHUNK_MIN_SIZE);
+	if (!p)
+		return NULL;
+	chunk = (struct umalloc_chunk *)p - 1;
+
+	a = (p + align - 1) & ~(uintptr_t)(align - 1);
+	if (a != p) {
+		/* the leading gap becomes a free chunk */
+		if ((a - p) < CHUNK_MIN_SIZE)
+			a += align;
+		uint32_t gap = a - p;
+		uint32_t csize = GET_SIZE(chunk), cend = GET_END(chunk);
+
+		_new = (struct umalloc_chunk *)a - 1;
+		_new->prev_size = gap;
+		_new->size_flags = SET_SIZE(csize - gap) | cend | FG_INUSE;
+		if (!cend)
+			NEXT_CHUNK(_new)->prev_size = csize - gap;
+
+		chunk->size_flags = SET_SIZE(gap);
+		_umalloc_chunk_free(ctx, chunk);
+		chunk = _new;
+	}
+
+	if (size < CHUNK_LINK_SIZE)
+		size = CHUNK_LINK_SIZE;
+	_umalloc_chunk_split(ctx, chunk, CHUNK_ALIGNED_SIZE(size));
+
+	return (void *)a;
+}
+
+/* @func: ___urealloc
+ * #desc:
+ *    memory reallocator (grows in place when possible).
+ *
+ * #1: umalloc context struct
+ * #2: allocated pointer / NULL pointer
+ * #3: allocate size
+ * #r: allocated pointer (NULL: the old pointer is unchanged)
+ */
+void *C_SYMBOL(___urealloc)(struct umalloc_ctx *ctx, void *p, size_t size)
+{
+	struct umalloc_chunk *chunk = p, *next;
+	void *_new;
+
+	if (!p)
+		return C_SYMBOL(___umalloc)(ctx, size);
+
+	chunk--;
+	if (GET_BIG(chunk)) {
+		if (size >= ALLOC_SIZE_MAX && !chunk->prev_size
+				&& ctx->call_realloc)
+			return _umalloc_realloc_big(ctx, chunk, size);
+	} else if (size < ALLOC_SIZE_MAX) {
+		uint32_t nsize = CHUNK_ALIGNED_SIZE((size < CHUNK_LINK_SIZE)
+			? CHUNK_LINK_SIZE : size);
+		uint32_t csize = GET_SIZE(chunk);
+
+		/* absorb the free neighbour */
+		if (nsize > csize && !GET_END(chunk)) {
+			next = NEXT_CHUNK(chunk);
+			if (!GET_INUSE(next)
+					&& (csize + GET_SIZE(next)) >= nsize) {
+				_umalloc_bin_remove(ctx, next);
+				chunk->size_flags = SET_SIZE(csize
+					+ GET_SIZE(next)) | GET_END(next)
+					| FG_INUSE;
+				if (!GET_END(chunk))
+					NEXT_CHUNK(chunk)->prev_size =
+						GET_SIZE(chunk);
+				csize = GET_SIZE(chunk);
+			}
+		}
+
+		if (nsize <= csize) {
+			_umalloc_chunk_split(ctx, chunk, nsize);
+			return p;
+		}
+	}
+
+	_new = C_SYMBOL(___umalloc)(ctx, size);
+	if (!_new)
+		return NULL;
+
+	size_t n = C_SYMBOL(___umalloc_usable)(p);
+	C_SYMBOL(memcpy)(_new, p, (n < size) ? n : size);
+	C_SYMBOL(___ufree)(ctx, p);
+
+	return _new;
+}
+
+/* @func: ___umalloc_usable
+ * #desc:
+ *    usable size of the allocated memory.
+ *
+ * #1: allocated pointer
+ * #r: usable size
+ */
+size_t C_SYMBOL(___umalloc_usable)(void *p)
+{
+	struct umalloc_chunk_node *node;
+	struct umalloc_chunk *chunk = p;
+
+	chunk--;
+	if (GET_BIG(chunk)) {
+		node = container_of(BIG_CHUNK(chunk),
+			struct umalloc_chunk_node, chunk);
+		return node->size - ((char *)p - (char *)node);
+	}
+
+	return GET_SIZE(chunk) - CHUNK_SIZE;
 }
@@ -0,0 +1,108 @@
+/* @file: unistd_truncate.c
+ * #desc:
+ *    The implementations of unix standard functions.
+ *
+ * #copy:
+ *    Copyright (C) 1970 Public Free Software
+ *
+ *    This library is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 2.1 of the License, or (at your option) any later version.
+ *
+ *    This library is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with this library; if not,
+ *    see <https://www.gnu.org/licenses/>.
+ */
+
+#include <demoz/config.h>
+#include <demoz/c/stdint.h>
+#include <demoz/c/errno.h>
+#include <demoz/c/sys/types.h>
+#include <demoz/c/sys/unistd.h>
+#include <demoz/c/sys/syscall.h>
+
+
+/* @func: ftruncate
+ * #desc:
+ *    set the file length.
+ *
+ * #1: file descriptor
+ * #2: file length
+ * #r: 0: no error, -1: errno
+ */
+int32_t C_SYMBOL(ftruncate)(int32_t fd, x_off_t len)
+{
+#if (DEMOZ_PLATFORM == DEMOZ_PLATFORM_LINUX)
+
+	int32_t ret = 0;
+
+#if (DEMOZ_MARCH_BITS == DEMOZ_MARCH_32)
+
+	/* 64-bit length in two words, low word first */
+#	if (DEMOZ_MARCH_TYPE == DEMOZ_MARCH_ARM_32)
+	/* arm eabi: the pair starts on an even register */
+	ret = C_SYMBOL(syscall_linux)(
+		XSYSCALL_ftruncate64,
+		fd,
+		0,
+		(long)(uint32_t)len,
+		(long)(uint32_t)(len >> 32));
+#	else
+	ret = C_SYMBOL(syscall_linux)(
+		XSYSCALL_ftruncate64,
+		fd,
+		(long)(uint32_t)len,
+		(long)(uint32_t)(len >> 32));
+#	endif
+
+#elif (DEMOZ_MARCH_BITS == DEMOZ_MARCH_64)
+
+	ret = C_SYMBOL(syscall_linux)(
+		XSYSCALL_ftruncate,
+		fd,
+		len);
+
+#else
+#	error "!!!unknown DEMOZ_MARCH_BITS!!!"
+#endif
+
+	if (ret < 0) {
+		/* errno */
+		switch (ret) {
+			case -EBADF:
+				x_errno = X_EBADF;
+				break;
+			case -EFBIG:
+				x_errno = X_EFBIG;
+				break;
+			case -EINTR:
+				x_errno = X_EINTR;
+				break;
+			case -EINVAL:
+				x_errno = X_EINVAL;
+				break;
+			case -EIO:
+				x_errno = X_EIO;
+				break;
+			case -EPERM:
+				x_errno = X_EPERM;
+				break;
+			default:
+				x_errno = X_EUNKNOWN;
+				break;
+		}
+		return -1;
+	}
+
+	return ret;
+
+#else
+#	error "!!!unknown DEMOZ_PLATFORM!!!"
+#endif
+}
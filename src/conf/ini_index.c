@@ -0,0 +1,834 @@
+/* @file: ini_index.c
+ * #desc:
+ *    The implementations of compiled ini (initial configuration) index.
+ *
+ * #copy:
+ *    Copyright (C) 1970 Public Free Software
+ *
+ *    This library is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 2.1 of the License, or (at your option) any later version.
+ *
+ *    This library is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with this library; if not,
+ *    see <https://www.gnu.org/licenses/>.
+ */
+
+#include <demoz/config.h>
+#include <demoz/c/stddef.h>
+#include <demoz/c/stdint.h>
+#include <demoz/c/stdlib.h>
+#include <demoz/c/string.h>
+#include <demoz/ds/arena.h>
+#include <demoz/ds/swissmap.h>
+#include <demoz/conf/ini_parse.h>
+#include <demoz/conf/ini_index.h>
+
+
+/* @def: _ */
+/* swissmap search key (the buckets only hold image offsets) */
+struct _ini_key {
+	const char *base;
+	const char *name;
+	uint32_t len;
+	uint32_t sec;
+};
+
+/* load time string interning */
+struct _ini_str {
+	const char *s;
+	uint32_t len;
+	uint32_t off;
+};
+
+/* 64-bit layout arithmetic (size_t may be 32-bit) */
+#define IMAGE_ALIGN(x) (((uint64_t)(x) + 15) & ~(uint64_t)15)
+/* about 7/8 load, at least one free slot (SWISSMAP_ALIGN) */
+#define TABLE_TOTAL(n) ((uint64_t)1 << (64 - __builtin_clzll( \
+	((uint64_t)(n) + (n) / 7) | (SWISSMAP_WIDTH - 1))))
+
+#define DURATION_S 1000000000LL
+/* end */
+
+/* @func: _ini_hash (static)
+ * #desc:
+ *    string hash (fnv-1a and a 64-bit finalizer), the hash is part
+ *    of the image layout and must not depend on the process.
+ *
+ * #1: s    [in]  input string
+ * #2: len  [in]  string length
+ * #3: seed [in]  hash seed
+ * #r:      [ret] hash value
+ */
+static uint64_t _ini_hash(const char *s, size_t len, uint64_t seed)
+{
+	uint64_t h = 0xcbf29ce484222325ULL ^ (seed * 0x9e3779b97f4a7c15ULL);
+	for (size_t i = 0; i < len; i++) {
+		h ^= (uint8_t)s[i];
+		h *= 0x100000001b3ULL;
+	}
+
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdULL;
+	h ^= h >> 33;
+	h *= 0xc4ceb9fe1a85ec53ULL;
+	h ^= h >> 33;
+
+	return h;
+}
+
+/* @func: _ini_sec_hash (static)
+ * #desc:
+ *    section table hash callback.
+ *
+ * #1: key [in]  search key
+ * #2: len [in]  key size
+ * #r:     [ret] hash value
+ */
+static uint64_t _ini_sec_hash(const void *key, size_t len)
+{
+	const struct _ini_key *k = key;
+	(void)len;
+
+	return _ini_hash(k->name, k->len, 0);
+}
+
+/* @func: _ini_sec_cmp (static)
+ * #desc:
+ *    section table compare callback.
+ *
+ * #1: bucket [in]  section bucket
+ * #2: key    [in]  search key
+ * #3: len    [in]  key size
+ * #r:        [ret] 0: equal, 1: not equal
+ */
+static int32_t _ini_sec_cmp(void *bucket, const void *key, size_t len)
+{
+	const struct ini_index_sec *b = bucket;
+	const struct _ini_key *k = key;
+	(void)len;
+
+	return b->len != k->len
+		|| C_SYMBOL(memcmp)(k->base + b->name, k->name, k->len);
+}
+
+/* @func: _ini_key_hash (static)
+ * #desc:
+ *    key table hash callback (section slot and key name).
+ *
+ * #1: key [in]  search key
+ * #2: len [in]  key size
+ * #r:     [ret] hash value
+ */
+static uint64_t _ini_key_hash(const void *key, size_t len)
+{
+	const struct _ini_key *k = key;
+	(void)len;
+
+	return _ini_hash(k->name, k->len, (uint64_t)k->sec + 1);
+}
+
+/* @func: _ini_key_cmp (static)
+ * #desc:
+ *    key table compare callback.
+ *
+ * #1: bucket [in]  key bucket
+ * #2: key    [in]  search key
+ * #3: len    [in]  key size
+ * #r:        [ret] 0: equal, 1: not equal
+ */
+static int32_t _ini_key_cmp(void *bucket, const void *key, size_t len)
+{
+	const struct ini_index_key *b = bucket;
+	const struct _ini_key *k = key;
+	(void)len;
+
+	return b->sec != k->sec || b->len != k->len
+		|| C_SYMBOL(memcmp)(k->base + b->name, k->name, k->len);
+}
+
+/* @func: _ini_str_hash (static)
+ * #desc:
+ *    interning table hash callback.
+ *
+ * #1: key [in]  input string
+ * #2: len [in]  string length
+ * #r:     [ret] hash value
+ */
+static uint64_t _ini_str_hash(const void *key, size_t len)
+{
+	return _ini_hash(key, len, 0);
+}
+
+/* @func: _ini_str_cmp (static)
+ * #desc:
+ *    interning table compare callback.
+ *
+ * #1: bucket [in]  string bucket
+ * #2: key    [in]  input string
+ * #3: len    [in]  string length
+ * #r:        [ret] 0: equal, 1: not equal
+ */
+static int32_t _ini_str_cmp(void *bucket, const void *key, size_t len)
+{
+	const struct _ini_str *b = bucket;
+
+	return b->len != len || C_SYMBOL(memcmp)(b->s, key, len);
+}
+
+/* @func: _ini_call (static)
+ * #desc:
+ *    ini_parse callback, the events are recorded (the arena array
+ *    doubles when full) and compiled after the parse.
+ *
+ * #1: type [in]     event type
+ * #2: s    [in]     event string
+ * #3: len  [in]     string length
+ * #4: arg  [in/out] ini index context
+ * #r:      [ret]    0: no error, -1: out of memory
+ */
+static int32_t _ini_call(int32_t type, const char *s, int32_t len, void *arg)
+{
+	struct ini_index *idx = arg;
+	struct ini_index_event *ev;
+
+	if (idx->ev_len == idx->ev_max) {
+		if (idx->ev_max > 0x3fffffff) { /* INT32_MAX */
+			idx->err = INI_INDEX_ERR_SIZE;
+			return -1;
+		}
+		ev = F_SYMBOL(arena_alloc)(idx->arena, (size_t)idx->ev_max * 2
+			* sizeof(struct ini_index_event));
+		if (!ev) {
+			idx->err = INI_INDEX_ERR_ALLOC;
+			return -1;
+		}
+		C_SYMBOL(memcpy)(ev, idx->ev, (size_t)idx->ev_len
+			* sizeof(struct ini_index_event));
+		idx->ev = ev;
+		idx->ev_max *= 2;
+	}
+
+	ev = &idx->ev[idx->ev_len++];
+	ev->s = s;
+	ev->len = len;
+	ev->type = type;
+
+	return 0;
+}
+
+/* @func: _ini_attach (static)
+ * #desc:
+ *    set the swissmap heads over the image tables.
+ *
+ * #1: idx  [out] ini index context
+ * #2: base [in]  image
+ */
+static void _ini_attach(struct ini_index *idx, const char *base)
+{
+	const struct ini_index_head *h = (const struct ini_index_head *)base;
+
+	idx->base = base;
+	/* lookups never write the tables */
+	SWISSMAP_INIT(&idx->sec, (union swissmap_group *)(base + h->sec_ctrl),
+		(void *)(base + h->sec_array), sizeof(struct ini_index_sec),
+		h->sec_total, _ini_sec_hash, _ini_sec_cmp);
+	SWISSMAP_INIT(&idx->key, (union swissmap_group *)(base + h->key_ctrl),
+		(void *)(base + h->key_array), sizeof(struct ini_index_key),
+		h->key_total, _ini_key_hash, _ini_key_cmp);
+	idx->sec.size = h->sec_num;
+	idx->key.size = h->key_num;
+}
+
+/* @func: _ini_intern (static)
+ * #desc:
+ *    copy the string to the pool once.
+ *
+ * #1: str  [in/out] interning table
+ * #2: base [in/out] image
+ * #3: pos  [in/out] pool end (image offset)
+ * #4: s    [in]     input string
+ * #5: len  [in]     string length
+ * #r:      [ret]    image offset
+ */
+static uint32_t _ini_intern(struct swissmap_head *str, char *base,
+		uint32_t *pos, const char *s, uint32_t len)
+{
+	size_t n = SWISSMAP_SIZE(str);
+	struct _ini_str *b = F_SYMBOL(swissmap_insert)(str, s, len);
+
+	if (SWISSMAP_SIZE(str) != n) {
+		b->s = base + *pos;
+		b->len = len;
+		b->off = *pos;
+		C_SYMBOL(memcpy)(base + *pos, s, len);
+		base[*pos + len] = '\0';
+		*pos += len + 1;
+	}
+
+	return b->off;
+}
+
+/* @func: _ini_compile (static)
+ * #desc:
+ *    build the image from the recorded events.
+ *
+ * #1: idx [in/out] ini index context
+ * #r:     [ret]    0: no error, -1: error (idx->err)
+ */
+static int32_t _ini_compile(struct ini_index *idx)
+{
+	struct ini_index_head *h;
+	struct ini_index_sec *sec;
+	struct ini_index_key *key = NULL;
+	struct arena_mark mark;
+	struct _ini_key k;
+	uint64_t nsec = 1, nkey = 0, pool = 1, size;
+	char *base;
+
+	/* no wrap: less than 2^31 events of less than 2^31 bytes */
+	for (int32_t i = 0; i < idx->ev_len; i++) {
+		nsec += idx->ev[i].type == INI_SECTION_TYPE;
+		nkey += idx->ev[i].type == INI_KEY_TYPE;
+		pool += (uint64_t)idx->ev[i].len + 1;
+	}
+
+	uint64_t sec_total = TABLE_TOTAL(nsec), key_total = TABLE_TOTAL(nkey);
+	uint64_t sec_ctrl = IMAGE_ALIGN(sizeof(struct ini_index_head));
+	uint64_t sec_array = sec_ctrl + sec_total;
+	uint64_t key_ctrl = IMAGE_ALIGN(sec_array
+		+ sec_total * sizeof(struct ini_index_sec));
+	uint64_t key_array = key_ctrl + key_total;
+	uint64_t str = key_array + key_total * sizeof(struct ini_index_key);
+	size = str + pool;
+	/* the image offsets are 32-bit */
+	if (size > UINT32_MAX) {
+		idx->err = INI_INDEX_ERR_SIZE;
+		return -1;
+	}
+
+	base = F_SYMBOL(arena_alloc_align)(idx->arena, (size_t)size,
+		INI_INDEX_ALIGN);
+	if (!base) {
+		idx->err = INI_INDEX_ERR_ALLOC;
+		return -1;
+	}
+
+	h = (struct ini_index_head *)base;
+	C_SYMBOL(memset)(h, 0, sizeof(struct ini_index_head));
+	h->magic = INI_INDEX_MAGIC;
+	h->version = INI_INDEX_VERSION;
+	h->width = SWISSMAP_WIDTH;
+	h->sec_total = (uint32_t)sec_total;
+	h->key_total = (uint32_t)key_total;
+	h->sec_ctrl = (uint32_t)sec_ctrl;
+	h->sec_array = (uint32_t)sec_array;
+	h->key_ctrl = (uint32_t)key_ctrl;
+	h->key_array = (uint32_t)key_array;
+	h->pool = (uint32_t)str;
+	_ini_attach(idx, base);
+	F_SYMBOL(swissmap_empty)(&idx->sec);
+	F_SYMBOL(swissmap_empty)(&idx->key);
+
+	/* the interning table is dropped after the build */
+	F_SYMBOL(arena_mark)(idx->arena, &mark);
+	uint64_t n = TABLE_TOTAL((uint64_t)idx->ev_len + 1);
+	union swissmap_group *ctrl = NULL;
+	void *array = NULL;
+	if (n <= SIZE_MAX / sizeof(struct _ini_str)) {
+		ctrl = F_SYMBOL(arena_alloc_align)(idx->arena, (size_t)n, 16);
+		array = F_SYMBOL(arena_alloc)(idx->arena,
+			(size_t)n * sizeof(struct _ini_str));
+	}
+	if (!ctrl || !array) {
+		F_SYMBOL(arena_reset)(idx->arena, &mark);
+		idx->base = NULL;
+		idx->err = INI_INDEX_ERR_ALLOC;
+		return -1;
+	}
+	SWISSMAP_NEW(strs, ctrl, array, sizeof(struct _ini_str), (size_t)n,
+		_ini_str_hash, _ini_str_cmp);
+	F_SYMBOL(swissmap_empty)(&strs);
+
+	uint32_t pos = (uint32_t)str, cur;
+	k.base = base;
+	k.name = "";
+	k.len = 0;
+	sec = F_SYMBOL(swissmap_insert)(&idx->sec, &k, sizeof(k));
+	sec->name = _ini_intern(&strs, base, &pos, "", 0);
+	sec->len = 0;
+	cur = (uint32_t)(((char *)sec - (char *)idx->sec.array)
+		/ sizeof(struct ini_index_sec));
+
+	for (int32_t i = 0; i < idx->ev_len; i++) {
+		const char *s = idx->ev[i].s;
+		uint32_t len = (uint32_t)idx->ev[i].len;
+		size_t m;
+
+		switch (idx->ev[i].type) {
+			case INI_SECTION_TYPE:
+				k.name = s;
+				k.len = len;
+				m = SWISSMAP_SIZE(&idx->sec);
+				sec = F_SYMBOL(swissmap_insert)(&idx->sec,
+					&k, sizeof(k));
+				if (SWISSMAP_SIZE(&idx->sec) != m) {
+					sec->name = _ini_intern(&strs, base,
+						&pos, s, len);
+					sec->len = len;
+				}
+				cur = (uint32_t)(((char *)sec
+					- (char *)idx->sec.array)
+					/ sizeof(struct ini_index_sec));
+				key = NULL;
+				break;
+			case INI_KEY_TYPE:
+				k.name = s;
+				k.len = len;
+				k.sec = cur;
+				m = SWISSMAP_SIZE(&idx->key);
+				key = F_SYMBOL(swissmap_insert)(&idx->key,
+					&k, sizeof(k));
+				if (SWISSMAP_SIZE(&idx->key) != m) {
+					key->sec = cur;
+					key->name = _ini_intern(&strs, base,
+						&pos, s, len);
+					key->len = len;
+				}
+				/* last one wins, no value event: "" */
+				key->value = h->pool;
+				key->value_len = 0;
+				break;
+			case INI_VALUE_TYPE:
+				if (!key)
+					break;
+				/* one pair of double quotes is removed */
+				if (len >= 2 && s[0] == '"'
+						&& s[len - 1] == '"') {
+					s++;
+					len -= 2;
+				}
+				key->value = _ini_intern(&strs, base, &pos,
+					s, len);
+				key->value_len = len;
+				break;
+			default:
+				break;
+		}
+	}
+	F_SYMBOL(arena_reset)(idx->arena, &mark);
+
+	h->sec_num = (uint32_t)SWISSMAP_SIZE(&idx->sec);
+	h->key_num = (uint32_t)SWISSMAP_SIZE(&idx->key);
+	h->size = pos;
+
+	return 0;
+}
+
+/* @func: ini_index_load
+ * #desc:
+ *    parse the ini document and compile the index. the image, the
+ *    copied strings and the load state are allocated from the arena
+ *    (released together), the input buffer is not kept.
+ *
+ * #1: idx   [out] ini index context
+ * #2: arena [in]  arena context
+ * #3: s     [in]  input string
+ * #r:       [ret] 0: no error, -1: error (idx->err)
+ */
+int32_t F_SYMBOL(ini_index_load)(struct ini_index *idx,
+		struct arena_ctx *arena, const char *s)
+{
+	idx->base = NULL;
+	idx->err = 0;
+	idx->arena = arena;
+	idx->ev_len = 0;
+	idx->ev_max = INI_INDEX_EVENT_MIN;
+	idx->ev = F_SYMBOL(arena_alloc)(arena, (size_t)idx->ev_max
+		* sizeof(struct ini_index_event));
+	if (!idx->ev) {
+		idx->err = INI_INDEX_ERR_ALLOC;
+		return -1;
+	}
+
+	INI_INIT(&idx->ini, _ini_call, NULL, idx);
+	if (F_SYMBOL(ini_parse)(&idx->ini, s)) {
+		if (!idx->err)
+			idx->err = INI_ERR(&idx->ini);
+		return -1;
+	}
+
+	return _ini_compile(idx);
+}
+
+/* @func: _ini_check_str (static)
+ * #desc:
+ *    image string inside the pool and null terminated.
+ *
+ * #1: h   [in]  image header
+ * #2: off [in]  string offset
+ * #3: len [in]  string length
+ * #r:     [ret] 0: valid, -1: invalid
+ */
+static int32_t _ini_check_str(const struct ini_index_head *h, uint32_t off,
+		uint32_t len)
+{
+	if (off < h->pool || (uint64_t)off + len >= h->size)
+		return -1;
+
+	return ((const char *)h)[off + len] ? -1 : 0;
+}
+
+/* @func: _ini_check (static)
+ * #desc:
+ *    check the buckets of the full slots (lookups read their strings
+ *    without bounds).
+ *
+ * #1: h [in]  image header
+ * #r:   [ret] 0: valid, -1: invalid
+ */
+static int32_t _ini_check(const struct ini_index_head *h)
+{
+	const char *base = (const char *)h;
+	const uint8_t *ctrl = (const uint8_t *)base + h->sec_ctrl;
+	const struct ini_index_sec *sec = (const void *)(base + h->sec_array);
+	const struct ini_index_key *key = (const void *)(base + h->key_array);
+
+	/* high bit: empty or deleted slot */
+	for (uint32_t i = 0; i < h->sec_total; i++) {
+		if (!(ctrl[i] & 0x80)
+				&& _ini_check_str(h, sec[i].name, sec[i].len))
+			return -1;
+	}
+
+	ctrl = (const uint8_t *)base + h->key_ctrl;
+	for (uint32_t i = 0; i < h->key_total; i++) {
+		if (ctrl[i] & 0x80)
+			continue;
+		if (key[i].sec >= h->sec_total
+				|| _ini_check_str(h, key[i].name, key[i].len)
+				|| _ini_check_str(h, key[i].value,
+					key[i].value_len))
+			return -1;
+	}
+
+	return 0;
+}
+
+/* @func: ini_index_open
+ * #desc:
+ *    attach the index to an image (ini_index_snapshot output), such
+ *    as a mapped file. the header and every bucket are checked, the
+ *    image is not copied, and must be kept (and 16-byte aligned) while
+ *    the index is used.
+ *
+ * #1: idx  [out] ini index context
+ * #2: buf  [in]  image buffer
+ * #3: size [in]  buffer size
+ * #r:      [ret] 0: no error, -1: error (idx->err)
+ */
+int32_t F_SYMBOL(ini_index_open)(struct ini_index *idx, const void *buf,
+		size_t size)
+{
+	const struct ini_index_head *h = buf;
+
+	idx->base = NULL;
+	idx->err = INI_INDEX_ERR_IMAGE;
+	if ((uintptr_t)buf & 15 || size < sizeof(struct ini_index_head))
+		return -1;
+	if (h->magic != INI_INDEX_MAGIC || h->version != INI_INDEX_VERSION
+			|| h->width != SWISSMAP_WIDTH || h->size > size)
+		return -1;
+
+	/* tables: power of two, in order, inside the image */
+	if (h->sec_total < SWISSMAP_WIDTH || h->key_total < SWISSMAP_WIDTH
+			|| (h->sec_total & (h->sec_total - 1))
+			|| (h->key_total & (h->key_total - 1)))
+		return -1;
+	if (h->sec_ctrl < sizeof(struct ini_index_head) || h->sec_ctrl & 15
+			|| h->key_ctrl & 15
+			|| h->sec_array != (uint64_t)h->sec_ctrl + h->sec_total
+			|| h->key_ctrl < (uint64_t)h->sec_array + h->sec_total
+				* sizeof(struct ini_index_sec)
+			|| h->key_array != (uint64_t)h->key_ctrl + h->key_total
+			|| h->pool < (uint64_t)h->key_array + h->key_total
+				* sizeof(struct ini_index_key)
+			|| h->pool >= h->size)
+		return -1;
+	if (_ini_check(h))
+		return -1;
+
+	idx->err = 0;
+	_ini_attach(idx, buf);
+
+	return 0;
+}
+
+/* @func: ini_index_snapshot
+ * #desc:
+ *    the index image, it can be written out and loaded by
+ *    ini_index_open (same SWISSMAP_WIDTH and byte order).
+ *
+ * #1: idx  [in]  ini index context
+ * #2: size [out] image size
+ * #r:      [ret] image pointer / NULL pointer
+ */
+const void *F_SYMBOL(ini_index_snapshot)(struct ini_index *idx,
+		size_t *size)
+{
+	if (!idx->base)
+		return NULL;
+
+	*size = INI_INDEX_SIZE(idx);
+
+	return idx->base;
+}
+
+/* @func: _ini_section (static)
+ * #desc:
+ *    section slot lookup.
+ *
+ * #1: idx [in]  ini index context
+ * #2: sec [in]  section name / NULL ("")
+ * #r:     [ret] section slot / -1
+ */
+static int64_t _ini_section(struct ini_index *idx, const char *sec)
+{
+	struct ini_index_sec *b;
+	struct _ini_key k;
+
+	if (!idx->base)
+		return -1;
+
+	k.base = idx->base;
+	k.name = sec ? sec : "";
+	k.len = (uint32_t)C_SYMBOL(strlen)(k.name);
+	b = F_SYMBOL(swissmap_find)(&idx->sec, &k, sizeof(k));
+	if (!b)
+		return -1;
+
+	return ((char *)b - (char *)idx->sec.array)
+		/ (int64_t)sizeof(struct ini_index_sec);
+}
+
+/* @func: ini_index_has
+ * #desc:
+ *    section exists.
+ *
+ * #1: idx [in]  ini index context
+ * #2: sec [in]  section name / NULL ("")
+ * #r:     [ret] 1: exists, 0: not found
+ */
+int32_t F_SYMBOL(ini_index_has)(struct ini_index *idx, const char *sec)
+{
+	return _ini_section(idx, sec) >= 0;
+}
+
+/* @func: ini_index_get
+ * #desc:
+ *    key value lookup, the value is null terminated (one pair of
+ *    surrounding double quotes is removed at load).
+ *
+ * #1: idx [in]  ini index context
+ * #2: sec [in]  section name / NULL ("")
+ * #3: key [in]  key name
+ * #4: len [out] value length / NULL
+ * #r:     [ret] value string / NULL pointer
+ */
+const char *F_SYMBOL(ini_index_get)(struct ini_index *idx, const char *sec,
+		const char *key, int32_t *len)
+{
+	struct ini_index_key *b;
+	struct _ini_key k;
+	int64_t n = _ini_section(idx, sec);
+
+	if (n < 0)
+		return NULL;
+
+	k.base = idx->base;
+	k.name = key;
+	k.len = (uint32_t)C_SYMBOL(strlen)(key);
+	k.sec = (uint32_t)n;
+	b = F_SYMBOL(swissmap_find)(&idx->key, &k, sizeof(k));
+	if (!b)
+		return NULL;
+
+	if (len)
+		*len = (int32_t)b->value_len;
+
+	return idx->base + b->value;
+}
+
+/* @func: ini_index_int
+ * #desc:
+ *    key value to integer (decimal, 0x hexadecimal, 0 octal).
+ *
+ * #1: idx [in]  ini index context
+ * #2: sec [in]  section name / NULL ("")
+ * #3: key [in]  key name
+ * #4: v   [out] return number
+ * #r:     [ret] 0: no error, -1: not found, invalid or overflow
+ */
+int32_t F_SYMBOL(ini_index_int)(struct ini_index *idx, const char *sec,
+		const char *key, int64_t *v)
+{
+	char *e;
+	int32_t len;
+	const char *s = F_SYMBOL(ini_index_get)(idx, sec, key, &len);
+
+	if (!s || !len)
+		return -1;
+
+	uint64_t m = INT64_MAX, n = C_SYMBOL(___strtoull)(s, &e, &m, 0);
+	if (!m)
+		return -1;
+	*v = (int64_t)n;
+
+	return (e == s + len) ? 0 : -1;
+}
+
+/* @func: ini_index_bool
+ * #desc:
+ *    key value to boolean (true/false, yes/no, on/off, 1/0, any case).
+ *
+ * #1: idx [in]  ini index context
+ * #2: sec [in]  section name / NULL ("")
+ * #3: key [in]  key name
+ * #4: v   [out] return boolean (1 or 0)
+ * #r:     [ret] 0: no error, -1: not found or invalid
+ */
+int32_t F_SYMBOL(ini_index_bool)(struct ini_index *idx, const char *sec,
+		const char *key, int32_t *v)
+{
+	static const char *const word[8] = {
+		"true", "false", "yes", "no", "on", "off", "1", "0"
+		};
+	char buf[8];
+	int32_t len;
+	const char *s = F_SYMBOL(ini_index_get)(idx, sec, key, &len);
+
+	if (!s || !len || len > 5)
+		return -1;
+
+	for (int32_t i = 0; i <= len; i++)
+		buf[i] = (s[i] >= 'A' && s[i] <= 'Z') ? (s[i] | 0x20) : s[i];
+
+	for (int32_t i = 0; i < 8; i++) {
+		if (!C_SYMBOL(strcmp)(buf, word[i])) {
+			*v = !(i & 1);
+			return 0;
+		}
+	}
+
+	return -1;
+}
+
+/* @func: ini_index_double
+ * #desc:
+ *    key value to floating-point number.
+ *
+ * #1: idx [in]  ini index context
+ * #2: sec [in]  section name / NULL ("")
+ * #3: key [in]  key name
+ * #4: v   [out] return number
+ * #r:     [ret] 0: no error, -1: not found or invalid
+ */
+int32_t F_SYMBOL(ini_index_double)(struct ini_index *idx, const char *sec,
+		const char *key, double *v)
+{
+	char *e;
+	int32_t len;
+	const char *s = F_SYMBOL(ini_index_get)(idx, sec, key, &len);
+
+	if (!s || !len)
+		return -1;
+
+	*v = C_SYMBOL(strtod)(s, &e);
+
+	return (e == s + len) ? 0 : -1;
+}
+
+/* @func: ini_index_duration
+ * #desc:
+ *    key value to nanoseconds, numbers with the units ns, us, ms, s,
+ *    m, h, d (such as "1h30m", "250ms"), a plain number is seconds.
+ *
+ * #1: idx [in]  ini index context
+ * #2: sec [in]  section name / NULL ("")
+ * #3: key [in]  key name
+ * #4: v   [out] return nanoseconds
+ * #r:     [ret] 0: no error, -1: not found, invalid or overflow
+ */
+int32_t F_SYMBOL(ini_index_duration)(struct ini_index *idx,
+		const char *sec, const char *key, int64_t *v)
+{
+	char *e;
+	int32_t len;
+	const char *s = F_SYMBOL(ini_index_get)(idx, sec, key, &len);
+
+	if (!s || !len)
+		return -1;
+
+	const char *p = s, *end = s + len;
+	int64_t sum = 0, unit;
+	for (; p < end; p = e) {
+		if (*p < '0' || *p > '9')
+			return -1;
+
+		uint64_t m = INT64_MAX, n = C_SYMBOL(atou64n)(p,
+			(size_t)(end - p), &e, &m);
+		if (!m)
+			return -1;
+
+		/* the value is null terminated, e[1] can be read */
+		unit = DURATION_S;
+		switch (*e) {
+			case '\0': /* plain number, not "1h30" */
+				if (p != s)
+					return -1;
+				break;
+			case 'n':
+			case 'u':
+				if (e[1] != 's')
+					return -1;
+				unit = (*e == 'n') ? 1 : 1000;
+				e += 2;
+				break;
+			case 'm':
+				if (e[1] == 's') {
+					unit = 1000000;
+					e++;
+				} else {
+					unit *= 60;
+				}
+				e++;
+				break;
+			case 's':
+				e++;
+				break;
+			case 'h':
+				unit *= 3600;
+				e++;
+				break;
+			case 'd':
+				unit *= 86400;
+				e++;
+				break;
+			default:
+				return -1;
+		}
+
+		if (n > (uint64_t)(INT64_MAX - sum) / (uint64_t)unit)
+			return -1;
+		sum += (int64_t)n * unit;
+	}
+	*v = sum;
+
+	return 0;
+}
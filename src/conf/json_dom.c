@@ -0,0 +1,480 @@
+/* @file: json_dom.c
+ * #desc:
+ *    The implementations of json document (tape) builder.
+ *
+ * #copy:
+ *    Copyright (C) 1970 Public Free Software
+ *
+ *    This library is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 2.1 of the License, or (at your option) any later version.
+ *
+ *    This library is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with this library; if not,
+ *    see <https://www.gnu.org/licenses/>.
+ */
+
+#include <demoz/config.h>
+#include <demoz/c/stddef.h>
+#include <demoz/c/stdint.h>
+#include <demoz/c/stdlib.h>
+#include <demoz/c/string.h>
+#include <demoz/ds/arena.h>
+#include <demoz/conf/json_parse.h>
+#include <demoz/conf/json_dom.h>
+
+
+/* @def: _ */
+/* container end entry (type byte) */
+#define DOM_END 0x80
+
+#define DOM_COUNT_MAX 0xffffff
+#define DOM_COUNT(x) ((int32_t)(((x) >> 32) & DOM_COUNT_MAX))
+#define DOM_SKIP(x) ((int32_t)(uint32_t)(x))
+#define DOM_LEN(x) ((int32_t)((x) & 0xffffffffffffffULL))
+#define DOM_PTR(x) ((const char *)(uintptr_t)(x))
+/* end */
+
+/* @func: _dom_reserve (static)
+ * #desc:
+ *    append tape entries, the tape grows (doubles) in the arena.
+ *
+ * #1: dom [in/out] json dom context
+ * #2: n   [in]     entry count
+ * #r:     [ret]    first new entry / NULL pointer
+ */
+static uint64_t *_dom_reserve(struct json_dom *dom, int32_t n)
+{
+	uint64_t *tape;
+	int32_t max = dom->max;
+
+	if (dom->len + n > max) {
+		while (dom->len + n > max) {
+			if (max > 0x3fffffff) /* INT32_MAX */
+				return NULL;
+			max *= 2;
+		}
+		tape = F_SYMBOL(arena_alloc_align)(dom->arena,
+			(size_t)max * sizeof(uint64_t), sizeof(uint64_t));
+		if (!tape)
+			return NULL;
+		C_SYMBOL(memcpy)(tape, dom->tape,
+			(size_t)dom->len * sizeof(uint64_t));
+		dom->tape = tape;
+		dom->max = max;
+	}
+
+	tape = dom->tape + dom->len;
+	dom->len += n;
+
+	return tape;
+}
+
+/* @func: _dom_call (static)
+ * #desc:
+ *    json_parse value callback.
+ *
+ * #1: type [in]     value type
+ * #2: s    [in]     value string
+ * #3: len  [in]     value length
+ * #4: arg  [in/out] json dom context
+ * #r:      [ret]    0: no error, -1: out of memory
+ */
+static int32_t _dom_call(int32_t type, const char *s, int32_t len, void *arg)
+{
+	struct json_dom *dom = arg;
+	uint64_t *p;
+	char *d;
+
+	/* arrays count values, objects count keys */
+	if (dom->depth) {
+		p = &dom->tape[dom->stack[dom->depth - 1]];
+		if (((*p >> 56) == JSON_ARRAY_TYPE || type == JSON_VALUE_TYPE)
+				&& DOM_COUNT(*p) < DOM_COUNT_MAX)
+			*p += 1ULL << 32;
+	}
+
+	switch (type) {
+		case JSON_ARRAY_TYPE:
+		case JSON_OBJECT_TYPE:
+			p = _dom_reserve(dom, 1);
+			if (!p)
+				goto e;
+			*p = (uint64_t)type << 56;
+			dom->stack[dom->depth++] = dom->len - 1;
+			return 0;
+		case JSON_VALUE_TYPE:
+		case JSON_STRING_TYPE:
+			if (len && C_SYMBOL(memchr)(s, '\\', len)) {
+				d = F_SYMBOL(arena_alloc_align)(dom->arena,
+					len, 1);
+				if (!d)
+					goto e;
+				len = F_SYMBOL(json_unescape)(d, s, len);
+				s = d;
+			}
+			/* fall through */
+		case JSON_NUMBER_TYPE:
+			p = _dom_reserve(dom, 2);
+			if (!p)
+				goto e;
+			p[0] = ((uint64_t)type << 56) | (uint32_t)len;
+			p[1] = (uint64_t)(uintptr_t)s;
+			return 0;
+		default: /* null, true, false */
+			p = _dom_reserve(dom, 1);
+			if (!p)
+				goto e;
+			*p = (uint64_t)type << 56;
+			return 0;
+	}
+
+e:
+	dom->err = JSON_DOM_ERR_ALLOC;
+
+	return -1;
+}
+
+/* @func: _dom_call_end (static)
+ * #desc:
+ *    json_parse container end callback.
+ *
+ * #1: type [in]     container type
+ * #2: arg  [in/out] json dom context
+ * #r:      [ret]    0: no error, -1: out of memory
+ */
+static int32_t _dom_call_end(int32_t type, void *arg)
+{
+	struct json_dom *dom = arg;
+	int32_t start = dom->stack[--dom->depth];
+	uint64_t *p = _dom_reserve(dom, 1);
+
+	if (!p) {
+		dom->err = JSON_DOM_ERR_ALLOC;
+		return -1;
+	}
+	*p = ((uint64_t)(DOM_END | type) << 56) | (uint32_t)start;
+	dom->tape[start] |= (uint32_t)dom->len;
+
+	return 0;
+}
+
+/* @func: json_dom_parse
+ * #desc:
+ *    parse the json document to the tape. the tape and unescaped
+ *    strings are allocated from the arena (released together), the
+ *    other strings point into the input buffer.
+ *
+ * #1: dom   [out] json dom context
+ * #2: arena [in]  arena context
+ * #3: s     [in]  input buffer (kept until the dom is released)
+ * #r:       [ret] 0: no error, -1: error (dom->err)
+ */
+int32_t F_SYMBOL(json_dom_parse)(struct json_dom *dom,
+		struct arena_ctx *arena, const char *s)
+{
+	size_t n = C_SYMBOL(strlen)(s) / 8;
+
+	dom->arena = arena;
+	dom->len = 0;
+	dom->err = 0;
+	dom->depth = 0;
+
+	/* about one entry per 8 bytes, the tape doubles when full */
+	dom->max = JSON_DOM_TAPE_MIN;
+	if (n > (size_t)dom->max)
+		dom->max = (n > 0x3fffffff) ? 0x3fffffff : (int32_t)n;
+	dom->tape = F_SYMBOL(arena_alloc_align)(arena,
+		(size_t)dom->max * sizeof(uint64_t), sizeof(uint64_t));
+	if (!dom->tape) {
+		dom->err = JSON_DOM_ERR_ALLOC;
+		return -1;
+	}
+
+	JSON_INIT(&dom->json, _dom_call, _dom_call_end, dom);
+	JSON_FEED_INIT(&dom->json, NULL, 0);
+	if (F_SYMBOL(json_parse)(&dom->json, s)) {
+		if (!dom->err)
+			dom->err = JSON_ERR(&dom->json);
+		return -1;
+	}
+
+	return 0;
+}
+
+/* @func: _dom_skip (static)
+ * #desc:
+ *    the tape index after the value.
+ *
+ * #1: dom [in]  json dom context
+ * #2: v   [in]  value
+ * #r:     [ret] next tape index
+ */
+static int32_t _dom_skip(struct json_dom *dom, int32_t v)
+{
+	uint64_t x = dom->tape[v];
+
+	switch (x >> 56) {
+		case JSON_ARRAY_TYPE:
+		case JSON_OBJECT_TYPE:
+			return DOM_SKIP(x);
+		case JSON_VALUE_TYPE:
+		case JSON_STRING_TYPE:
+		case JSON_NUMBER_TYPE:
+			return v + 2;
+		default:
+			return v + 1;
+	}
+}
+
+/* @func: json_dom_size
+ * #desc:
+ *    array value count or object key count.
+ *
+ * #1: dom [in]  json dom context
+ * #2: v   [in]  array or object
+ * #r:     [ret] count (-1: not a container)
+ */
+int32_t F_SYMBOL(json_dom_size)(struct json_dom *dom, int32_t v)
+{
+	uint64_t x = dom->tape[v];
+	int32_t n = 0;
+
+	if ((x >> 56) != JSON_ARRAY_TYPE && (x >> 56) != JSON_OBJECT_TYPE)
+		return -1;
+	if (DOM_COUNT(x) < DOM_COUNT_MAX)
+		return DOM_COUNT(x);
+
+	/* saturated, count by walking */
+	for (v = F_SYMBOL(json_dom_child)(dom, v); v >= 0;
+			v = F_SYMBOL(json_dom_next)(dom, v))
+		n++;
+
+	return n;
+}
+
+/* @func: json_dom_child
+ * #desc:
+ *    first array value or first object key.
+ *
+ * #1: dom [in]  json dom context
+ * #2: v   [in]  array or object
+ * #r:     [ret] value or key (-1: empty or not a container)
+ */
+int32_t F_SYMBOL(json_dom_child)(struct json_dom *dom, int32_t v)
+{
+	uint64_t x = dom->tape[v];
+
+	if ((x >> 56) != JSON_ARRAY_TYPE && (x >> 56) != JSON_OBJECT_TYPE)
+		return -1;
+	if ((dom->tape[v + 1] >> 56) & DOM_END)
+		return -1;
+
+	return v + 1;
+}
+
+/* @func: json_dom_next
+ * #desc:
+ *    next array value, or next object key (the value of a key is
+ *    key + 2).
+ *
+ * #1: dom [in]  json dom context
+ * #2: v   [in]  array value or object key
+ * #r:     [ret] value or key (-1: container end)
+ */
+int32_t F_SYMBOL(json_dom_next)(struct json_dom *dom, int32_t v)
+{
+	if ((dom->tape[v] >> 56) == JSON_VALUE_TYPE) /* key and value */
+		v += 2;
+	v = _dom_skip(dom, v);
+
+	if ((dom->tape[v] >> 56) & DOM_END)
+		return -1;
+
+	return v;
+}
+
+/* @func: json_dom_get
+ * #desc:
+ *    object value lookup by key.
+ *
+ * #1: dom [in]  json dom context
+ * #2: v   [in]  object
+ * #3: key [in]  key string
+ * #4: len [in]  key length
+ * #r:     [ret] value (-1: not found)
+ */
+int32_t F_SYMBOL(json_dom_get)(struct json_dom *dom, int32_t v,
+		const char *key, int32_t len)
+{
+	if ((dom->tape[v] >> 56) != JSON_OBJECT_TYPE)
+		return -1;
+
+	for (v = F_SYMBOL(json_dom_child)(dom, v); v >= 0;
+			v = F_SYMBOL(json_dom_next)(dom, v)) {
+		uint64_t x = dom->tape[v];
+		if (DOM_LEN(x) == len
+				&& !C_SYMBOL(memcmp)(DOM_PTR(dom->tape[v + 1]),
+					key, len))
+			return v + 2;
+	}
+
+	return -1;
+}
+
+/* @func: json_dom_at
+ * #desc:
+ *    array value lookup by index.
+ *
+ * #1: dom [in]  json dom context
+ * #2: v   [in]  array
+ * #3: n   [in]  index
+ * #r:     [ret] value (-1: not found)
+ */
+int32_t F_SYMBOL(json_dom_at)(struct json_dom *dom, int32_t v, int32_t n)
+{
+	if ((dom->tape[v] >> 56) != JSON_ARRAY_TYPE || n < 0)
+		return -1;
+	if (n >= F_SYMBOL(json_dom_size)(dom, v))
+		return -1;
+
+	for (v = F_SYMBOL(json_dom_child)(dom, v); n-- && v >= 0; )
+		v = F_SYMBOL(json_dom_next)(dom, v);
+
+	return v;
+}
+
+/* @func: _dom_token_eq (static)
+ * #desc:
+ *    json pointer reference token compare ("~0": '~', "~1": '/').
+ *
+ * #1: s   [in]  key string
+ * #2: len [in]  key length
+ * #3: t   [in]  reference token
+ * #4: n   [in]  token length
+ * #r:     [ret] 1: equal, 0: not equal
+ */
+static int32_t _dom_token_eq(const char *s, int32_t len, const char *t,
+		int32_t n)
+{
+	int32_t i = 0, k = 0;
+
+	for (; i < len && k < n; i++, k++) {
+		char c = t[k];
+		if (c == '~' && k + 1 < n) {
+			c = (t[k + 1] == '0') ? '~'
+				: ((t[k + 1] == '1') ? '/' : 0);
+			if (!c)
+				return 0;
+			k++;
+		}
+		if (s[i] != c)
+			return 0;
+	}
+
+	return i == len && k == n;
+}
+
+/* @func: json_dom_pointer
+ * #desc:
+ *    json pointer (rfc 6901) lookup, such as "/a/0/b~1c".
+ *
+ * #1: dom  [in]  json dom context
+ * #2: v    [in]  start value
+ * #3: path [in]  json pointer
+ * #r:      [ret] value (-1: not found)
+ */
+int32_t F_SYMBOL(json_dom_pointer)(struct json_dom *dom, int32_t v,
+		const char *path)
+{
+	while (*path == '/') {
+		const char *t = ++path;
+		int32_t n, k, idx = 0;
+
+		for (n = 0; t[n] != '\0' && t[n] != '/'; n++);
+		path += n;
+
+		switch (dom->tape[v] >> 56) {
+			case JSON_OBJECT_TYPE:
+				k = F_SYMBOL(json_dom_child)(dom, v);
+				while (k >= 0) {
+					uint64_t *x = dom->tape + k;
+					if (_dom_token_eq(DOM_PTR(x[1]),
+							DOM_LEN(x[0]), t, n))
+						break;
+					k = F_SYMBOL(json_dom_next)(dom, k);
+				}
+				if (k < 0)
+					return -1;
+				v = k + 2;
+				break;
+			case JSON_ARRAY_TYPE:
+				/* no sign, no leading zero */
+				if (!n || n > 9 || (t[0] == '0' && n > 1))
+					return -1;
+				for (k = 0; k < n; k++) {
+					if (t[k] < '0' || t[k] > '9')
+						return -1;
+					idx = idx * 10 + (t[k] - '0');
+				}
+				v = F_SYMBOL(json_dom_at)(dom, v, idx);
+				if (v < 0)
+					return -1;
+				break;
+			default:
+				return -1;
+		}
+	}
+
+	return *path ? -1 : v;
+}
+
+/* @func: json_dom_string
+ * #desc:
+ *    string, key or number text (no null terminator).
+ *
+ * #1: dom [in]  json dom context
+ * #2: v   [in]  value
+ * #3: len [out] string length
+ * #r:     [ret] string pointer / NULL pointer
+ */
+const char *F_SYMBOL(json_dom_string)(struct json_dom *dom, int32_t v,
+		int32_t *len)
+{
+	uint64_t x = dom->tape[v];
+
+	switch (x >> 56) {
+		case JSON_VALUE_TYPE:
+		case JSON_STRING_TYPE:
+		case JSON_NUMBER_TYPE:
+			*len = DOM_LEN(x);
+			return DOM_PTR(dom->tape[v + 1]);
+		default:
+			*len = 0;
+			return NULL;
+	}
+}
+
+/* @func: json_dom_number
+ * #desc:
+ *    number value.
+ *
+ * #1: dom [in]  json dom context
+ * #2: v   [in]  value
+ * #r:     [ret] number (not a number: 0)
+ */
+double F_SYMBOL(json_dom_number)(struct json_dom *dom, int32_t v)
+{
+	uint64_t x = dom->tape[v];
+
+	if ((x >> 56) != JSON_NUMBER_TYPE)
+		return 0;
+
+	return C_SYMBOL(strntod)(DOM_PTR(dom->tape[v + 1]), DOM_LEN(x), NULL);
+}
@@ -24,9 +24,34 @@
 #include <demoz/c/stddef.h>
 #include <demoz/c/stdint.h>
 #include <demoz/c/string.h>
+#include <demoz/ds/arena.h>
 #include <demoz/conf/json_parse.h>
 
 
+/* @def: _
+ * json_parse stage 1 (structural index), avx2 is selected at run time
+ * on top of sse2. without simd json_parse runs the byte loop */
+#define JSON_SIMD_SWAR 1
+#define JSON_SIMD_SSE2 2
+#define JSON_SIMD_NEON 3
+
+#ifndef JSON_SIMD
+#	if defined(__SSE2__)
+#		define JSON_SIMD JSON_SIMD_SSE2
+#	elif (defined(__aarch64__) && defined(__ARM_NEON))
+#		define JSON_SIMD JSON_SIMD_NEON
+#	else
+#		define JSON_SIMD JSON_SIMD_SWAR
+#	endif
+#endif
+/* end */
+
+#if (JSON_SIMD == JSON_SIMD_SSE2)
+#	include <immintrin.h>
+#elif (JSON_SIMD == JSON_SIMD_NEON)
+#	include <arm_neon.h>
+#endif
+
 /* @def: _ */
 // [
 //   // Comment
@@ -75,21 +100,74 @@ enum {
 	TOKEN_COMMENT
 };
 
+/* json_feed grammar states (stack entries) */
+enum {
+	FEED_ROOT = 0,
+	FEED_DONE,
+	FEED_OBJECT_KEY,
+	FEED_OBJECT_COLON,
+	FEED_OBJECT_VALUE,
+	FEED_OBJECT_NEXT,
+	FEED_ARRAY_VALUE,
+	FEED_ARRAY_NEXT
+};
+
+/* json_feed token lexers */
+enum {
+	LEX_NONE = 0,
+	LEX_KEY,
+	LEX_STRING,
+	LEX_NUMBER,
+	LEX_LITERAL,
+	LEX_SLASH,
+	LEX_LINE,
+	LEX_BLOCK
+};
+
+/* json_feed lexer step result */
+enum {
+	STEP_MORE = 1,
+	STEP_END, /* last character of the token */
+	STEP_END_BEFORE /* character belongs to the next token */
+};
+
+/* string lexer: escape flag next to the quote character */
+#define LEX_ESCAPE 0x100
+
+/* stage 1 character classes of a 64-byte block, one bit per byte */
+struct json_block {
+	uint64_t quote;
+	uint64_t bslash;
+	uint64_t op; /* {}[]:, */
+	uint64_t ws; /* space, \t, \n, \r */
+	uint64_t ctrl; /* < 0x20 */
+	uint64_t ext; /* ' and / (json5 strings and comments) */
+};
+
 static int32_t _json_token(char c);
-static int32_t _json_string(struct json_ctx *ctx);
-static int32_t _json_number(struct json_ctx *ctx);
-static int32_t _json_null(struct json_ctx *ctx);
-static int32_t _json_true(struct json_ctx *ctx);
-static int32_t _json_false(struct json_ctx *ctx);
-static int32_t _json_comment(struct json_ctx *ctx);
-static int32_t _json_object(struct json_ctx *ctx);
-static int32_t _json_array(struct json_ctx *ctx);
 
 #define SKIP_CHAR(x) \
 	((x) == ' ' || (x) == '\n' || (x) == '\t' || (x) == '\r')
 #define INVALID_CHAR(x) ((uint8_t)(x) < 0x20)
 /* end */
 
+/* @def: _ */
+/* character to token (0: unknown token) */
+static const uint8_t _json_tokens[256] = {
+	['['] = TOKEN_ARRAY, [']'] = TOKEN_ARRAY_END,
+	['{'] = TOKEN_OBJECT, ['}'] = TOKEN_OBJECT_END,
+	[','] = TOKEN_NEXT, [':'] = TOKEN_VALUE,
+	['"'] = TOKEN_STRING, ['\''] = TOKEN_STRING,
+	['n'] = TOKEN_NULL, ['t'] = TOKEN_TRUE, ['f'] = TOKEN_FALSE,
+	['/'] = TOKEN_COMMENT,
+	['+'] = TOKEN_NUMBER, ['-'] = TOKEN_NUMBER, ['.'] = TOKEN_NUMBER,
+	['0'] = TOKEN_NUMBER, ['1'] = TOKEN_NUMBER, ['2'] = TOKEN_NUMBER,
+	['3'] = TOKEN_NUMBER, ['4'] = TOKEN_NUMBER, ['5'] = TOKEN_NUMBER,
+	['6'] = TOKEN_NUMBER, ['7'] = TOKEN_NUMBER, ['8'] = TOKEN_NUMBER,
+	['9'] = TOKEN_NUMBER, ['I'] = TOKEN_NUMBER, ['N'] = TOKEN_NUMBER
+};
+/* end */
+
 /* @func: _json_token (static)
  * #desc:
  *    get the json token.
@@ -99,667 +177,1204 @@ static int32_t _json_array(struct json_ctx *ctx);
  */
 static int32_t _json_token(char c)
 {
-	switch (c) {
-		case '[':
-			return TOKEN_ARRAY;
-		case ']':
-			return TOKEN_ARRAY_END;
-		case '{':
-			return TOKEN_OBJECT;
-		case '}':
-			return TOKEN_OBJECT_END;
-		case ',':
-			return TOKEN_NEXT;
-		case ':':
-			return TOKEN_VALUE;
-		case '"':
-		case '\'':
-			return TOKEN_STRING;
-		case 'n':
-			return TOKEN_NULL;
-		case 't':
-			return TOKEN_TRUE;
-		case 'f':
-			return TOKEN_FALSE;
-		case '/':
-			return TOKEN_COMMENT;
-		default:
-			if (c == '+' || c == '-') {
-				return TOKEN_NUMBER;
+	int32_t tok = _json_tokens[(uint8_t)c];
+
+	return tok ? tok : -1;
+}
+
+/* @func: _feed_number (static)
+ * #desc:
+ *    json number lexer step.
+ *
+ * #1: ctx [in/out] json struct context
+ * #2: c   [in]     character
+ * #r:     [ret]    STEP_* (-1: error)
+ */
+static int32_t _feed_number(struct json_ctx *ctx, char c)
+{
+	switch (ctx->sub) {
+		case 0: /* start */
+			if (c == '+' || c == '-' || (c >= '0' && c <= '9')) {
+				ctx->sub = 1;
+				return STEP_MORE;
+			} else if (c == '.') {
+				ctx->sub = 4;
+				return STEP_MORE;
+			}
+			break;
+		case 1: /* hexadecimal, decimal or floating */
+			if (c == 'X' || c == 'x') {
+				ctx->sub = 2;
+				return STEP_MORE;
 			} else if (c >= '0' && c <= '9') {
-				return TOKEN_NUMBER;
+				ctx->sub = 3;
+				return STEP_MORE;
 			} else if (c == '.') {
-				return TOKEN_NUMBER;
-			} else if (c == 'I' || c == 'N') {
-				return TOKEN_NUMBER;
+				ctx->sub = 4;
+				return STEP_MORE;
 			}
-
+			break;
+		case 2: /* hexadecimal */
+			if ((c >= '0' && c <= '9') || (c >= 'A' && c <= 'F')
+					|| (c >= 'a' && c <= 'f'))
+				return STEP_MORE;
+			return STEP_END_BEFORE;
+		case 3: /* decimal, floating, or exponent */
+			if (c >= '0' && c <= '9') {
+				return STEP_MORE;
+			} else if (c == '.') {
+				ctx->sub = 4;
+				return STEP_MORE;
+			} else if (c == 'e') {
+				ctx->sub = 5;
+				return STEP_MORE;
+			}
+			return STEP_END_BEFORE;
+		case 4: /* floating, or exponent */
+			if (c >= '0' && c <= '9') {
+				return STEP_MORE;
+			} else if (c == 'e') {
+				ctx->sub = 5;
+				return STEP_MORE;
+			}
+			return STEP_END_BEFORE;
+		case 5: /* '+-', or exponent */
+			if (c >= '0' && c <= '9') {
+				return STEP_MORE;
+			} else if (c == '+' || c == '-') {
+				ctx->sub = 6;
+				return STEP_MORE;
+			}
+			return STEP_END_BEFORE;
+		case 6: /* exponent */
+			if (c >= '0' && c <= '9')
+				return STEP_MORE;
+			return STEP_END_BEFORE;
+		case 7: /* Infinity and NaN */
+			if (c != ctx->kw[ctx->kw_n])
+				return -1;
+			if (!ctx->kw[++ctx->kw_n])
+				return STEP_END;
+			return STEP_MORE;
+		default:
 			return -1;
 	}
 
+	/* start or sign, then Infinity and NaN */
+	if (ctx->sub <= 1 && (c == 'I' || c == 'N')) {
+		ctx->sub = 7;
+		ctx->kw = (c == 'I') ? "Infinity" : "NaN";
+		ctx->kw_n = 1;
+		return STEP_MORE;
+	}
+	if (ctx->sub == 1)
+		return STEP_END_BEFORE;
+
 	return -1;
 }
 
-/* @func: _json_string (static)
+/* @func: _feed_lex (static)
  * #desc:
- *    get the length of the json string.
+ *    json_feed token lexer step.
  *
  * #1: ctx [in/out] json struct context
- * #r:     [ret]    string length (-1: error)
+ * #2: c   [in]     character
+ * #r:     [ret]    STEP_* (-1: error)
  */
-static int32_t _json_string(struct json_ctx *ctx)
+static int32_t _feed_lex(struct json_ctx *ctx, char c)
 {
-	char cc;
-	int32_t st = 0, len = ctx->len;
-	for (; *(ctx->str) != '\0'; ctx->str++, ctx->len++) {
-		char c = *(ctx->str);
-		switch (st) {
-			case 0: /* start */
+	switch (ctx->lex) {
+		case LEX_KEY:
+		case LEX_STRING:
+			if (!ctx->sub) { /* start */
 				if (c != '"' && c != '\'')
 					return -1;
-				cc = c;
-				st = 1;
-				break;
-			case 1:
-				if (c == cc) { /* end */
-					ctx->str++;
-					ctx->len++;
-					return ctx->len - len;
-				} else if (c == '\\') { /* escape */
-					st = 2;
-				}
-				if (INVALID_CHAR(c))
-					return -1;
-				break;
-			case 2: /* escape */
-				st = 1;
-				break;
-			default:
+				ctx->sub = c;
+			} else if (ctx->sub & LEX_ESCAPE) {
+				ctx->sub &= ~LEX_ESCAPE;
+			} else if (c == ctx->sub) { /* end */
+				return STEP_END;
+			} else if (c == '\\') {
+				ctx->sub |= LEX_ESCAPE;
+			} else if (INVALID_CHAR(c)) {
 				return -1;
-		}
+			}
+			return STEP_MORE;
+		case LEX_NUMBER:
+			return _feed_number(ctx, c);
+		case LEX_LITERAL:
+			if (c != ctx->kw[ctx->kw_n])
+				return -1;
+			if (!ctx->kw[++ctx->kw_n])
+				return STEP_END;
+			return STEP_MORE;
+		case LEX_SLASH:
+			if (!ctx->sub) {
+				ctx->sub = 1;
+				return (c == '/') ? STEP_MORE : -1;
+			}
+			if (c == '/') {
+				ctx->lex = LEX_LINE;
+			} else if (c == '*') {
+				ctx->lex = LEX_BLOCK;
+				ctx->sub = 0;
+			} else {
+				return -1;
+			}
+			return STEP_MORE;
+		case LEX_LINE:
+			return (c == '\n') ? STEP_END : STEP_MORE;
+		case LEX_BLOCK:
+			if (ctx->sub && c == '/')
+				return STEP_END;
+			ctx->sub = (c == '*');
+			return STEP_MORE;
+		default:
+			return -1;
 	}
+}
 
-	return -1;
+/* @func: _feed_err (static)
+ * #desc:
+ *    json_feed lexer error code.
+ *
+ * #1: ctx [in] json struct context
+ * #r:     [ret] JSON_ERR_*
+ */
+static int32_t _feed_err(struct json_ctx *ctx)
+{
+	int32_t obj = (ctx->stack[ctx->depth] < FEED_ARRAY_VALUE);
+
+	switch (ctx->lex) {
+		case LEX_KEY:
+			return JSON_ERR_OBJECT_VALUE;
+		case LEX_STRING:
+			return obj ? JSON_ERR_OBJECT_STRING
+				: JSON_ERR_ARRAY_STRING;
+		case LEX_NUMBER:
+			return obj ? JSON_ERR_OBJECT_NUMBER
+				: JSON_ERR_ARRAY_NUMBER;
+		case LEX_LITERAL:
+			return obj ? JSON_ERR_OBJECT_TOKEN
+				: JSON_ERR_ARRAY_TOKEN;
+		default:
+			return JSON_ERR_COMMENT;
+	}
 }
 
-/* @func: _json_number (static)
+/* @func: _feed_save (static)
  * #desc:
- *    get the length of the json number.
+ *    append a token piece to the token buffer.
  *
  * #1: ctx [in/out] json struct context
- * #r:     [ret]    number length (-1: error)
+ * #2: s   [in]     token piece
+ * #3: len [in]     piece length
+ * #r:     [ret]    0: no error, -1: token buffer is full
  */
-static int32_t _json_number(struct json_ctx *ctx)
+static int32_t _feed_save(struct json_ctx *ctx, const char *s, int32_t len)
 {
-	int32_t st = 0, len = ctx->len;
-	for (; *(ctx->str) != '\0'; ctx->str++, ctx->len++) {
-		char c = *(ctx->str);
-		switch (st) {
-			case 0: /* start */
-				if (c == '+' || c == '-') {
-					st = 1;
-					break;
-				} else if (c >= '0' && c <= '9') {
-					st = 1;
-					break;
-				} else if (c == '.') {
-					st = 4;
-					break;
-				} else if (c == 'I' || c == 'N') {
-					st = 7;
-					break;
-				}
-				return -1;
-			case 1: /* hexadecimal, decimal or floating */
-				if (c == 'X' || c == 'x') {
-					st = 2;
-					break;
-				} else if (c >= '0' && c <= '9') {
-					st = 3;
-					break;
-				} else if (c == '.') {
-					st = 4;
-					break;
-				} else if (c == 'I' || c == 'N') {
-					st = 7;
-					break;
-				}
-				return ctx->len - len;
-			case 2: /* hexadecimal */
-				if (c >= '0' && c <= '9') {
-					break;
-				} else if (c >= 'A' && c <= 'F') {
-					break;
-				} else if (c >= 'a' && c <= 'f') {
-					break;
-				}
-				return ctx->len - len;
-			case 3: /* decimal, floating, or exponent */
-				if (c >= '0' && c <= '9') {
-					break;
-				} else if (c == '.') {
-					st = 4;
-					break;
-				} else if (c == 'e') {
-					st = 5;
-					break;
-				}
-				return ctx->len - len;
-			case 4: /* floating, or exponent */
-				if (c >= '0' && c <= '9') {
-					break;
-				} else if (c == 'e') {
-					st = 5;
-					break;
-				}
-				return ctx->len - len;
-			case 5: /* '+-', or exponent */
-				if (c >= '0' && c <= '9') {
-					break;
-				} else if (c == '+' || c == '-') {
-					st = 6;
-					break;
-				}
-				return ctx->len - len;
-			case 6: /* exponent */
-				if (c >= '0' && c <= '9')
-					break;
-				return ctx->len - len;
-			case 7: /* Infinity and NaN */
-				ctx->str--;
-				ctx->len--;
-				if (!C_SYMBOL(strncmp)("Infinity",
-						ctx->str, 8)) {
-					ctx->str += 8;
-					ctx->len += 8;
-					return ctx->len - len;
-				} else if (!C_SYMBOL(strncmp)("NaN",
-						ctx->str, 3)) {
-					ctx->str += 3;
-					ctx->len += 3;
-					return ctx->len - len;
-				}
-				return -1;
-			default:
-				return -1;
-		}
+	if (len > ctx->tok_max - ctx->tok_len) {
+		ctx->err = JSON_ERR_TOKEN_SIZE;
+		return -1;
 	}
 
-	return -1;
+	C_SYMBOL(memcpy)(ctx->tok + ctx->tok_len, s, len);
+	ctx->tok_len += len;
+
+	return 0;
 }
 
-/* @func: _json_null (static)
+/* @func: _feed_value_end (static)
  * #desc:
- *    get the length of the json null.
+ *    json_feed state after a value.
  *
  * #1: ctx [in/out] json struct context
- * #r:     [ret]    null length (-1: error)
  */
-static int32_t _json_null(struct json_ctx *ctx)
+static void _feed_value_end(struct json_ctx *ctx)
 {
-	if (!C_SYMBOL(strncmp)("null", ctx->str, 4)) {
-		ctx->str += 4;
-		ctx->len += 4;
-		return 4;
+	uint8_t *st = &ctx->stack[ctx->depth];
+
+	if (*st == FEED_OBJECT_VALUE) {
+		*st = FEED_OBJECT_NEXT;
+	} else if (*st == FEED_ARRAY_VALUE) {
+		*st = FEED_ARRAY_NEXT;
 	}
+}
 
-	return -1;
+/* @func: _feed_string (static)
+ * #desc:
+ *    json_feed string options (JSON_OPT_*).
+ *
+ * #1: ctx [in/out] json struct context
+ * #2: s   [in/out] string (without quotes)
+ * #3: len [in/out] string length
+ * #r:     [ret]    0: no error, -1: error
+ */
+static int32_t _feed_string(struct json_ctx *ctx, const char **s,
+		int32_t *len)
+{
+	char *d;
+
+	if ((ctx->opt & JSON_OPT_UTF8)
+			&& C_SYMBOL(utf8_validate)(*s, *len)) {
+		ctx->err = JSON_ERR_UTF8;
+		return -1;
+	}
+	if (!(ctx->opt & JSON_OPT_UNESCAPE))
+		return 0;
+
+	if (ctx->arena) {
+		d = F_SYMBOL(arena_alloc_align)(ctx->arena, *len ? *len : 1, 1);
+	} else {
+		/* in place, nothing to decode */
+		if (!*len || !C_SYMBOL(memchr)(*s, '\\', *len))
+			return 0;
+		d = (*len <= ctx->ubuf_max) ? ctx->ubuf : NULL;
+	}
+	if (!d) {
+		ctx->err = JSON_ERR_UNESCAPE;
+		return -1;
+	}
+
+	*len = F_SYMBOL(json_unescape)(d, *s, *len);
+	*s = d;
+
+	return 0;
 }
 
-/* @func: _json_true (static)
+/* @func: _feed_emit (static)
  * #desc:
- *    get the length of the json true.
+ *    json_feed token end.
  *
  * #1: ctx [in/out] json struct context
- * #r:     [ret]    true length (-1: error)
+ * #2: s   [in]     token (in this feed)
+ * #3: len [in]     token length (in this feed)
+ * #r:     [ret]    0: no error, -1: error, -2: call error
  */
-static int32_t _json_true(struct json_ctx *ctx)
+static int32_t _feed_emit(struct json_ctx *ctx, const char *s, int32_t len)
 {
-	if (!C_SYMBOL(strncmp)("true", ctx->str, 4)) {
-		ctx->str += 4;
-		ctx->len += 4;
-		return 4;
+	int32_t lex = ctx->lex, type = 0;
+
+	ctx->lex = LEX_NONE;
+	if (lex >= LEX_SLASH) /* comment */
+		return 0;
+
+	/* split across feeds */
+	if (ctx->tok_len) {
+		if (_feed_save(ctx, s, len))
+			return -1;
+		s = ctx->tok;
+		len = ctx->tok_len;
+		ctx->tok_len = 0;
 	}
 
-	return -1;
+	switch (lex) {
+		case LEX_KEY:
+		case LEX_STRING:
+			s++;
+			len -= 2;
+			if (ctx->opt && _feed_string(ctx, &s, &len))
+				return -1;
+			if (lex == LEX_KEY) {
+				if (ctx->call(JSON_VALUE_TYPE, s, len,
+						ctx->arg))
+					return -2;
+				ctx->stack[ctx->depth] = FEED_OBJECT_COLON;
+				return 0;
+			}
+			if (ctx->call(JSON_STRING_TYPE, s, len, ctx->arg))
+				return -2;
+			break;
+		case LEX_NUMBER:
+			if (ctx->call(JSON_NUMBER_TYPE, s, len, ctx->arg))
+				return -2;
+			break;
+		default: /* literal */
+			if (ctx->kw[0] == 'n') {
+				type = JSON_NULL_TYPE;
+			} else if (ctx->kw[0] == 't') {
+				type = JSON_TRUE_TYPE;
+			} else {
+				type = JSON_FALSE_TYPE;
+			}
+			if (ctx->call(type, NULL, 0, ctx->arg))
+				return -2;
+			break;
+	}
+	_feed_value_end(ctx);
+
+	return 0;
 }
 
-/* @func: _json_false (static)
+/* @func: _feed_value (static)
  * #desc:
- *    get the length of the json false.
+ *    json_feed value start.
  *
  * #1: ctx [in/out] json struct context
- * #r:     [ret]    false length (-1: error)
+ * #2: c   [in]     character
+ * #r:     [ret]    0: lexer started, 1: container started, -1: error,
+ *                  -2: call error
  */
-static int32_t _json_false(struct json_ctx *ctx)
+static int32_t _feed_value(struct json_ctx *ctx, char c)
 {
-	if (!C_SYMBOL(strncmp)("false", ctx->str, 5)) {
-		ctx->str += 5;
-		ctx->len += 5;
-		return 5;
+	int32_t obj = (ctx->stack[ctx->depth] == FEED_OBJECT_VALUE);
+
+	ctx->sub = 0;
+	ctx->kw_n = 0;
+	switch (_json_token(c)) {
+		case TOKEN_STRING:
+			ctx->lex = LEX_STRING;
+			return 0;
+		case TOKEN_NUMBER:
+			ctx->lex = LEX_NUMBER;
+			return 0;
+		case TOKEN_NULL:
+			ctx->lex = LEX_LITERAL;
+			ctx->kw = "null";
+			return 0;
+		case TOKEN_TRUE:
+			ctx->lex = LEX_LITERAL;
+			ctx->kw = "true";
+			return 0;
+		case TOKEN_FALSE:
+			ctx->lex = LEX_LITERAL;
+			ctx->kw = "false";
+			return 0;
+		case TOKEN_OBJECT:
+		case TOKEN_ARRAY:
+			if (ctx->depth + 1 >= JSON_DEPTH_MAX) {
+				ctx->err = JSON_ERR_DEPTH;
+				return -1;
+			}
+			obj = (c == '{');
+			if (ctx->call(obj ? JSON_OBJECT_TYPE : JSON_ARRAY_TYPE,
+					NULL,
+					0,
+					ctx->arg))
+				return -2;
+			ctx->stack[++ctx->depth] = obj ? FEED_OBJECT_KEY
+				: FEED_ARRAY_VALUE;
+			return 1;
+		default:
+			ctx->err = obj ? JSON_ERR_OBJECT_TOKEN
+				: JSON_ERR_ARRAY_TOKEN;
+			return -1;
 	}
+}
 
-	return -1;
+/* @func: _feed_end (static)
+ * #desc:
+ *    json_feed container end.
+ *
+ * #1: ctx  [in/out] json struct context
+ * #2: type [in]     container type
+ * #r:      [ret]    0: no error, -2: call error
+ */
+static int32_t _feed_end(struct json_ctx *ctx, int32_t type)
+{
+	if (ctx->call_end(type, ctx->arg))
+		return -2;
+
+	if (!--ctx->depth) {
+		ctx->stack[0] = FEED_DONE;
+	} else {
+		_feed_value_end(ctx);
+	}
+
+	return 0;
 }
 
-/* @func: _json_comment (static)
+/* @func: _feed_grammar (static)
  * #desc:
- *    get the length of the json comments.
+ *    json_feed step between tokens.
  *
  * #1: ctx [in/out] json struct context
- * #r:     [ret]    comment length (-1: error)
+ * #2: c   [in]     character (not blank)
+ * #r:     [ret]    0: lexer started, 1: consumed, -1: error,
+ *                  -2: call error
  */
-static int32_t _json_comment(struct json_ctx *ctx)
+static int32_t _feed_grammar(struct json_ctx *ctx, char c)
 {
-	int32_t st = 0, len = ctx->len;
-	if (!C_SYMBOL(strncmp)("//", ctx->str, 2)) {
-		ctx->str += 2;
-		ctx->len += 2;
-		for (; *(ctx->str) != '\0'; ctx->str++, ctx->len++) {
-			if (*(ctx->str) == '\n') {
-				ctx->str++;
-				ctx->len++;
-				break;
+	int32_t tok = _json_token(c);
+
+	if (tok == TOKEN_COMMENT) {
+		ctx->lex = LEX_SLASH;
+		ctx->sub = 0;
+		return 0;
+	}
+
+	switch (ctx->stack[ctx->depth]) {
+		case FEED_ROOT:
+			if (tok == TOKEN_OBJECT || tok == TOKEN_ARRAY)
+				return _feed_value(ctx, c);
+			ctx->err = JSON_ERR_START_TOKEN;
+			return -1;
+		case FEED_OBJECT_KEY:
+			if (tok == TOKEN_STRING) {
+				ctx->lex = LEX_KEY;
+				ctx->sub = 0;
+				return 0;
+			} else if (tok == TOKEN_OBJECT_END) {
+				return _feed_end(ctx, JSON_OBJECT_TYPE)
+					? -2 : 1;
 			}
-		}
-		return ctx->len - len;
-	} else if (!C_SYMBOL(strncmp)("/*", ctx->str, 2)) {
-		ctx->str += 2;
-		ctx->len += 2;
-		for (; *(ctx->str) != '\0'; ctx->str++, ctx->len++) {
-			char c = *(ctx->str);
-			switch (st) {
-				case 0:
-					if (c == '*')
-						st = 1;
+			ctx->err = JSON_ERR_OBJECT_TOKEN;
+			return -1;
+		case FEED_OBJECT_COLON:
+			if (tok == TOKEN_VALUE) {
+				ctx->stack[ctx->depth] = FEED_OBJECT_VALUE;
+				return 1;
+			}
+			ctx->err = JSON_ERR_OBJECT_VALUE;
+			return -1;
+		case FEED_OBJECT_VALUE:
+			return _feed_value(ctx, c);
+		case FEED_OBJECT_NEXT:
+			if (tok == TOKEN_NEXT) {
+				ctx->stack[ctx->depth] = FEED_OBJECT_KEY;
+				return 1;
+			} else if (tok == TOKEN_OBJECT_END) {
+				return _feed_end(ctx, JSON_OBJECT_TYPE)
+					? -2 : 1;
+			}
+			ctx->err = JSON_ERR_OBJECT_END;
+			return -1;
+		case FEED_ARRAY_VALUE:
+			if (tok == TOKEN_ARRAY_END)
+				return _feed_end(ctx, JSON_ARRAY_TYPE) ? -2 : 1;
+			return _feed_value(ctx, c);
+		case FEED_ARRAY_NEXT:
+			if (tok == TOKEN_NEXT) {
+				ctx->stack[ctx->depth] = FEED_ARRAY_VALUE;
+				return 1;
+			} else if (tok == TOKEN_ARRAY_END) {
+				return _feed_end(ctx, JSON_ARRAY_TYPE) ? -2 : 1;
+			}
+			ctx->err = JSON_ERR_ARRAY_END;
+			return -1;
+		default:
+			return -1;
+	}
+}
+
+/* @func: json_feed_reset
+ * #desc:
+ *    json_feed state initialization (keeps callbacks and token buffer).
+ *
+ * #1: ctx [in/out] json struct context
+ */
+void F_SYMBOL(json_feed_reset)(struct json_ctx *ctx)
+{
+	ctx->str = NULL;
+	ctx->len = 0;
+	ctx->err = 0;
+	ctx->depth = 0;
+	ctx->lex = LEX_NONE;
+	ctx->sub = 0;
+	ctx->kw_n = 0;
+	ctx->kw = NULL;
+	ctx->tok_len = 0;
+	ctx->stack[0] = FEED_ROOT;
+}
+
+/* @func: _json_feed (static)
+ * #desc:
+ *    json_feed byte loop.
+ *
+ * #1: ctx  [in/out] json struct context
+ * #2: s    [in]     input buffer
+ * #3: len  [in]     input length
+ * #4: save [in]     keep a split token (more input follows)
+ * #r:      [ret]    0: no error, -1: error, -2: call error
+ */
+static int32_t _json_feed(struct json_ctx *ctx, const char *s, int32_t len,
+		int32_t save)
+{
+	int32_t i = 0, t = 0, k = 0;
+
+	for (; i < len && ctx->stack[0] != FEED_DONE; ) {
+		char c = s[i];
+		if (ctx->lex) { /* inside a token */
+			if (ctx->lex <= LEX_STRING && ctx->sub == '"') {
+				/* plain string bytes */
+				for (; i < len && s[i] != '"' && s[i] != '\\'
+						&& !INVALID_CHAR(s[i]); i++);
+				if (i == len)
 					break;
-				case 1:
-					if (c == '/') {
-						ctx->str++;
-						ctx->len++;
-						return ctx->len - len;
-					}
-					st = 0;
+				c = s[i];
+			} else if (ctx->lex == LEX_NUMBER
+					&& ctx->sub >= 3 && ctx->sub <= 6) {
+				/* digits keep the number state */
+				for (; i < len && s[i] >= '0' && s[i] <= '9'; )
+					i++;
+				if (i == len)
 					break;
-				default:
-					return -1;
+				c = s[i];
+			}
+			k = _feed_lex(ctx, c);
+			if (k < 0) {
+				ctx->err = _feed_err(ctx);
+				goto e;
 			}
+			if (k == STEP_MORE) {
+				i++;
+				continue;
+			}
+			if (k == STEP_END)
+				i++;
+			k = _feed_emit(ctx, s + t, i - t);
+			if (k < 0)
+				goto e;
+			continue;
+		}
+
+		if (SKIP_CHAR(c)) {
+			i++;
+			continue;
+		}
+		if (INVALID_CHAR(c)) {
+			ctx->err = JSON_ERR_INVALID;
+			k = -1;
+			goto e;
+		}
+
+		k = _feed_grammar(ctx, c);
+		if (k < 0)
+			goto e;
+		if (k) {
+			i++;
+		} else { /* token starts here */
+			t = i;
 		}
 	}
 
-	return -1;
+	/* keep the start of a split token */
+	k = 0;
+	if (save && ctx->lex >= LEX_KEY && ctx->lex <= LEX_NUMBER)
+		k = _feed_save(ctx, s + t, i - t);
+
+e:
+	ctx->str = s + i;
+	ctx->len += i;
+
+	return k;
 }
 
-/* @func: _json_object (static)
+/* @func: json_feed
  * #desc:
- *    parse json object.
+ *    incremental json parser, the input may end anywhere (even inside
+ *    a token). tokens inside one feed are passed in place, split tokens
+ *    are passed from the token buffer (JSON_FEED_INIT). input after
+ *    the root container is ignored.
  *
  * #1: ctx [in/out] json struct context
+ * #2: s   [in]     input buffer (no null terminator needed)
+ * #3: len [in]     input length
  * #r:     [ret]    0: no error, -1: error, -2: call error
  */
-static int32_t _json_object(struct json_ctx *ctx)
+int32_t F_SYMBOL(json_feed)(struct json_ctx *ctx, const char *s, int32_t len)
 {
-	int32_t st = 0, k = 0;
-	for (; *(ctx->str) != '\0'; ctx->str++, ctx->len++) {
-		char c = *(ctx->str);
-		if (SKIP_CHAR(c))
-			continue;
-		if (INVALID_CHAR(c)) {
-			ctx->err = JSON_ERR_INVALID;
+	return _json_feed(ctx, s, len, 1);
+}
+
+/* @func: json_finish
+ * #desc:
+ *    end of json_feed input.
+ *
+ * #1: ctx [in/out] json struct context
+ * #r:     [ret]    0: no error, -1: error
+ */
+int32_t F_SYMBOL(json_finish)(struct json_ctx *ctx)
+{
+	if (ctx->err)
+		return -1;
+
+	/* complete, or only blanks and comments */
+	if (ctx->stack[0] == FEED_DONE)
+		return 0;
+	if (!ctx->depth && (ctx->lex == LEX_NONE || ctx->lex == LEX_LINE))
+		return 0;
+
+	ctx->err = JSON_ERR_INCOMPLETE;
+
+	return -1;
+}
+
+/* @func: _json_utf8 (static)
+ * #desc:
+ *    code point to utf-8.
+ *
+ * #1: d [out] output buffer
+ * #2: u [in]  code point
+ * #r:   [ret] output length
+ */
+static int32_t _json_utf8(char *d, uint32_t u)
+{
+	if (u < 0x80) {
+		d[0] = (char)u;
+		return 1;
+	} else if (u < 0x800) {
+		d[0] = (char)(0xc0 | (u >> 6));
+		d[1] = (char)(0x80 | (u & 0x3f));
+		return 2;
+	} else if (u < 0x10000) {
+		d[0] = (char)(0xe0 | (u >> 12));
+		d[1] = (char)(0x80 | ((u >> 6) & 0x3f));
+		d[2] = (char)(0x80 | (u & 0x3f));
+		return 3;
+	}
+	d[0] = (char)(0xf0 | (u >> 18));
+	d[1] = (char)(0x80 | ((u >> 12) & 0x3f));
+	d[2] = (char)(0x80 | ((u >> 6) & 0x3f));
+	d[3] = (char)(0x80 | (u & 0x3f));
+
+	return 4;
+}
+
+/* @func: _json_hex4 (static)
+ * #desc:
+ *    four hexadecimal digits of the \u escape.
+ *
+ * #1: s [in]  input buffer
+ * #2: n [in]  input length
+ * #r:   [ret] code unit (-1: invalid)
+ */
+static int32_t _json_hex4(const char *s, int32_t n)
+{
+	int32_t u = 0;
+
+	if (n < 4)
+		return -1;
+
+	for (int32_t i = 0; i < 4; i++) {
+		char c = s[i];
+		if (c >= '0' && c <= '9') {
+			u = (u << 4) | (c - '0');
+		} else if ((c | 0x20) >= 'a' && (c | 0x20) <= 'f') {
+			u = (u << 4) | ((c | 0x20) - 'a' + 10);
+		} else {
 			return -1;
 		}
+	}
 
-		switch (st) {
-			case 0: /* start */
-				if (ctx->call(JSON_OBJECT_TYPE,
-						NULL,
-						0,
-						ctx->arg))
-					return -2;
-				st = 1;
+	return u;
+}
+
+/* @func: json_unescape
+ * #desc:
+ *    json string unescape, \u surrogate pairs to utf-8 and json5 line
+ *    continuations (the output is never longer than the input, and
+ *    has no null terminator).
+ *
+ * #1: d   [out] output buffer
+ * #2: s   [in]  string (without quotes)
+ * #3: len [in]  string length
+ * #r:     [ret] output length
+ */
+int32_t F_SYMBOL(json_unescape)(char *d, const char *s, int32_t len)
+{
+	const char *e = s + len, *p;
+	int32_t n = 0, u, lo;
+
+	while (s < e) {
+		/* plain runs by the vector kernels */
+		p = C_SYMBOL(memchr)(s, '\\', e - s);
+		if (!p)
+			p = e;
+		C_SYMBOL(memcpy)(d + n, s, p - s);
+		n += p - s;
+		s = p;
+		if (e - s < 2) {
+			if (s < e) /* trailing backslash */
+				d[n++] = *s++;
+			break;
+		}
+
+		s += 2;
+		switch (s[-1]) {
+			case 'b':
+				d[n++] = '\b';
 				break;
-			case 1:
-				switch (_json_token(c)) {
-					case TOKEN_COMMENT:
-						k = _json_comment(ctx);
-						if (k < 0) {
-							ctx->err = JSON_ERR_COMMENT;
-							return -1;
-						}
-						ctx->str--;
-						ctx->len--;
-						break;
-					case TOKEN_STRING: /* value */
-						k = _json_string(ctx);
-						if (k < 0) {
-							ctx->err = JSON_ERR_OBJECT_VALUE;
-							return -1;
-						}
-						if (ctx->call(JSON_VALUE_TYPE,
-								ctx->str - k + 1,
-								k - 2,
-								ctx->arg))
-							return -2;
-						ctx->str--;
-						ctx->len--;
-						st = 2;
-						break;
-					case TOKEN_OBJECT_END: /* end */
-						if (ctx->call_end(JSON_OBJECT_TYPE,
-								ctx->arg))
-							return -2;
-						ctx->str++;
-						ctx->len++;
-						return 0;
-					default:
-						ctx->err = JSON_ERR_OBJECT_TOKEN;
-						return -1;
-				}
+			case 'f':
+				d[n++] = '\f';
 				break;
-			case 2: /* value */
-				switch (_json_token(c)) {
-					case TOKEN_COMMENT:
-						k = _json_comment(ctx);
-						if (k < 0) {
-							ctx->err = JSON_ERR_COMMENT;
-							return -1;
-						}
-						ctx->str--;
-						ctx->len--;
-						break;
-					case TOKEN_VALUE:
-						st = 3;
-						break;
-					default:
-						ctx->err = JSON_ERR_OBJECT_VALUE;
-						return -1;
-				}
+			case 'n':
+				d[n++] = '\n';
 				break;
-			case 3:
-				if (_json_token(c) == TOKEN_COMMENT) {
-					k = _json_comment(ctx);
-					if (k < 0) {
-						ctx->err = JSON_ERR_COMMENT;
-						return -1;
-					}
-					ctx->str--;
-					ctx->len--;
+			case 'r':
+				d[n++] = '\r';
+				break;
+			case 't':
+				d[n++] = '\t';
+				break;
+			case '\r': /* json5 line continuation */
+				if (s < e && *s == '\n')
+					s++;
+				break;
+			case '\n':
+				break;
+			case 'u':
+				u = _json_hex4(s, e - s);
+				if (u < 0) {
+					d[n++] = 'u';
 					break;
 				}
-
-				switch (_json_token(c)) {
-					case TOKEN_STRING:
-						k = _json_string(ctx);
-						if (k < 0) {
-							ctx->err = JSON_ERR_OBJECT_STRING;
-							return -1;
-						}
-						if (ctx->call(JSON_STRING_TYPE,
-								ctx->str - k + 1,
-								k - 2,
-								ctx->arg))
-							return -2;
-						break;
-					case TOKEN_NUMBER:
-						k = _json_number(ctx);
-						if (k < 0) {
-							ctx->err = JSON_ERR_OBJECT_NUMBER;
-							return -1;
-						}
-						if (ctx->call(JSON_NUMBER_TYPE,
-								ctx->str - k,
-								k,
-								ctx->arg))
-							return -2;
-						break;
-					case TOKEN_NULL:
-						k = _json_null(ctx);
-						if (k < 0) {
-							ctx->err = JSON_ERR_OBJECT_TOKEN;
-							return -1;
-						}
-						if (ctx->call(JSON_NULL_TYPE,
-								NULL,
-								0,
-								ctx->arg))
-							return -2;
-						break;
-					case TOKEN_TRUE:
-						k = _json_true(ctx);
-						if (k < 0) {
-							ctx->err = JSON_ERR_OBJECT_TOKEN;
-							return -1;
-						}
-						if (ctx->call(JSON_TRUE_TYPE,
-								NULL,
-								0,
-								ctx->arg))
-							return -2;
-						break;
-					case TOKEN_FALSE:
-						k = _json_false(ctx);
-						if (k < 0) {
-							ctx->err = JSON_ERR_OBJECT_TOKEN;
-							return -1;
-						}
-						if (ctx->call(JSON_FALSE_TYPE,
-								NULL,
-								0,
-								ctx->arg))
-							return -2;
-						break;
-					case TOKEN_OBJECT: /* object */
-						k = _json_object(ctx);
-						if (k < 0)
-							return k;
-						break;
-					case TOKEN_ARRAY: /* array */
-						k = _json_array(ctx);
-						if (k < 0)
-							return k;
-						break;
-					default:
-						ctx->err = JSON_ERR_OBJECT_TOKEN;
-						return -1;
+				s += 4;
+				/* surrogate pair */
+				if (u >= 0xd800 && u < 0xdc00
+						&& e - s >= 6 && s[0] == '\\'
+						&& s[1] == 'u') {
+					lo = _json_hex4(s + 2, e - s - 2);
+					if (lo >= 0xdc00 && lo < 0xe000) {
+						u = 0x10000
+							+ ((u - 0xd800) << 10)
+							+ (lo - 0xdc00);
+						s += 6;
+					}
 				}
-				ctx->str--;
-				ctx->len--;
-				st = 4;
+				n += _json_utf8(d + n, (uint32_t)u);
 				break;
-			case 4: /* next or end */
-				switch (_json_token(c)) {
-					case TOKEN_COMMENT:
-						k = _json_comment(ctx);
-						if (k < 0) {
-							ctx->err = JSON_ERR_COMMENT;
-							return -1;
-						}
-						ctx->str--;
-						ctx->len--;
-						break;
-					case TOKEN_NEXT:
-						st = 1;
-						break;
-					case TOKEN_OBJECT_END:
-						if (ctx->call_end(JSON_OBJECT_TYPE,
-								ctx->arg))
-							return -2;
-						ctx->str++;
-						ctx->len++;
-						return 0;
-					default:
-						ctx->err = JSON_ERR_OBJECT_END;
-						return -1;
-				}
+			default: /* '"', '\\', '/', '\'' */
+				d[n++] = s[-1];
 				break;
-			default:
-				return -1;
 		}
 	}
 
-	return -1;
+	return n;
+}
+
+#if (JSON_SIMD != JSON_SIMD_SWAR)
+
+/* @func: _prefix_xor (static)
+ * #desc:
+ *    prefix xor (bit i is the xor of bits 0 .. i).
+ *
+ * #1: x [in]  input bits
+ * #r:   [ret] prefix xor bits
+ */
+static uint64_t _prefix_xor(uint64_t x)
+{
+	x ^= x << 1;
+	x ^= x << 2;
+	x ^= x << 4;
+	x ^= x << 8;
+	x ^= x << 16;
+	x ^= x << 32;
+
+	return x;
+}
+
+/* @func: _json_escaped (static)
+ * #desc:
+ *    characters escaped by odd-length backslash runs.
+ *
+ * #1: bs    [in]     backslash bits
+ * #2: carry [in/out] last byte of the previous block is escaping
+ * #r:       [ret]    escaped bits
+ */
+static uint64_t _json_escaped(uint64_t bs, uint64_t *carry)
+{
+	const uint64_t even = 0x5555555555555555ULL;
+	uint64_t follows, odd_starts, sum;
+
+	bs &= ~*carry;
+	follows = (bs << 1) | *carry;
+	odd_starts = bs & ~even & ~follows;
+
+	/* runs starting on odd bits end on even bits when odd-length */
+	sum = odd_starts + bs;
+	*carry = (sum < bs);
+
+	return (even ^ (sum << 1)) & follows;
+}
+
+#if (JSON_SIMD == JSON_SIMD_SSE2)
+
+/* @def: _ */
+#define SSE2_BITS(v, i) ((uint64_t)(uint16_t)_mm_movemask_epi8(v) << (i))
+#define AVX2_BITS(v, i) ((uint64_t)(uint32_t)_mm256_movemask_epi8(v) << (i))
+/* end */
+
+/* @func: _json_classify_sse2 (static)
+ * #desc:
+ *    sse2 stage 1 character classes.
+ *
+ * #1: b [out] character classes
+ * #2: p [in]  64-byte block
+ */
+static void _json_classify_sse2(struct json_block *b, const uint8_t *p)
+{
+	const __m128i sp = _mm_set1_epi8(0x20), c1f = _mm_set1_epi8(0x1f);
+	uint64_t quote = 0, bslash = 0, op = 0, ws = 0, ctrl = 0, ext = 0;
+
+	for (int32_t i = 0; i < 64; i += 16) {
+		__m128i x = _mm_loadu_si128((const __m128i *)(p + i));
+		/* '[' and ']' fold into '{' and '}' */
+		__m128i u = _mm_or_si128(x, sp);
+		__m128i vop = _mm_or_si128(
+			_mm_or_si128(_mm_cmpeq_epi8(u, _mm_set1_epi8('{')),
+				_mm_cmpeq_epi8(u, _mm_set1_epi8('}'))),
+			_mm_or_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8(':')),
+				_mm_cmpeq_epi8(x, _mm_set1_epi8(','))));
+		__m128i vws = _mm_or_si128(
+			_mm_or_si128(_mm_cmpeq_epi8(x, sp),
+				_mm_cmpeq_epi8(x, _mm_set1_epi8('\t'))),
+			_mm_or_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8('\n')),
+				_mm_cmpeq_epi8(x, _mm_set1_epi8('\r'))));
+		__m128i vext = _mm_or_si128(
+			_mm_cmpeq_epi8(x, _mm_set1_epi8('\'')),
+			_mm_cmpeq_epi8(x, _mm_set1_epi8('/')));
+
+		quote |= SSE2_BITS(_mm_cmpeq_epi8(x, _mm_set1_epi8('"')), i);
+		bslash |= SSE2_BITS(_mm_cmpeq_epi8(x, _mm_set1_epi8('\\')), i);
+		op |= SSE2_BITS(vop, i);
+		ws |= SSE2_BITS(vws, i);
+		ctrl |= SSE2_BITS(_mm_cmpeq_epi8(_mm_max_epu8(x, c1f), c1f), i);
+		ext |= SSE2_BITS(vext, i);
+	}
+
+	b->quote = quote;
+	b->bslash = bslash;
+	b->op = op;
+	b->ws = ws;
+	b->ctrl = ctrl;
+	b->ext = ext;
+}
+
+/* @func: _json_classify_avx2 (static)
+ * #desc:
+ *    avx2 stage 1 character classes.
+ *
+ * #1: b [out] character classes
+ * #2: p [in]  64-byte block
+ */
+__attribute__((target("avx2")))
+static void _json_classify_avx2(struct json_block *b, const uint8_t *p)
+{
+	const __m256i sp = _mm256_set1_epi8(0x20), c1f = _mm256_set1_epi8(0x1f);
+	uint64_t quote = 0, bslash = 0, op = 0, ws = 0, ctrl = 0, ext = 0;
+
+	for (int32_t i = 0; i < 64; i += 32) {
+		__m256i x = _mm256_loadu_si256((const __m256i *)(p + i));
+		__m256i u = _mm256_or_si256(x, sp);
+		__m256i vop = _mm256_or_si256(
+			_mm256_or_si256(
+				_mm256_cmpeq_epi8(u, _mm256_set1_epi8('{')),
+				_mm256_cmpeq_epi8(u, _mm256_set1_epi8('}'))),
+			_mm256_or_si256(
+				_mm256_cmpeq_epi8(x, _mm256_set1_epi8(':')),
+				_mm256_cmpeq_epi8(x, _mm256_set1_epi8(','))));
+		__m256i vws = _mm256_or_si256(
+			_mm256_or_si256(_mm256_cmpeq_epi8(x, sp),
+				_mm256_cmpeq_epi8(x, _mm256_set1_epi8('\t'))),
+			_mm256_or_si256(
+				_mm256_cmpeq_epi8(x, _mm256_set1_epi8('\n')),
+				_mm256_cmpeq_epi8(x, _mm256_set1_epi8('\r'))));
+		__m256i vext = _mm256_or_si256(
+			_mm256_cmpeq_epi8(x, _mm256_set1_epi8('\'')),
+			_mm256_cmpeq_epi8(x, _mm256_set1_epi8('/')));
+		__m256i vctrl = _mm256_cmpeq_epi8(_mm256_max_epu8(x, c1f), c1f);
+
+		quote |= AVX2_BITS(
+			_mm256_cmpeq_epi8(x, _mm256_set1_epi8('"')), i);
+		bslash |= AVX2_BITS(
+			_mm256_cmpeq_epi8(x, _mm256_set1_epi8('\\')), i);
+		op |= AVX2_BITS(vop, i);
+		ws |= AVX2_BITS(vws, i);
+		ctrl |= AVX2_BITS(vctrl, i);
+		ext |= AVX2_BITS(vext, i);
+	}
+
+	b->quote = quote;
+	b->bslash = bslash;
+	b->op = op;
+	b->ws = ws;
+	b->ctrl = ctrl;
+	b->ext = ext;
 }
 
-/* @func: _json_array (static)
+/* @func: _json_avx2 (static)
  * #desc:
- *    parse json array.
+ *    check the cpu (cpuid) and the os (xgetbv) for avx2 support.
+ *
+ * #r: [ret] 0: no, 1: yes
+ */
+static int32_t _json_avx2(void)
+{
+	uint32_t a, b, c, d;
+
+	__asm__ volatile ("cpuid"
+		: "=a" (a), "=b" (b), "=c" (c), "=d" (d)
+		: "a" (0), "c" (0));
+	if (a < 7)
+		return 0;
+
+	__asm__ volatile ("cpuid"
+		: "=a" (a), "=b" (b), "=c" (c), "=d" (d)
+		: "a" (1), "c" (0));
+	if (!(c & (1U << 27)) || !(c & (1U << 28))) /* osxsave, avx */
+		return 0;
+
+	__asm__ volatile ("xgetbv" : "=a" (a), "=d" (d) : "c" (0));
+	if ((a & 6) != 6) /* xmm and ymm state */
+		return 0;
+
+	__asm__ volatile ("cpuid"
+		: "=a" (a), "=b" (b), "=c" (c), "=d" (d)
+		: "a" (7), "c" (0));
+
+	return (b >> 5) & 1;
+}
+
+#elif (JSON_SIMD == JSON_SIMD_NEON)
+
+/* @func: _neon_bits (static)
+ * #desc:
+ *    four neon byte masks to a 64-bit mask.
+ *
+ * #1: v [in]  byte masks (0x00 or 0xff)
+ * #r:   [ret] one bit per byte
+ */
+static uint64_t _neon_bits(const uint8x16_t *v)
+{
+	static const uint8_t w[16] = {
+		1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128
+	};
+	uint8x16_t bit = vld1q_u8(w);
+	uint8x16_t s0 = vpaddq_u8(vandq_u8(v[0], bit), vandq_u8(v[1], bit));
+	uint8x16_t s1 = vpaddq_u8(vandq_u8(v[2], bit), vandq_u8(v[3], bit));
+
+	s0 = vpaddq_u8(s0, s1);
+	s0 = vpaddq_u8(s0, s0);
+
+	return vgetq_lane_u64(vreinterpretq_u64_u8(s0), 0);
+}
+
+/* @func: _json_classify_neon (static)
+ * #desc:
+ *    neon stage 1 character classes.
+ *
+ * #1: b [out] character classes
+ * #2: p [in]  64-byte block
+ */
+static void _json_classify_neon(struct json_block *b, const uint8_t *p)
+{
+	uint8x16_t quote[4], bslash[4], op[4], ws[4], ctrl[4], ext[4];
+
+	for (int32_t i = 0; i < 4; i++) {
+		uint8x16_t x = vld1q_u8(p + i * 16);
+		uint8x16_t u = vorrq_u8(x, vdupq_n_u8(0x20));
+		quote[i] = vceqq_u8(x, vdupq_n_u8('"'));
+		bslash[i] = vceqq_u8(x, vdupq_n_u8('\\'));
+		op[i] = vorrq_u8(
+			vorrq_u8(vceqq_u8(u, vdupq_n_u8('{')),
+				vceqq_u8(u, vdupq_n_u8('}'))),
+			vorrq_u8(vceqq_u8(x, vdupq_n_u8(':')),
+				vceqq_u8(x, vdupq_n_u8(','))));
+		ws[i] = vorrq_u8(
+			vorrq_u8(vceqq_u8(x, vdupq_n_u8(' ')),
+				vceqq_u8(x, vdupq_n_u8('\t'))),
+			vorrq_u8(vceqq_u8(x, vdupq_n_u8('\n')),
+				vceqq_u8(x, vdupq_n_u8('\r'))));
+		ctrl[i] = vcltq_u8(x, vdupq_n_u8(0x20));
+		ext[i] = vorrq_u8(vceqq_u8(x, vdupq_n_u8('\'')),
+			vceqq_u8(x, vdupq_n_u8('/')));
+	}
+
+	b->quote = _neon_bits(quote);
+	b->bslash = _neon_bits(bslash);
+	b->op = _neon_bits(op);
+	b->ws = _neon_bits(ws);
+	b->ctrl = _neon_bits(ctrl);
+	b->ext = _neon_bits(ext);
+}
+
+#endif /* JSON_SIMD */
+
+static void _json_classify_init(struct json_block *b, const uint8_t *p);
+
+/* resolved on the first call */
+static void (*_json_classify)(struct json_block *, const uint8_t *)
+	= _json_classify_init;
+
+/* @func: _json_classify_init (static)
+ * #desc:
+ *    select the stage 1 kernel for this cpu.
+ *
+ * #1: b [out] character classes
+ * #2: p [in]  64-byte block
+ */
+static void _json_classify_init(struct json_block *b, const uint8_t *p)
+{
+#if (JSON_SIMD == JSON_SIMD_SSE2)
+	_json_classify = _json_avx2() ? _json_classify_avx2
+		: _json_classify_sse2;
+#else
+	_json_classify = _json_classify_neon;
+#endif
+	_json_classify(b, p);
+}
+
+/* @func: _index_scalar (static)
+ * #desc:
+ *    plain json number or literal length, the bytes are the same ones
+ *    the byte lexer takes (other scalars go to the byte loop).
+ *
+ * #1: s [in]  scalar start
+ * #2: n [in]  input length
+ * #3: c [in]  first character
+ * #r:   [ret] scalar length (0: not plain)
+ */
+static int32_t _index_scalar(const char *s, int32_t n, char c)
+{
+	int32_t i = 0, k;
+
+	if (c == 't' || c == 'n') {
+		if (n < 4 || C_SYMBOL(memcmp)(s, (c == 't') ? "true" : "null",
+				4))
+			return 0;
+		i = 4;
+	} else if (c == 'f') {
+		if (n < 5 || C_SYMBOL(memcmp)(s, "false", 5))
+			return 0;
+		i = 5;
+	} else {
+		i = (c == '-');
+		for (k = i; i < n && s[i] >= '0' && s[i] <= '9'; i++);
+		if (i == k)
+			return 0;
+		if (i < n && s[i] == '.') {
+			for (i++; i < n && s[i] >= '0' && s[i] <= '9'; i++);
+		}
+		/* the lexer ends a one-character number before 'e' */
+		if (i > 1 && i < n && s[i] == 'e') {
+			i++;
+			if (i < n && (s[i] == '+' || s[i] == '-'))
+				i++;
+			for (; i < n && s[i] >= '0' && s[i] <= '9'; i++);
+		}
+	}
+
+	/* the next token must have its own event */
+	if (i == n)
+		return 0;
+	c = s[i];
+	if (SKIP_CHAR(c) || c == '"' || c == ',' || c == ':'
+			|| (c | 0x20) == '{' || (c | 0x20) == '}')
+		return i;
+
+	return 0;
+}
+
+/* @func: _json_index (static)
+ * #desc:
+ *    json parser driven by the stage 1 index, 64 bytes at a time.
+ *    structural characters, quotes and scalar starts outside strings
+ *    are the events, the bytes in between are never looked at. json5
+ *    (single quotes, comments) and control characters go to the byte
+ *    loop from the last token boundary.
  *
  * #1: ctx [in/out] json struct context
+ * #2: s   [in]     input buffer
+ * #3: len [in]     input length
  * #r:     [ret]    0: no error, -1: error, -2: call error
  */
-static int32_t _json_array(struct json_ctx *ctx)
+static int32_t _json_index(struct json_ctx *ctx, const char *s, int32_t len)
 {
-	int32_t st = 0, k = 0;
-	for (; *(ctx->str) != '\0'; ctx->str++, ctx->len++) {
-		char c = *(ctx->str);
-		if (SKIP_CHAR(c))
-			continue;
-		if (INVALID_CHAR(c)) {
-			ctx->err = JSON_ERR_INVALID;
-			return -1;
+	struct json_block b;
+	uint8_t pad[64];
+	uint64_t esc = 0, instr = 0, scalar = 0;
+	int32_t base = 0, open = 0, pos = 0, k = 0, i;
+
+	for (int32_t off = 0; off < len; off += 64) {
+		const uint8_t *p = (const uint8_t *)s + off;
+		uint64_t qu, in, sc, ev, bad;
+
+		if (len - off < 64) { /* blank padding */
+			C_SYMBOL(memset)(pad, ' ', sizeof(pad));
+			C_SYMBOL(memcpy)(pad, p, len - off);
+			p = pad;
 		}
+		_json_classify(&b, p);
 
-		switch (st) {
-			case 0: /* start */
-				if (ctx->call(JSON_ARRAY_TYPE,
-						NULL,
-						0,
-						ctx->arg))
-					return -2;
-				st = 1;
-				break;
-			case 1:
-				if (_json_token(c) == TOKEN_COMMENT) {
-					k = _json_comment(ctx);
-					if (k < 0) {
-						ctx->err = JSON_ERR_COMMENT;
-						return -1;
-					}
-					ctx->str--;
-					ctx->len--;
-					break;
-				}
+		/* strings: opening quote .. closing quote (exclusive) */
+		qu = b.quote & ~_json_escaped(b.bslash, &esc);
+		in = _prefix_xor(qu) ^ instr;
+		instr = (uint64_t)((int64_t)in >> 63);
+
+		sc = ~(b.op | b.ws | qu | in);
+		ev = (b.op & ~in) | qu | (sc & ~((sc << 1) | scalar));
+		scalar = sc >> 63;
 
-				switch (_json_token(c)) {
-					case TOKEN_STRING:
-						k = _json_string(ctx);
-						if (k < 0) {
-							ctx->err = JSON_ERR_ARRAY_STRING;
-							return -1;
-						}
-						if (ctx->call(JSON_STRING_TYPE,
-								ctx->str - k + 1,
-								k - 2,
-								ctx->arg))
-							return -2;
-						break;
-					case TOKEN_NUMBER:
-						k = _json_number(ctx);
-						if (k < 0) {
-							ctx->err = JSON_ERR_ARRAY_NUMBER;
-							return -1;
-						}
-						if (ctx->call(JSON_NUMBER_TYPE,
-								ctx->str - k,
-								k,
-								ctx->arg))
-							return -2;
-						break;
-					case TOKEN_NULL:
-						k = _json_null(ctx);
-						if (k < 0) {
-							ctx->err = JSON_ERR_ARRAY_TOKEN;
-							return -1;
-						}
-						if (ctx->call(JSON_NULL_TYPE,
-								NULL,
-								0,
-								ctx->arg))
-							return -2;
-						break;
-					case TOKEN_TRUE:
-						k = _json_true(ctx);
-						if (k < 0) {
-							ctx->err = JSON_ERR_ARRAY_TOKEN;
-							return -1;
-						}
-						if (ctx->call(JSON_TRUE_TYPE,
-								NULL,
-								0,
-								ctx->arg))
-							return -2;
-						break;
-					case TOKEN_FALSE:
-						k = _json_false(ctx);
-						if (k < 0) {
-							ctx->err = JSON_ERR_ARRAY_TOKEN;
-							return -1;
-						}
-						if (ctx->call(JSON_FALSE_TYPE,
-								NULL,
-								0,
-								ctx->arg))
-							return -2;
-						break;
-					case TOKEN_OBJECT: /* object */
-						k = _json_object(ctx);
-						if (k < 0)
-							return k;
-						break;
-					case TOKEN_ARRAY: /* array */
-						k = _json_array(ctx);
-						if (k < 0)
-							return k;
-						break;
-					case TOKEN_ARRAY_END: /* end */
-						if (ctx->call_end(JSON_ARRAY_TYPE,
-								ctx->arg))
-							return -2;
-						ctx->str++;
-						ctx->len++;
-						return 0;
-					default:
-						ctx->err = JSON_ERR_ARRAY_TOKEN;
-						return -1;
+		bad = (b.ext & ~in) | (b.ctrl & (in | ~b.ws));
+		if (bad)
+			ev &= (bad & -bad) - 1;
+
+		for (; ev; ev &= ev - 1) {
+			i = __builtin_ctzll(ev);
+			pos = off + i;
+
+			if ((qu >> i) & 1) {
+				if ((in >> i) & 1) { /* opening */
+					k = _feed_grammar(ctx, s[pos]);
+					if (k < 0)
+						goto e;
+					open = pos;
+				} else { /* closing */
+					k = _feed_emit(ctx, s + open,
+						pos + 1 - open);
+					if (k < 0)
+						goto e;
+					base = pos + 1;
 				}
-				ctx->str--;
-				ctx->len--;
-				st = 2;
-				break;
-			case 2: /* next or end */
-				switch (_json_token(c)) {
-					case TOKEN_COMMENT:
-						k = _json_comment(ctx);
-						if (k < 0) {
-							ctx->err = JSON_ERR_COMMENT;
-							return -1;
-						}
-						ctx->str--;
-						ctx->len--;
-						break;
-					case TOKEN_NEXT:
-						st = 1;
-						break;
-					case TOKEN_ARRAY_END:
-						if (ctx->call_end(JSON_ARRAY_TYPE,
-								ctx->arg))
-							return -2;
-						ctx->str++;
-						ctx->len++;
-						return 0;
-					default:
-						ctx->err = JSON_ERR_ARRAY_END;
-						return -1;
+				continue;
+			}
+
+			k = _feed_grammar(ctx, s[pos]);
+			if (k < 0)
+				goto e;
+			if (k) { /* structural */
+				base = pos + 1;
+				if (ctx->stack[0] == FEED_DONE) {
+					pos++;
+					k = 0;
+					goto e;
 				}
-				break;
-			default:
-				return -1;
+				continue;
+			}
+
+			/* scalar, plain json only */
+			i = _index_scalar(s + pos, len - pos, s[pos]);
+			if (!i)
+				goto r;
+			k = _feed_emit(ctx, s + pos, i);
+			if (k < 0)
+				goto e;
+			base = pos + i;
 		}
+		if (bad)
+			goto r;
 	}
 
-	return -1;
+r:
+	/* the rest by the byte loop */
+	ctx->lex = LEX_NONE;
+	ctx->len = base;
+	k = _json_feed(ctx, s + base, len - base, 0);
+	if (k)
+		return k;
+
+	return F_SYMBOL(json_finish)(ctx);
+
+e:
+	ctx->str = s + pos;
+	ctx->len = pos;
+
+	return k;
 }
 
+#endif /* JSON_SIMD != JSON_SIMD_SWAR */
+
 /* @func: json_parse
  * #desc:
  *    json (javascript object notation) parser.
@@ -770,39 +1385,16 @@ static int32_t _json_array(struct json_ctx *ctx)
  */
 int32_t F_SYMBOL(json_parse)(struct json_ctx *ctx, const char *s)
 {
-	ctx->str = s;
-	ctx->len = 0;
-	ctx->err = 0;
+	F_SYMBOL(json_feed_reset)(ctx);
 
-	int32_t k = 0;
-	for (; *(ctx->str) != '\0'; ctx->str++, ctx->len++) {
-		char c = *(ctx->str);
-		if (SKIP_CHAR(c))
-			continue;
-		if (INVALID_CHAR(c)) {
-			ctx->err = JSON_ERR_INVALID;
-			return -1;
-		}
+#if (JSON_SIMD == JSON_SIMD_SWAR)
+	/* word-at-a-time classes are slower than the byte loop */
+	int32_t k = _json_feed(ctx, s, (int32_t)C_SYMBOL(strlen)(s), 0);
+	if (k)
+		return k;
 
-		switch (_json_token(c)) {
-			case TOKEN_COMMENT:
-				k = _json_comment(ctx);
-				if (k < 0) {
-					ctx->err = JSON_ERR_COMMENT;
-					return -1;
-				}
-				ctx->str--;
-				ctx->len--;
-				break;
-			case TOKEN_OBJECT:
-				return _json_object(ctx);
-			case TOKEN_ARRAY:
-				return _json_array(ctx);
-			default:
-				ctx->err = JSON_ERR_START_TOKEN;
-				return -1;
-		}
-	}
-
-	return 0;
+	return F_SYMBOL(json_finish)(ctx);
+#else
+	return _json_index(ctx, s, (int32_t)C_SYMBOL(strlen)(s));
+#endif
 }
@@ -155,6 +155,221 @@ static int32_t _xml_token(const char *s)
 	return -1;
 }
 
+/* @func: _xml_utf8 (static)
+ * #desc:
+ *    code point to utf-8.
+ *
+ * #1: d [out] output buffer
+ * #2: u [in]  code point
+ * #r:   [ret] output length
+ */
+static int32_t _xml_utf8(char *d, uint32_t u)
+{
+	if (u < 0x80) {
+		d[0] = (char)u;
+		return 1;
+	} else if (u < 0x800) {
+		d[0] = (char)(0xc0 | (u >> 6));
+		d[1] = (char)(0x80 | (u & 0x3f));
+		return 2;
+	} else if (u < 0x10000) {
+		d[0] = (char)(0xe0 | (u >> 12));
+		d[1] = (char)(0x80 | ((u >> 6) & 0x3f));
+		d[2] = (char)(0x80 | (u & 0x3f));
+		return 3;
+	}
+	d[0] = (char)(0xf0 | (u >> 18));
+	d[1] = (char)(0x80 | ((u >> 12) & 0x3f));
+	d[2] = (char)(0x80 | ((u >> 6) & 0x3f));
+	d[3] = (char)(0x80 | (u & 0x3f));
+
+	return 4;
+}
+
+/* @func: _xml_reference (static)
+ * #desc:
+ *    decode a character reference ("&name;", "&#n;", "&#xh;").
+ *
+ * #1: d   [out] output buffer
+ * #2: s   [in]  reference (after '&')
+ * #3: len [in]  input length
+ * #4: n   [out] reference length (with ';')
+ * #r:     [ret] output length (-1: invalid reference)
+ */
+static int32_t _xml_reference(char *d, const char *s, int32_t len,
+		int32_t *n)
+{
+	uint32_t u = 0;
+	int32_t i = 0;
+
+	if (len > 0 && s[0] != '#') {
+		static const struct {
+			const char *name;
+			int32_t len;
+			char c;
+		} ent[] = {
+			{ "lt;", 3, '<' }, { "gt;", 3, '>' },
+			{ "amp;", 4, '&' }, { "apos;", 5, '\'' },
+			{ "quot;", 5, '"' }
+		};
+		for (i = 0; i < (int32_t)(sizeof(ent) / sizeof(ent[0])); i++) {
+			if (len >= ent[i].len && !C_SYMBOL(memcmp)(s,
+					ent[i].name, ent[i].len)) {
+				*d = ent[i].c;
+				*n = ent[i].len;
+				return 1;
+			}
+		}
+		return -1;
+	}
+
+	if (len > 1 && s[1] == 'x') { /* hexadecimal */
+		for (i = 2; i < len && i < 10; i++) {
+			char c = s[i];
+			if (c >= '0' && c <= '9') {
+				u = (u << 4) | (uint32_t)(c - '0');
+			} else if ((c | 0x20) >= 'a' && (c | 0x20) <= 'f') {
+				u = (u << 4)
+					| (uint32_t)((c | 0x20) - 'a' + 10);
+			} else {
+				break;
+			}
+		}
+		if (i == 2)
+			return -1;
+	} else { /* decimal */
+		for (i = 1; i < len && i < 9; i++) {
+			char c = s[i];
+			if (c < '0' || c > '9')
+				break;
+			u = u * 10 + (uint32_t)(c - '0');
+		}
+		if (i == 1)
+			return -1;
+	}
+
+	if (i == len || s[i] != ';')
+		return -1;
+	if (!u || u > 0x10ffff || (u >= 0xd800 && u <= 0xdfff))
+		return -1;
+	*n = i + 1;
+
+	return _xml_utf8(d, u);
+}
+
+/* @func: xml_decode
+ * #desc:
+ *    decode xml predefined and numeric character references (the output
+ *    is never longer than the input).
+ *
+ * #1: d   [out] output buffer (must not overlap the input)
+ * #2: s   [in]  input string
+ * #3: len [in]  input length
+ * #r:     [ret] output length (-1: invalid reference)
+ */
+int32_t F_SYMBOL(xml_decode)(char *d, const char *s, int32_t len)
+{
+	const char *e = s + len, *p;
+	char *d0 = d;
+
+	while (s < e) {
+		/* plain run */
+		p = C_SYMBOL(memchr)(s, '&', e - s);
+		if (!p)
+			p = e;
+		C_SYMBOL(memcpy)(d, s, p - s);
+		d += p - s;
+		if (p == e)
+			break;
+
+		int32_t n = 0, k = _xml_reference(d, p + 1,
+			(int32_t)(e - p - 1), &n);
+		if (k < 0)
+			return -1;
+		d += k;
+		s = p + 1 + n;
+	}
+
+	return (int32_t)(d - d0);
+}
+
+/* @func: _xml_call (static)
+ * #desc:
+ *    string callback (text and attribute values are decoded with
+ *    XML_OPT_DECODE).
+ *
+ * #1: ctx  [in/out] xml struct context
+ * #2: type [in]     event type
+ * #3: s    [in]     string
+ * #4: len  [in]     string length
+ * #r:      [ret]    0: no error, -1: error, -2: call error
+ */
+static int32_t _xml_call(struct xml_ctx *ctx, int32_t type, const char *s,
+		int32_t len)
+{
+	if ((ctx->opt & XML_OPT_DECODE) && (type == XML_ELEMENT_STRING
+			|| type == XML_ELEMENT_ATTR_VALUE
+			|| type == XML_STATEMENT_ATTR_VALUE)
+			&& C_SYMBOL(memchr)(s, '&', len)) {
+		if (len > ctx->dbuf_max) {
+			ctx->err = XML_ERR_TOKEN_SIZE;
+			return -1;
+		}
+		len = F_SYMBOL(xml_decode)(ctx->dbuf, s, len);
+		if (len < 0) {
+			ctx->err = XML_ERR_REFERENCE;
+			return -1;
+		}
+		s = ctx->dbuf;
+	}
+
+	return ctx->call(type, s, len, ctx->arg) ? -2 : 0;
+}
+
+/* @func: _xml_scan (static)
+ * #desc:
+ *    find either character, the first bytes inline (attribute values
+ *    are mostly short), the rest with memchr2.
+ *
+ * #1: s  [in]  input string
+ * #2: e  [in]  end of input
+ * #3: c1 [in]  character
+ * #4: c2 [in]  character
+ * #r:    [ret] target location / end of input
+ */
+static const char *_xml_scan(const char *s, const char *e, char c1, char c2)
+{
+	const char *t = (e - s > 16) ? s + 16 : e;
+
+	for (; s < t; s++) {
+		if (*s == c1 || *s == c2)
+			return s;
+	}
+	if (s == e)
+		return e;
+
+	t = C_SYMBOL(memchr2)(s, (uint8_t)c1, (uint8_t)c2, e - s);
+
+	return t ? t : e;
+}
+
+/* @func: _xml_ctrl (static)
+ * #desc:
+ *    check a plain run for control characters.
+ *
+ * #1: s   [in]  input string
+ * #2: len [in]  input length
+ * #r:     [ret] 0: none, 1: found
+ */
+static int32_t _xml_ctrl(const char *s, int32_t len)
+{
+	uint8_t m = 0;
+	for (int32_t i = 0; i < len; i++)
+		m |= INVALID_CHAR(s[i]);
+
+	return m;
+}
+
 /* @func: _xml_string (static)
  * #desc:
  *    get the length of the xml string.
@@ -164,8 +379,9 @@ static int32_t _xml_token(const char *s)
  */
 static int32_t _xml_string(struct xml_ctx *ctx)
 {
+	const char *p;
 	char cc;
-	int32_t st = 0, len = ctx->len;
+	int32_t st = 0, n = 0, len = ctx->len;
 	for (; *(ctx->str) != '\0'; ctx->str++, ctx->len++) {
 		char c = *(ctx->str);
 		switch (st) {
@@ -182,9 +398,16 @@ static int32_t _xml_string(struct xml_ctx *ctx)
 					return ctx->len - len;
 				} else if (c == '\\') { /* escape */
 					st = 2;
+					break;
 				}
-				if (INVALID_CHAR(c))
+
+				/* plain run, up to the quote or escape */
+				p = _xml_scan(ctx->str, ctx->end, cc, '\\');
+				n = (int32_t)(p - ctx->str);
+				if (_xml_ctrl(ctx->str, n))
 					return -1;
+				ctx->str += n - 1;
+				ctx->len += n - 1;
 				break;
 			case 2: /* escape */
 				st = 1;
@@ -206,7 +429,8 @@ static int32_t _xml_string(struct xml_ctx *ctx)
  */
 static int32_t _xml_comment(struct xml_ctx *ctx)
 {
-	int32_t st = 0, len = ctx->len;
+	const char *p;
+	int32_t st = 0, n = 0, len = ctx->len;
 	for (; *(ctx->str) != '\0'; ctx->str++, ctx->len++) {
 		char c = *(ctx->str);
 		switch (st) {
@@ -216,8 +440,15 @@ static int32_t _xml_comment(struct xml_ctx *ctx)
 				st = 1;
 				break;
 			case 1: /* end */
-				if (c != '-')
+				if (c != '-') { /* skip to the next '-' */
+					p = C_SYMBOL(memchr)(ctx->str, '-',
+						ctx->end - ctx->str);
+					p = p ? p : ctx->end;
+					n = (int32_t)(p - ctx->str);
+					ctx->str += n - 1;
+					ctx->len += n - 1;
 					break;
+				}
 				if (C_SYMBOL(strncmp)("-->", ctx->str, 3))
 					break;
 
@@ -241,7 +472,8 @@ static int32_t _xml_comment(struct xml_ctx *ctx)
  */
 static int32_t _xml_cdata(struct xml_ctx *ctx)
 {
-	int32_t st = 0, len = ctx->len;
+	const char *p;
+	int32_t st = 0, n = 0, len = ctx->len;
 	for (; *(ctx->str) != '\0'; ctx->str++, ctx->len++) {
 		char c = *(ctx->str);
 		switch (st) {
@@ -251,8 +483,15 @@ static int32_t _xml_cdata(struct xml_ctx *ctx)
 				st = 1;
 				break;
 			case 1: /* end */
-				if (c != ']')
+				if (c != ']') { /* skip to the next ']' */
+					p = C_SYMBOL(memchr)(ctx->str, ']',
+						ctx->end - ctx->str);
+					p = p ? p : ctx->end;
+					n = (int32_t)(p - ctx->str);
+					ctx->str += n - 1;
+					ctx->len += n - 1;
 					break;
+				}
 				if (C_SYMBOL(strncmp)("]]>", ctx->str, 3))
 					break;
 
@@ -290,6 +529,8 @@ static int32_t _xml_statement_attr(struct xml_ctx *ctx)
 					ctx->len += 2;
 					return 0;
 				}
+				if (c == '?' && !ctx->str[1]) /* cut "?>" */
+					break;
 
 				/* invalid character */
 				if (xml_name_table[(uint8_t)c]) {
@@ -301,7 +542,8 @@ static int32_t _xml_statement_attr(struct xml_ctx *ctx)
 					case '0': case '1': case '2': case '3':
 					case '4': case '5': case '6': case '7':
 					case '8': case '9':
-						ctx->err = XML_ERR_STATEMENT_ATTR_CHAR;
+						ctx->err =
+						XML_ERR_STATEMENT_ATTR_CHAR;
 						return -1;
 					default:
 						break;
@@ -333,11 +575,11 @@ static int32_t _xml_statement_attr(struct xml_ctx *ctx)
 					ctx->err = XML_ERR_STATEMENT_ATTR_VALUE;
 					return -1;
 				}
-				if (ctx->call(XML_STATEMENT_ATTR_VALUE,
-						ctx->str - k + 1,
-						k - 2,
-						ctx->arg))
-					return -2;
+				k = _xml_call(ctx, XML_STATEMENT_ATTR_VALUE,
+					ctx->str - k + 1,
+					k - 2);
+				if (k < 0)
+					return k;
 
 				/* next */
 				ctx->str--;
@@ -380,6 +622,8 @@ static int32_t _xml_statement(struct xml_ctx *ctx)
 					ctx->len += 2;
 					return 0;
 				}
+				if (c == '?' && !ctx->str[1]) /* cut "?>" */
+					break;
 
 				/* invalid character */
 				if (xml_name_table[(uint8_t)c]) {
@@ -426,6 +670,8 @@ static int32_t _xml_statement(struct xml_ctx *ctx)
 					ctx->len += 2;
 					return 0;
 				}
+				if (c == '?' && !ctx->str[1]) /* cut "?>" */
+					break;
 
 				/* invalid character */
 				if (xml_name_table[(uint8_t)c]) {
@@ -668,11 +914,11 @@ static int32_t _xml_element_attr(struct xml_ctx *ctx)
 					ctx->err = XML_ERR_ELEMENT_ATTR_VALUE;
 					return -1;
 				}
-				if (ctx->call(XML_ELEMENT_ATTR_VALUE,
-						ctx->str - k + 1,
-						k - 2,
-						ctx->arg))
-					return -2;
+				k = _xml_call(ctx, XML_ELEMENT_ATTR_VALUE,
+					ctx->str - k + 1,
+					k - 2);
+				if (k < 0)
+					return k;
 
 				/* next */
 				ctx->str--;
@@ -811,6 +1057,7 @@ static int32_t _xml_element_start(struct xml_ctx *ctx)
  */
 static int32_t _xml_element_end(struct xml_ctx *ctx)
 {
+	const char *name = NULL;
 	int32_t st = 0, len = 0;
 	for (; *(ctx->str) != '\0'; ctx->str++, ctx->len++) {
 		char c = *(ctx->str);
@@ -847,6 +1094,7 @@ static int32_t _xml_element_end(struct xml_ctx *ctx)
 				break;
 			case 3: /* name or end */
 				if (SKIP_CHAR(c)) { /* end */
+					name = ctx->str - len;
 					st = 4;
 					break;
 				}
@@ -881,7 +1129,7 @@ static int32_t _xml_element_end(struct xml_ctx *ctx)
 
 				/* end */
 				if (ctx->call_end(XML_ELEMENT_END,
-						ctx->str - len,
+						name,
 						len,
 						ctx->arg))
 					return -2;
@@ -905,7 +1153,8 @@ static int32_t _xml_element_end(struct xml_ctx *ctx)
  */
 static int32_t _xml_element(struct xml_ctx *ctx)
 {
-	int32_t st = 0, k = 0, len = 0;
+	const char *p;
+	int32_t st = 0, k = 0, n = 0, len = 0;
 	for (; *(ctx->str) != '\0'; ctx->str++, ctx->len++) {
 		char c = *(ctx->str);
 		switch (st) {
@@ -928,17 +1177,23 @@ static int32_t _xml_element(struct xml_ctx *ctx)
 				st = 1;
 				break;
 			case 1: /* element */
-				if (c != '<') {
-					len++;
+				if (c != '<') { /* text, up to the next tag */
+					p = C_SYMBOL(memchr)(ctx->str, '<',
+						ctx->end - ctx->str);
+					p = p ? p : ctx->end;
+					n = (int32_t)(p - ctx->str);
+					len += n;
+					ctx->str += n - 1;
+					ctx->len += n - 1;
 					break;
 				}
 
 				/* string */
-				if (ctx->call(XML_ELEMENT_STRING,
-						ctx->str - len,
-						len,
-						ctx->arg))
-					return -2;
+				k = _xml_call(ctx, XML_ELEMENT_STRING,
+					ctx->str - len,
+					len);
+				if (k < 0)
+					return k;
 
 				/* embed */
 				switch (_xml_token(ctx->str)) {
@@ -989,20 +1244,44 @@ static int32_t _xml_element(struct xml_ctx *ctx)
 	return -1;
 }
 
-/* @func: xml_parse
+/* @func: _xml_partial (static)
  * #desc:
- *    xml (extensible markup language) parser.
+ *    the rest of the input is the start of a markup token.
+ *
+ * #1: s [in]  token start ('<')
+ * #2: e [in]  end of the input
+ * #r:   [ret] 1: cut token, 0: not
+ */
+static int32_t _xml_partial(const char *s, const char *e)
+{
+	static const char *const keys[] = {
+		"<!--", "<![CDATA[", "<!DOCTYPE"
+	};
+	size_t n = (size_t)(e - s);
+
+	for (size_t i = 0; i < sizeof(keys) / sizeof(keys[0]); i++) {
+		if (n <= C_SYMBOL(strlen)(keys[i])
+				&& !C_SYMBOL(strncmp)(keys[i], s, n))
+			return 1;
+	}
+
+	/* "<", "</" and blanks */
+	for (s++; s < e && SKIP_CHAR(*s); s++);
+	if (s < e && *s == '/')
+		for (s++; s < e && SKIP_CHAR(*s); s++);
+
+	return s == e;
+}
+
+/* @func: _xml_document (static)
+ * #desc:
+ *    parsing xml document.
  *
  * #1: ctx [in/out] xml struct context
- * #2: s   [in]     input buffer
  * #r:     [ret]    0: no error, -1: error, -2: call error
  */
-int32_t F_SYMBOL(xml_parse)(struct xml_ctx *ctx, const char *s)
+static int32_t _xml_document(struct xml_ctx *ctx)
 {
-	ctx->str = s;
-	ctx->len = 0;
-	ctx->err = 0;
-
 	int32_t k = 0;
 	for (; *(ctx->str) != '\0'; ctx->str++, ctx->len++) {
 		char c = *(ctx->str);
@@ -1049,3 +1328,727 @@ int32_t F_SYMBOL(xml_parse)(struct xml_ctx *ctx, const char *s)
 
 	return 0;
 }
+
+/* @func: xml_parse
+ * #desc:
+ *    xml (extensible markup language) parser, input that ends inside
+ *    a token or an element is XML_ERR_INCOMPLETE (as xml_finish).
+ *
+ * #1: ctx [in/out] xml struct context
+ * #2: s   [in]     input buffer
+ * #r:     [ret]    0: no error, -1: error, -2: call error
+ */
+int32_t F_SYMBOL(xml_parse)(struct xml_ctx *ctx, const char *s)
+{
+	ctx->str = s;
+	ctx->end = s + C_SYMBOL(strlen)(s);
+	ctx->len = 0;
+	ctx->err = 0;
+
+	int32_t k = _xml_document(ctx);
+	if (k == -1 && (ctx->str >= ctx->end || (ctx->err == XML_ERR_TOKEN
+			&& _xml_partial(ctx->str, ctx->end))))
+		ctx->err = XML_ERR_INCOMPLETE;
+
+	return k;
+}
+
+/* @def: _
+ * xml_feed states, the token states (FEED_PI_NAME and after) keep the
+ * start of a split token in the token buffer.
+ */
+enum {
+	FEED_TOP = 0,
+	FEED_LT, /* "<" */
+	FEED_LT_BLANK, /* "< " */
+	FEED_BANG, /* "<!" keyword */
+	FEED_PI, /* "<?" */
+	FEED_PI_Q, /* "<??" */
+	FEED_PI_ATTR,
+	FEED_PI_ATTR_Q,
+	FEED_PI_ATTR_VALUE,
+	FEED_DT_SEP, /* "<!DOCTYPE" */
+	FEED_DT,
+	FEED_DT_NEXT,
+	FEED_EL,
+	FEED_EL_ATTR,
+	FEED_EL_ATTR_VALUE,
+	FEED_EL_EMPTY,
+	FEED_END, /* "</" */
+	FEED_END_BLANK, /* name in the token buffer */
+	FEED_PI_NAME,
+	FEED_PI_NAME_Q,
+	FEED_PI_ATTR_NAME,
+	FEED_PI_ATTR_STRING,
+	FEED_DT_NAME,
+	FEED_DT_STRING,
+	FEED_EL_NAME,
+	FEED_EL_ATTR_NAME,
+	FEED_EL_ATTR_STRING,
+	FEED_END_NAME,
+	FEED_COMMENT,
+	FEED_CDATA,
+	FEED_TEXT
+};
+
+#define FEED_ESCAPE 0x100
+
+#define NAME_START(x) (!xml_name_table[(uint8_t)(x)] \
+	&& !((x) >= '0' && (x) <= '9') \
+	&& (x) != '-' && (x) != '.' && (x) != ':')
+/* end */
+
+/* @func: _feed_save (static)
+ * #desc:
+ *    append a token piece to the token buffer.
+ *
+ * #1: ctx [in/out] xml struct context
+ * #2: s   [in]     token piece
+ * #3: len [in]     piece length
+ * #r:     [ret]    0: no error, -1: token buffer is full
+ */
+static int32_t _feed_save(struct xml_ctx *ctx, const char *s, int32_t len)
+{
+	if (len > ctx->tok_max - ctx->tok_len) {
+		ctx->err = XML_ERR_TOKEN_SIZE;
+		return -1;
+	}
+
+	C_SYMBOL(memcpy)(ctx->tok + ctx->tok_len, s, len);
+	ctx->tok_len += len;
+
+	return 0;
+}
+
+/* @func: _feed_emit (static)
+ * #desc:
+ *    token callback, from the token buffer if the token was split.
+ *
+ * #1: ctx  [in/out] xml struct context
+ * #2: type [in]     event type
+ * #3: s    [in]     token (or the rest of it)
+ * #4: len  [in]     token length
+ * #5: trim [in]     trailing bytes to drop
+ * #r:      [ret]    0: no error, -1: error, -2: call error
+ */
+static int32_t _feed_emit(struct xml_ctx *ctx, int32_t type, const char *s,
+		int32_t len, int32_t trim)
+{
+	if (ctx->tok_len) {
+		if (_feed_save(ctx, s, len))
+			return -1;
+		s = ctx->tok;
+		len = ctx->tok_len;
+		ctx->tok_len = 0;
+	}
+
+	if (type == XML_ELEMENT_END)
+		return ctx->call_end(type, s, len - trim, ctx->arg) ? -2 : 0;
+
+	return _xml_call(ctx, type, s, len - trim);
+}
+
+/* @func: _feed_event (static)
+ * #desc:
+ *    callback without a string.
+ *
+ * #1: ctx  [in/out] xml struct context
+ * #2: type [in]     event type
+ * #r:      [ret]    0: no error, -2: call error
+ */
+static int32_t _feed_event(struct xml_ctx *ctx, int32_t type)
+{
+	if (type == XML_DOCTYPE_START || type == XML_ELEMENT_HEAD)
+		return ctx->call(type, NULL, 0, ctx->arg) ? -2 : 0;
+
+	return ctx->call_end(type, NULL, 0, ctx->arg) ? -2 : 0;
+}
+
+/* @func: _feed_quote (static)
+ * #desc:
+ *    quoted string byte (ctx->sub: quote and escape flag).
+ *
+ * #1: ctx [in/out] xml struct context
+ * #2: c   [in]     input byte
+ * #r:     [ret]    1: string end, 0: more, -1: invalid character
+ */
+static int32_t _feed_quote(struct xml_ctx *ctx, char c)
+{
+	if (ctx->sub & FEED_ESCAPE) {
+		ctx->sub &= ~FEED_ESCAPE;
+		return 0;
+	}
+	if (c == ctx->sub)
+		return 1;
+	if (c == '\\')
+		ctx->sub |= FEED_ESCAPE;
+	if (INVALID_CHAR(c))
+		return -1;
+
+	return 0;
+}
+
+/* @func: xml_feed_reset
+ * #desc:
+ *    xml_feed state initialization (keeps callbacks and buffers).
+ *
+ * #1: ctx [in/out] xml struct context
+ */
+void F_SYMBOL(xml_feed_reset)(struct xml_ctx *ctx)
+{
+	ctx->str = NULL;
+	ctx->len = 0;
+	ctx->err = 0;
+	ctx->depth = 0;
+	ctx->state = FEED_TOP;
+	ctx->sub = 0;
+	ctx->kw = NULL;
+	ctx->tok_len = 0;
+}
+
+/* @func: xml_feed
+ * #desc:
+ *    incremental xml parser, the input may end anywhere (even inside
+ *    a tag, comment or CDATA block). the events are the same as
+ *    xml_parse, tokens inside one feed are passed in place, split
+ *    tokens are passed from the token buffer (XML_FEED_INIT).
+ *
+ * #1: ctx [in/out] xml struct context
+ * #2: s   [in]     input buffer (no null terminator needed)
+ * #3: len [in]     input length
+ * #r:     [ret]    0: no error, -1: error, -2: call error
+ */
+int32_t F_SYMBOL(xml_feed)(struct xml_ctx *ctx, const char *s, int32_t len)
+{
+	int32_t i = 0, t = 0, k = 0;
+	const char *p;
+
+	for (; i < len; i++) {
+		/* plain runs */
+		switch (ctx->state) {
+			case FEED_TEXT:
+				p = C_SYMBOL(memchr)(s + i, '<', len - i);
+				i = p ? (int32_t)(p - s) : len;
+				break;
+			case FEED_COMMENT:
+			case FEED_CDATA:
+				if (ctx->sub)
+					break;
+				p = C_SYMBOL(memchr)(s + i,
+					ctx->state == FEED_COMMENT ? '-' : ']',
+					len - i);
+				i = p ? (int32_t)(p - s) : len;
+				break;
+			case FEED_PI_NAME:
+			case FEED_PI_ATTR_NAME:
+			case FEED_DT_NAME:
+			case FEED_EL_NAME:
+			case FEED_EL_ATTR_NAME:
+			case FEED_END_NAME:
+				for (; i < len; i++) {
+					if (xml_name_table[(uint8_t)s[i]])
+						break;
+				}
+				break;
+			case FEED_PI_ATTR_STRING:
+			case FEED_DT_STRING:
+			case FEED_EL_ATTR_STRING:
+				if (ctx->sub & FEED_ESCAPE)
+					break;
+				for (; i < len; i++) {
+					if (s[i] == ctx->sub || s[i] == '\\'
+							|| INVALID_CHAR(s[i]))
+						break;
+				}
+				break;
+			default:
+				break;
+		}
+		if (i == len)
+			break;
+
+		char c = s[i];
+		switch (ctx->state) {
+			case FEED_TOP:
+				if (SKIP_CHAR(c))
+					break;
+				if (c != '<') {
+					ctx->err = XML_ERR_TOKEN;
+					k = -1;
+					goto e;
+				}
+				ctx->state = FEED_LT;
+				break;
+			case FEED_LT:
+				if (c == '!') {
+					ctx->kw = NULL;
+					ctx->state = FEED_BANG;
+				} else if (c == '?' && !ctx->depth) {
+					ctx->state = FEED_PI;
+				} else if (c == '/' && ctx->depth) {
+					ctx->state = FEED_END;
+				} else if (SKIP_CHAR(c)) {
+					ctx->state = FEED_LT_BLANK;
+				} else if (xml_name_table[(uint8_t)c]) {
+					ctx->err = XML_ERR_TOKEN;
+					k = -1;
+					goto e;
+				} else { /* element name */
+					ctx->state = FEED_EL;
+					i--;
+				}
+				break;
+			case FEED_LT_BLANK:
+				if (SKIP_CHAR(c))
+					break;
+				if (c == '/' && !ctx->depth) {
+					ctx->err = XML_ERR_TOKEN;
+					k = -1;
+					goto e;
+				}
+				if (c == '/') {
+					ctx->state = FEED_END;
+				} else {
+					ctx->state = FEED_EL;
+					i--;
+				}
+				break;
+			case FEED_BANG: /* "--", "DOCTYPE" or "[CDATA[" */
+				if (!ctx->kw) {
+					ctx->kw = (c == '-') ? "--" : (c == 'D')
+						? "DOCTYPE" : "[CDATA[";
+					ctx->sub = 0;
+				}
+				if (c != ctx->kw[ctx->sub]) {
+					ctx->err = XML_ERR_TOKEN;
+					k = -1;
+					goto e;
+				}
+				if (ctx->kw[++ctx->sub])
+					break;
+
+				ctx->sub = 0;
+				if (ctx->kw[0] == '-') {
+					ctx->state = FEED_COMMENT;
+				} else if (ctx->kw[0] == 'D' && !ctx->depth) {
+					ctx->state = FEED_DT_SEP;
+				} else if (ctx->kw[0] == '[' && ctx->depth) {
+					ctx->state = FEED_CDATA;
+				} else {
+					ctx->err = XML_ERR_TOKEN;
+					k = -1;
+					goto e;
+				}
+				t = i + 1;
+				break;
+			case FEED_COMMENT:
+			case FEED_CDATA:
+				if (c == ((ctx->state == FEED_COMMENT)
+						? '-' : ']')) {
+					ctx->sub++;
+					break;
+				}
+				if (c != '>' || ctx->sub < 2) {
+					ctx->sub = 0;
+					break;
+				}
+
+				/* "-->" or "]]>" */
+				k = _feed_emit(ctx, (ctx->state == FEED_COMMENT)
+					? XML_COMMENT : XML_CDATA,
+					s + t, i - t, 2);
+				if (k < 0)
+					goto e;
+				ctx->sub = 0;
+				ctx->state = ctx->depth ? FEED_TEXT : FEED_TOP;
+				t = i + 1;
+				break;
+			case FEED_PI: /* name start or end */
+				if (SKIP_CHAR(c))
+					break;
+				if (c == '?') {
+					ctx->state = FEED_PI_Q;
+					break;
+				}
+				if (!NAME_START(c)) {
+					ctx->err = XML_ERR_STATEMENT_CHAR;
+					k = -1;
+					goto e;
+				}
+				t = i;
+				ctx->state = FEED_PI_NAME;
+				break;
+			case FEED_PI_Q:
+				if (c != '>') {
+					ctx->err = XML_ERR_STATEMENT_CHAR;
+					k = -1;
+					goto e;
+				}
+				ctx->state = FEED_TOP;
+				break;
+			case FEED_PI_NAME: /* name, attribute or end */
+				if (SKIP_CHAR(c)) {
+					k = _feed_emit(ctx, XML_STATEMENT_START,
+						s + t, i - t, 0);
+					if (k < 0)
+						goto e;
+					ctx->state = FEED_PI_ATTR;
+					break;
+				}
+				if (c == '?') {
+					ctx->state = FEED_PI_NAME_Q;
+					break;
+				}
+				ctx->err = XML_ERR_STATEMENT_CHAR;
+				k = -1;
+				goto e;
+			case FEED_PI_NAME_Q:
+				if (c != '>') {
+					ctx->err = XML_ERR_STATEMENT_CHAR;
+					k = -1;
+					goto e;
+				}
+				k = _feed_emit(ctx, XML_STATEMENT_START,
+					s + t, i - t, 1);
+				if (k < 0)
+					goto e;
+				k = _feed_event(ctx, XML_STATEMENT_END);
+				if (k < 0)
+					goto e;
+				ctx->state = FEED_TOP;
+				break;
+			case FEED_PI_ATTR: /* attribute name start or end */
+				if (SKIP_CHAR(c))
+					break;
+				if (c == '?') {
+					ctx->state = FEED_PI_ATTR_Q;
+					break;
+				}
+				if (!NAME_START(c)) {
+					ctx->err = XML_ERR_STATEMENT_ATTR_CHAR;
+					k = -1;
+					goto e;
+				}
+				t = i;
+				ctx->state = FEED_PI_ATTR_NAME;
+				break;
+			case FEED_PI_ATTR_Q:
+				if (c != '>') {
+					ctx->err = XML_ERR_STATEMENT_ATTR_CHAR;
+					k = -1;
+					goto e;
+				}
+				k = _feed_event(ctx, XML_STATEMENT_END);
+				if (k < 0)
+					goto e;
+				ctx->state = FEED_TOP;
+				break;
+			case FEED_PI_ATTR_NAME:
+				if (c != '=') {
+					ctx->err = XML_ERR_STATEMENT_ATTR_CHAR;
+					k = -1;
+					goto e;
+				}
+				k = _feed_emit(ctx, XML_STATEMENT_ATTR_NAME,
+					s + t, i - t, 0);
+				if (k < 0)
+					goto e;
+				ctx->state = FEED_PI_ATTR_VALUE;
+				break;
+			case FEED_PI_ATTR_VALUE:
+				if (c != '"' && c != '\'') {
+					ctx->err = XML_ERR_STATEMENT_ATTR_VALUE;
+					k = -1;
+					goto e;
+				}
+				ctx->sub = c;
+				t = i + 1;
+				ctx->state = FEED_PI_ATTR_STRING;
+				break;
+			case FEED_PI_ATTR_STRING:
+				k = _feed_quote(ctx, c);
+				if (k < 0) {
+					ctx->err = XML_ERR_STATEMENT_ATTR_VALUE;
+					goto e;
+				}
+				if (!k)
+					break;
+				k = _feed_emit(ctx, XML_STATEMENT_ATTR_VALUE,
+					s + t, i - t, 0);
+				if (k < 0)
+					goto e;
+				ctx->state = FEED_PI_ATTR;
+				break;
+			case FEED_DT_SEP: /* end or blank */
+				if (c != '>' && !SKIP_CHAR(c)) {
+					ctx->err = XML_ERR_TOKEN;
+					k = -1;
+					goto e;
+				}
+				k = _feed_event(ctx, XML_DOCTYPE_START);
+				if (k < 0)
+					goto e;
+				if (c == '>') {
+					k = _feed_event(ctx, XML_DOCTYPE_END);
+					if (k < 0)
+						goto e;
+					ctx->state = FEED_TOP;
+					break;
+				}
+				ctx->state = FEED_DT;
+				break;
+			case FEED_DT: /* name start, string or end */
+				if (SKIP_CHAR(c))
+					break;
+				if (c == '>') {
+					k = _feed_event(ctx, XML_DOCTYPE_END);
+					if (k < 0)
+						goto e;
+					ctx->state = FEED_TOP;
+					break;
+				}
+				if (c == '"' || c == '\'') {
+					ctx->sub = c;
+					t = i + 1;
+					ctx->state = FEED_DT_STRING;
+					break;
+				}
+				if (!NAME_START(c)) {
+					ctx->err = XML_ERR_DOCTYPE_CHAR;
+					k = -1;
+					goto e;
+				}
+				t = i;
+				ctx->state = FEED_DT_NAME;
+				break;
+			case FEED_DT_NAME: /* name, next or end */
+				if (!SKIP_CHAR(c) && c != '>') {
+					ctx->err = XML_ERR_DOCTYPE_CHAR;
+					k = -1;
+					goto e;
+				}
+				k = _feed_emit(ctx, XML_DOCTYPE_NAME,
+					s + t, i - t, 0);
+				if (k < 0)
+					goto e;
+				ctx->state = FEED_DT_NEXT;
+				if (c == '>')
+					i--;
+				break;
+			case FEED_DT_STRING:
+				k = _feed_quote(ctx, c);
+				if (k < 0) {
+					ctx->err = XML_ERR_DOCTYPE_STRING;
+					goto e;
+				}
+				if (!k)
+					break;
+				k = _feed_emit(ctx, XML_DOCTYPE_STRING,
+					s + t, i - t, 0);
+				if (k < 0)
+					goto e;
+				ctx->state = FEED_DT_NEXT;
+				break;
+			case FEED_DT_NEXT: /* next or end */
+				if (SKIP_CHAR(c))
+					break;
+				if (c == '>') {
+					k = _feed_event(ctx, XML_DOCTYPE_END);
+					if (k < 0)
+						goto e;
+					ctx->state = FEED_TOP;
+					break;
+				}
+				ctx->state = FEED_DT;
+				i--;
+				break;
+			case FEED_EL: /* name start */
+				if (SKIP_CHAR(c))
+					break;
+				if (!NAME_START(c)) {
+					ctx->err = XML_ERR_ELEMENT_CHAR;
+					k = -1;
+					goto e;
+				}
+				t = i;
+				ctx->state = FEED_EL_NAME;
+				break;
+			case FEED_EL_NAME: /* name, attribute, empty or end */
+				if (!SKIP_CHAR(c) && c != '>' && c != '/') {
+					ctx->err = XML_ERR_ELEMENT_CHAR;
+					k = -1;
+					goto e;
+				}
+				k = _feed_emit(ctx, XML_ELEMENT_START,
+					s + t, i - t, 0);
+				if (k < 0)
+					goto e;
+				ctx->state = FEED_EL_ATTR;
+				if (!SKIP_CHAR(c))
+					i--;
+				break;
+			case FEED_EL_ATTR: /* attribute name, empty or end */
+				if (SKIP_CHAR(c))
+					break;
+				if (c == '>') {
+					k = _feed_event(ctx, XML_ELEMENT_HEAD);
+					if (k < 0)
+						goto e;
+					ctx->depth++;
+					ctx->state = FEED_TEXT;
+					t = i + 1;
+					break;
+				}
+				if (c == '/') {
+					ctx->state = FEED_EL_EMPTY;
+					break;
+				}
+				if (!NAME_START(c)) {
+					ctx->err = XML_ERR_ELEMENT_ATTR_CHAR;
+					k = -1;
+					goto e;
+				}
+				t = i;
+				ctx->state = FEED_EL_ATTR_NAME;
+				break;
+			case FEED_EL_ATTR_NAME:
+				if (c != '=') {
+					ctx->err = XML_ERR_ELEMENT_ATTR_CHAR;
+					k = -1;
+					goto e;
+				}
+				k = _feed_emit(ctx, XML_ELEMENT_ATTR_NAME,
+					s + t, i - t, 0);
+				if (k < 0)
+					goto e;
+				ctx->state = FEED_EL_ATTR_VALUE;
+				break;
+			case FEED_EL_ATTR_VALUE:
+				if (c != '"' && c != '\'') {
+					ctx->err = XML_ERR_ELEMENT_ATTR_VALUE;
+					k = -1;
+					goto e;
+				}
+				ctx->sub = c;
+				t = i + 1;
+				ctx->state = FEED_EL_ATTR_STRING;
+				break;
+			case FEED_EL_ATTR_STRING:
+				k = _feed_quote(ctx, c);
+				if (k < 0) {
+					ctx->err = XML_ERR_ELEMENT_ATTR_VALUE;
+					goto e;
+				}
+				if (!k)
+					break;
+				k = _feed_emit(ctx, XML_ELEMENT_ATTR_VALUE,
+					s + t, i - t, 0);
+				if (k < 0)
+					goto e;
+				ctx->state = FEED_EL_ATTR;
+				break;
+			case FEED_EL_EMPTY: /* empty element end */
+				if (SKIP_CHAR(c))
+					break;
+				if (c != '>') {
+					ctx->err = XML_ERR_ELEMENT_EMPTY_END;
+					k = -1;
+					goto e;
+				}
+				k = _feed_event(ctx, XML_ELEMENT_EMPTY_END);
+				if (k < 0)
+					goto e;
+				ctx->state = ctx->depth ? FEED_TEXT : FEED_TOP;
+				t = i + 1;
+				break;
+			case FEED_END: /* name start */
+				if (SKIP_CHAR(c))
+					break;
+				if (!NAME_START(c)) {
+					ctx->err = XML_ERR_ELEMENT_END_CHAR;
+					k = -1;
+					goto e;
+				}
+				t = i;
+				ctx->state = FEED_END_NAME;
+				break;
+			case FEED_END_NAME: /* name or end */
+				if (SKIP_CHAR(c)) { /* the name waits for '>' */
+					k = _feed_save(ctx, s + t, i - t);
+					if (k < 0)
+						goto e;
+					ctx->state = FEED_END_BLANK;
+					break;
+				}
+				if (c != '>') {
+					ctx->err = XML_ERR_ELEMENT_END_CHAR;
+					k = -1;
+					goto e;
+				}
+				k = _feed_emit(ctx, XML_ELEMENT_END,
+					s + t, i - t, 0);
+				if (k < 0)
+					goto e;
+				ctx->depth--;
+				ctx->state = ctx->depth ? FEED_TEXT : FEED_TOP;
+				t = i + 1;
+				break;
+			case FEED_END_BLANK:
+				if (SKIP_CHAR(c))
+					break;
+				if (c != '>') {
+					ctx->err = XML_ERR_ELEMENT_END_CHAR;
+					k = -1;
+					goto e;
+				}
+				k = _feed_emit(ctx, XML_ELEMENT_END,
+					s + i, 0, 0);
+				if (k < 0)
+					goto e;
+				ctx->depth--;
+				ctx->state = ctx->depth ? FEED_TEXT : FEED_TOP;
+				t = i + 1;
+				break;
+			case FEED_TEXT: /* '<' */
+				k = _feed_emit(ctx, XML_ELEMENT_STRING,
+					s + t, i - t, 0);
+				if (k < 0)
+					goto e;
+				ctx->state = FEED_LT;
+				break;
+			default:
+				k = -1;
+				goto e;
+		}
+	}
+
+	/* keep the start of a split token */
+	k = 0;
+	if (ctx->state >= FEED_PI_NAME)
+		k = _feed_save(ctx, s + t, i - t);
+
+e:
+	ctx->str = s + i;
+	ctx->len += i;
+
+	return k;
+}
+
+/* @func: xml_finish
+ * #desc:
+ *    end of xml_feed input.
+ *
+ * #1: ctx [in/out] xml struct context
+ * #r:     [ret]    0: no error, -1: error
+ */
+int32_t F_SYMBOL(xml_finish)(struct xml_ctx *ctx)
+{
+	if (ctx->err)
+		return -1;
+	if (ctx->state == FEED_TOP)
+		return 0;
+
+	ctx->err = XML_ERR_INCOMPLETE;
+
+	return -1;
+}
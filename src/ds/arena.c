@@ -0,0 +1,176 @@
+/* @file: arena.c
+ * #desc:
+ *    The implementations of arena (bump-pointer region) allocator.
+ *
+ * #copy:
+ *    Copyright (C) 1970 Public Free Software
+ *
+ *    This library is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 2.1 of the License, or (at your option) any later version.
+ *
+ *    This library is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with this library; if not,
+ *    see <https://www.gnu.org/licenses/>.
+ */
+
+#include <demoz/config.h>
+#include <demoz/c/stddef.h>
+#include <demoz/c/stdint.h>
+#include <demoz/ds/arena.h>
+
+
+/* @func: arena_init
+ * #desc:
+ *    arena context initialization.
+ *
+ * #1: ctx        [out] arena context
+ * #2: block_size [in]  block size (0: default)
+ * #3: call_alloc [in]  block allocate callback
+ * #4: call_free  [in]  block free callback
+ * #5: arg        [in]  callback argument
+ */
+void F_SYMBOL(arena_init)(struct arena_ctx *ctx, size_t block_size,
+		void *(*call_alloc)(size_t, void *),
+		void (*call_free)(void *, size_t, void *),
+		void *arg)
+{
+	if (block_size < (ARENA_HEADER_SIZE * 2))
+		block_size = ARENA_BLOCK_SIZE;
+
+	ctx->block = NULL;
+	ctx->pos = 0;
+	ctx->block_size = block_size;
+	ctx->call_alloc = call_alloc;
+	ctx->call_free = call_free;
+	ctx->arg = arg;
+}
+
+/* @func: arena_alloc_align
+ * #desc:
+ *    arena aligned allocator.
+ *
+ * #1: ctx   [in/out] arena context
+ * #2: size  [in]     allocate size
+ * #3: align [in]     alignment (power of two)
+ * #r:       [ret]    allocated pointer / NULL pointer
+ */
+void *F_SYMBOL(arena_alloc_align)(struct arena_ctx *ctx, size_t size,
+		size_t align)
+{
+	struct arena_block *block = ctx->block;
+	uintptr_t base, p;
+	size_t off;
+
+	if (block) {
+		base = (uintptr_t)block;
+		p = (base + ctx->pos + align - 1) & ~(uintptr_t)(align - 1);
+		/* p + size may wrap */
+		off = p - base;
+		if (off <= block->size && size <= block->size - off) {
+			ctx->pos = off + size;
+			return (void *)p;
+		}
+	}
+
+	size_t n = ARENA_HEADER_SIZE + size + align;
+	if (n < size) /* overflow */
+		return NULL;
+	if (n < ctx->block_size)
+		n = ctx->block_size;
+
+	block = ctx->call_alloc(n, ctx->arg);
+	if (!block)
+		return NULL;
+	block->prev = ctx->block;
+	block->size = n;
+	ctx->block = block;
+
+	base = (uintptr_t)block;
+	p = (base + ARENA_HEADER_SIZE + align - 1) & ~(uintptr_t)(align - 1);
+	ctx->pos = p + size - base;
+
+	return (void *)p;
+}
+
+/* @func: arena_alloc
+ * #desc:
+ *    arena allocator (16-byte aligned).
+ *
+ * #1: ctx  [in/out] arena context
+ * #2: size [in]     allocate size
+ * #r:      [ret]    allocated pointer / NULL pointer
+ */
+void *F_SYMBOL(arena_alloc)(struct arena_ctx *ctx, size_t size)
+{
+	return F_SYMBOL(arena_alloc_align)(ctx, size, ARENA_ALIGN);
+}
+
+/* @func: arena_mark
+ * #desc:
+ *    save the current arena position.
+ *
+ * #1: ctx  [in]  arena context
+ * #2: mark [out] rollback point
+ */
+void F_SYMBOL(arena_mark)(struct arena_ctx *ctx, struct arena_mark *mark)
+{
+	mark->block = ctx->block;
+	mark->pos = ctx->pos;
+}
+
+/* @func: arena_reset
+ * #desc:
+ *    rollback to the saved position, or empty the arena and keep
+ *    the oldest block when the rollback point is NULL.
+ *
+ * #1: ctx  [in/out] arena context
+ * #2: mark [in]     rollback point / NULL
+ */
+void F_SYMBOL(arena_reset)(struct arena_ctx *ctx, struct arena_mark *mark)
+{
+	struct arena_block *block;
+
+	if (!mark) {
+		if (!ctx->block)
+			return;
+		while (ctx->block->prev) {
+			block = ctx->block;
+			ctx->block = block->prev;
+			ctx->call_free(block, block->size, ctx->arg);
+		}
+		ctx->pos = ARENA_HEADER_SIZE;
+		return;
+	}
+
+	while (ctx->block != mark->block) {
+		block = ctx->block;
+		ctx->block = block->prev;
+		ctx->call_free(block, block->size, ctx->arg);
+	}
+	ctx->pos = mark->pos;
+}
+
+/* @func: arena_release
+ * #desc:
+ *    free all blocks of the arena.
+ *
+ * #1: ctx [in/out] arena context
+ */
+void F_SYMBOL(arena_release)(struct arena_ctx *ctx)
+{
+	struct arena_block *block;
+
+	while (ctx->block) {
+		block = ctx->block;
+		ctx->block = block->prev;
+		ctx->call_free(block, block->size, ctx->arg);
+	}
+	ctx->pos = 0;
+}
@@ -0,0 +1,212 @@
+/* @file: dheap.c
+ * #desc:
+ *    The implementations of indexed d-ary heap data structure.
+ *
+ * #copy:
+ *    Copyright (C) 1970 Public Free Software
+ *
+ *    This library is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 2.1 of the License, or (at your option) any later version.
+ *
+ *    This library is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with this library; if not,
+ *    see <https://www.gnu.org/licenses/>.
+ */
+
+#include <demoz/config.h>
+#include <demoz/c/stddef.h>
+#include <demoz/c/stdint.h>
+#include <demoz/ds/dheap.h>
+
+
+/* @func: _dheap_up (static)
+ * #desc:
+ *    dheap member up shift (the parents move down into the hole).
+ *
+ * #1: head [in/out] dheap head
+ * #2: n    [in]     array index (hole)
+ * #3: node [in/out] member node
+ * #4: cmp  [in]     callback
+ */
+static void _dheap_up(struct dheap_head *head, size_t n,
+		struct dheap_node *node, int32_t (*cmp)(void *, void *))
+{
+	while (n > 0) {
+		size_t k = DHEAP_PARENT(head, n);
+		if (!(cmp(head->array[k], node) > 0))
+			break;
+
+		head->array[n] = head->array[k];
+		head->array[n]->index = n;
+		n = k;
+	}
+
+	head->array[n] = node;
+	node->index = n;
+}
+
+/* @func: _dheap_down (static)
+ * #desc:
+ *    dheap member down shift (the minimum children move up into the
+ *    hole).
+ *
+ * #1: head [in/out] dheap head
+ * #2: n    [in]     array index (hole)
+ * #3: node [in/out] member node
+ * #4: cmp  [in]     callback
+ */
+static void _dheap_down(struct dheap_head *head, size_t n,
+		struct dheap_node *node, int32_t (*cmp)(void *, void *))
+{
+	size_t c, e, m;
+	while (1) {
+		c = DHEAP_CHILD(head, n);
+		if (c >= head->size)
+			break;
+
+		e = c + ((size_t)1 << head->shift);
+		if (e > head->size)
+			e = head->size;
+		for (m = c++; c < e; c++) {
+			if (cmp(head->array[c], head->array[m]) < 0)
+				m = c;
+		}
+		if (!(cmp(head->array[m], node) < 0))
+			break;
+
+		head->array[n] = head->array[m];
+		head->array[n]->index = n;
+		n = m;
+	}
+
+	head->array[n] = node;
+	node->index = n;
+}
+
+/* @func: dheap_insert
+ * #desc:
+ *    insert a dheap member.
+ *
+ * #1: head [in/out] dheap head
+ * #2: new  [in/out] new member node
+ * #3: cmp  [in]     callback
+ * #r:      [ret]    0: no error, -1: error array full
+ */
+int32_t F_SYMBOL(dheap_insert)(struct dheap_head *head,
+		struct dheap_node *new, int32_t (*cmp)(void *, void *))
+{
+	if (head->size >= head->total_size)
+		return -1;
+
+	_dheap_up(head, head->size++, new, cmp);
+
+	return 0;
+}
+
+/* @func: dheap_extract
+ * #desc:
+ *    extract a dheap minimum member.
+ *
+ * #1: head [in/out] dheap head
+ * #2: cmp  [in]     callback
+ * #r:      [ret]    minimum member / NULL pointer
+ */
+struct dheap_node *F_SYMBOL(dheap_extract)(struct dheap_head *head,
+		int32_t (*cmp)(void *, void *))
+{
+	if (head->size < 1)
+		return NULL;
+
+	struct dheap_node *p = head->array[0];
+	struct dheap_node *last = head->array[--head->size];
+	if (head->size)
+		_dheap_down(head, 0, last, cmp);
+	p->index = DHEAP_NONE;
+
+	return p;
+}
+
+/* @func: dheap_erase
+ * #desc:
+ *    erase a dheap member (by its index).
+ *
+ * #1: head [in/out] dheap head
+ * #2: node [in/out] member node
+ * #3: cmp  [in]     callback
+ * #r:      [ret]    0: no error, -1: not in the heap
+ */
+int32_t F_SYMBOL(dheap_erase)(struct dheap_head *head,
+		struct dheap_node *node, int32_t (*cmp)(void *, void *))
+{
+	if (!DHEAP_IN(head, node))
+		return -1;
+
+	size_t n = node->index;
+	struct dheap_node *last = head->array[--head->size];
+	node->index = DHEAP_NONE;
+	if (last == node)
+		return 0;
+
+	if (n > 0 && cmp(last, head->array[DHEAP_PARENT(head, n)]) < 0) {
+		_dheap_up(head, n, last, cmp);
+	} else {
+		_dheap_down(head, n, last, cmp);
+	}
+
+	return 0;
+}
+
+/* @func: dheap_decrease
+ * #desc:
+ *    restore the order after the member key decreased.
+ *
+ * #1: head [in/out] dheap head
+ * #2: node [in/out] member node
+ * #3: cmp  [in]     callback
+ */
+void F_SYMBOL(dheap_decrease)(struct dheap_head *head,
+		struct dheap_node *node, int32_t (*cmp)(void *, void *))
+{
+	_dheap_up(head, node->index, node, cmp);
+}
+
+/* @func: dheap_increase
+ * #desc:
+ *    restore the order after the member key increased.
+ *
+ * #1: head [in/out] dheap head
+ * #2: node [in/out] member node
+ * #3: cmp  [in]     callback
+ */
+void F_SYMBOL(dheap_increase)(struct dheap_head *head,
+		struct dheap_node *node, int32_t (*cmp)(void *, void *))
+{
+	_dheap_down(head, node->index, node, cmp);
+}
+
+/* @func: dheap_update
+ * #desc:
+ *    restore the order after the member key changed (either way).
+ *
+ * #1: head [in/out] dheap head
+ * #2: node [in/out] member node
+ * #3: cmp  [in]     callback
+ */
+void F_SYMBOL(dheap_update)(struct dheap_head *head,
+		struct dheap_node *node, int32_t (*cmp)(void *, void *))
+{
+	size_t n = node->index;
+
+	if (n > 0 && cmp(node, head->array[DHEAP_PARENT(head, n)]) < 0) {
+		_dheap_up(head, n, node, cmp);
+	} else {
+		_dheap_down(head, n, node, cmp);
+	}
+}
@@ -26,6 +26,13 @@
 #include <demoz/ds/ringbuf.h>
 
 
+/* @def: _ */
+#undef MIN
+#define MIN(a, b) (((a) < (b)) ? (a) : (b))
+
+#define OFFSET(x, n) ((x)->mask ? ((n) & (x)->mask) : ((n) % (x)->size))
+/* end */
+
 /* @func: ringbuf_write
  * #desc:
  *    write to the ring buffer.
@@ -43,10 +50,7 @@ uint32_t F_SYMBOL(ringbuf_write)(struct ringbuf_head *head, const uint8_t *s,
 	/* NOTE: unsigned overflow features */
 
 	l = head->size - (head->write - head->read); /* avail length */
-	f = head->write % head->size; /* first offset */
-
-#undef MIN
-#define MIN(a, b) (((a) < (b)) ? (a) : (b))
+	f = OFFSET(head, head->write); /* first offset */
 
 	head->write += len = MIN(len, l);
 	l = MIN(len, head->size - f); /* first length */
@@ -74,10 +78,7 @@ uint32_t F_SYMBOL(ringbuf_read)(struct ringbuf_head *head, uint8_t *s,
 	/* NOTE: unsigned overflow features */
 
 	l = head->write - head->read; /* use length */
-	f = head->read % head->size; /* first offset */
-
-#undef MIN
-#define MIN(a, b) (((a) < (b)) ? (a) : (b))
+	f = OFFSET(head, head->read); /* first offset */
 
 	head->read += len = MIN(len, l);
 	l = MIN(len, head->size - f); /* first length */
@@ -110,10 +111,7 @@ uint32_t F_SYMBOL(ringbuf_peek)(struct ringbuf_head *head, uint8_t *s,
 		return 0;
 
 	l -= off;
-	f = (head->read + off) % head->size; /* first offset */
-
-#undef MIN
-#define MIN(a, b) (((a) < (b)) ? (a) : (b))
+	f = OFFSET(head, head->read + off); /* first offset */
 
 	len = MIN(len, l);
 	l = MIN(len, head->size - f); /* first length */
@@ -123,3 +121,89 @@ uint32_t F_SYMBOL(ringbuf_peek)(struct ringbuf_head *head, uint8_t *s,
 
 	return len;
 }
+
+/* @func: _ringbuf_span (static)
+ * #desc:
+ *    split the ring range to the spans.
+ *
+ * #1: head [in]  ring buffer head
+ * #2: span [out] spans (the second one is empty if not wrapped)
+ * #3: pos  [in]  range index
+ * #4: len  [in]  range length
+ */
+static void _ringbuf_span(struct ringbuf_head *head,
+		struct ringbuf_span span[2], uint32_t pos, uint32_t len)
+{
+	uint32_t f = OFFSET(head, pos); /* first offset */
+	uint32_t l = MIN(len, head->size - f); /* first length */
+
+	span[0].base = head->buf + f;
+	span[0].len = l;
+	span[1].base = head->buf;
+	span[1].len = len - l;
+}
+
+/* @func: ringbuf_reserve
+ * #desc:
+ *    reserve the free space in place (no copy), the data written to
+ *    the spans is added by ringbuf_commit.
+ *
+ * #1: head [in]  ring buffer head
+ * #2: span [out] writable spans
+ * #3: len  [in]  wanted length
+ * #r:      [ret] reserved length
+ */
+uint32_t F_SYMBOL(ringbuf_reserve)(struct ringbuf_head *head,
+		struct ringbuf_span span[2], uint32_t len)
+{
+	/* NOTE: unsigned overflow features */
+
+	len = MIN(len, head->size - (head->write - head->read));
+	_ringbuf_span(head, span, head->write, len);
+
+	return len;
+}
+
+/* @func: ringbuf_commit
+ * #desc:
+ *    add the written part of the reserved space.
+ *
+ * #1: head [in/out] ring buffer head
+ * #2: len  [in]     written length (<= reserved length)
+ */
+void F_SYMBOL(ringbuf_commit)(struct ringbuf_head *head, uint32_t len)
+{
+	head->write += MIN(len, head->size - (head->write - head->read));
+}
+
+/* @func: ringbuf_peek_span
+ * #desc:
+ *    peek the data in place (no copy), removed by ringbuf_consume.
+ *
+ * #1: head [in]  ring buffer head
+ * #2: span [out] readable spans
+ * #3: len  [in]  wanted length
+ * #r:      [ret] readable length
+ */
+uint32_t F_SYMBOL(ringbuf_peek_span)(struct ringbuf_head *head,
+		struct ringbuf_span span[2], uint32_t len)
+{
+	/* NOTE: unsigned overflow features */
+
+	len = MIN(len, head->write - head->read);
+	_ringbuf_span(head, span, head->read, len);
+
+	return len;
+}
+
+/* @func: ringbuf_consume
+ * #desc:
+ *    remove the data from the ring buffer.
+ *
+ * #1: head [in/out] ring buffer head
+ * #2: len  [in]     consumed length
+ */
+void F_SYMBOL(ringbuf_consume)(struct ringbuf_head *head, uint32_t len)
+{
+	head->read += MIN(len, head->write - head->read);
+}
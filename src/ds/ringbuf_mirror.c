@@ -0,0 +1,109 @@
+/* @file: ringbuf_mirror.c
+ * #desc:
+ *    The implementations of mirrored (virtual memory) ring buffer.
+ *
+ * #copy:
+ *    Copyright (C) 1970 Public Free Software
+ *
+ *    This library is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 2.1 of the License, or (at your option) any later version.
+ *
+ *    This library is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with this library; if not,
+ *    see <https://www.gnu.org/licenses/>.
+ */
+
+#include <demoz/config.h>
+#include <demoz/c/stddef.h>
+#include <demoz/c/stdint.h>
+#include <demoz/c/errno.h>
+#include <demoz/c/sys/mman.h>
+#include <demoz/c/sys/unistd.h>
+#include <demoz/ds/ringbuf.h>
+#include <demoz/ds/ringbuf_mirror.h>
+
+
+/* @func: ringbuf_mirror_create
+ * #desc:
+ *    create the mirrored ring buffer, one memory file is mapped twice
+ *    into an address range reserved as a whole.
+ *
+ * #1: head [out] ring buffer head
+ * #2: size [in]  ring size (rounded up to a power of two, at least
+ *                one page, at most 2GiB)
+ * #r:      [ret] 0: no error, -1: errno
+ */
+int32_t F_SYMBOL(ringbuf_mirror_create)(struct ringbuf_head *head,
+		uint32_t size)
+{
+	uint8_t *p, *q;
+	int32_t fd;
+
+	if (size > 0x80000000U) {
+		/* errno */
+		x_errno = X_EINVAL;
+		return -1;
+	}
+	if (size < RINGBUF_MIRROR_PAGE)
+		size = RINGBUF_MIRROR_PAGE;
+	size = (uint32_t)1 << (32 - __builtin_clz(size - 1));
+
+	fd = C_SYMBOL(memfd_create)("ringbuf", X_MFD_CLOEXEC);
+	if (fd < 0)
+		return -1;
+	if (C_SYMBOL(ftruncate)(fd, size))
+		goto e;
+
+	/* reserve both halves, then replace them with the file */
+	p = C_SYMBOL(mmap)(NULL, (size_t)size * 2, X_PROT_NONE,
+		X_MAP_PRIVATE | X_MAP_ANONYMOUS, -1, 0);
+	if (p == X_MAP_FAILED)
+		goto e;
+
+	q = C_SYMBOL(mmap)(p, size, X_PROT_READ | X_PROT_WRITE,
+		X_MAP_FIXED | X_MAP_SHARED, fd, 0);
+	if (q != p)
+		goto f;
+	q = C_SYMBOL(mmap)(p + size, size, X_PROT_READ | X_PROT_WRITE,
+		X_MAP_FIXED | X_MAP_SHARED, fd, 0);
+	if (q != p + size)
+		goto f;
+
+	/* the mappings keep the file */
+	C_SYMBOL(close)(fd);
+	RINGBUF_INIT(head, p, size);
+
+	return 0;
+
+f:
+	C_SYMBOL(munmap)(p, (size_t)size * 2);
+e:
+	C_SYMBOL(close)(fd);
+
+	return -1;
+}
+
+/* @func: ringbuf_mirror_destroy
+ * #desc:
+ *    unmap the mirrored ring buffer.
+ *
+ * #1: head [in/out] ring buffer head
+ */
+void F_SYMBOL(ringbuf_mirror_destroy)(struct ringbuf_head *head)
+{
+	if (head->buf)
+		C_SYMBOL(munmap)(head->buf, (size_t)head->size * 2);
+
+	head->buf = NULL;
+	head->size = 0;
+	head->mask = 0;
+	head->read = 0;
+	head->write = 0;
+}
@@ -0,0 +1,134 @@
+/* @file: ringbuf_mpmc.c
+ * #desc:
+ *    The implementations of multi-producer multi-consumer slot queue.
+ *
+ * #copy:
+ *    Copyright (C) 1970 Public Free Software
+ *
+ *    This library is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 2.1 of the License, or (at your option) any later version.
+ *
+ *    This library is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with this library; if not,
+ *    see <https://www.gnu.org/licenses/>.
+ */
+
+#include <demoz/config.h>
+#include <demoz/c/stddef.h>
+#include <demoz/c/stdint.h>
+#include <demoz/c/string.h>
+#include <demoz/c/atomic.h>
+#include <demoz/ds/ringbuf_mpmc.h>
+
+
+/* @def: _ */
+#define SLOT(x, n) ((x)->buf + (size_t)((n) & (x)->mask) * (x)->stride)
+#define SLOT_SEQ(p) ((uint32_t *)(p))
+#define SLOT_DATA(p) ((p) + sizeof(uint32_t))
+/* end */
+
+/* @func: ringbuf_mpmc_init
+ * #desc:
+ *    slot queue initialization.
+ *
+ * #1: head  [out] slot queue head
+ * #2: buf   [in]  slot buffer (RINGBUF_MPMC_BUFSIZE)
+ * #3: size  [in]  slot count (power of two)
+ * #4: wsize [in]  size of each data
+ */
+void F_SYMBOL(ringbuf_mpmc_init)(struct ringbuf_mpmc_head *head,
+		void *buf, uint32_t size, uint32_t wsize)
+{
+	head->buf = buf;
+	head->size = size;
+	head->mask = size - 1;
+	head->wsize = wsize;
+	head->stride = (uint32_t)RINGBUF_MPMC_STRIDE(wsize);
+
+	for (uint32_t i = 0; i < size; i++)
+		ATOMIC_STORE(SLOT_SEQ(SLOT(head, i)), i, ATOMIC_RELAXED);
+
+	ATOMIC_STORE(&head->push, 0, ATOMIC_RELAXED);
+	ATOMIC_STORE(&head->pop, 0, ATOMIC_RELEASE);
+}
+
+/* @func: ringbuf_mpmc_push
+ * #desc:
+ *    push the data to the slot queue (any thread).
+ *
+ * #1: head [in/out] slot queue head
+ * #2: p    [in]     input data (wsize)
+ * #r:      [ret]    0: no error, -1: full
+ */
+int32_t F_SYMBOL(ringbuf_mpmc_push)(struct ringbuf_mpmc_head *head,
+		const void *p)
+{
+	uint8_t *slot;
+	uint32_t pos = ATOMIC_LOAD(&head->push, ATOMIC_RELAXED), seq;
+
+	/* NOTE: unsigned overflow features */
+
+	for (;;) {
+		slot = SLOT(head, pos);
+		seq = ATOMIC_LOAD(SLOT_SEQ(slot), ATOMIC_ACQUIRE);
+		int32_t d = (int32_t)(seq - pos);
+		if (!d) {
+			if (ATOMIC_CAS_WEAK(&head->push, &pos, pos + 1,
+					ATOMIC_RELAXED, ATOMIC_RELAXED))
+				break;
+		} else if (d < 0) { /* the last lap is not popped */
+			return -1;
+		} else {
+			pos = ATOMIC_LOAD(&head->push, ATOMIC_RELAXED);
+		}
+	}
+
+	C_SYMBOL(memcpy)(SLOT_DATA(slot), p, head->wsize);
+	ATOMIC_STORE(SLOT_SEQ(slot), pos + 1, ATOMIC_RELEASE);
+
+	return 0;
+}
+
+/* @func: ringbuf_mpmc_pop
+ * #desc:
+ *    pop the data from the slot queue (any thread).
+ *
+ * #1: head [in/out] slot queue head
+ * #2: p    [out]    output data (wsize)
+ * #r:      [ret]    0: no error, -1: empty
+ */
+int32_t F_SYMBOL(ringbuf_mpmc_pop)(struct ringbuf_mpmc_head *head,
+		void *p)
+{
+	uint8_t *slot;
+	uint32_t pos = ATOMIC_LOAD(&head->pop, ATOMIC_RELAXED), seq;
+
+	/* NOTE: unsigned overflow features */
+
+	for (;;) {
+		slot = SLOT(head, pos);
+		seq = ATOMIC_LOAD(SLOT_SEQ(slot), ATOMIC_ACQUIRE);
+		int32_t d = (int32_t)(seq - (pos + 1));
+		if (!d) {
+			if (ATOMIC_CAS_WEAK(&head->pop, &pos, pos + 1,
+					ATOMIC_RELAXED, ATOMIC_RELAXED))
+				break;
+		} else if (d < 0) { /* not pushed yet */
+			return -1;
+		} else {
+			pos = ATOMIC_LOAD(&head->pop, ATOMIC_RELAXED);
+		}
+	}
+
+	C_SYMBOL(memcpy)(p, SLOT_DATA(slot), head->wsize);
+	ATOMIC_STORE(SLOT_SEQ(slot), pos + head->size, ATOMIC_RELEASE);
+
+	return 0;
+}
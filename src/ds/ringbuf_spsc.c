@@ -0,0 +1,105 @@
+/* @file: ringbuf_spsc.c
+ * #desc:
+ *    The implementations of single-producer single-consumer ring buffer.
+ *
+ * #copy:
+ *    Copyright (C) 1970 Public Free Software
+ *
+ *    This library is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 2.1 of the License, or (at your option) any later version.
+ *
+ *    This library is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with this library; if not,
+ *    see <https://www.gnu.org/licenses/>.
+ */
+
+#include <demoz/config.h>
+#include <demoz/c/stdint.h>
+#include <demoz/c/string.h>
+#include <demoz/c/atomic.h>
+#include <demoz/ds/ringbuf_spsc.h>
+
+
+/* @def: _ */
+#undef MIN
+#define MIN(a, b) (((a) < (b)) ? (a) : (b))
+/* end */
+
+/* @func: ringbuf_spsc_write
+ * #desc:
+ *    write to the ring buffer (producer thread).
+ *
+ * #1: head [in/out] ring buffer head
+ * #2: s    [in]     input buffer
+ * #3: len  [in]     input length
+ * #r:      [ret]    length of write
+ */
+uint32_t F_SYMBOL(ringbuf_spsc_write)(struct ringbuf_spsc_head *head,
+		const uint8_t *s, uint32_t len)
+{
+	uint32_t w = head->write, l, f;
+
+	/* NOTE: unsigned overflow features */
+
+	l = head->size - (w - head->read_cache); /* avail length */
+	if (l < len) {
+		head->read_cache = ATOMIC_LOAD(&head->read, ATOMIC_ACQUIRE);
+		l = head->size - (w - head->read_cache);
+	}
+
+	len = MIN(len, l);
+	if (!len)
+		return 0;
+
+	f = w & head->mask; /* first offset */
+	l = MIN(len, head->size - f); /* first length */
+
+	C_SYMBOL(memcpy)(head->buf + f, s, l);
+	C_SYMBOL(memcpy)(head->buf, s + l, len - l);
+	ATOMIC_STORE(&head->write, w + len, ATOMIC_RELEASE);
+
+	return len;
+}
+
+/* @func: ringbuf_spsc_read
+ * #desc:
+ *    read from the ring buffer (consumer thread).
+ *
+ * #1: head [in/out] ring buffer head
+ * #2: s    [out]    output buffer
+ * #3: len  [in]     buffer length
+ * #r:      [ret]    length of read
+ */
+uint32_t F_SYMBOL(ringbuf_spsc_read)(struct ringbuf_spsc_head *head,
+		uint8_t *s, uint32_t len)
+{
+	uint32_t r = head->read, l, f;
+
+	/* NOTE: unsigned overflow features */
+
+	l = head->write_cache - r; /* use length */
+	if (l < len) {
+		head->write_cache = ATOMIC_LOAD(&head->write, ATOMIC_ACQUIRE);
+		l = head->write_cache - r;
+	}
+
+	len = MIN(len, l);
+	if (!len)
+		return 0;
+
+	f = r & head->mask; /* first offset */
+	l = MIN(len, head->size - f); /* first length */
+
+	C_SYMBOL(memcpy)(s, head->buf + f, l);
+	C_SYMBOL(memcpy)(s + l, head->buf, len - l);
+	ATOMIC_STORE(&head->read, r + len, ATOMIC_RELEASE);
+
+	return len;
+}
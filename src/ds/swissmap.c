@@ -26,70 +26,512 @@
 #include <demoz/c/string.h>
 #include <demoz/ds/swissmap.h>
 
+#if (SWISSMAP_SIMD == SWISSMAP_SIMD_SSE2)
+#	include <emmintrin.h>
+#elif (SWISSMAP_SIMD == SWISSMAP_SIMD_NEON)
+#	include <arm_neon.h>
+#endif
 
-/* @func: swissmap_empty
+
+/* @def: _
+ * probe: group (h1 & mask), triangular step (1, 2, 3 ...)
+ * match: one bit per slot, MASK_INDEX() gives the lowest slot */
+#if (SWISSMAP_SIMD == SWISSMAP_SIMD_SSE2)
+#	define MASK_SHIFT 0
+#elif (SWISSMAP_SIMD == SWISSMAP_SIMD_NEON)
+#	define MASK_SHIFT 2
+#else
+#	define MASK_SHIFT 3
+#endif
+
+#define MASK_INDEX(x) ((size_t)__builtin_ctzll(x) >> MASK_SHIFT)
+
+#define SWAR_LSB 0x0101010101010101ULL
+#define SWAR_MSB 0x8080808080808080ULL
+#define NEON_MSB 0x8888888888888888ULL
+
+#define GROUP_MASK(x) ((x)->total_size / SWISSMAP_WIDTH - 1)
+
+#if (SWISSMAP_SIMD == SWISSMAP_SIMD_SSE2)
+#	define GROUP_FULL 0xffffULL
+#elif (SWISSMAP_SIMD == SWISSMAP_SIMD_NEON)
+#	define GROUP_FULL NEON_MSB
+#else
+#	define GROUP_FULL SWAR_MSB
+#endif
+
+#define BUCKET(x, a, n) ((void *)((char *)(a) + (x)->wsize * (n)))
+#define TABLE_SIZE(x, n) ((n) + (n) * (x)->wsize)
+#define NO_SLOT ((size_t)-1)
+
+/* old groups moved by each insert/delete while rehashing */
+#define REHASH_STEP 1
+
+/* keys hashed and prefetched ahead by the batch calls */
+#define BATCH_NUM 16
+/* end */
+
+/* @func: _swissmap_group (static)
  * #desc:
- *    swissmap ctrl group set to empty.
+ *    first probe group (fibonacci hashing of h1, so weak hashes
+ *    still spread over the power-of-two groups).
+ *
+ * #1: total [in] table size
+ * #2: h     [in] hash value
+ * #r:       [ret] group index
+ */
+static size_t _swissmap_group(size_t total, uint64_t h)
+{
+	uint32_t b = __builtin_ctzll(total / SWISSMAP_WIDTH);
+
+	return (size_t)((((h >> 7) * 0x9e3779b97f4a7c15ULL) >> (63 - b)) >> 1);
+}
+
+/* @func: _swissmap_match (static)
+ * #desc:
+ *    match the ctrl bytes equal to h2.
+ *
+ * #1: g  [in] ctrl group
+ * #2: h2 [in] hash tag
+ * #r:    [ret] slot bitmask
+ */
+static uint64_t _swissmap_match(const union swissmap_group *g, uint8_t h2)
+{
+#if (SWISSMAP_SIMD == SWISSMAP_SIMD_SSE2)
+	__m128i x = _mm_loadu_si128((const __m128i *)g->_ctrl);
+	return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(x,
+		_mm_set1_epi8((char)h2)));
+#elif (SWISSMAP_SIMD == SWISSMAP_SIMD_NEON)
+	uint8x16_t x = vceqq_u8(vld1q_u8(g->_ctrl), vdupq_n_u8(h2));
+	return vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(
+		vreinterpretq_u16_u8(x), 4)), 0) & NEON_MSB;
+#else
+	/* may report false positives, the key is always compared */
+	uint64_t x = g->ctrl[0] ^ (SWAR_LSB * h2);
+	return (x - SWAR_LSB) & ~x & SWAR_MSB;
+#endif
+}
+
+/* @func: _swissmap_match_empty (static)
+ * #desc:
+ *    match the empty ctrl bytes.
+ *
+ * #1: g [in] ctrl group
+ * #r:   [ret] slot bitmask
+ */
+static uint64_t _swissmap_match_empty(const union swissmap_group *g)
+{
+#if (SWISSMAP_SIMD == SWISSMAP_SIMD_SSE2)
+	__m128i x = _mm_loadu_si128((const __m128i *)g->_ctrl);
+	return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(x,
+		_mm_set1_epi8((char)SWISSMAP_EMPTY)));
+#elif (SWISSMAP_SIMD == SWISSMAP_SIMD_NEON)
+	uint8x16_t x = vceqq_u8(vld1q_u8(g->_ctrl),
+		vdupq_n_u8(SWISSMAP_EMPTY));
+	return vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(
+		vreinterpretq_u16_u8(x), 4)), 0) & NEON_MSB;
+#else
+	/* 0b1'0000000: msb set and bit 1 clear */
+	uint64_t x = g->ctrl[0];
+	return x & ~(x << 6) & SWAR_MSB;
+#endif
+}
+
+/* @func: _swissmap_match_free (static)
+ * #desc:
+ *    match the empty or deleted ctrl bytes.
+ *
+ * #1: g [in] ctrl group
+ * #r:   [ret] slot bitmask
+ */
+static uint64_t _swissmap_match_free(const union swissmap_group *g)
+{
+#if (SWISSMAP_SIMD == SWISSMAP_SIMD_SSE2)
+	__m128i x = _mm_loadu_si128((const __m128i *)g->_ctrl);
+	return (uint32_t)_mm_movemask_epi8(x);
+#elif (SWISSMAP_SIMD == SWISSMAP_SIMD_NEON)
+	uint8x16_t x = vcltq_s8(vreinterpretq_s8_u8(vld1q_u8(g->_ctrl)),
+		vdupq_n_s8(0));
+	return vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(
+		vreinterpretq_u16_u8(x), 4)), 0) & NEON_MSB;
+#else
+	return g->ctrl[0] & SWAR_MSB;
+#endif
+}
+
+/* @func: _swissmap_lookup (static)
+ * #desc:
+ *    find the slot of the key in a table.
+ *
+ * #1: head  [in] swissmap head
+ * #2: group [in] ctrl groups
+ * #3: array [in] buckets
+ * #4: total [in] table size
+ * #5: h     [in] hash value
+ * #6: key   [in] input key
+ * #7: len   [in] key length
+ * #r:       [ret] slot index / NO_SLOT
+ */
+static size_t _swissmap_lookup(struct swissmap_head *head,
+		union swissmap_group *group, void *array, size_t total,
+		uint64_t h, const void *key, size_t len)
+{
+	uint8_t h2 = h & 0x7f;
+
+	size_t mask = total / SWISSMAP_WIDTH - 1, g = _swissmap_group(total, h);
+	for (size_t i = 1; i <= (mask + 1); i++) {
+		union swissmap_group *grp = &group[g];
+		for (uint64_t m = _swissmap_match(grp, h2); m; m &= m - 1) {
+			size_t n = g * SWISSMAP_WIDTH + MASK_INDEX(m);
+			if (!head->call_cmp(BUCKET(head, array, n), key, len))
+				return n;
+		}
+
+		if (_swissmap_match_empty(grp))
+			break;
+
+		g = (g + i) & mask;
+	}
+
+	return NO_SLOT;
+}
+
+/* @func: _swissmap_free_slot (static)
+ * #desc:
+ *    first empty or deleted slot on the probe sequence.
+ *
+ * #1: head [in] swissmap head
+ * #2: h    [in] hash value
+ * #r:      [ret] slot index / NO_SLOT
+ */
+static size_t _swissmap_free_slot(struct swissmap_head *head, uint64_t h)
+{
+	size_t mask = GROUP_MASK(head);
+	size_t g = _swissmap_group(head->total_size, h);
+	for (size_t i = 1; i <= (mask + 1); i++) {
+		uint64_t m = _swissmap_match_free(&head->group[g]);
+		if (m)
+			return g * SWISSMAP_WIDTH + MASK_INDEX(m);
+
+		g = (g + i) & mask;
+	}
+
+	return NO_SLOT;
+}
+
+/* @func: _swissmap_erase (static)
+ * #desc:
+ *    clear a full slot.
+ *
+ * #1: grp [in/out] ctrl group
+ * #2: j   [in]     slot of the group
+ * #r:     [ret]    0: set to empty, 1: set to deleted
+ */
+static int32_t _swissmap_erase(union swissmap_group *grp, size_t j)
+{
+	/*
+	 * a probe never passes a group that still has an
+	 * empty slot, so no tombstone is needed there.
+	 */
+	if (_swissmap_match_empty(grp)) {
+		grp->_ctrl[j] = SWISSMAP_EMPTY;
+		return 0;
+	}
+	grp->_ctrl[j] = SWISSMAP_DELETE;
+
+	return 1;
+}
+
+/* @func: _swissmap_swap (static)
+ * #desc:
+ *    swap two buckets.
+ *
+ * #1: a   [in/out] bucket
+ * #2: b   [in/out] bucket
+ * #3: len [in]     bucket size
+ */
+static void _swissmap_swap(void *a, void *b, size_t len)
+{
+	char t[64], *x = a, *y = b;
+
+	for (size_t n; len; len -= n, x += n, y += n) {
+		n = (len < sizeof(t)) ? len : sizeof(t);
+		C_SYMBOL(memcpy)(t, x, n);
+		C_SYMBOL(memcpy)(x, y, n);
+		C_SYMBOL(memcpy)(y, t, n);
+	}
+}
+
+/* @func: _swissmap_next (static)
+ * #desc:
+ *    next full slot of a table.
+ *
+ * #1: group [in] ctrl groups
+ * #2: total [in] table size
+ * #3: n     [in] start slot
+ * #r:       [ret] slot index / NO_SLOT
+ */
+static size_t _swissmap_next(union swissmap_group *group, size_t total,
+		size_t n)
+{
+	for (; n < total; n = (n / SWISSMAP_WIDTH + 1) * SWISSMAP_WIDTH) {
+		union swissmap_group *grp = &group[n / SWISSMAP_WIDTH];
+		uint64_t m = ~_swissmap_match_free(grp) & GROUP_FULL;
+		m &= ~0ULL << ((n % SWISSMAP_WIDTH) << MASK_SHIFT);
+		if (m)
+			return (n / SWISSMAP_WIDTH) * SWISSMAP_WIDTH
+				+ MASK_INDEX(m);
+	}
+
+	return NO_SLOT;
+}
+
+/* @func: _swissmap_rehash_step (static)
+ * #desc:
+ *    move the old table groups into the current table, and free
+ *    the old table when it is drained.
  *
  * #1: head [in/out] swissmap head
+ * #2: step [in]     number of groups
  */
-void F_SYMBOL(swissmap_empty)(struct swissmap_head *head)
+static void _swissmap_rehash_step(struct swissmap_head *head, size_t step)
 {
-	C_SYMBOL(memset)(head->group, SWISSMAP_EMPTY,
-		sizeof(union swissmap_group)
-		* SWISSMAP_CLIGN(head->total_size));
+	size_t ngroup = head->old_total / SWISSMAP_WIDTH;
+
+	if (!head->old_group)
+		return;
+
+	for (; step && head->old_size && head->old_pos < ngroup; step--) {
+		union swissmap_group *grp = &head->old_group[head->old_pos];
+		for (size_t j = 0; j < SWISSMAP_WIDTH; j++) {
+			if (grp->_ctrl[j] & SWISSMAP_EMPTY)
+				continue;
+
+			void *p = BUCKET(head, head->old_array,
+				head->old_pos * SWISSMAP_WIDTH + j);
+			uint64_t h = head->call_rehash(p);
+			size_t n = _swissmap_free_slot(head, h);
+			if (SWISSMAP_ACTRL(head, n) == SWISSMAP_DELETE)
+				head->deleted--;
+			SWISSMAP_ACTRL(head, n) = h & 0x7f;
+			C_SYMBOL(memcpy)(BUCKET(head, head->array, n), p,
+				head->wsize);
+
+			/* keep the old probe sequences intact */
+			grp->_ctrl[j] = SWISSMAP_DELETE;
+			head->old_size--;
+		}
+		head->old_pos++;
+	}
+	if (head->old_size && head->old_pos < ngroup)
+		return;
+
+	head->call_free(head->old_group, TABLE_SIZE(head, head->old_total),
+		head->arg);
+	head->old_group = NULL;
+	head->old_array = NULL;
+	head->old_size = 0;
+	head->old_total = 0;
+	head->old_pos = 0;
 }
 
-/* @func: swissmap_insert
+/* @func: _swissmap_resize (static)
  * #desc:
- *    swissmap insert function.
+ *    allocate a new current table, the current table becomes the
+ *    old table and is moved by the rehash steps.
+ *
+ * #1: head  [in/out] swissmap head
+ * #2: total [in]     new table size (power of two)
+ * #r:       [ret]    0: no error, -1: no memory
+ */
+static int32_t _swissmap_resize(struct swissmap_head *head, size_t total)
+{
+	if (total > ((size_t)-1 / (head->wsize + 1)))
+		return -1;
+
+	void *p = head->call_alloc(TABLE_SIZE(head, total), head->arg);
+	if (!p)
+		return -1;
+	C_SYMBOL(memset)(p, SWISSMAP_EMPTY, total);
+
+	head->old_group = head->group;
+	head->old_array = head->array;
+	head->old_size = head->size;
+	head->old_total = head->total_size;
+	head->old_pos = 0;
+
+	head->group = p;
+	head->array = (char *)p + total;
+	head->total_size = total;
+	head->deleted = 0;
+
+	return 0;
+}
+
+/* @func: _swissmap_grow (static)
+ * #desc:
+ *    make room for the insert, purge the tombstones in place when
+ *    they dominate, otherwise double the table.
  *
  * #1: head [in/out] swissmap head
- * #2: key  [in]     input key
- * #3: len  [in]     key length
- * #r:      [ret]    bucket / NULL pointer
  */
-void *F_SYMBOL(swissmap_insert)(struct swissmap_head *head,
+static void _swissmap_grow(struct swissmap_head *head)
+{
+	_swissmap_rehash_step(head, (size_t)-1);
+
+	if (head->total_size
+			&& SWISSMAP_FACTOR(head) <= SWISSMAP_PURGE_FACTOR) {
+		F_SYMBOL(swissmap_purge)(head);
+		return;
+	}
+
+	/* on failure, the remaining free slots are still used */
+	_swissmap_resize(head, head->total_size
+		? (head->total_size * 2) : SWISSMAP_WIDTH);
+}
+
+/* @func: _swissmap_insert (static)
+ * #desc:
+ *    swissmap insert (hashed key).
+ *
+ * #1: head [in/out] swissmap head
+ * #2: h    [in]     hash value
+ * #3: key  [in]     input key
+ * #4: len  [in]     key length
+ * #r:      [ret]    bucket (new or existing) / NULL pointer
+ */
+static void *_swissmap_insert(struct swissmap_head *head, uint64_t h,
 		const void *key, size_t len)
 {
-	uint64_t h = head->call_hash(key, len);
-	uint64_t h1 = h >> 7;
 	uint8_t h2 = h & 0x7f;
 
-	uint32_t _mask = h2 * 0x01010101;
-	uint8_t *_ctrl;
-
-	size_t n = head->total_size;
-	size_t m = h1 % n;
-	for (size_t i = 0; i < n; i += 4) {
-		size_t pos = ((m + i) % n) & ~0x3;
-		uint32_t x = head->group[pos >> 2].ctrl;
-
-		size_t j = 0;
-		if (x & 0x80808080) {
-			_ctrl = head->group[pos >> 2]._ctrl;
-			for (; !(_ctrl[j] & 0x80) && j < 4; j++);
-			_ctrl[j] = h2;
-			head->size++;
-			return SWISSMAP_ARRAY(head, pos + j);
+	if (head->call_alloc) {
+		_swissmap_rehash_step(head, REHASH_STEP);
+
+		size_t used = head->size - head->old_size + head->deleted;
+		if ((used + 1) * 1000 > head->total_size
+				* SWISSMAP_GROW_FACTOR)
+			_swissmap_grow(head);
+		if (!head->total_size)
+			return NULL;
+
+		if (head->old_group) {
+			size_t n = _swissmap_lookup(head, head->old_group,
+				head->old_array, head->old_total, h, key, len);
+			if (n != NO_SLOT)
+				return BUCKET(head, head->old_array, n);
+		}
+	}
+
+	size_t mask = GROUP_MASK(head);
+	size_t g = _swissmap_group(head->total_size, h);
+	size_t slot = NO_SLOT;
+	for (size_t i = 1; i <= (mask + 1); i++) {
+		union swissmap_group *grp = &head->group[g];
+		for (uint64_t m = _swissmap_match(grp, h2); m; m &= m - 1) {
+			void *p = SWISSMAP_ARRAY(head,
+				g * SWISSMAP_WIDTH + MASK_INDEX(m));
+			if (!head->call_cmp(p, key, len))
+				return p;
 		}
 
-		x ^= _mask;
-		x = (x - 0x01010101) & ~x & 0x80808080;
-		if (!x)
-			continue;
+		if (slot == NO_SLOT) {
+			uint64_t m = _swissmap_match_free(grp);
+			if (m)
+				slot = g * SWISSMAP_WIDTH + MASK_INDEX(m);
+		}
+		if (_swissmap_match_empty(grp))
+			break;
+
+		g = (g + i) & mask;
+	}
+	if (slot == NO_SLOT)
+		return NULL;
+
+	if (SWISSMAP_ACTRL(head, slot) == SWISSMAP_DELETE)
+		head->deleted--;
+	SWISSMAP_ACTRL(head, slot) = h2;
+	head->size++;
+
+	return SWISSMAP_ARRAY(head, slot);
+}
+
+/* @func: _swissmap_find (static)
+ * #desc:
+ *    swissmap find (hashed key).
+ *
+ * #1: head [in] swissmap head
+ * #2: h    [in] hash value
+ * #3: key  [in] input key
+ * #4: len  [in] key length
+ * #r:      [ret] bucket / NULL pointer
+ */
+static void *_swissmap_find(struct swissmap_head *head, uint64_t h,
+		const void *key, size_t len)
+{
+	uint8_t h2 = h & 0x7f;
 
-		_ctrl = head->group[pos >> 2]._ctrl;
-		for (; j < 4; j++) {
-			void *p = SWISSMAP_ARRAY(head, pos + j);
-			if (_ctrl[j] == h2 && !head->call_cmp(p, key, len))
+	size_t mask = GROUP_MASK(head);
+	size_t g = _swissmap_group(head->total_size, h);
+	for (size_t i = 1; i <= (mask + 1); i++) {
+		union swissmap_group *grp = &head->group[g];
+		for (uint64_t m = _swissmap_match(grp, h2); m; m &= m - 1) {
+			void *p = SWISSMAP_ARRAY(head,
+				g * SWISSMAP_WIDTH + MASK_INDEX(m));
+			if (!head->call_cmp(p, key, len))
 				return p;
 		}
+
+		if (_swissmap_match_empty(grp))
+			break;
+
+		g = (g + i) & mask;
+	}
+
+	if (head->old_group) {
+		size_t n = _swissmap_lookup(head, head->old_group,
+			head->old_array, head->old_total, h, key, len);
+		if (n != NO_SLOT)
+			return BUCKET(head, head->old_array, n);
 	}
 
 	return NULL;
 }
 
+/* @func: swissmap_empty
+ * #desc:
+ *    swissmap ctrl group set to empty.
+ *
+ * #1: head [in/out] swissmap head
+ */
+void F_SYMBOL(swissmap_empty)(struct swissmap_head *head)
+{
+	if (head->old_group) {
+		head->old_size = 0;
+		_swissmap_rehash_step(head, 0);
+	}
+
+	if (head->total_size)
+		C_SYMBOL(memset)(head->group, SWISSMAP_EMPTY, head->total_size);
+	head->size = 0;
+	head->deleted = 0;
+}
+
+/* @func: swissmap_insert
+ * #desc:
+ *    swissmap insert function.
+ *
+ * #1: head [in/out] swissmap head
+ * #2: key  [in]     input key
+ * #3: len  [in]     key length
+ * #r:      [ret]    bucket (new or existing) / NULL pointer
+ */
+void *F_SYMBOL(swissmap_insert)(struct swissmap_head *head,
+		const void *key, size_t len)
+{
+	return _swissmap_insert(head, head->call_hash(key, len), key, len);
+}
+
 /* @func: swissmap_find
  * #desc:
  *    swissmap find function.
@@ -102,33 +544,10 @@ void *F_SYMBOL(swissmap_insert)(struct swissmap_head *head,
 void *F_SYMBOL(swissmap_find)(struct swissmap_head *head,
 		const void *key, size_t len)
 {
-	uint64_t h = head->call_hash(key, len);
-	uint64_t h1 = h >> 7;
-	uint8_t h2 = h & 0x7f;
-
-	uint32_t _mask = h2 * 0x01010101;
-	uint8_t *_ctrl;
-
-	size_t n = head->total_size;
-	size_t m = h1 % n;
-	for (size_t i = 0; i < n; i += 4) {
-		size_t pos = ((m + i) % n) & ~0x3;
-		uint32_t x = head->group[pos >> 2].ctrl;
+	if (!head->total_size)
+		return NULL;
 
-		x ^= _mask;
-		x = (x - 0x01010101) & ~x & 0x80808080;
-		if (!x)
-			continue;
-
-		_ctrl = head->group[pos >> 2]._ctrl;
-		for (size_t j = 0; j < 4; j++) {
-			void *p = SWISSMAP_ARRAY(head, pos + j);
-			if (_ctrl[j] == h2 && !head->call_cmp(p, key, len))
-				return p;
-		}
-	}
-
-	return NULL;
+	return _swissmap_find(head, head->call_hash(key, len), key, len);
 }
 
 /* @func: swissmap_delete
@@ -143,34 +562,289 @@ void *F_SYMBOL(swissmap_find)(struct swissmap_head *head,
 void *F_SYMBOL(swissmap_delete)(struct swissmap_head *head,
 		const void *key, size_t len)
 {
+	void *p;
+
+	if (!head->total_size)
+		return NULL;
+
 	uint64_t h = head->call_hash(key, len);
-	uint64_t h1 = h >> 7;
-	uint8_t h2 = h & 0x7f;
+	if (head->call_alloc)
+		_swissmap_rehash_step(head, REHASH_STEP);
 
-	uint32_t _mask = h2 * 0x01010101;
-	uint8_t *_ctrl;
+	size_t n = _swissmap_lookup(head, head->group, head->array,
+		head->total_size, h, key, len);
+	if (n != NO_SLOT) {
+		head->deleted += _swissmap_erase(
+			&head->group[n / SWISSMAP_WIDTH], n % SWISSMAP_WIDTH);
+		p = SWISSMAP_ARRAY(head, n);
+	} else if (head->old_group) {
+		n = _swissmap_lookup(head, head->old_group, head->old_array,
+			head->old_total, h, key, len);
+		if (n == NO_SLOT)
+			return NULL;
+		_swissmap_erase(&head->old_group[n / SWISSMAP_WIDTH],
+			n % SWISSMAP_WIDTH);
+		head->old_size--;
+		p = BUCKET(head, head->old_array, n);
+	} else {
+		return NULL;
+	}
+	head->size--;
 
-	size_t n = head->total_size;
-	size_t m = h1 % n;
-	for (size_t i = 0; i < n; i += 4) {
-		size_t pos = ((m + i) % n) & ~0x3;
-		uint32_t x = head->group[pos >> 2].ctrl;
+	/* the bucket stays valid until the next insert/delete */
+	if ((head->flags & SWISSMAP_AUTO_SHRINK) && !head->old_group
+			&& head->total_size > SWISSMAP_WIDTH
+			&& SWISSMAP_FACTOR(head) < SWISSMAP_SHRINK_FACTOR)
+		_swissmap_resize(head, head->total_size / 2);
 
-		x ^= _mask;
-		x = (x - 0x01010101) & ~x & 0x80808080;
-		if (!x)
+	return p;
+}
+
+/* @func: swissmap_purge
+ * #desc:
+ *    purge the tombstones in place (rehash the current table).
+ *
+ * #1: head [in/out] swissmap head
+ */
+void F_SYMBOL(swissmap_purge)(struct swissmap_head *head)
+{
+	size_t total = head->total_size;
+
+	_swissmap_rehash_step(head, (size_t)-1);
+	if (!head->deleted || !head->call_rehash)
+		return;
+
+	/* full -> deleted (pending), deleted -> empty */
+	for (size_t i = 0; i < total; i++) {
+		uint8_t *c = &SWISSMAP_ACTRL(head, i);
+		*c = (*c & SWISSMAP_EMPTY) ? SWISSMAP_EMPTY : SWISSMAP_DELETE;
+	}
+
+	for (size_t i = 0; i < total; i++) {
+		if (SWISSMAP_ACTRL(head, i) != SWISSMAP_DELETE)
 			continue;
 
-		_ctrl = head->group[pos >> 2]._ctrl;
-		for (size_t j = 0; j < 4; j++) {
-			void *p = SWISSMAP_ARRAY(head, pos + j);
-			if (_ctrl[j] == h2 && !head->call_cmp(p, key, len)) {
-				_ctrl[j] = SWISSMAP_DELETE;
-				head->size--;
-				return p;
-			}
+		void *p = SWISSMAP_ARRAY(head, i);
+		uint64_t h = head->call_rehash(p);
+		size_t n = _swissmap_free_slot(head, h);
+
+		/* already in the first group with a free slot */
+		if ((n / SWISSMAP_WIDTH) == (i / SWISSMAP_WIDTH)) {
+			SWISSMAP_ACTRL(head, i) = h & 0x7f;
+			continue;
+		}
+
+		if (SWISSMAP_ACTRL(head, n) == SWISSMAP_EMPTY) {
+			C_SYMBOL(memcpy)(SWISSMAP_ARRAY(head, n), p,
+				head->wsize);
+			SWISSMAP_ACTRL(head, i) = SWISSMAP_EMPTY;
+		} else {
+			/* pending bucket, process it again at the slot i */
+			_swissmap_swap(SWISSMAP_ARRAY(head, n), p,
+				head->wsize);
+			i--;
+		}
+		SWISSMAP_ACTRL(head, n) = h & 0x7f;
+	}
+	head->deleted = 0;
+}
+
+/* @func: swissmap_release
+ * #desc:
+ *    free the table storage (auto mode).
+ *
+ * #1: head [in/out] swissmap head
+ */
+void F_SYMBOL(swissmap_release)(struct swissmap_head *head)
+{
+	if (!head->call_alloc)
+		return;
+
+	if (head->old_group) {
+		head->old_size = 0;
+		_swissmap_rehash_step(head, 0);
+	}
+	if (head->group) {
+		head->call_free(head->group,
+			TABLE_SIZE(head, head->total_size), head->arg);
+	}
+
+	head->group = NULL;
+	head->array = NULL;
+	head->size = 0;
+	head->total_size = 0;
+	head->deleted = 0;
+}
+
+/* @func: swissmap_next
+ * #desc:
+ *    swissmap iterator, the live buckets of the current table and
+ *    then of the old table (auto mode).
+ *
+ * #1: head [in]     swissmap head
+ * #2: pos  [in/out] iterator position (0: first)
+ * #r:      [ret]    bucket / NULL pointer (end)
+ */
+void *F_SYMBOL(swissmap_next)(struct swissmap_head *head, size_t *pos)
+{
+	size_t n = *pos;
+
+	if (n < head->total_size) {
+		n = _swissmap_next(head->group, head->total_size, n);
+		if (n != NO_SLOT) {
+			*pos = n + 1;
+			return SWISSMAP_ARRAY(head, n);
+		}
+		n = head->total_size;
+	}
+
+	if (head->old_group) {
+		n = _swissmap_next(head->old_group, head->old_total,
+			n - head->total_size);
+		if (n != NO_SLOT) {
+			*pos = head->total_size + n + 1;
+			return BUCKET(head, head->old_array, n);
 		}
 	}
+	*pos = head->total_size + head->old_total;
 
 	return NULL;
 }
+
+/* @func: swissmap_reserve
+ * #desc:
+ *    make room for more buckets, no resize or rehash step happens
+ *    until they are inserted.
+ *
+ * #1: head [in/out] swissmap head
+ * #2: n    [in]     number of buckets
+ * #r:      [ret]    0: no error, -1: no space
+ */
+int32_t F_SYMBOL(swissmap_reserve)(struct swissmap_head *head, size_t n)
+{
+	size_t total = head->total_size;
+
+	if (!head->call_alloc)
+		return ((head->size + head->deleted + n) <= total) ? 0 : -1;
+
+	_swissmap_rehash_step(head, (size_t)-1);
+	if ((head->size + head->deleted + n) * 1000
+			<= total * SWISSMAP_GROW_FACTOR)
+		return 0;
+
+	if ((head->size + n) * 1000 <= total * SWISSMAP_GROW_FACTOR) {
+		F_SYMBOL(swissmap_purge)(head);
+		return 0;
+	}
+
+	if (!total)
+		total = SWISSMAP_WIDTH;
+	while ((head->size + n) * 1000 > total * SWISSMAP_GROW_FACTOR)
+		total *= 2;
+	if (_swissmap_resize(head, total))
+		return -1;
+	_swissmap_rehash_step(head, (size_t)-1);
+
+	return 0;
+}
+
+/* @func: swissmap_find_batch
+ * #desc:
+ *    swissmap batch find, the keys are hashed and their ctrl groups
+ *    and buckets are prefetched before they are resolved.
+ *
+ * #1: head   [in]  swissmap head
+ * #2: key    [in]  input keys (n * len)
+ * #3: len    [in]  key length
+ * #4: n      [in]  number of keys
+ * #5: bucket [out] buckets / NULL pointer
+ * #r:        [ret] number of found keys
+ */
+size_t F_SYMBOL(swissmap_find_batch)(struct swissmap_head *head,
+		const void *key, size_t len, size_t n, void **bucket)
+{
+	const char *k = key;
+	uint64_t h[BATCH_NUM];
+	size_t found = 0;
+
+	if (!head->total_size) {
+		for (size_t i = 0; i < n; i++)
+			bucket[i] = NULL;
+		return 0;
+	}
+
+	for (size_t i = 0; i < n; i += BATCH_NUM) {
+		size_t num = ((n - i) < BATCH_NUM) ? (n - i) : BATCH_NUM;
+
+		for (size_t j = 0; j < num; j++) {
+			h[j] = head->call_hash(k + (i + j) * len, len);
+			__builtin_prefetch(&head->group[_swissmap_group(
+				head->total_size, h[j])]);
+		}
+
+		/* the first candidate of the first group */
+		for (size_t j = 0; j < num; j++) {
+			size_t g = _swissmap_group(head->total_size, h[j]);
+			uint64_t m = _swissmap_match(&head->group[g],
+				h[j] & 0x7f);
+			if (m)
+				__builtin_prefetch(SWISSMAP_ARRAY(head,
+					g * SWISSMAP_WIDTH + MASK_INDEX(m)));
+		}
+
+		for (size_t j = 0; j < num; j++) {
+			bucket[i + j] = _swissmap_find(head, h[j],
+				k + (i + j) * len, len);
+			found += !!bucket[i + j];
+		}
+	}
+
+	return found;
+}
+
+/* @func: swissmap_insert_batch
+ * #desc:
+ *    swissmap batch insert, the keys are hashed and their ctrl groups
+ *    are prefetched before they are inserted. every bucket is passed
+ *    to the callback before the next key is inserted.
+ *
+ * #1: head     [in/out] swissmap head
+ * #2: key      [in]     input keys (n * len)
+ * #3: len      [in]     key length
+ * #4: n        [in]     number of keys
+ * #5: call_set [in]     bucket callback (bucket, index, new, arg)
+ * #6: arg      [in]     callback argument
+ * #r:          [ret]    number of inserted keys (stop at the first failure)
+ */
+size_t F_SYMBOL(swissmap_insert_batch)(struct swissmap_head *head,
+		const void *key, size_t len, size_t n,
+		void (*call_set)(void *, size_t, int32_t, void *), void *arg)
+{
+	const char *k = key;
+	uint64_t h[BATCH_NUM];
+
+	/* no resize inside the batch, the prefetches stay useful */
+	if (head->call_alloc)
+		F_SYMBOL(swissmap_reserve)(head, n);
+
+	for (size_t i = 0; i < n; i += BATCH_NUM) {
+		size_t num = ((n - i) < BATCH_NUM) ? (n - i) : BATCH_NUM;
+
+		for (size_t j = 0; j < num; j++) {
+			h[j] = head->call_hash(k + (i + j) * len, len);
+			__builtin_prefetch(&head->group[_swissmap_group(
+				head->total_size, h[j])], 1);
+		}
+
+		for (size_t j = 0; j < num; j++) {
+			size_t size = head->size;
+			void *p = _swissmap_insert(head, h[j],
+				k + (i + j) * len, len);
+			if (!p)
+				return i + j;
+			call_set(p, i + j, head->size != size, arg);
+		}
+	}
+
+	return n;
+}
@@ -0,0 +1,123 @@
+/* @file: test_bench_itoa.c
+ * #desc:
+ *
+ * #copy:
+ *    Copyright (C) 1970 Public Free Software
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program. If not,
+ *    see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <demoz/c/stdint.h>
+#include <demoz/c/stdlib.h>
+#include <demoz/c/stdio.h>
+
+
+#define SIZE 1000000
+
+static uint64_t *val;
+static char (*str)[24];
+static volatile uint64_t sink;
+
+double now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (double)ts.tv_sec + (double)ts.tv_nsec / 1000000000;
+}
+
+void report(const char *name, double time)
+{
+	printf("%s: %d -- %.6fs (%.2f/s) %.2f ns/op\n", name, SIZE, time,
+		(double)SIZE / time, (double)(time * 1000000000) / SIZE);
+}
+
+int main(void)
+{
+	char buf[32];
+	double time;
+
+	val = malloc(sizeof(uint64_t) * SIZE);
+	str = malloc(sizeof(str[0]) * SIZE);
+	if (!val || !str)
+		return 1;
+
+	/* uniform digit counts, 1 .. 20 */
+	srand(123456);
+	for (int32_t i = 0; i < SIZE; i++) {
+		uint64_t v = ((uint64_t)rand() << 62) ^ ((uint64_t)rand() << 31)
+			^ (uint64_t)rand();
+		val[i] = v >> (rand() % 64);
+		snprintf(str[i], sizeof(str[i]), "%llu",
+			(unsigned long long)val[i]);
+	}
+
+	time = now();
+	for (int32_t i = 0; i < SIZE; i++)
+		sink += (uint64_t)C_SYMBOL(u64toa)(buf, val[i]);
+	report("demoz u64toa", now() - time);
+
+	time = now();
+	for (int32_t i = 0; i < SIZE; i++) {
+		sink += (uint64_t)C_SYMBOL(snprintf)(buf, sizeof(buf), "%llu",
+			(unsigned long long)val[i]);
+	}
+	report("demoz snprintf %llu", now() - time);
+
+	time = now();
+	for (int32_t i = 0; i < SIZE; i++) {
+		sink += (uint64_t)snprintf(buf, sizeof(buf), "%llu",
+			(unsigned long long)val[i]);
+	}
+	report(" libc snprintf %llu", now() - time);
+
+	time = now();
+	for (int32_t i = 0; i < SIZE; i++) {
+		sink += (uint64_t)C_SYMBOL(snprintf)(buf, sizeof(buf), "%llx",
+			(unsigned long long)val[i]);
+	}
+	report("demoz snprintf %llx", now() - time);
+
+	time = now();
+	for (int32_t i = 0; i < SIZE; i++) {
+		sink += (uint64_t)snprintf(buf, sizeof(buf), "%llx",
+			(unsigned long long)val[i]);
+	}
+	report(" libc snprintf %llx", now() - time);
+
+	time = now();
+	for (int32_t i = 0; i < SIZE; i++)
+		sink += C_SYMBOL(atou64n)(str[i], strlen(str[i]), NULL, NULL);
+	report("demoz atou64n", now() - time);
+
+	time = now();
+	for (int32_t i = 0; i < SIZE; i++)
+		sink += C_SYMBOL(strtoull)(str[i], NULL, 10);
+	report("demoz strtoull", now() - time);
+
+	time = now();
+	for (int32_t i = 0; i < SIZE; i++)
+		sink += strtoull(str[i], NULL, 10);
+	report(" libc strtoull", now() - time);
+
+	free(str);
+	free(val);
+
+	return 0;
+}
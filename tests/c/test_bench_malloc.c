@@ -0,0 +1,144 @@
+/* @file: test_bench_malloc.c
+ * #desc:
+ *
+ * #copy:
+ *    Copyright (C) 1970 Public Free Software
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program. If not,
+ *    see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <time.h>
+#include <pthread.h>
+#include <demoz/c/stdint.h>
+#include <demoz/c/stdlib.h>
+#include <demoz/c/string.h>
+#include <demoz/c/sys/stdlib.h>
+
+
+#define THREAD_MAX 8
+#define SLOT 1024
+#define SIZE 2000000
+#define GROW_SIZE (64 * 1024 * 1024)
+
+struct T {
+	int32_t id;
+	int32_t err;
+};
+
+void *worker(void *arg)
+{
+	struct T *t = arg;
+	RANDOM_TYPE0_NEW(ran, 123456 + t->id);
+	uint8_t *slot[SLOT] = { NULL };
+	size_t len[SLOT] = { 0 };
+	int32_t r;
+
+	for (int32_t i = 0; i < SIZE; i++) {
+		C_SYMBOL(random_r)(&ran, &r);
+		uint32_t n = (uint32_t)r % SLOT;
+		if (slot[n]) {
+			if (slot[n][0] != (uint8_t)n
+					|| slot[n][len[n] - 1] != (uint8_t)n)
+				t->err++;
+			C_SYMBOL(free)(slot[n]);
+			slot[n] = NULL;
+			continue;
+		}
+
+		/* mostly small, sometimes medium */
+		len[n] = ((uint32_t)r >> 10) % ((r & 0x10) ? 4096 : 256) + 1;
+		slot[n] = C_SYMBOL(malloc)(len[n]);
+		if (!slot[n]) {
+			t->err++;
+			continue;
+		}
+		slot[n][0] = (uint8_t)n;
+		slot[n][len[n] - 1] = (uint8_t)n;
+	}
+
+	for (int32_t i = 0; i < SLOT; i++)
+		C_SYMBOL(free)(slot[i]);
+
+	return NULL;
+}
+
+void test_malloc(int32_t n)
+{
+	struct timespec start, end;
+	double time;
+	pthread_t tid[THREAD_MAX];
+	struct T t[THREAD_MAX];
+	int32_t err = 0;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (int32_t i = 0; i < n; i++) {
+		t[i].id = i;
+		t[i].err = 0;
+		pthread_create(&tid[i], NULL, worker, &t[i]);
+	}
+	for (int32_t i = 0; i < n; i++) {
+		pthread_join(tid[i], NULL);
+		err += t[i].err;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	time = (double)(end.tv_sec - start.tv_sec)
+		+ (double)(end.tv_nsec - start.tv_nsec) / 1000000000;
+	printf("threads: %d, ops: %d -- %.6fs (%.2f/s) %.2f ns/op, err: %d\n",
+		n, n * SIZE, time,
+		(double)n * SIZE / time,
+		(double)(time * 1000000000) / ((double)n * SIZE),
+		err);
+}
+
+void test_realloc(void)
+{
+	clock_t start, end;
+	double time;
+	uint8_t *p = NULL, *q;
+	int32_t moved = 0;
+
+	/* grow a buffer by 4KiB steps up to 64MiB */
+	start = clock();
+	for (size_t n = 4096; n <= GROW_SIZE; n += 4096) {
+		q = C_SYMBOL(realloc)(p, n);
+		if (!q) {
+			printf("no memory: n:%zu\n", n);
+			break;
+		}
+		moved += (p != q);
+		q[n - 1] = 1;
+		p = q;
+	}
+	end = clock();
+	time = (double)(end - start) / CLOCKS_PER_SEC;
+	printf("realloc: %d (moved: %d) -- %.6fs (%.2f/s) %.2f ns/op\n",
+		GROW_SIZE / 4096, moved, time,
+		(double)(GROW_SIZE / 4096) / time,
+		(double)(time * 1000000000) / (GROW_SIZE / 4096));
+
+	C_SYMBOL(free)(p);
+}
+
+int main(void)
+{
+	for (int32_t i = 1; i <= THREAD_MAX; i *= 2)
+		test_malloc(i);
+
+	test_realloc();
+
+	return 0;
+}
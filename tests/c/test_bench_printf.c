@@ -0,0 +1,101 @@
+/* @file: test_bench_printf.c
+ * #desc:
+ *
+ * #copy:
+ *    Copyright (C) 1970 Public Free Software
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program. If not,
+ *    see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <demoz/c/stdint.h>
+#include <demoz/c/stdio.h>
+
+
+#define SIZE 200000
+/* 10^-POW_MAX .. 10^POW_MAX */
+#define POW_MAX 9
+
+static const char *fmt[] = {
+	"%.6f", "%.2f", "%.17f", "%e", "%.17e", "%g", "%.17g", "%r"
+};
+
+static double *val;
+static volatile size_t sink;
+
+double now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (double)ts.tv_sec + (double)ts.tv_nsec / 1000000000;
+}
+
+void test_printf(const char *f, int32_t libc)
+{
+	char buf[512];
+	double time;
+
+	/* the host has no %r, use its round-trip form */
+	if (libc && f[1] == 'r')
+		f = "%.17g";
+
+	time = now();
+	for (int32_t i = 0; i < SIZE; i++) {
+		if (libc) {
+			sink += (size_t)snprintf(buf, sizeof(buf), f, val[i]);
+		} else {
+			sink += (size_t)C_SYMBOL(snprintf)(buf, sizeof(buf), f,
+				val[i]);
+		}
+	}
+	time = now() - time;
+
+	printf("%s %s: %d -- %.6fs (%.2f/s) %.2f ns/op\n",
+		libc ? " libc" : "demoz", f, SIZE, time,
+		(double)SIZE / time,
+		(double)(time * 1000000000) / SIZE);
+}
+
+int main(void)
+{
+	val = malloc(sizeof(double) * SIZE);
+	if (!val)
+		return 1;
+
+	/* random digits over a spread of magnitudes */
+	srand(123456);
+	for (int32_t i = 0; i < SIZE; i++) {
+		double k = 1.0;
+		for (int32_t n = rand() % (POW_MAX * 2 + 1); n > 0; n--)
+			k *= 10;
+		for (int32_t n = 0; n < POW_MAX; n++)
+			k /= 10;
+		val[i] = (double)rand() / RAND_MAX * k;
+		if (rand() & 1)
+			val[i] = -val[i];
+	}
+
+	for (size_t i = 0; i < sizeof(fmt) / sizeof(fmt[0]); i++) {
+		test_printf(fmt[i], 0);
+		test_printf(fmt[i], 1);
+	}
+
+	free(val);
+
+	return 0;
+}
@@ -0,0 +1,276 @@
+/* @file: test_bench_qsort.c
+ * #desc:
+ *
+ * #copy:
+ *    Copyright (C) 1970 Public Free Software
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program. If not,
+ *    see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
+#include <demoz/c/stdint.h>
+#include <demoz/c/stdlib.h>
+#include <demoz/c/string.h>
+
+
+#define MIN_SIZE 1000
+#define MAX_SIZE 10000000
+#define THREAD_MAX 4
+
+struct R {
+	int32_t key;
+	int32_t id;
+	char data[16];
+};
+
+struct K {
+	uint32_t key;
+	uint32_t id;
+};
+
+struct P {
+	struct K *a, *tmp;
+	uint64_t *part;
+	int32_t id;
+};
+
+int32_t cmp_int(const void *a, const void *b)
+{
+	int32_t x = *(const int32_t *)a, y = *(const int32_t *)b;
+
+	return (x > y) - (x < y);
+}
+
+int32_t cmp_rec(const void *a, const void *b)
+{
+	int32_t x = ((const struct R *)a)->key;
+	int32_t y = ((const struct R *)b)->key;
+
+	return (x > y) - (x < y);
+}
+
+int32_t cmp_key(const void *a, const void *b)
+{
+	uint32_t x = ((const struct K *)a)->key, y = ((const struct K *)b)->key;
+
+	return (x > y) - (x < y);
+}
+
+uint32_t key_key(const void *a)
+{
+	return ((const struct K *)a)->key;
+}
+
+void make(int32_t *a, int32_t n, int32_t type)
+{
+	RANDOM_TYPE0_NEW(ran, 123456);
+	int32_t r;
+
+	for (int32_t i = 0; i < n; i++) {
+		C_SYMBOL(random_r)(&ran, &r);
+		switch (type) {
+			case 0: /* random */
+				a[i] = r;
+				break;
+			case 1: /* sorted */
+				a[i] = i;
+				break;
+			case 2: /* reversed */
+				a[i] = n - i;
+				break;
+			default: /* few unique */
+				a[i] = r % 16;
+				break;
+		}
+	}
+}
+
+void test_qsort(void)
+{
+	const char *name[] = { "random", "sorted", "reversed", "few unique" };
+	int32_t *src = malloc(sizeof(int32_t) * MAX_SIZE);
+	int32_t *a = malloc(sizeof(int32_t) * MAX_SIZE);
+	struct timespec start, end;
+	double time;
+
+	for (int32_t type = 0; type < 4; type++) {
+		for (int32_t n = MIN_SIZE; n <= MAX_SIZE; n *= 10) {
+			int32_t round = MAX_SIZE / n, err = 0;
+			make(src, n, type);
+
+			time = 0;
+			for (int32_t k = 0; k < round; k++) {
+				C_SYMBOL(memcpy)(a, src, sizeof(int32_t) * n);
+				clock_gettime(CLOCK_MONOTONIC, &start);
+				C_SYMBOL(qsort)(a, n, sizeof(int32_t), cmp_int);
+				clock_gettime(CLOCK_MONOTONIC, &end);
+				time += (double)(end.tv_sec - start.tv_sec)
+					+ (double)(end.tv_nsec - start.tv_nsec)
+					/ 1000000000;
+			}
+			for (int32_t i = 1; i < n; i++)
+				err += a[i - 1] > a[i];
+
+			printf("%s: %d x %d -- %.6fs (%.2f/s) %.2f ns/op"
+				", err: %d\n",
+				name[type], n, round, time,
+				(double)n * round / time,
+				(double)(time * 1000000000)
+					/ ((double)n * round),
+				err);
+		}
+	}
+
+	free(src);
+	free(a);
+}
+
+void test_qsort_record(void)
+{
+	int32_t n = MAX_SIZE / 10, err = 0;
+	struct R *a = malloc(sizeof(struct R) * n);
+	int32_t *key = malloc(sizeof(int32_t) * n);
+	clock_t start, end;
+	double time;
+
+	make(key, n, 0);
+	for (int32_t i = 0; i < n; i++) {
+		a[i].key = key[i];
+		a[i].id = i;
+	}
+
+	start = clock();
+	C_SYMBOL(qsort)(a, n, sizeof(struct R), cmp_rec);
+	end = clock();
+	for (int32_t i = 1; i < n; i++)
+		err += a[i - 1].key > a[i].key;
+
+	time = (double)(end - start) / CLOCKS_PER_SEC;
+	printf("record (%zu bytes): %d -- %.6fs (%.2f/s) %.2f ns/op"
+		", err: %d\n",
+		sizeof(struct R), n, time,
+		(double)n / time,
+		(double)(time * 1000000000) / n,
+		err);
+
+	free(a);
+	free(key);
+}
+
+void *worker(void *arg)
+{
+	struct P *t = arg;
+
+	/* parts are striped over the threads */
+	for (int32_t i = t->id; i < 256; i += THREAD_MAX) {
+		C_SYMBOL(radix_sort32)(t->a + t->part[i],
+			t->part[i + 1] - t->part[i], sizeof(struct K),
+			key_key, t->tmp + t->part[i]);
+	}
+
+	return NULL;
+}
+
+void report(const char *name, struct K *a, int32_t n, double time)
+{
+	int32_t err = 0, unstable = 0;
+
+	for (int32_t i = 1; i < n; i++) {
+		err += a[i - 1].key > a[i].key;
+		unstable += a[i - 1].key == a[i].key
+			&& a[i - 1].id > a[i].id;
+	}
+
+	printf("%s: %d -- %.6fs (%.2f/s) %.2f ns/op"
+		", err: %d, unstable: %d\n",
+		name, n, time,
+		(double)n / time,
+		(double)(time * 1000000000) / n,
+		err, unstable);
+}
+
+void test_stable(int32_t n, int32_t type)
+{
+	struct K *src = malloc(sizeof(struct K) * n);
+	struct K *a = malloc(sizeof(struct K) * n);
+	struct K *tmp = malloc(sizeof(struct K) * n);
+	int32_t *key = malloc(sizeof(int32_t) * n);
+	uint64_t part[257];
+	pthread_t tid[THREAD_MAX];
+	struct P t[THREAD_MAX];
+	struct timespec start, end;
+
+	make(key, n, type);
+	for (int32_t i = 0; i < n; i++) {
+		src[i].key = (uint32_t)key[i];
+		src[i].id = (uint32_t)i;
+	}
+	if (type == 1) {
+		/* nearly sorted: 1% of the members swapped */
+		for (int32_t i = 0; i < n / 100; i++) {
+			int32_t x = (int32_t)(((uint32_t)i * 2654435761U) % n);
+			struct K k = src[x];
+			src[x] = src[i * 100];
+			src[i * 100] = k;
+		}
+	}
+
+	printf("-- %s\n", type ? "nearly sorted" : "random");
+#define TIME(name, code) \
+	C_SYMBOL(memcpy)(a, src, sizeof(struct K) * n); \
+	clock_gettime(CLOCK_MONOTONIC, &start); \
+	code; \
+	clock_gettime(CLOCK_MONOTONIC, &end); \
+	report(name, a, n, (double)(end.tv_sec - start.tv_sec) \
+		+ (double)(end.tv_nsec - start.tv_nsec) / 1000000000)
+
+	TIME("qsort", C_SYMBOL(qsort)(a, n, sizeof(struct K), cmp_key));
+	TIME("msort", C_SYMBOL(msort)(a, n, sizeof(struct K), cmp_key, tmp));
+	TIME("radix", C_SYMBOL(radix_sort32)(a, n, sizeof(struct K),
+		key_key, tmp));
+	TIME("radix part", {
+		C_SYMBOL(radix_part32)(a, n, sizeof(struct K), key_key,
+			tmp, part);
+		for (int32_t i = 0; i < THREAD_MAX; i++) {
+			t[i].a = a;
+			t[i].tmp = tmp;
+			t[i].part = part;
+			t[i].id = i;
+			pthread_create(&tid[i], NULL, worker, &t[i]);
+		}
+		for (int32_t i = 0; i < THREAD_MAX; i++)
+			pthread_join(tid[i], NULL);
+	});
+#undef TIME
+
+	free(src);
+	free(a);
+	free(tmp);
+	free(key);
+}
+
+int main(void)
+{
+	test_qsort();
+	test_qsort_record();
+	test_stable(MAX_SIZE / 10, 0);
+	test_stable(MAX_SIZE, 0);
+	test_stable(MAX_SIZE, 1);
+
+	return 0;
+}
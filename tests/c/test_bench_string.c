@@ -0,0 +1,151 @@
+/* @file: test_bench_string.c
+ * #desc:
+ *
+ * #copy:
+ *    Copyright (C) 1970 Public Free Software
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program. If not,
+ *    see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <demoz/c/stdint.h>
+#include <demoz/c/string.h>
+
+
+#define BUF_MIN 8
+#define BUF_MAX (64 * 1024 * 1024)
+/* bytes moved per measurement */
+#define VOLUME (256 * 1024 * 1024)
+#define PAD 64
+
+enum {
+	B_MEMCPY,
+	B_MEMSET,
+	B_MEMCMP,
+	B_MEMCHR,
+	B_MEMCHR2,
+	B_STRLEN,
+	B_UTF8
+};
+
+static const char *name[] = {
+	"memcpy", "memset", "memcmp", "memchr", "memchr2", "strlen",
+	"utf8_validate"
+};
+
+/* 1, 2, 3 and 4-byte sequences */
+static const char utf8_text[] = "x\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80";
+
+/* target/source offsets from a 64-byte boundary */
+static const size_t align[][2] = {
+	{ 0, 0 }, { 0, 1 }, { 1, 0 }, { 7, 13 }
+};
+
+static uint8_t *buf_t, *buf_s;
+static volatile size_t sink;
+
+double now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (double)ts.tv_sec + (double)ts.tv_nsec / 1000000000;
+}
+
+void test_string(int32_t type, size_t size, size_t at, size_t as)
+{
+	uint8_t *t = buf_t + at, *s = buf_s + as;
+	int32_t n = (int32_t)(VOLUME / size);
+	double time;
+
+	if (n < 4)
+		n = 4;
+
+	/* equal areas for memcmp, no match for memchr/memchr2/strlen */
+	C_SYMBOL(memset)(s, 'x', size);
+	C_SYMBOL(memset)(t, 'x', size);
+	s[size - 1] = '\0';
+	if (type == B_UTF8) { /* valid text, cut at a sequence boundary */
+		for (size_t i = 0; i < size; i++)
+			s[i] = utf8_text[i % (sizeof(utf8_text) - 1)];
+		for (size_t i = size - size % (sizeof(utf8_text) - 1);
+				i < size; i++)
+			s[i] = 'x';
+	}
+
+	time = now();
+	for (int32_t i = 0; i < n; i++) {
+		switch (type) {
+			case B_MEMCPY:
+				C_SYMBOL(memcpy)(t, s, size);
+				break;
+			case B_MEMSET:
+				C_SYMBOL(memset)(t, (int8_t)i, size);
+				break;
+			case B_MEMCMP:
+				sink += (size_t)C_SYMBOL(memcmp)(t, t, size);
+				break;
+			case B_MEMCHR:
+				sink += (size_t)C_SYMBOL(memchr)(s, 'y', size);
+				break;
+			case B_MEMCHR2:
+				sink += (size_t)C_SYMBOL(memchr2)(s, 'y', 'z', size);
+				break;
+			case B_STRLEN:
+				sink += C_SYMBOL(strlen)((char *)s);
+				break;
+			case B_UTF8:
+				sink += (size_t)C_SYMBOL(utf8_validate)(s, size);
+				break;
+			default:
+				break;
+		}
+		__asm__ volatile ("" : : : "memory");
+	}
+	time = now() - time;
+
+	printf("%s: %zu (%zu/%zu) %d -- %.6fs (%.2f/s) %.2f ns/op "
+		"%.2f GiB/s\n",
+		name[type], size, at, as, n, time,
+		(double)n / time,
+		(double)(time * 1000000000) / n,
+		(double)size * n / time / (1024 * 1024 * 1024));
+}
+
+int main(void)
+{
+	buf_t = aligned_alloc(64, BUF_MAX + PAD);
+	buf_s = aligned_alloc(64, BUF_MAX + PAD);
+	if (!buf_t || !buf_s)
+		return 1;
+
+	for (size_t size = BUF_MIN; size <= BUF_MAX; size *= 4) {
+		for (size_t i = 0; i < sizeof(align) / sizeof(align[0]); i++)
+			test_string(B_MEMCPY, size, align[i][0], align[i][1]);
+		for (int32_t type = B_MEMSET; type <= B_UTF8; type++) {
+			test_string(type, size, 0, 0);
+			test_string(type, size, 1, 1);
+		}
+		if (size == BUF_MAX / 2)
+			size /= 2;
+	}
+
+	free(buf_t);
+	free(buf_s);
+
+	return 0;
+}
@@ -0,0 +1,114 @@
+/* @file: test_bench_strtod.c
+ * #desc:
+ *
+ * #copy:
+ *    Copyright (C) 1970 Public Free Software
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program. If not,
+ *    see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <demoz/c/stdint.h>
+#include <demoz/c/stdlib.h>
+
+
+#define SIZE 200000
+/* 10^-POW_MAX .. 10^POW_MAX */
+#define POW_MAX 9
+
+static const char *fmt[] = {
+	"%.17g", "%.6f", "%.3e", "%.40e", "%a"
+};
+
+static char (*str)[64];
+static double *val;
+static volatile double sink;
+
+double now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (double)ts.tv_sec + (double)ts.tv_nsec / 1000000000;
+}
+
+void test_strtod(const char *f, int32_t libc)
+{
+	double time;
+	int32_t bad = 0;
+
+	for (int32_t i = 0; i < SIZE; i++)
+		snprintf(str[i], sizeof(str[i]), f, val[i]);
+
+	time = now();
+	for (int32_t i = 0; i < SIZE; i++) {
+		if (libc) {
+			sink += strtod(str[i], NULL);
+		} else {
+			sink += C_SYMBOL(strtod)(str[i], NULL);
+		}
+	}
+	time = now() - time;
+
+	/* must round the same as the host */
+	for (int32_t i = 0; !libc && i < SIZE; i++) {
+		double a = strtod(str[i], NULL);
+		double b = C_SYMBOL(strntod)(str[i], strlen(str[i]), NULL);
+		if (memcmp(&a, &b, sizeof(double)))
+			bad++;
+	}
+
+	printf("%s %s: %d -- %.6fs (%.2f/s) %.2f ns/op",
+		libc ? " libc" : "demoz", f, SIZE, time,
+		(double)SIZE / time,
+		(double)(time * 1000000000) / SIZE);
+	if (!libc)
+		printf(" (mismatch: %d)", bad);
+	printf("\n");
+}
+
+int main(void)
+{
+	val = malloc(sizeof(double) * SIZE);
+	str = malloc(sizeof(str[0]) * SIZE);
+	if (!val || !str)
+		return 1;
+
+	/* random digits over a spread of magnitudes */
+	srand(123456);
+	for (int32_t i = 0; i < SIZE; i++) {
+		double k = 1.0;
+		for (int32_t n = rand() % (POW_MAX * 2 + 1); n > 0; n--)
+			k *= 10;
+		for (int32_t n = 0; n < POW_MAX; n++)
+			k /= 10;
+		val[i] = (double)rand() / RAND_MAX * k;
+		if (rand() & 1)
+			val[i] = -val[i];
+	}
+
+	for (size_t i = 0; i < sizeof(fmt) / sizeof(fmt[0]); i++) {
+		test_strtod(fmt[i], 0);
+		test_strtod(fmt[i], 1);
+	}
+
+	free(str);
+	free(val);
+
+	return 0;
+}
@@ -0,0 +1,131 @@
+/* @file: test_bench_umalloc.c
+ * #desc:
+ *
+ * #copy:
+ *    Copyright (C) 1970 Public Free Software
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program. If not,
+ *    see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <demoz/c/stddef.h>
+#include <demoz/c/stdint.h>
+#include <demoz/c/stdlib.h>
+#include <demoz/c/sys/umalloc.h>
+
+
+#define SLOT 65536
+#define ROUND 10
+#define SIZE 2000000
+
+static size_t mapped = 0;
+
+void *call_alloc(size_t size, void *arg)
+{
+	(void)arg;
+	mapped += size;
+
+	return aligned_alloc(16, (size + 15) & ~15UL);
+}
+
+void call_free(void *p, size_t size, void *arg)
+{
+	(void)arg;
+	mapped -= size;
+
+	free(p);
+}
+
+/* mixed-size trace: mostly small objects, a tail of buffers */
+size_t trace_size(struct random_ctx *ran)
+{
+	int32_t r, n;
+	C_SYMBOL(random_r)(ran, &r);
+	C_SYMBOL(random_r)(ran, &n);
+	n &= 0x7fffffff;
+
+	r = (uint32_t)r % 100;
+	if (r < 1)
+		return n % (120 * 1024) + 32 * 1024;
+	if (r < 5)
+		return n % (28 * 1024) + 4 * 1024;
+	if (r < 15)
+		return n % 3584 + 512;
+	if (r < 40)
+		return n % 448 + 64;
+
+	return n % 64 + 1;
+}
+
+void test_umalloc(void)
+{
+	clock_t start, end;
+	double time;
+	RANDOM_TYPE0_NEW(ran, 123456);
+	UMALLOC_NEW(ctx, call_alloc, call_free, NULL);
+
+	uint8_t **slot = calloc(SLOT, sizeof(uint8_t *));
+	size_t *len = calloc(SLOT, sizeof(size_t));
+	size_t live = 0;
+	int32_t r;
+
+	for (int32_t k = 0; k < ROUND; k++) {
+		start = clock();
+		for (int32_t i = 0; i < SIZE; i++) {
+			C_SYMBOL(random_r)(&ran, &r);
+			/* the low quarter of slots are long-lived */
+			uint32_t n = (uint32_t)r % SLOT;
+			if (n < (SLOT / 4) && slot[n] && (r & 0xff00))
+				continue;
+
+			if (slot[n]) {
+				C_SYMBOL(___ufree)(&ctx, slot[n]);
+				live -= len[n];
+				slot[n] = NULL;
+				continue;
+			}
+
+			len[n] = trace_size(&ran);
+			slot[n] = C_SYMBOL(___umalloc)(&ctx, len[n]);
+			if (!slot[n]) {
+				printf("no memory: i:%d\n", i);
+				continue;
+			}
+			slot[n][0] = slot[n][len[n] - 1] = (uint8_t)n;
+			live += len[n];
+		}
+		end = clock();
+		time = (double)(end - start) / CLOCKS_PER_SEC;
+		printf("round %d: %d -- %.6fs (%.2f/s) %.2f ns/op, "
+			"live: %zu, mapped: %zu (%.1f%%)\n",
+			k, SIZE, time,
+			(double)SIZE / time,
+			(double)(time * 1000000000) / SIZE,
+			live, mapped, (double)live * 100 / mapped);
+	}
+
+	C_SYMBOL(___ufree_all)(&ctx);
+	free(slot);
+	free(len);
+}
+
+int main(void)
+{
+	test_umalloc();
+
+	return 0;
+}
@@ -0,0 +1,159 @@
+/* @file: test_stdio_file.c
+ * #desc:
+ *
+ * #copy:
+ *    Copyright (C) 1970 Public Free Software
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program. If not,
+ *    see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <demoz/c/stdint.h>
+#include <demoz/c/string.h>
+#include <demoz/c/sys/fcntl.h>
+#include <demoz/c/sys/unistd.h>
+#include <demoz/c/sys/stdio.h>
+
+
+#define PATH "/tmp/demoz_test_stdio_file"
+#define LINES 10000
+#define BLOCK (3 * X_BUFSIZ + 123)
+
+/* bytes on disk, seen through another descriptor */
+x_off_t file_size(void)
+{
+	int32_t fd = C_SYMBOL(open)(PATH, X_O_RDONLY, 0);
+	x_off_t n = C_SYMBOL(lseek)(fd, 0, X_SEEK_END);
+	C_SYMBOL(close)(fd);
+
+	return n;
+}
+
+void test_printf_scanf(void)
+{
+	struct x_file *f = C_SYMBOL(fopen)(PATH, "w+");
+	char name[16];
+	int32_t err = 0, n = 0, a, r;
+	uint64_t b;
+
+	for (int32_t i = 0; i < LINES; i++)
+		C_SYMBOL(fprintf)(f, "%d key%d %lx\n", i, i % 7, i * 3ULL);
+	printf("printf: buffered %d, ", file_size() < C_SYMBOL(ftell)(f));
+
+	C_SYMBOL(rewind)(f);
+	while ((r = C_SYMBOL(fscanf)(f, "%d %15s %lx ", &a, name, &b)) == 3) {
+		if (a != n || b != (uint64_t)n * 3
+				|| name[3] != '0' + n % 7)
+			err++;
+		n++;
+	}
+	printf("scanf: %d %d, eof %d, err %d\n", n, r,
+		C_SYMBOL(feof)(f), err);
+
+	C_SYMBOL(fclose)(f);
+}
+
+/* one number per line, the pairs cross the buffer end */
+void test_scanf_pairs(void)
+{
+	struct x_file *f = C_SYMBOL(fopen)(PATH, "w+");
+	int32_t err = 0, n = 0, a, b, r;
+
+	for (int32_t i = 0; i < LINES; i++)
+		C_SYMBOL(fprintf)(f, "%d\n", i * 37);
+
+	C_SYMBOL(rewind)(f);
+	while ((r = C_SYMBOL(fscanf)(f, "%d %d ", &a, &b)) == 2) {
+		if (a != n * 37 || b != (n + 1) * 37)
+			err++;
+		n += 2;
+	}
+	printf("scanf pairs: %d %d, err %d\n", n, r, err);
+
+	C_SYMBOL(fclose)(f);
+}
+
+void test_read_write(void)
+{
+	static uint8_t in[BLOCK], out[BLOCK];
+	struct x_file *f = C_SYMBOL(fopen)(PATH, "w+");
+
+	for (int32_t i = 0; i < BLOCK; i++)
+		out[i] = (uint8_t)(i * 31 + 7);
+
+	C_SYMBOL(fwrite)(out, 1, 10, f);
+	C_SYMBOL(fwrite)(out + 10, 1, BLOCK - 10, f);
+	C_SYMBOL(fseek)(f, 5, X_SEEK_SET);
+	C_SYMBOL(fputs)("hello", f);
+	C_SYMBOL(memcpy)(out + 5, "hello", 5);
+	printf("write: %ld\n", (long)C_SYMBOL(ftell)(f));
+
+	C_SYMBOL(rewind)(f);
+	size_t k = C_SYMBOL(fread)(in, 1, 100, f);
+	k += C_SYMBOL(fread)(in + 100, 1, BLOCK, f);
+	printf("read: %zu, eof %d, cmp %d\n", k, C_SYMBOL(feof)(f),
+		C_SYMBOL(memcmp)(in, out, BLOCK));
+
+	C_SYMBOL(fseek)(f, -3, X_SEEK_END);
+	C_SYMBOL(getc)(f);
+	printf("getc: %ld", (long)C_SYMBOL(ftell)(f));
+	printf(" %d", C_SYMBOL(getc)(f) == out[BLOCK - 2]);
+	printf(" %d", C_SYMBOL(getc)(f) == out[BLOCK - 1]);
+	printf(" %d\n", C_SYMBOL(getc)(f));
+
+	C_SYMBOL(fclose)(f);
+}
+
+void test_line(void)
+{
+	struct x_file *f = C_SYMBOL(fopen)(PATH, "w");
+
+	C_SYMBOL(setvbuf)(f, NULL, X_IOLBF, 256);
+	C_SYMBOL(fprintf)(f, "abc");
+	printf("line: %ld", (long)file_size());
+	C_SYMBOL(fprintf)(f, "%s\nx", "def");
+	printf(" %ld", (long)file_size());
+	C_SYMBOL(flockfile)(f);
+	C_SYMBOL(putc)('\n', f);
+	C_SYMBOL(funlockfile)(f);
+	printf(" %ld\n", (long)file_size());
+
+	/* the newline write does not fit, the buffer is flushed first */
+	C_SYMBOL(fclose)(f);
+	f = C_SYMBOL(fopen)(PATH, "w");
+	C_SYMBOL(setvbuf)(f, NULL, X_IOLBF, 17);
+	C_SYMBOL(fwrite)("Hello, world!", 1, 13, f);
+	printf("line boundary: %ld", (long)file_size());
+	C_SYMBOL(fputs)("xyz\n", f);
+	printf(" %ld\n", (long)file_size());
+
+	C_SYMBOL(fclose)(f);
+	f = C_SYMBOL(fopen)(PATH, "a");
+	C_SYMBOL(setvbuf)(f, NULL, X_IONBF, 0);
+	C_SYMBOL(fprintf)(f, "%d", 12345);
+	printf("none: %ld\n", (long)file_size());
+
+	C_SYMBOL(fclose)(f);
+}
+
+int main(void)
+{
+	test_printf_scanf();
+	test_scanf_pairs();
+	test_read_write();
+	test_line();
+
+	return 0;
+}
@@ -20,10 +20,50 @@
  */
 
 #include <stdio.h>
+#include <pthread.h>
 #include <demoz/c/stdint.h>
 #include <demoz/c/sys/stdlib.h>
 
 
+#define THREAD_LOOP 200
+#define THREAD_OBJS 64
+
+static void *g_seen[THREAD_LOOP * THREAD_OBJS];
+static int32_t g_seen_num = 0;
+
+/* the blocks stay in the thread cache after the frees */
+void *worker(void *arg)
+{
+	void *p[THREAD_OBJS];
+	(void)arg;
+
+	for (int32_t i = 0; i < THREAD_OBJS; i++)
+		p[i] = C_SYMBOL(malloc)(64);
+	for (int32_t i = 0; i < THREAD_OBJS; i++) {
+		int32_t k = 0;
+		for (; k < g_seen_num && g_seen[k] != p[i]; k++);
+		if (k == g_seen_num)
+			g_seen[g_seen_num++] = p[i];
+		C_SYMBOL(free)(p[i]);
+	}
+	C_SYMBOL(malloc_thread_release)();
+
+	return NULL;
+}
+
+void test_thread(void)
+{
+	pthread_t tid;
+
+	/* one thread at a time, later threads reuse the released blocks */
+	for (int32_t i = 0; i < THREAD_LOOP; i++) {
+		pthread_create(&tid, NULL, worker, NULL);
+		pthread_join(tid, NULL);
+	}
+	printf("threads: %d, blocks: %d (%d without release)\n",
+		THREAD_LOOP, g_seen_num, THREAD_LOOP * THREAD_OBJS);
+}
+
 int main(void)
 {
 	void *p = C_SYMBOL(malloc)(0);
@@ -42,5 +82,30 @@ int main(void)
 	p = C_SYMBOL(malloc)(1*1024*1024*1024);
 	printf("%p: %zu\n", p, (uintptr_t)p & 15);
 
+	p = C_SYMBOL(realloc)(p, 2UL*1024*1024*1024);
+	printf("%p: %zu\n", p, C_SYMBOL(malloc_usable_size)(p));
+	C_SYMBOL(free)(p);
+
+	p = C_SYMBOL(calloc)(100, 17);
+	printf("%p: %zu\n", p, C_SYMBOL(malloc_usable_size)(p));
+
+	p = C_SYMBOL(realloc)(p, 4000);
+	printf("%p: %zu\n", p, C_SYMBOL(malloc_usable_size)(p));
+
+	p = C_SYMBOL(aligned_alloc)(4096, 100);
+	printf("%p: %zu\n", p, (uintptr_t)p & 4095);
+
+	p = C_SYMBOL(aligned_alloc)(1 << 20, 100);
+	printf("%p: %zu\n", p, (uintptr_t)p & ((1 << 20) - 1));
+	C_SYMBOL(free)(p);
+
+	int32_t ret = C_SYMBOL(posix_memalign)(&p, 1 << 21, 4 << 20);
+	printf("%p: %d %zu\n", p, ret, (uintptr_t)p & ((1 << 21) - 1));
+	p = C_SYMBOL(realloc)(p, 8 << 20);
+	printf("%p: %zu\n", p, C_SYMBOL(malloc_usable_size)(p));
+	C_SYMBOL(free)(p);
+
+	test_thread();
+
 	return 0;
 }
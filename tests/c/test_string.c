@@ -0,0 +1,53 @@
+/* @file: test_string.c
+ * #desc:
+ *
+ * #copy:
+ *    Copyright (C) 1970 Public Free Software
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program. If not,
+ *    see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdio.h>
+#include <demoz/c/stdint.h>
+#include <demoz/c/string.h>
+
+
+static char g_buf[128] __attribute__((aligned(64)));
+
+/* (size_t)-1 is "no limit" at every alignment */
+void test_nolimit(void)
+{
+	int32_t n = 0, m = 0, m2 = 0;
+
+	for (size_t i = 0; i < 64; i++) {
+		char *s = g_buf + i;
+		C_SYMBOL(memcpy)(s, "abc", 4);
+
+		n += C_SYMBOL(strnlen)(s, (size_t)-1) == 3;
+		m += C_SYMBOL(memchr)(s, 'c', (size_t)-1) == s + 2;
+		m2 += C_SYMBOL(memchr2)(s, 'z', 'c', (size_t)-1) == s + 2;
+	}
+	printf("strnlen: %d/64\n", n);
+	printf("memchr: %d/64\n", m);
+	printf("memchr2: %d/64\n", m2);
+}
+
+int main(void)
+{
+	test_nolimit();
+
+	return 0;
+}
@@ -0,0 +1,79 @@
+/* @file: test_string_utf8.c
+ * #desc:
+ *
+ * #copy:
+ *    Copyright (C) 1970 Public Free Software
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program. If not,
+ *    see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <demoz/c/stdint.h>
+#include <demoz/c/string.h>
+
+
+static const struct {
+	const char *name;
+	const char *s;
+} utf8[] = {
+	{ "ascii", "hello, world" },
+	{ "2-byte", "caf\xc3\xa9" },
+	{ "3-byte", "\xe2\x82\xac 100" },
+	{ "4-byte", "\xf0\x9f\x98\x80" },
+	{ "max", "\xf4\x8f\xbf\xbf" },
+	{ "before surrogates", "\xed\x9f\xbf" },
+	{ "after surrogates", "\xee\x80\x80" },
+	{ "lone continuation", "a\x80" },
+	{ "truncated 2-byte", "caf\xc3" },
+	{ "truncated 4-byte", "\xf0\x9f\x98" },
+	{ "overlong 2-byte", "\xc0\xaf" },
+	{ "overlong 3-byte", "\xe0\x80\xaf" },
+	{ "overlong 4-byte", "\xf0\x80\x80\xaf" },
+	{ "surrogate", "\xed\xa0\x80" },
+	{ "too large", "\xf4\x90\x80\x80" },
+	{ "invalid byte", "\xff" },
+	{ "5-byte lead", "\xf8\x88\x80\x80\x80" }
+};
+
+void test_utf8(void)
+{
+	char buf[128];
+
+	for (size_t i = 0; i < sizeof(utf8) / sizeof(utf8[0]); i++) {
+		size_t len = strlen(utf8[i].s);
+		printf("%s: %d", utf8[i].name,
+			C_SYMBOL(utf8_validate)(utf8[i].s, len));
+
+		/* across the 32-byte and 64-byte vector boundaries */
+		for (size_t at = 27; at < 66; at += 1) {
+			memset(buf, 'x', sizeof(buf));
+			memcpy(buf + at, utf8[i].s, len);
+			if (C_SYMBOL(utf8_validate)(buf, sizeof(buf))
+					!= C_SYMBOL(utf8_validate)(utf8[i].s, len)) {
+				printf(" (differs at %zu)", at);
+				break;
+			}
+		}
+		printf("\n");
+	}
+}
+
+int main(void)
+{
+	test_utf8();
+
+	return 0;
+}
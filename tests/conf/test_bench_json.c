@@ -0,0 +1,124 @@
+/* @file: test_bench_json.c
+ * #desc:
+ *
+ * #copy:
+ *    Copyright (C) 1970 Public Free Software
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program. If not,
+ *    see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <demoz/c/stdint.h>
+#include <demoz/conf/json_parse.h>
+
+
+/* usage: zcat t_json_twitter.json.gz > a.json && ./a.out a.json */
+
+#define LOOP_MIN 20
+/* bytes parsed per file, at least */
+#define BYTES_MIN (1L << 30)
+
+static char g_tok[1 << 16];
+
+double now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (double)ts.tv_sec + (double)ts.tv_nsec / 1000000000;
+}
+
+int32_t call(int32_t type, const char *s, int32_t len, void *arg)
+{
+	(void)type;
+	(void)s;
+	(void)len;
+	(*(long *)arg)++;
+
+	return 0;
+}
+
+int32_t call_end(int32_t type, void *arg)
+{
+	(void)type;
+	(*(long *)arg)++;
+
+	return 0;
+}
+
+void test_parse(const char *name, const char *buf, long size)
+{
+	long loop = BYTES_MIN / size, events = 0;
+	double time;
+	int32_t r = 0;
+
+	if (loop < LOOP_MIN)
+		loop = LOOP_MIN;
+
+	JSON_NEW(ctx, call, call_end, &events);
+	time = now();
+	for (long i = 0; i < loop && !r; i++)
+		r = F_SYMBOL(json_parse)(&ctx, buf);
+	time = now() - time;
+
+	printf("json_parse %s: %d, %ld bytes, %ld events -- %.3f GB/s\n",
+		name, r, size, events / loop,
+		(double)size * loop / time / 1000000000);
+
+	JSON_NEW(feed, call, call_end, &events);
+	JSON_FEED_INIT(&feed, g_tok, sizeof(g_tok));
+	events = 0;
+	r = 0;
+	time = now();
+	for (long i = 0; i < loop && !r; i++) {
+		F_SYMBOL(json_feed_reset)(&feed);
+		r = F_SYMBOL(json_feed)(&feed, buf, (int32_t)size);
+		if (!r)
+			r = F_SYMBOL(json_finish)(&feed);
+	}
+	time = now() - time;
+
+	printf("json_feed  %s: %d, %ld bytes, %ld events -- %.3f GB/s\n",
+		name, r, size, events / loop,
+		(double)size * loop / time / 1000000000);
+}
+
+int main(int argc, char *argv[])
+{
+	for (int32_t n = 1; n < argc; n++) {
+		FILE *fp;
+		char *buf;
+		long size;
+
+		fp = fopen(argv[n], "rb");
+		if (!fp)
+			return 1;
+		fseek(fp, 0, SEEK_END);
+		size = ftell(fp);
+		fseek(fp, 0, SEEK_SET);
+		buf = malloc(size + 1);
+		if (!buf || fread(buf, 1, size, fp) != (size_t)size)
+			return 1;
+		buf[size] = '\0';
+		fclose(fp);
+
+		test_parse(argv[n], buf, size);
+		free(buf);
+	}
+
+	return 0;
+}
@@ -0,0 +1,185 @@
+/* @file: test_ini_index.c
+ * #desc:
+ *
+ * #copy:
+ *    Copyright (C) 1970 Public Free Software
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program. If not,
+ *    see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <demoz/c/stddef.h>
+#include <demoz/c/stdint.h>
+#include <demoz/ds/arena.h>
+#include <demoz/conf/ini_index.h>
+
+
+static const char *doc =
+	"name = demoz ; global\n"
+	"\n"
+	"[server]\n"
+	"host = \"example.org\"\n"
+	"port = 8080\n"
+	"mask = 0x1f\n"
+	"big = 99999999999999999999\n"
+	"big16 = 0x10000000000000000\n"
+	"debug = Yes\n"
+	"ratio = 0.75\n"
+	"timeout = 1h30m\n"
+	"retry = 250ms\n"
+	"empty =\n"
+	"port = 8081 # last one wins\n"
+	"\n"
+	"[client]\n"
+	"timeout = 30\n"
+	"debug = off\n"
+	"name = demoz\n"
+	"\n"
+	"[server]\n"
+	"idle = 2d\n";
+
+static const char *keys[][2] = {
+	{ NULL, "name" }, { "server", "host" }, { "server", "port" },
+	{ "server", "empty" }, { "server", "idle" }, { "client", "name" },
+	{ "client", "host" }, { "none", "name" }, { NULL, "port" }
+};
+
+void *call_alloc(size_t size, void *arg)
+{
+	(void)arg;
+
+	return malloc(size);
+}
+
+void call_free(void *p, size_t size, void *arg)
+{
+	(void)size;
+	(void)arg;
+
+	free(p);
+}
+
+void print_index(struct ini_index *idx)
+{
+	const char *s;
+	int64_t n;
+	int32_t b, len;
+	double d;
+
+	for (size_t i = 0; i < sizeof(keys) / sizeof(keys[0]); i++) {
+		s = F_SYMBOL(ini_index_get)(idx, keys[i][0], keys[i][1], &len);
+		printf("[%s] %s: ", keys[i][0] ? keys[i][0] : "", keys[i][1]);
+		if (s) {
+			printf("(%d) \"%s\"\n", len, s);
+		} else {
+			printf("not found\n");
+		}
+	}
+
+	if (!F_SYMBOL(ini_index_int)(idx, "server", "port", &n))
+		printf("int port: %lld\n", (long long)n);
+	if (!F_SYMBOL(ini_index_int)(idx, "server", "mask", &n))
+		printf("int mask: %lld\n", (long long)n);
+	printf("int host: %d\n", F_SYMBOL(ini_index_int)(idx, "server",
+		"host", &n));
+	printf("int big: %d, big16: %d\n",
+		F_SYMBOL(ini_index_int)(idx, "server", "big", &n),
+		F_SYMBOL(ini_index_int)(idx, "server", "big16", &n));
+	if (!F_SYMBOL(ini_index_bool)(idx, "server", "debug", &b))
+		printf("bool server.debug: %d\n", b);
+	if (!F_SYMBOL(ini_index_bool)(idx, "client", "debug", &b))
+		printf("bool client.debug: %d\n", b);
+	printf("bool port: %d\n", F_SYMBOL(ini_index_bool)(idx, "server",
+		"port", &b));
+	if (!F_SYMBOL(ini_index_double)(idx, "server", "ratio", &d))
+		printf("double ratio: %g\n", d);
+	if (!F_SYMBOL(ini_index_duration)(idx, "server", "timeout", &n))
+		printf("duration server.timeout: %lld\n", (long long)n);
+	if (!F_SYMBOL(ini_index_duration)(idx, "server", "retry", &n))
+		printf("duration retry: %lld\n", (long long)n);
+	if (!F_SYMBOL(ini_index_duration)(idx, "server", "idle", &n))
+		printf("duration idle: %lld\n", (long long)n);
+	if (!F_SYMBOL(ini_index_duration)(idx, "client", "timeout", &n))
+		printf("duration client.timeout: %lld\n", (long long)n);
+	printf("duration ratio: %d\n", F_SYMBOL(ini_index_duration)(idx,
+		"server", "ratio", &n));
+	printf("has client: %d, has none: %d\n",
+		F_SYMBOL(ini_index_has)(idx, "client"),
+		F_SYMBOL(ini_index_has)(idx, "none"));
+}
+
+void test_ini_index(void)
+{
+	struct arena_ctx arena;
+	struct ini_index idx, map;
+	struct ini_index_head *h;
+	struct ini_index_key *key;
+	const uint8_t *ctrl;
+	const void *image;
+	void *buf;
+	size_t size, i;
+	uint32_t v;
+
+	F_SYMBOL(arena_init)(&arena, 0, call_alloc, call_free, NULL);
+	if (F_SYMBOL(ini_index_load)(&idx, &arena, doc)) {
+		printf("ini_index_load: error %d\n", INI_INDEX_ERR(&idx));
+		return;
+	}
+	print_index(&idx);
+
+	/* snapshot copy, as if it was written out and mapped back */
+	image = F_SYMBOL(ini_index_snapshot)(&idx, &size);
+	buf = aligned_alloc(64, (size + 63) & ~(size_t)63);
+	memcpy(buf, image, size);
+	F_SYMBOL(arena_release)(&arena);
+
+	if (F_SYMBOL(ini_index_open)(&map, buf, size)) {
+		printf("ini_index_open: error %d\n", INI_INDEX_ERR(&map));
+		return;
+	}
+	printf("snapshot:\n");
+	print_index(&map);
+
+	/* errors */
+	printf("truncated: %d\n", F_SYMBOL(ini_index_open)(&map, buf,
+		size - 1));
+	/* first full key slot, value out of the image */
+	h = buf;
+	ctrl = (const uint8_t *)buf + h->key_ctrl;
+	key = (struct ini_index_key *)((char *)buf + h->key_array);
+	for (i = 0; ctrl[i] & 0x80; i++);
+	v = key[i].value;
+	key[i].value = h->size;
+	printf("bucket: %d error %d\n", F_SYMBOL(ini_index_open)(&map, buf,
+		size), INI_INDEX_ERR(&map));
+	key[i].value = v;
+	((uint32_t *)buf)[0] ^= 1;
+	printf("magic: %d error %d\n", F_SYMBOL(ini_index_open)(&map, buf,
+		size), INI_INDEX_ERR(&map));
+	free(buf);
+
+	if (F_SYMBOL(ini_index_load)(&idx, &arena, "[a\nb = 1\n"))
+		printf("syntax: error %d\n", INI_INDEX_ERR(&idx));
+	F_SYMBOL(arena_release)(&arena);
+}
+
+int main(void)
+{
+	test_ini_index();
+
+	return 0;
+}
@@ -0,0 +1,156 @@
+/* @file: test_json_dom.c
+ * #desc:
+ *
+ * #copy:
+ *    Copyright (C) 1970 Public Free Software
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program. If not,
+ *    see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <demoz/c/stddef.h>
+#include <demoz/c/stdint.h>
+#include <demoz/ds/arena.h>
+#include <demoz/conf/json_dom.h>
+
+
+static const char *doc =
+	"{\n"
+	"  \"name\": \"demoz\",\n"
+	"  \"esc\": \"a\\\"b\\\\c\\/d\\n\\u00e9\\ud83d\\ude00\",\n"
+	"  \"a/b\": 1, \"m~n\": 2,\n"
+	"  \"list\": [ 1, -2.5, 1.5e2, true, false, null, [], {} ],\n"
+	"  \"obj\": { \"x\": { \"y\": [ \"deep\" ] } },\n"
+	"  // json5\n"
+	"  'single': 'it\\'s',\n"
+	"  \"\": \"empty key\"\n"
+	"}";
+
+static const char *path[] = {
+	"", "/name", "/esc", "/a~1b", "/m~0n", "/list", "/list/0",
+	"/list/1", "/list/2", "/list/3", "/list/6", "/list/8", "/list/01",
+	"/list/-", "/obj/x/y/0", "/obj/x/z", "/single", "/", "/name/0"
+};
+
+void *call_alloc(size_t size, void *arg)
+{
+	(void)arg;
+
+	return malloc(size);
+}
+
+void call_free(void *p, size_t size, void *arg)
+{
+	(void)size;
+	(void)arg;
+
+	free(p);
+}
+
+void print_value(struct json_dom *dom, int32_t v)
+{
+	const char *s;
+	int32_t len;
+
+	switch (JSON_DOM_TYPE(dom, v)) {
+		case JSON_ARRAY_TYPE:
+			printf("array(%d)", F_SYMBOL(json_dom_size)(dom, v));
+			break;
+		case JSON_OBJECT_TYPE:
+			printf("object(%d)", F_SYMBOL(json_dom_size)(dom, v));
+			break;
+		case JSON_STRING_TYPE:
+			s = F_SYMBOL(json_dom_string)(dom, v, &len);
+			printf("string(%d) \"", len);
+			for (int32_t i = 0; i < len; i++) {
+				if ((uint8_t)s[i] < 0x20 || (uint8_t)s[i] >= 0x7f) {
+					printf("\\x%02x", (uint8_t)s[i]);
+				} else {
+					putchar(s[i]);
+				}
+			}
+			printf("\"");
+			break;
+		case JSON_NUMBER_TYPE:
+			printf("number %g", F_SYMBOL(json_dom_number)(dom, v));
+			break;
+		case JSON_NULL_TYPE:
+			printf("null");
+			break;
+		case JSON_TRUE_TYPE:
+			printf("true");
+			break;
+		case JSON_FALSE_TYPE:
+			printf("false");
+			break;
+	}
+}
+
+void test_json_dom(void)
+{
+	struct arena_ctx arena;
+	struct json_dom dom;
+	int32_t v;
+
+	F_SYMBOL(arena_init)(&arena, 0, call_alloc, call_free, NULL);
+	if (F_SYMBOL(json_dom_parse)(&dom, &arena, doc)) {
+		printf("json_dom_parse: error %d\n", dom.err);
+		return;
+	}
+	printf("tape: %d entries\n", dom.len);
+
+	for (size_t i = 0; i < sizeof(path) / sizeof(path[0]); i++) {
+		printf("\"%s\": ", path[i]);
+		v = F_SYMBOL(json_dom_pointer)(&dom, 0, path[i]);
+		if (v < 0) {
+			printf("not found\n");
+			continue;
+		}
+		print_value(&dom, v);
+		printf("\n");
+	}
+
+	/* iteration */
+	for (v = F_SYMBOL(json_dom_child)(&dom, 0); v >= 0;
+			v = F_SYMBOL(json_dom_next)(&dom, v)) {
+		const char *s;
+		int32_t len;
+		s = F_SYMBOL(json_dom_string)(&dom, v, &len);
+		printf("key \"%.*s\": ", len, s);
+		print_value(&dom, v + 2);
+		printf("\n");
+	}
+
+	v = F_SYMBOL(json_dom_get)(&dom, 0, "list", 4);
+	printf("list[4]: ");
+	print_value(&dom, F_SYMBOL(json_dom_at)(&dom, v, 4));
+	printf("\nlist[8]: %d\n", F_SYMBOL(json_dom_at)(&dom, v, 8));
+
+	/* errors */
+	if (F_SYMBOL(json_dom_parse)(&dom, &arena, "[1, 2"))
+		printf("truncated: error %d\n", dom.err);
+	if (F_SYMBOL(json_dom_parse)(&dom, &arena, "{\"a\" 1}"))
+		printf("syntax: error %d\n", dom.err);
+
+	F_SYMBOL(arena_release)(&arena);
+}
+
+int main(void)
+{
+	test_json_dom();
+
+	return 0;
+}
@@ -0,0 +1,120 @@
+/* @file: test_json_feed.c
+ * #desc:
+ *
+ * #copy:
+ *    Copyright (C) 1970 Public Free Software
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program. If not,
+ *    see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <demoz/c/stdint.h>
+#include <demoz/conf/json_parse.h>
+
+
+/* usage: zcat t_json_canada.json.gz > a.json && ./a.out a.json */
+
+struct events {
+	uint64_t hash;
+	int32_t count;
+};
+
+static const int32_t chunk[] = {
+	1, 2, 3, 7, 64, 4093, 1 << 20
+};
+
+static char g_tok[1 << 16];
+
+void hash(struct events *e, const void *p, int32_t len)
+{
+	const uint8_t *s = p;
+	for (int32_t i = 0; i < len; i++)
+		e->hash = (e->hash ^ s[i]) * 0x100000001b3ULL;
+}
+
+int32_t call(int32_t type, const char *s, int32_t len, void *arg)
+{
+	struct events *e = arg;
+	hash(e, &type, sizeof(type));
+	hash(e, &len, sizeof(len));
+	if (s)
+		hash(e, s, len);
+	e->count++;
+
+	return 0;
+}
+
+int32_t call_end(int32_t type, void *arg)
+{
+	struct events *e = arg;
+	type = -type;
+	hash(e, &type, sizeof(type));
+	e->count++;
+
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	struct events a = { 0xcbf29ce484222325ULL, 0 };
+	FILE *fp;
+	char *buf;
+	long size;
+	int32_t r;
+
+	if (argc < 2)
+		return 1;
+	fp = fopen(argv[1], "rb");
+	if (!fp)
+		return 1;
+	fseek(fp, 0, SEEK_END);
+	size = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+	buf = malloc(size + 1);
+	if (!buf || fread(buf, 1, size, fp) != (size_t)size)
+		return 1;
+	buf[size] = '\0';
+	fclose(fp);
+
+	JSON_NEW(ctx, call, call_end, &a);
+	r = F_SYMBOL(json_parse)(&ctx, buf);
+	printf("json_parse: %d, events: %d, hash: %016llx\n",
+		r, a.count, (unsigned long long)a.hash);
+
+	for (size_t n = 0; n < sizeof(chunk) / sizeof(chunk[0]); n++) {
+		struct events b = { 0xcbf29ce484222325ULL, 0 };
+		JSON_NEW(feed, call, call_end, &b);
+		JSON_FEED_INIT(&feed, g_tok, sizeof(g_tok));
+		F_SYMBOL(json_feed_reset)(&feed);
+
+		r = 0;
+		for (long i = 0; i < size && !r; i += chunk[n]) {
+			int32_t len = (size - i < chunk[n]) ? (size - i) : chunk[n];
+			r = F_SYMBOL(json_feed)(&feed, buf + i, len);
+		}
+		if (!r)
+			r = F_SYMBOL(json_finish)(&feed);
+
+		printf("json_feed %7d: %d (err: %d), events: %d, hash: %016llx %s\n",
+			chunk[n], r, JSON_ERR(&feed), b.count,
+			(unsigned long long)b.hash,
+			(b.count == a.count && b.hash == a.hash) ? "ok" : "FAIL");
+	}
+
+	free(buf);
+
+	return 0;
+}
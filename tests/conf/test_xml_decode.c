@@ -0,0 +1,147 @@
+/* @file: test_xml_decode.c
+ * #desc:
+ *
+ * #copy:
+ *    Copyright (C) 1970 Public Free Software
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program. If not,
+ *    see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <demoz/c/stdint.h>
+#include <demoz/conf/xml_parse.h>
+
+
+static const char *refs[] = {
+	"plain text",
+	"a &lt; b &amp;&amp; c &gt; d",
+	"&quot;q&quot; &apos;a&apos;",
+	"&#65;&#x42;",
+	"&#X43;",
+	"&#xe9; &#8364; &#x1F600;",
+	"&#x10FFFF;",
+	"&",
+	"&lt",
+	"&nbsp;",
+	"&#;",
+	"&#x;",
+	"&#0;",
+	"&#xD800;",
+	"&#x110000;",
+	"&#65"
+};
+
+static const char doc[] =
+	"<?xml version=\"1.0\"?>\n"
+	"<a title=\"x &amp; y\">1 &lt; 2<!-- &amp; --><![CDATA[&amp;]]>"
+	"<b>&#x263A;</b></a>\n";
+
+static char g_tok[64], g_buf[64], g_cut[sizeof(doc)];
+
+int32_t call(int32_t type, const char *s, int32_t len, void *arg)
+{
+	(void)arg;
+	if (s)
+		printf("  %d: '%.*s'\n", type, len, s);
+
+	return 0;
+}
+
+int32_t quiet(int32_t type, const char *s, int32_t len, void *arg)
+{
+	(void)type;
+	(void)s;
+	(void)len;
+	(void)arg;
+
+	return 0;
+}
+
+void test_decode(void)
+{
+	char buf[64];
+
+	for (size_t i = 0; i < sizeof(refs) / sizeof(refs[0]); i++) {
+		int32_t r = F_SYMBOL(xml_decode)(buf, refs[i],
+			(int32_t)strlen(refs[i]));
+		if (r < 0) {
+			printf("'%s': error\n", refs[i]);
+		} else {
+			printf("'%s': '%.*s'\n", refs[i], r, buf);
+		}
+	}
+}
+
+void test_feed(void)
+{
+	int32_t r = 0;
+
+	/* one byte at a time, every token is split */
+	XML_NEW(ctx, call, call, NULL);
+	XML_FEED_INIT(&ctx, g_tok, sizeof(g_tok));
+	XML_OPT_INIT(&ctx, XML_OPT_DECODE, g_buf, sizeof(g_buf));
+	F_SYMBOL(xml_feed_reset)(&ctx);
+	for (size_t i = 0; i < sizeof(doc) - 1 && !r; i++)
+		r = F_SYMBOL(xml_feed)(&ctx, doc + i, 1);
+	if (!r)
+		r = F_SYMBOL(xml_finish)(&ctx);
+	printf("xml_feed: %d (err: %d)\n", r, XML_ERR(&ctx));
+
+	XML_NEW(bad, call, call, NULL);
+	XML_OPT_INIT(&bad, XML_OPT_DECODE, g_buf, sizeof(g_buf));
+	r = F_SYMBOL(xml_parse)(&bad, "<a>&bad;</a>");
+	printf("xml_parse: %d (err: %d)\n", r, XML_ERR(&bad));
+}
+
+void test_truncated(void)
+{
+	int32_t n = 0, diff = 0, r, k;
+
+	/* every cut of the document, xml_parse reports what xml_feed does */
+	for (size_t i = 1; i < sizeof(doc) - 2; i++) {
+		memcpy(g_cut, doc, i);
+		g_cut[i] = '\0';
+
+		XML_NEW(ctx, quiet, quiet, NULL);
+		r = F_SYMBOL(xml_parse)(&ctx, g_cut);
+
+		XML_NEW(feed, quiet, quiet, NULL);
+		XML_FEED_INIT(&feed, g_tok, sizeof(g_tok));
+		F_SYMBOL(xml_feed_reset)(&feed);
+		k = F_SYMBOL(xml_feed)(&feed, g_cut, (int32_t)i);
+		if (!k)
+			k = F_SYMBOL(xml_finish)(&feed);
+
+		n += XML_ERR(&ctx) == XML_ERR_INCOMPLETE;
+		diff += r != k || XML_ERR(&ctx) != XML_ERR(&feed);
+	}
+	printf("truncated: %d incomplete, %d differ\n", n, diff);
+
+	XML_NEW(cut, quiet, quiet, NULL);
+	r = F_SYMBOL(xml_parse)(&cut, "<a><b x=\"1");
+	printf("xml_parse: %d (err: %d)\n", r, XML_ERR(&cut));
+	r = F_SYMBOL(xml_parse)(&cut, "<?xml version=\"1.0\"?");
+	printf("xml_parse: %d (err: %d)\n", r, XML_ERR(&cut));
+}
+
+int main(void)
+{
+	test_decode();
+	test_feed();
+	test_truncated();
+
+	return 0;
+}
@@ -0,0 +1,99 @@
+/* @file: test_arena.c
+ * #desc:
+ *
+ * #copy:
+ *    Copyright (C) 1970 Public Free Software
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program. If not,
+ *    see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <demoz/c/stddef.h>
+#include <demoz/c/stdint.h>
+#include <demoz/ds/arena.h>
+
+
+static int32_t blocks = 0;
+
+void *call_alloc(size_t size, void *arg)
+{
+	(void)arg;
+	blocks++;
+
+	return malloc(size);
+}
+
+void call_free(void *p, size_t size, void *arg)
+{
+	(void)size;
+	(void)arg;
+	blocks--;
+
+	free(p);
+}
+
+void test_arena(void)
+{
+	struct arena_ctx ctx;
+	struct arena_mark mark;
+	char *p, *q, *r;
+
+	F_SYMBOL(arena_init)(&ctx, 1024, call_alloc, call_free, NULL);
+
+	p = F_SYMBOL(arena_alloc)(&ctx, 1);
+	printf("alloc: %d aligned:%d blocks:%d\n", 1,
+		!((uintptr_t)p & 15), blocks);
+
+	p = F_SYMBOL(arena_alloc_align)(&ctx, 3, 64);
+	printf("alloc: %d-%d aligned:%d blocks:%d\n", 3, 64,
+		!((uintptr_t)p & 63), blocks);
+
+	F_SYMBOL(arena_mark)(&ctx, &mark);
+	p = F_SYMBOL(arena_alloc)(&ctx, 100);
+	for (int32_t i = 0; i < 64; i++)
+		F_SYMBOL(arena_alloc)(&ctx, 100);
+	printf("alloc: %d*%d blocks:%d\n", 100, 65, blocks);
+
+	q = F_SYMBOL(arena_alloc)(&ctx, 4096);
+	printf("alloc: %d aligned:%d blocks:%d\n", 4096,
+		!((uintptr_t)q & 15), blocks);
+
+	F_SYMBOL(arena_reset)(&ctx, &mark);
+	q = F_SYMBOL(arena_alloc)(&ctx, 100);
+	printf("reset: mark blocks:%d same:%d\n", blocks, p == q);
+
+	/* no wrap around the block end */
+	p = F_SYMBOL(arena_alloc)(&ctx, (size_t)-1 - 8);
+	q = F_SYMBOL(arena_alloc)(&ctx, 16);
+	r = F_SYMBOL(arena_alloc)(&ctx, 16);
+	printf("alloc: max-8 null:%d next:%d blocks:%d\n", !p, r == q + 16,
+		blocks);
+
+	for (int32_t i = 0; i < 64; i++)
+		F_SYMBOL(arena_alloc)(&ctx, 100);
+	F_SYMBOL(arena_reset)(&ctx, NULL);
+	printf("reset: null blocks:%d\n", blocks);
+
+	F_SYMBOL(arena_release)(&ctx);
+	printf("release: blocks:%d\n", blocks);
+}
+
+int main(void)
+{
+	test_arena();
+
+	return 0;
+}
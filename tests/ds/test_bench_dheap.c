@@ -0,0 +1,170 @@
+/* @file: test_bench_dheap.c
+ * #desc:
+ *
+ * #copy:
+ *    Copyright (C) 1970 Public Free Software
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program. If not,
+ *    see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <demoz/c/stddef.h>
+#include <demoz/c/stdint.h>
+#include <demoz/c/stdlib.h>
+#include <demoz/ds/minheap.h>
+#include <demoz/ds/dheap.h>
+
+
+/* timers: 7/8 ops expire the first timer and rearm it,
+ * 1/8 ops cancel a random timer and rearm it (minheap: search) */
+#define TIMERS (1 << 14)
+#define TIMERS_MAX (1 << 20)
+#define OPS (1 << 21)
+
+struct T {
+	uint64_t key; /* deadline:44 | id:20, unique */
+	struct dheap_node node;
+};
+
+static struct T timer[TIMERS_MAX];
+static int32_t ran[OPS];
+
+int32_t cmp_minheap(void *a, void *b)
+{
+	uint64_t key_a = ((struct T *)a)->key;
+	uint64_t key_b = ((struct T *)b)->key;
+
+	return (key_a > key_b) ? 1 : ((key_a < key_b) ? -1 : 0);
+}
+
+int32_t cmp_dheap(void *a, void *b)
+{
+	uint64_t key_a = container_of(a, struct T, node)->key;
+	uint64_t key_b = container_of(b, struct T, node)->key;
+
+	return (key_a > key_b) ? 1 : ((key_a < key_b) ? -1 : 0);
+}
+
+/* the delays are spread over the timer count */
+void reset(int32_t n)
+{
+	for (int32_t i = 0; i < n; i++)
+		timer[i].key = ((uint64_t)(ran[i] % n + 1) << 20) | i;
+}
+
+#define REARM(t, now, r, n) \
+	((t)->key = (((now) + (uint64_t)(r) % (n) + 1) << 20) \
+		| ((t)->key & 0xfffff))
+
+void bench_minheap(void)
+{
+	clock_t start, end;
+	double time;
+	uint64_t now = 0, sum = 0;
+	void **array = malloc(sizeof(void *) * TIMERS);
+	MINHEAP_NEW(head, array, TIMERS);
+
+	reset(TIMERS);
+	start = clock();
+	for (int32_t i = 0; i < TIMERS; i++)
+		F_SYMBOL(minheap_insert)(&head, &timer[i], cmp_minheap);
+
+	for (int32_t i = 0; i < OPS; i++) {
+		struct T *t;
+		if ((i & 7) == 7) {
+			t = &timer[ran[i] % TIMERS];
+			F_SYMBOL(minheap_erase)(&head,
+				F_SYMBOL(minheap_search)(&head, t),
+				cmp_minheap);
+		} else {
+			t = F_SYMBOL(minheap_extract)(&head, cmp_minheap);
+			now = t->key >> 20;
+			sum += t->key;
+		}
+		REARM(t, now, ran[i], TIMERS);
+		F_SYMBOL(minheap_insert)(&head, t, cmp_minheap);
+	}
+	end = clock();
+	time = (double)(end - start) / CLOCKS_PER_SEC;
+	printf("minheap: %d timers %d ops (sum:%016llx) -- %.6fs (%.2f/s)"
+		" %.2f ns/op\n", TIMERS, OPS, (unsigned long long)sum, time,
+		(double)OPS / time, (double)(time * 1000000000) / OPS);
+
+	free(array);
+}
+
+void bench_dheap(int32_t n, uint32_t arity, int32_t update)
+{
+	clock_t start, end;
+	double time;
+	uint64_t now = 0, sum = 0;
+	struct dheap_node **array = malloc(sizeof(void *) * n);
+	DHEAP_NEW(head, array, n, arity);
+
+	reset(n);
+	start = clock();
+	for (int32_t i = 0; i < n; i++)
+		F_SYMBOL(dheap_insert)(&head, &timer[i].node, cmp_dheap);
+
+	for (int32_t i = 0; i < OPS; i++) {
+		struct T *t;
+		if ((i & 7) == 7) {
+			t = &timer[ran[i] % n];
+			if (update) { /* reprioritize in place */
+				REARM(t, now, ran[i], n);
+				F_SYMBOL(dheap_update)(&head, &t->node,
+					cmp_dheap);
+				continue;
+			}
+			F_SYMBOL(dheap_erase)(&head, &t->node, cmp_dheap);
+		} else {
+			t = container_of(F_SYMBOL(dheap_extract)(&head,
+				cmp_dheap), struct T, node);
+			now = t->key >> 20;
+			sum += t->key;
+		}
+		REARM(t, now, ran[i], n);
+		F_SYMBOL(dheap_insert)(&head, &t->node, cmp_dheap);
+	}
+	end = clock();
+	time = (double)(end - start) / CLOCKS_PER_SEC;
+	printf("dheap-%u%s: %d timers %d ops (sum:%016llx) -- %.6fs"
+		" (%.2f/s) %.2f ns/op\n", arity, update ? " update" : "",
+		n, OPS, (unsigned long long)sum, time,
+		(double)OPS / time, (double)(time * 1000000000) / OPS);
+
+	free(array);
+}
+
+int main(void)
+{
+	RANDOM_TYPE0_NEW(r, 123456);
+	for (int32_t i = 0; i < OPS; i++) {
+		C_SYMBOL(random_r)(&r, &ran[i]);
+		ran[i] &= INT32_MAX;
+	}
+
+	bench_minheap();
+	for (int32_t n = TIMERS; n <= TIMERS_MAX; n *= 64) {
+		for (uint32_t arity = 2; arity <= 8; arity *= 2)
+			bench_dheap(n, arity, 0);
+		for (uint32_t arity = 2; arity <= 8; arity *= 2)
+			bench_dheap(n, arity, 1);
+	}
+
+	return 0;
+}
@@ -0,0 +1,229 @@
+/* @file: test_bench_ringbuf.c
+ * #desc:
+ *
+ * #copy:
+ *    Copyright (C) 1970 Public Free Software
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program. If not,
+ *    see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+#include <demoz/c/stdint.h>
+#include <demoz/c/atomic.h>
+#include <demoz/ds/ringbuf.h>
+#include <demoz/ds/ringbuf_spsc.h>
+#include <demoz/ds/ringbuf_mpmc.h>
+
+
+#define RSIZE (1 << 16)
+#define BYTES (1ULL << 28)
+#define CHUNK 64
+#define QSIZE 1024
+#define ITEMS (1 << 22)
+#define THREADS 4
+
+static uint8_t ring[RSIZE];
+static struct ringbuf_spsc_head spsc;
+static struct ringbuf_head locked;
+static int32_t lock;
+static struct ringbuf_mpmc_head mpmc;
+static int32_t producers;
+
+/* spin a little, then give the cpu away (fewer cores than threads) */
+void spin_wait(int32_t *spin)
+{
+	if (++*spin < 64) {
+		ATOMIC_PAUSE();
+	} else {
+		*spin = 0;
+		sched_yield();
+	}
+}
+
+double now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (double)ts.tv_sec + (double)ts.tv_nsec / 1000000000;
+}
+
+void *spsc_producer(void *arg)
+{
+	int32_t spin = 0;
+	uint8_t buf[CHUNK];
+	uint64_t n = 0;
+	(void)arg;
+
+	while (n < BYTES) {
+		for (int32_t i = 0; i < CHUNK; i++)
+			buf[i] = (uint8_t)(n + i);
+		uint32_t r = F_SYMBOL(ringbuf_spsc_write)(&spsc, buf, CHUNK);
+		if (!r) {
+			spin_wait(&spin);
+			continue;
+		}
+		n += r; /* a partial write, the rest is sent again */
+	}
+
+	return NULL;
+}
+
+void *locked_producer(void *arg)
+{
+	int32_t spin = 0;
+	uint8_t buf[CHUNK];
+	uint64_t n = 0;
+	uint32_t r;
+	(void)arg;
+
+	while (n < BYTES) {
+		for (int32_t i = 0; i < CHUNK; i++)
+			buf[i] = (uint8_t)(n + i);
+		while (ATOMIC_EXCHANGE(&lock, 1, ATOMIC_ACQUIRE))
+			spin_wait(&spin);
+		r = F_SYMBOL(ringbuf_write)(&locked, buf, CHUNK);
+		ATOMIC_STORE(&lock, 0, ATOMIC_RELEASE);
+		if (!r)
+			spin_wait(&spin);
+		n += r;
+	}
+
+	return NULL;
+}
+
+void test_spsc(int32_t lk)
+{
+	int32_t spin = 0;
+	pthread_t t;
+	uint8_t buf[CHUNK];
+	uint64_t n = 0, err = 0;
+	uint32_t r;
+	double start, time;
+
+	RINGBUF_SPSC_INIT(&spsc, ring, RSIZE);
+	RINGBUF_INIT(&locked, ring, RSIZE);
+
+	start = now();
+	pthread_create(&t, NULL, lk ? locked_producer : spsc_producer, NULL);
+	while (n < BYTES) {
+		if (lk) {
+			while (ATOMIC_EXCHANGE(&lock, 1, ATOMIC_ACQUIRE))
+				spin_wait(&spin);
+			r = F_SYMBOL(ringbuf_read)(&locked, buf, CHUNK);
+			ATOMIC_STORE(&lock, 0, ATOMIC_RELEASE);
+		} else {
+			r = F_SYMBOL(ringbuf_spsc_read)(&spsc, buf, CHUNK);
+		}
+		if (!r) {
+			spin_wait(&spin);
+			continue;
+		}
+		for (uint32_t i = 0; i < r; i++)
+			err += buf[i] != (uint8_t)(n + i);
+		n += r;
+	}
+	pthread_join(t, NULL);
+	time = now() - start;
+
+	printf("%s: %llu bytes (err:%llu) -- %.6fs (%.2f MB/s)"
+		" %.2f ns/chunk\n",
+		lk ? "ringbuf+lock" : "ringbuf_spsc",
+		(unsigned long long)n, (unsigned long long)err, time,
+		(double)n / time / 1000000,
+		time * 1000000000 / ((double)n / CHUNK));
+}
+
+void *mpmc_producer(void *arg)
+{
+	int32_t spin = 0;
+	uint64_t id = (uintptr_t)arg;
+
+	for (uint64_t i = id; i < ITEMS; i += producers) {
+		while (F_SYMBOL(ringbuf_mpmc_push)(&mpmc, &i))
+			spin_wait(&spin);
+	}
+
+	return NULL;
+}
+
+void *mpmc_consumer(void *arg)
+{
+	int32_t spin = 0;
+	uint64_t *sum = arg, v;
+
+	for (;;) {
+		if (F_SYMBOL(ringbuf_mpmc_pop)(&mpmc, &v)) {
+			spin_wait(&spin);
+			continue;
+		}
+		if (v == UINT64_MAX)
+			break;
+		*sum += v;
+	}
+
+	return NULL;
+}
+
+void test_mpmc(int32_t n)
+{
+	int32_t spin = 0;
+	pthread_t pt[THREADS], ct[THREADS];
+	uint64_t sum[THREADS] = { 0 }, total = 0, stop = UINT64_MAX;
+	double start, time;
+	void *buf = malloc(RINGBUF_MPMC_BUFSIZE(QSIZE, sizeof(uint64_t)));
+
+	F_SYMBOL(ringbuf_mpmc_init)(&mpmc, buf, QSIZE, sizeof(uint64_t));
+	producers = n;
+
+	start = now();
+	for (int32_t i = 0; i < n; i++) {
+		pthread_create(&ct[i], NULL, mpmc_consumer, &sum[i]);
+		pthread_create(&pt[i], NULL, mpmc_producer,
+			(void *)(uintptr_t)i);
+	}
+	for (int32_t i = 0; i < n; i++)
+		pthread_join(pt[i], NULL);
+	for (int32_t i = 0; i < n; i++) {
+		while (F_SYMBOL(ringbuf_mpmc_push)(&mpmc, &stop))
+			spin_wait(&spin);
+	}
+	for (int32_t i = 0; i < n; i++) {
+		pthread_join(ct[i], NULL);
+		total += sum[i];
+	}
+	time = now() - start;
+
+	printf("ringbuf_mpmc: %dP/%dC %d (sum:%d) -- %.6fs (%.2f/s)"
+		" %.2f ns/op\n", n, n, ITEMS,
+		total == (uint64_t)ITEMS * (ITEMS - 1) / 2, time,
+		(double)ITEMS / time, time * 1000000000 / ITEMS);
+
+	free(buf);
+}
+
+int main(void)
+{
+	test_spsc(0);
+	test_spsc(1);
+	for (int32_t n = 1; n <= THREADS; n *= 2)
+		test_mpmc(n);
+
+	return 0;
+}
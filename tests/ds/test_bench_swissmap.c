@@ -29,9 +29,11 @@
 #include <demoz/ds/swissmap.h>
 
 
-#define TSIZE (5000000)
+#define TSIZE (1 << 22)
 #define SIZE ((int32_t)(TSIZE * 0.90))
 #define A_SIZE ((int32_t)(SIZE * 0.1))
+#define F_TSIZE (1 << 22)
+#define BATCH 1024
 
 struct T {
 	int32_t key;
@@ -46,6 +48,24 @@ uint64_t hash(const void *a, size_t len)
 	return hash | (hash ^ 0x123456789) << 32;
 }
 
+uint64_t rehash(void *a)
+{
+	return hash(&((struct T *)a)->key, sizeof(int32_t));
+}
+
+void *call_alloc(size_t size, void *arg)
+{
+	(void)arg;
+	return malloc(size);
+}
+
+void call_free(void *p, size_t size, void *arg)
+{
+	(void)size;
+	(void)arg;
+	free(p);
+}
+
 int32_t cmp(void *a, const void *b, size_t len)
 {
 	int32_t key_a = ((struct T *)a)->key;
@@ -193,9 +213,303 @@ void test_swissmap(void)
 		(double)(time * 1000000000) / A_SIZE);
 }
 
+void test_swissmap_factor(void)
+{
+	clock_t start, end;
+	double time;
+	size_t total = SWISSMAP_ALIGN(F_TSIZE);
+	union swissmap_group *ctrl = malloc(sizeof(union swissmap_group)
+		* SWISSMAP_CLIGN(F_TSIZE));
+	struct T *array = malloc(sizeof(struct T) * total);
+	int32_t *array_key = malloc(sizeof(int32_t) * total);
+	struct T *p;
+
+	SWISSMAP_NEW(head, ctrl, array, sizeof(struct T),
+		total, hash, cmp);
+
+	/* 50%, 62.5%, 75%, 87.5% */
+	for (int32_t k = 4; k <= 7; k++) {
+		int32_t n = (int32_t)(total * k / 8), miss = 0;
+		F_SYMBOL(swissmap_empty)(&head);
+
+		/* distinct odd keys */
+		for (int32_t i = 0; i < n; i++) {
+			array_key[i] = (int32_t)((((uint32_t)i * 2654435761U)
+				& 0x7fffffff) << 1 | 1);
+			p = F_SYMBOL(swissmap_insert)(&head,
+				&array_key[i], sizeof(int32_t));
+			if (!p) {
+				printf("no speac: i:%d\n", i);
+			} else {
+				p->key = array_key[i];
+			}
+		}
+
+		/* find hit */
+		start = clock();
+		for (int32_t i = 0; i < n; i++) {
+			p = F_SYMBOL(swissmap_find)(&head,
+				&array_key[i], sizeof(int32_t));
+			if (!p || p->key != array_key[i])
+				printf("not found: i:%d\n", i);
+		}
+		end = clock();
+		time = (double)(end - start) / CLOCKS_PER_SEC;
+		printf("find hit: %d (%.1f) -- %.6fs (%.2f/s) %.2f ns/op\n",
+			n, (double)SWISSMAP_FACTOR(&head) / 10,
+			time,
+			(double)n / time,
+			(double)(time * 1000000000) / n);
+
+		/* find miss (the misses are even) */
+		start = clock();
+		for (int32_t i = 0; i < n; i++) {
+			int32_t key = array_key[i] ^ 1;
+			if (F_SYMBOL(swissmap_find)(&head, &key,
+					sizeof(int32_t)))
+				miss++;
+		}
+		end = clock();
+		time = (double)(end - start) / CLOCKS_PER_SEC;
+		printf("find miss: %d (%.1f) -- %.6fs (%.2f/s) %.2f ns/op"
+			" (hit: %d)\n",
+			n, (double)SWISSMAP_FACTOR(&head) / 10,
+			time,
+			(double)n / time,
+			(double)(time * 1000000000) / n,
+			miss);
+	}
+
+	free(ctrl);
+	free(array);
+	free(array_key);
+}
+
+void test_swissmap_auto(void)
+{
+	clock_t start, end, t;
+	double time, batch;
+	int32_t *array_key = malloc(sizeof(int32_t) * SIZE * 2);
+	struct T *p;
+
+	SWISSMAP_AUTO_NEW(head, sizeof(struct T), hash, cmp, rehash,
+		call_alloc, call_free, NULL, SWISSMAP_AUTO_SHRINK);
+
+	/* distinct odd keys */
+	for (int32_t i = 0; i < SIZE * 2; i++)
+		array_key[i] = (int32_t)((((uint32_t)i * 2654435761U)
+			& 0x7fffffff) << 1 | 1);
+
+	/* insert (grow from empty), the slowest batch shows the spikes */
+	batch = 0;
+	start = t = clock();
+	for (int32_t i = 0; i < SIZE; i++) {
+		p = F_SYMBOL(swissmap_insert)(&head,
+			&array_key[i], sizeof(int32_t));
+		if (!p) {
+			printf("no speac: i:%d\n", i);
+		} else {
+			p->key = array_key[i];
+		}
+		if (!((i + 1) % BATCH)) {
+			end = clock();
+			if ((double)(end - t) > batch)
+				batch = (double)(end - t);
+			t = end;
+		}
+	}
+	end = clock();
+	time = (double)(end - start) / CLOCKS_PER_SEC;
+	printf("auto insert: %d (%.1f, %zu) -- %.6fs (%.2f/s) %.2f ns/op"
+		" (max: %.2f ns/op)\n",
+		SIZE, (double)SWISSMAP_FACTOR(&head) / 10,
+		SWISSMAP_TOTAL(&head),
+		time,
+		(double)SIZE / time,
+		(double)(time * 1000000000) / SIZE,
+		batch / CLOCKS_PER_SEC * 1000000000 / BATCH);
+
+	/* churn: sliding window, the tombstones are purged in place */
+	start = clock();
+	for (int32_t i = 0; i < SIZE; i++) {
+		if (!F_SYMBOL(swissmap_delete)(&head,
+				&array_key[i], sizeof(int32_t)))
+			printf("not found: i:%d\n", i);
+		p = F_SYMBOL(swissmap_insert)(&head,
+			&array_key[i + SIZE], sizeof(int32_t));
+		if (!p) {
+			printf("no speac: i:%d\n", i + SIZE);
+		} else {
+			p->key = array_key[i + SIZE];
+		}
+	}
+	end = clock();
+	time = (double)(end - start) / CLOCKS_PER_SEC;
+	printf("auto churn: %d (%.1f, %zu) -- %.6fs (%.2f/s) %.2f ns/op\n",
+		SIZE, (double)SWISSMAP_FACTOR(&head) / 10,
+		SWISSMAP_TOTAL(&head),
+		time,
+		(double)SIZE / time,
+		(double)(time * 1000000000) / SIZE);
+
+	/* find */
+	start = clock();
+	for (int32_t i = SIZE; i < SIZE * 2; i++) {
+		p = F_SYMBOL(swissmap_find)(&head,
+			&array_key[i], sizeof(int32_t));
+		if (!p || p->key != array_key[i])
+			printf("not found: i:%d\n", i);
+	}
+	end = clock();
+	time = (double)(end - start) / CLOCKS_PER_SEC;
+	printf("auto find: %d (%.1f, %zu) -- %.6fs (%.2f/s) %.2f ns/op\n",
+		SIZE, (double)SWISSMAP_FACTOR(&head) / 10,
+		SWISSMAP_TOTAL(&head),
+		time,
+		(double)SIZE / time,
+		(double)(time * 1000000000) / SIZE);
+
+	/* delete (shrink) */
+	start = clock();
+	for (int32_t i = SIZE; i < SIZE * 2; i++) {
+		if (!F_SYMBOL(swissmap_delete)(&head,
+				&array_key[i], sizeof(int32_t)))
+			printf("not found: i:%d\n", i);
+	}
+	end = clock();
+	time = (double)(end - start) / CLOCKS_PER_SEC;
+	printf("auto delete: %d (%zu) -- %.6fs (%.2f/s) %.2f ns/op\n",
+		SIZE, SWISSMAP_TOTAL(&head),
+		time,
+		(double)SIZE / time,
+		(double)(time * 1000000000) / SIZE);
+
+	F_SYMBOL(swissmap_release)(&head);
+	free(array_key);
+}
+
+void set_key(void *p, size_t i, int32_t new, void *arg)
+{
+	(void)new;
+	((struct T *)p)->key = ((int32_t *)arg)[i];
+}
+
+void test_swissmap_batch(void)
+{
+	clock_t start, end;
+	double time;
+	size_t total = SWISSMAP_ALIGN(F_TSIZE), count;
+	int32_t n = (int32_t)(total * 3 / 4);
+	union swissmap_group *ctrl = malloc(sizeof(union swissmap_group)
+		* SWISSMAP_CLIGN(F_TSIZE));
+	struct T *array = malloc(sizeof(struct T) * total);
+	int32_t *array_key = malloc(sizeof(int32_t) * n);
+	void **bucket = malloc(sizeof(void *) * n);
+	struct T *p;
+
+	SWISSMAP_NEW(head, ctrl, array, sizeof(struct T),
+		total, hash, cmp);
+
+	/* distinct odd keys */
+	for (int32_t i = 0; i < n; i++)
+		array_key[i] = (int32_t)((((uint32_t)i * 2654435761U)
+			& 0x7fffffff) << 1 | 1);
+
+	/* insert */
+	F_SYMBOL(swissmap_empty)(&head);
+	start = clock();
+	for (int32_t i = 0; i < n; i++) {
+		p = F_SYMBOL(swissmap_insert)(&head,
+			&array_key[i], sizeof(int32_t));
+		if (!p) {
+			printf("no speac: i:%d\n", i);
+		} else {
+			p->key = array_key[i];
+		}
+	}
+	end = clock();
+	time = (double)(end - start) / CLOCKS_PER_SEC;
+	printf("insert: %d (%.1f) -- %.6fs (%.2f/s) %.2f ns/op\n",
+		n, (double)SWISSMAP_FACTOR(&head) / 10,
+		time,
+		(double)n / time,
+		(double)(time * 1000000000) / n);
+
+	/* insert batch */
+	F_SYMBOL(swissmap_empty)(&head);
+	start = clock();
+	count = F_SYMBOL(swissmap_insert_batch)(&head, array_key,
+		sizeof(int32_t), n, set_key, array_key);
+	end = clock();
+	if (count != (size_t)n)
+		printf("no speac: i:%zu\n", count);
+	time = (double)(end - start) / CLOCKS_PER_SEC;
+	printf("insert batch: %d (%.1f) -- %.6fs (%.2f/s) %.2f ns/op\n",
+		n, (double)SWISSMAP_FACTOR(&head) / 10,
+		time,
+		(double)n / time,
+		(double)(time * 1000000000) / n);
+
+	/* find */
+	start = clock();
+	for (int32_t i = 0; i < n; i++) {
+		p = F_SYMBOL(swissmap_find)(&head,
+			&array_key[i], sizeof(int32_t));
+		if (!p || p->key != array_key[i])
+			printf("not found: i:%d\n", i);
+	}
+	end = clock();
+	time = (double)(end - start) / CLOCKS_PER_SEC;
+	printf("find: %d (%.1f) -- %.6fs (%.2f/s) %.2f ns/op\n",
+		n, (double)SWISSMAP_FACTOR(&head) / 10,
+		time,
+		(double)n / time,
+		(double)(time * 1000000000) / n);
+
+	/* find batch */
+	start = clock();
+	count = F_SYMBOL(swissmap_find_batch)(&head, array_key,
+		sizeof(int32_t), n, bucket);
+	end = clock();
+	if (count != (size_t)n)
+		printf("not found: %zu\n", n - count);
+	for (int32_t i = 0; i < n; i++) {
+		p = bucket[i];
+		if (!p || p->key != array_key[i])
+			printf("not found: i:%d\n", i);
+	}
+	time = (double)(end - start) / CLOCKS_PER_SEC;
+	printf("find batch: %d (%.1f) -- %.6fs (%.2f/s) %.2f ns/op\n",
+		n, (double)SWISSMAP_FACTOR(&head) / 10,
+		time,
+		(double)n / time,
+		(double)(time * 1000000000) / n);
+
+	/* iterate */
+	count = 0;
+	start = clock();
+	SWISSMAP_FOR_EACH(&head, pos, p)
+		count++;
+	end = clock();
+	time = (double)(end - start) / CLOCKS_PER_SEC;
+	printf("iterate: %zu (%.1f) -- %.6fs (%.2f/s) %.2f ns/op\n",
+		count, (double)SWISSMAP_FACTOR(&head) / 10,
+		time,
+		(double)count / time,
+		(double)(time * 1000000000) / count);
+
+	free(ctrl);
+	free(array);
+	free(array_key);
+	free(bucket);
+}
+
 int main(void)
 {
 	test_swissmap();
+	test_swissmap_factor();
+	test_swissmap_auto();
+	test_swissmap_batch();
 
 	return 0;
 }
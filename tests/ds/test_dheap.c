@@ -0,0 +1,120 @@
+/* @file: test_dheap.c
+ * #desc:
+ *
+ * #copy:
+ *    Copyright (C) 1970 Public Free Software
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program. If not,
+ *    see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <demoz/c/stddef.h>
+#include <demoz/c/stdint.h>
+#include <demoz/c/stdlib.h>
+#include <demoz/ds/dheap.h>
+
+
+#define SIZE 4096
+
+struct T {
+	int32_t key;
+	struct dheap_node node;
+};
+
+int32_t cmp(void *a, void *b)
+{
+	int32_t key_a = container_of(a, struct T, node)->key;
+	int32_t key_b = container_of(b, struct T, node)->key;
+
+	return (key_a > key_b) ? 1 : ((key_a < key_b) ? -1 : 0);
+}
+
+void test_dheap(uint32_t arity)
+{
+	static const int32_t keys[] = { 50, 20, 70, 10, 40, 90, 30, 60, 80 };
+	struct T t[9];
+	struct dheap_node *array[9], *p;
+	DHEAP_NEW(head, array, 9, arity);
+
+	for (int32_t i = 0; i < 9; i++) {
+		t[i].key = keys[i];
+		DHEAP_NODE_INIT(&t[i].node);
+		F_SYMBOL(dheap_insert)(&head, &t[i].node, cmp);
+	}
+	printf("arity: %u size: %zu first: %d\n", arity, DHEAP_SIZE(&head),
+		container_of(DHEAP_FIRST(&head), struct T, node)->key);
+
+	t[5].key = 5; /* 90 -> 5 */
+	F_SYMBOL(dheap_decrease)(&head, &t[5].node, cmp);
+	t[3].key = 75; /* 10 -> 75 */
+	F_SYMBOL(dheap_increase)(&head, &t[3].node, cmp);
+	t[0].key = 15; /* 50 -> 15 */
+	F_SYMBOL(dheap_update)(&head, &t[0].node, cmp);
+
+	printf("erase: %d", F_SYMBOL(dheap_erase)(&head, &t[4].node, cmp));
+	printf(" again: %d in: %d\n",
+		F_SYMBOL(dheap_erase)(&head, &t[4].node, cmp),
+		DHEAP_IN(&head, &t[4].node));
+
+	printf("extract:");
+	while ((p = F_SYMBOL(dheap_extract)(&head, cmp)))
+		printf(" %d", container_of(p, struct T, node)->key);
+	printf("\n");
+}
+
+void test_dheap_random(uint32_t arity)
+{
+	struct T *t = malloc(sizeof(struct T) * SIZE);
+	struct dheap_node **array = malloc(sizeof(void *) * SIZE), *p;
+	int32_t v, last = INT32_MIN, err = 0;
+	RANDOM_TYPE0_NEW(ran, 123456);
+	DHEAP_NEW(head, array, SIZE, arity);
+
+	for (int32_t i = 0; i < SIZE; i++) {
+		C_SYMBOL(random_r)(&ran, &t[i].key);
+		F_SYMBOL(dheap_insert)(&head, &t[i].node, cmp);
+	}
+	/* reprioritize and erase by handle */
+	for (int32_t i = 0; i + 1 < SIZE; i += 3) {
+		C_SYMBOL(random_r)(&ran, &v);
+		t[i].key = v;
+		F_SYMBOL(dheap_update)(&head, &t[i].node, cmp);
+		err += F_SYMBOL(dheap_erase)(&head, &t[i + 1].node, cmp) != 0;
+	}
+	for (size_t i = 0; i < DHEAP_SIZE(&head); i++)
+		err += array[i]->index != i;
+
+	size_t n = DHEAP_SIZE(&head);
+	while ((p = F_SYMBOL(dheap_extract)(&head, cmp))) {
+		v = container_of(p, struct T, node)->key;
+		err += v < last;
+		last = v;
+	}
+	printf("random: arity: %u size: %zu err: %d\n", arity, n, err);
+
+	free(t);
+	free(array);
+}
+
+int main(void)
+{
+	for (uint32_t arity = 2; arity <= 8; arity *= 2)
+		test_dheap(arity);
+	for (uint32_t arity = 2; arity <= 8; arity *= 2)
+		test_dheap_random(arity);
+
+	return 0;
+}
@@ -20,6 +20,8 @@
  */
 
 #include <stdio.h>
+#include <string.h>
+#include <sys/uio.h>
 #include <demoz/c/stdint.h>
 #include <demoz/ds/ringbuf.h>
 
@@ -54,9 +56,45 @@ void test_ringbuf(void)
 	printf(": %s\n", out);
 }
 
+void test_ringbuf_span(void)
+{
+	uint8_t buf[16];
+	struct ringbuf_span span[2];
+	uint32_t r;
+	RINGBUF_NEW(head, buf, 16);
+
+	/* move the indexes near the end */
+	F_SYMBOL(ringbuf_commit)(&head, 12);
+	F_SYMBOL(ringbuf_consume)(&head, 12);
+
+	r = F_SYMBOL(ringbuf_reserve)(&head, span, 10);
+	printf("reserve: %d:%u spans:%d %zu+%zu\n", 10, r,
+		RINGBUF_SPAN_NUM(span), span[0].len, span[1].len);
+	memcpy(span[0].base, "span", 4);
+	memcpy(span[1].base, "s out\n", 6);
+	F_SYMBOL(ringbuf_commit)(&head, r);
+	printf("commit: used:%u\n", RINGBUF_USED(&head));
+
+	/* no copy, the spans are iovecs */
+	r = F_SYMBOL(ringbuf_peek_span)(&head, span, 16);
+	printf("peek_span: %d:%u spans:%d\n", 16, r, RINGBUF_SPAN_NUM(span));
+	fflush(stdout);
+	writev(1, (struct iovec *)span, RINGBUF_SPAN_NUM(span));
+
+	F_SYMBOL(ringbuf_consume)(&head, 4);
+	r = F_SYMBOL(ringbuf_peek_span)(&head, span, 16);
+	printf("consume: %d used:%u spans:%d %zu+%zu\n", 4,
+		RINGBUF_USED(&head), RINGBUF_SPAN_NUM(span),
+		span[0].len, span[1].len);
+
+	r = F_SYMBOL(ringbuf_reserve)(&head, span, 32);
+	printf("reserve: %d:%u\n", 32, r);
+}
+
 int main(void)
 {
 	test_ringbuf();
+	test_ringbuf_span();
 
 	return 0;
 }
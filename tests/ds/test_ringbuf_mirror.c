@@ -0,0 +1,75 @@
+/* @file: test_ringbuf_mirror.c
+ * #desc:
+ *
+ * #copy:
+ *    Copyright (C) 1970 Public Free Software
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program. If not,
+ *    see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <demoz/c/stdint.h>
+#include <demoz/ds/ringbuf.h>
+#include <demoz/ds/ringbuf_mirror.h>
+
+
+void test_ringbuf_mirror(void)
+{
+	struct ringbuf_head head;
+	uint8_t *p;
+	uint32_t r;
+
+	if (F_SYMBOL(ringbuf_mirror_create)(&head, 100)) {
+		printf("ringbuf_mirror_create: error\n");
+		return;
+	}
+	printf("size: %u mask: %u\n", head.size, head.mask);
+
+	/* the second half is the same memory */
+	head.buf[0] = 'a';
+	head.buf[head.size + 1] = 'b';
+	printf("mirror: %c%c\n", head.buf[head.size], head.buf[1]);
+
+	/* move the indexes near the end */
+	F_SYMBOL(ringbuf_commit)(&head, head.size - 5);
+	F_SYMBOL(ringbuf_consume)(&head, head.size - 5);
+
+	/* no wrap: one pointer, written across the end */
+	p = RINGBUF_MIRROR_WRITE(&head);
+	memcpy(p, "Hello, world!", 13);
+	F_SYMBOL(ringbuf_commit)(&head, 13);
+	printf("write: %u used:%u offset:%u\n", 13, RINGBUF_USED(&head),
+		(uint32_t)(p - head.buf));
+
+	p = RINGBUF_MIRROR_READ(&head);
+	printf("read: %.*s\n", (int)RINGBUF_USED(&head), p);
+	printf("start: %.8s\n", head.buf);
+
+	/* the ringbuf calls see the same data */
+	uint8_t out[16];
+	r = F_SYMBOL(ringbuf_read)(&head, out, 16);
+	printf("ringbuf_read: %u %.*s\n", r, (int)r, out);
+
+	F_SYMBOL(ringbuf_mirror_destroy)(&head);
+	printf("destroy: null:%d\n", !head.buf);
+}
+
+int main(void)
+{
+	test_ringbuf_mirror();
+
+	return 0;
+}
@@ -0,0 +1,62 @@
+/* @file: test_ringbuf_mpmc.c
+ * #desc:
+ *
+ * #copy:
+ *    Copyright (C) 1970 Public Free Software
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program. If not,
+ *    see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <demoz/c/stdint.h>
+#include <demoz/ds/ringbuf_mpmc.h>
+
+
+void test_ringbuf_mpmc(void)
+{
+	uint64_t buf[4 * 2];
+	struct ringbuf_mpmc_head head;
+	int32_t v, r;
+
+	F_SYMBOL(ringbuf_mpmc_init)(&head, buf, 4, sizeof(int32_t));
+	printf("stride: %u bufsize: %u\n", head.stride,
+		(uint32_t)RINGBUF_MPMC_BUFSIZE(4, sizeof(int32_t)));
+
+	for (v = 1; v <= 5; v++) {
+		r = F_SYMBOL(ringbuf_mpmc_push)(&head, &v);
+		printf("push: %d:%d\n", v, r);
+	}
+
+	/* the slots are reused on the next lap */
+	for (int32_t i = 0; i < 6; i++) {
+		r = F_SYMBOL(ringbuf_mpmc_pop)(&head, &v);
+		printf("pop: %d", r);
+		if (!r)
+			printf(" %d", v);
+		printf("\n");
+		if (i == 1) {
+			v = 6;
+			r = F_SYMBOL(ringbuf_mpmc_push)(&head, &v);
+			printf("push: %d:%d\n", v, r);
+		}
+	}
+}
+
+int main(void)
+{
+	test_ringbuf_mpmc();
+
+	return 0;
+}
@@ -0,0 +1,62 @@
+/* @file: test_ringbuf_spsc.c
+ * #desc:
+ *
+ * #copy:
+ *    Copyright (C) 1970 Public Free Software
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program. If not,
+ *    see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <demoz/c/stdint.h>
+#include <demoz/ds/ringbuf_spsc.h>
+
+
+void test_ringbuf_spsc(void)
+{
+	uint8_t buf[16], out[32];
+	uint32_t r;
+	RINGBUF_SPSC_NEW(head, buf, 16);
+
+	r = F_SYMBOL(ringbuf_spsc_write)(&head, (uint8_t *)"Hello, world!", 13);
+	printf("write: %d:%u used:%u\n", 13, r, RINGBUF_SPSC_USED(&head));
+
+	r = F_SYMBOL(ringbuf_spsc_read)(&head, out, 7);
+	printf("read: %d:%u\n", 7, r);
+	out[r] = '\0';
+	printf(": %s\n", out);
+
+	/* wraps around, the ring is full */
+	r = F_SYMBOL(ringbuf_spsc_write)(&head, (uint8_t *)"0123456789ab", 12);
+	printf("write: %d:%u used:%u\n", 12, r, RINGBUF_SPSC_USED(&head));
+
+	r = F_SYMBOL(ringbuf_spsc_write)(&head, (uint8_t *)"x", 1);
+	printf("write: %d:%u\n", 1, r);
+
+	r = F_SYMBOL(ringbuf_spsc_read)(&head, out, 32);
+	printf("read: %d:%u\n", 32, r);
+	out[r] = '\0';
+	printf(": %s\n", out);
+
+	r = F_SYMBOL(ringbuf_spsc_read)(&head, out, 32);
+	printf("read: %d:%u used:%u\n", 32, r, RINGBUF_SPSC_USED(&head));
+}
+
+int main(void)
+{
+	test_ringbuf_spsc();
+
+	return 0;
+}